@@ -35,6 +35,20 @@ void LoadContentConfig()
   contentSystem->ContentOutputPath = FilePath::Combine(GetUserDocumentsApplicationDirectory(), "ContentOutput", revisionChangesetName);
   contentSystem->PrebuiltContentPath = FilePath::Combine(sourceDirectory, "Build", "PrebuiltContent", revisionChangesetName);
   ZPrint("Content output directory '%s'\n", contentSystem->ContentOutputPath.c_str());
+
+  // The artifact cache mixes the engine version into its keys, so one
+  // directory can be shared by every checkout and version without mixing up
+  // their outputs
+  if (contentConfig && contentConfig->ArtifactCacheEnabled)
+  {
+    String artifactCachePath = contentConfig->ArtifactCacheDirectory;
+    if (artifactCachePath.Empty())
+      artifactCachePath = FilePath::Combine(GetUserDocumentsApplicationDirectory(), "ArtifactCache");
+
+    contentSystem->ArtifactCachePath = artifactCachePath;
+    contentSystem->ArtifactCacheMaxSize = (u64)contentConfig->ArtifactCacheSizeMb * 1024 * 1024;
+    ZPrint("Content artifact cache '%s'\n", artifactCachePath.c_str());
+  }
 }
 
 bool LoadContentLibrary(StringParam name)
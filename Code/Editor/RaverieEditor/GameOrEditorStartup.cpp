@@ -9,6 +9,10 @@ void CreateEditor(StringParam projectFile);
 void CreateGame(StringParam projectFile, Cog* projectCog);
 void LoadGamePackages(StringParam projectFile, Cog* projectCog);
 
+// Script functions called at least this many times are written out by the
+// 'AotOutput' argument
+static const size_t cAotMinCallCount = 1000;
+
 StartupPhase::Enum GameOrEditorStartup::RunIteration()
 {
   switch (mPhase)
@@ -81,6 +85,9 @@ void GameOrEditorStartup::Initialize()
   if (Environment::GetValue<bool>("BeginTracing", false))
     Profile::ProfileSystem::Instance->BeginTracing();
 
+  // Count script calls so the hot functions can be written out on shutdown
+  AotCodeGenerator::CountCalls = !environment->GetParsedArgument("AotOutput").Empty();
+
   CommonLibrary::Initialize();
 
   // Temporary location for registering handle managers
@@ -227,10 +234,31 @@ void GameOrEditorStartup::EngineUpdate()
   NextPhase();
 }
 
+void GameOrEditorStartup::WriteAotCode()
+{
+  String outputFile = Environment::GetInstance()->GetParsedArgument("AotOutput");
+  if (outputFile.Empty())
+    return;
+
+  // Gather the hot functions of every script library that is still loaded
+  Array<Function*> functions;
+  forRange (ResourceLibrary* library, Z::gResources->LoadedResourceLibraries.Values())
+  {
+    Library* scriptLibrary = library->mSwapScript.mCurrentLibrary;
+    if (scriptLibrary != nullptr)
+      AotCodeGenerator::GetHotFunctions(scriptLibrary, cAotMinCallCount, functions);
+  }
+
+  String code = AotCodeGenerator::Generate(functions, AotCodeGenerator::ProjectRegistrationName);
+  WriteStringRangeToFile(outputFile, code);
+  ZPrint("Wrote %d ahead of time functions to '%s' (build with RAVERIE_AOT_SOURCE set to it)\n", (int)functions.Size(), outputFile.c_str());
+}
+
 void GameOrEditorStartup::Shutdown()
 {
   {
     ProfileScopeFunction();
+    WriteAotCode();
     Z::gEngine->Shutdown();
 
     Core::GetInstance().GetLibrary()->ClearComponents();
@@ -416,6 +444,23 @@ void GameOrEditorStartup::UserCreation()
   // rather than each time a content library begins and ends building (this batches everything)
   Shell::sInstance->mInitialLoadingComplete = true;
   Shell::sInstance->SetProgress(nullptr, 1.0f);
+
+  // Everything the tests need is loaded by now, quit once they've run
+  if (Environment::GetInstance()->mParsedCommandLineArguments.ContainsKey("RunUnitTests"))
+  {
+    RunUnitTests();
+    Z::gEngine->Terminate();
+  }
+}
+
+void GameOrEditorStartup::RunUnitTests()
+{
+  ZPrint("Running unit tests\n");
+  Sha1Builder::RunUnitTests();
+  PhysicsSnapshot::RunUnitTests();
+  ContentBuildCache::RunUnitTests();
+  ContentArtifactCache::RunUnitTests();
+  ZPrint("Unit tests complete\n");
 }
 
 } // namespace Raverie
@@ -60,6 +60,9 @@ private:
   void JobsComplete();
   void EngineUpdate();
   void Shutdown();
+  void WriteAotCode();
+  /// Runs the engine's unit tests (see the RunUnitTests command line argument).
+  void RunUnitTests();
 
   void NextPhase();
 
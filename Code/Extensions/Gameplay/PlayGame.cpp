@@ -21,6 +21,10 @@ void LoadResourcePackageRelative(StringParam baseDirectory, StringParam libraryN
 void LoadGamePackages(StringParam projectFile, Cog* projectCog)
 {
   String projectDirectory = FilePath::GetDirectoryPath(projectFile);
+
+  // Nothing browses every resource when just playing the game, so large data
+  // (textures, meshes, sounds) is only loaded once something uses it
+  Z::gResources->mLoadOnDemand = true;
   LoadResourcePackageRelative(projectDirectory, "FragmentCore");
   LoadResourcePackageRelative(projectDirectory, "Loading");
   LoadResourcePackageRelative(projectDirectory, "EngineCore");
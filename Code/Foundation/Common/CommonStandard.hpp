@@ -92,6 +92,7 @@ typedef double MaxAlignmentType;
 #include "Memory/Memory.hpp"
 #include "Memory/Pool.hpp"
 #include "Memory/Stack.hpp"
+#include "Memory/FrameArena.hpp"
 #include "Utility/Permuter.hpp"
 #include "String/Rune.hpp"
 #include "String/String.hpp"
@@ -343,6 +343,67 @@ void Sort(range r, Comparer comparer)
   QuickSort(r.Begin(), r.End(), &r.Front(), comparer);
 }
 
+// Stable least significant digit radix sort by an unsigned integer key.
+// Scratch must point at storage for at least as many elements as the range.
+// Digits that are the same for every element are skipped, so keys that only
+// use a few of their bytes only pay for those passes.
+template <typename range, typename KeyFunctor>
+void RadixSort(range r, typename range::contiguousRangeType* scratch, KeyFunctor getKey)
+{
+  typedef typename range::contiguousRangeType type;
+  typedef decltype(getKey(r.Front())) keyType;
+  const size_t cDigitCount = sizeof(keyType);
+
+  size_t size = r.Length();
+  if (size < 2)
+    return;
+
+  // Build the histograms of every digit in one pass
+  size_t counts[cDigitCount][256] = {};
+  for (size_t i = 0; i < size; ++i)
+  {
+    keyType key = getKey(r[i]);
+    for (size_t digit = 0; digit < cDigitCount; ++digit)
+      ++counts[digit][(key >> (digit * 8)) & 0xFF];
+  }
+
+  type* source = r.Begin();
+  type* destination = scratch;
+  for (size_t digit = 0; digit < cDigitCount; ++digit)
+  {
+    size_t* digitCounts = counts[digit];
+    keyType firstKey = getKey(source[0]);
+    if (digitCounts[(firstKey >> (digit * 8)) & 0xFF] == size)
+      continue;
+
+    // Convert the counts to starting offsets
+    size_t offset = 0;
+    for (size_t bucket = 0; bucket < 256; ++bucket)
+    {
+      size_t count = digitCounts[bucket];
+      digitCounts[bucket] = offset;
+      offset += count;
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+      size_t bucket = (getKey(source[i]) >> (digit * 8)) & 0xFF;
+      destination[digitCounts[bucket]++] = source[i];
+    }
+
+    type* temp = source;
+    source = destination;
+    destination = temp;
+  }
+
+  // An odd number of passes leaves the result in the scratch buffer
+  if (source != r.Begin())
+  {
+    for (size_t i = 0; i < size; ++i)
+      r[i] = source[i];
+  }
+}
+
 template <typename iterator>
 void Reverse(iterator start, iterator end)
 {
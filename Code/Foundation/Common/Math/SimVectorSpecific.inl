@@ -135,6 +135,11 @@ SimInline SimVec Max(SimVecParam vec, SimVecParam maxVec)
   return _mm_max_ps(vec, maxVec);
 }
 
+SimInline int MoveMask(SimVecParam vec)
+{
+  return _mm_movemask_ps(vec);
+}
+
 SimInline SimVec Select(SimVecParam v0, SimVecParam v1, SimVecParam select)
 {
   return OrVec(AndNotVec(select, v0), AndVec(v1, select));
@@ -45,6 +45,8 @@ SimVec LessEqual(SimVecParam lhs, SimVecParam rhs);
 // bounds logic/arithmetic
 SimVec Min(SimVecParam vec, SimVecParam minVec);
 SimVec Max(SimVecParam vec, SimVecParam maxVec);
+// packs the sign bit of each element into the low 4 bits of an int (x is bit 0)
+int MoveMask(SimVecParam vec);
 // larger primitives (multiple sse instructions, 1 vmx instruction)
 // Selects v0 if the element mask is empty, v1 if it is not
 SimVec Select(SimVecParam v0, SimVecParam v1, SimVecParam select);
@@ -0,0 +1,237 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+namespace Memory
+{
+
+// Each thread is given the index of its sub arena the first time it allocates
+static Atomic<s32> gNextFrameArenaThread;
+static RaverieThreadLocal s32 tFrameArenaThread = -1;
+
+static uint GetFrameArenaThread()
+{
+  if (tFrameArenaThread < 0)
+    tFrameArenaThread = gNextFrameArenaThread.FetchAdd(1);
+  return Math::Min((uint)tFrameArenaThread, FrameArena::cMaxThreads - 1);
+}
+
+static size_t AlignFrameSize(size_t numberOfBytes)
+{
+  return (numberOfBytes + FrameArena::cAlignment - 1) & ~(FrameArena::cAlignment - 1);
+}
+
+FrameArena::FrameArena(cstr name, Graph* parent, size_t chunkSize) : Graph(name, parent)
+{
+  mChunkSize = chunkSize;
+  mCurrentBuffer = 0;
+  mFreeChunks = nullptr;
+  mDedicatedBytes = 0;
+  mLastFrameBytes = 0;
+  mPeakFrameBytes = 0;
+
+  for (uint i = 0; i < 2; ++i)
+  {
+    size_t bufferSize = sizeof(ThreadArena) * cMaxThreads;
+    mBuffers[i] = (ThreadArena*)zAllocate(bufferSize);
+    memset(mBuffers[i], 0, bufferSize);
+  }
+}
+
+FrameArena::~FrameArena()
+{
+  CleanUp();
+}
+
+void FrameArena::Print(size_t tabs, size_t flags)
+{
+  PrintHelper(tabs, flags, "FrameArena");
+}
+
+MemPtr FrameArena::Allocate(size_t numberOfBytes)
+{
+  size_t size = AlignFrameSize(Math::Max(numberOfBytes, (size_t)1));
+
+  uint threadIndex = GetFrameArenaThread();
+  bool shared = (threadIndex == cMaxThreads - 1);
+  if (shared)
+    mSharedLock.Lock();
+
+  ThreadArena& arena = mBuffers[mCurrentBuffer][threadIndex];
+  if (arena.mCurrent + size > arena.mEnd)
+    AddChunk(arena, size);
+
+  byte* memory = arena.mCurrent;
+  arena.mCurrent += size;
+  arena.mBytes += size;
+  ++arena.mAllocations;
+
+  if (shared)
+    mSharedLock.Unlock();
+  return memory;
+}
+
+void FrameArena::Deallocate(MemPtr ptr, size_t numberOfBytes)
+{
+}
+
+void FrameArena::AddChunk(ThreadArena& arena, size_t numberOfBytes)
+{
+  // The rest of the current chunk is wasted, allocations that do not fit in a
+  // standard chunk get one of their own (freed when the frame is reclaimed)
+  size_t headerSize = AlignFrameSize(sizeof(Chunk));
+  size_t chunkSize = Math::Max(mChunkSize, numberOfBytes + headerSize);
+
+  mFreeLock.Lock();
+  Chunk* chunk = nullptr;
+  if (chunkSize == mChunkSize && mFreeChunks != nullptr)
+  {
+    chunk = mFreeChunks;
+    mFreeChunks = chunk->mNext;
+  }
+  else
+  {
+    chunk = (Chunk*)zAllocate(chunkSize);
+    chunk->mSize = chunkSize;
+    mDedicatedBytes += chunkSize;
+  }
+  mFreeLock.Unlock();
+
+  chunk->mNext = arena.mChunks;
+  arena.mChunks = chunk;
+  arena.mCurrent = (byte*)chunk + headerSize;
+  arena.mEnd = (byte*)chunk + chunkSize;
+}
+
+void FrameArena::Recycle(ThreadArena* arenas)
+{
+  mFreeLock.Lock();
+  for (uint i = 0; i < cMaxThreads; ++i)
+  {
+    ThreadArena& arena = arenas[i];
+    Chunk* chunk = arena.mChunks;
+    while (chunk != nullptr)
+    {
+      Chunk* next = chunk->mNext;
+      if (chunk->mSize == mChunkSize)
+      {
+        chunk->mNext = mFreeChunks;
+        mFreeChunks = chunk;
+      }
+      else
+      {
+        mDedicatedBytes -= chunk->mSize;
+        zDeallocate(chunk);
+      }
+      chunk = next;
+    }
+
+    arena.mCurrent = nullptr;
+    arena.mEnd = nullptr;
+    arena.mChunks = nullptr;
+    arena.mBytes = 0;
+    arena.mAllocations = 0;
+  }
+  mFreeLock.Unlock();
+}
+
+void FrameArena::Reset()
+{
+  // Record the frame that just ended before its memory becomes the
+  // previous frame's
+  ThreadArena* current = mBuffers[mCurrentBuffer];
+  size_t frameBytes = 0;
+  size_t frameAllocations = 0;
+  for (uint i = 0; i < cMaxThreads; ++i)
+  {
+    frameBytes += current[i].mBytes;
+    frameAllocations += current[i].mAllocations;
+  }
+
+  mLastFrameBytes = frameBytes;
+  mPeakFrameBytes = Math::Max(mPeakFrameBytes, frameBytes);
+
+  // The memory from two frames ago can no longer be referenced
+  mCurrentBuffer = 1 - mCurrentBuffer;
+  Recycle(mBuffers[mCurrentBuffer]);
+
+  mData.Allocations += frameAllocations;
+  mData.Active = frameAllocations;
+  mData.BytesAllocated = frameBytes;
+  mData.PeakAllocated = mPeakFrameBytes;
+  mData.BytesDedicated = mDedicatedBytes;
+}
+
+void FrameArena::CleanUp()
+{
+  if (mBuffers[0] == nullptr)
+    return;
+
+  for (uint i = 0; i < 2; ++i)
+  {
+    Recycle(mBuffers[i]);
+    zDeallocate(mBuffers[i]);
+    mBuffers[i] = nullptr;
+  }
+
+  while (mFreeChunks != nullptr)
+  {
+    Chunk* next = mFreeChunks->mNext;
+    zDeallocate(mFreeChunks);
+    mFreeChunks = next;
+  }
+  mDedicatedBytes = 0;
+}
+
+size_t FrameArena::GetLastFrameBytes()
+{
+  return mLastFrameBytes;
+}
+
+size_t FrameArena::GetPeakFrameBytes()
+{
+  return mPeakFrameBytes;
+}
+
+static SpinLock gFrameArenaLock;
+static Graph* gFrameArenas = nullptr;
+
+FrameArena* GetNamedFrameArena(cstr name)
+{
+  gFrameArenaLock.Lock();
+  if (gFrameArenas == nullptr)
+    gFrameArenas = new Graph("Frame", GetRoot());
+
+  FrameArena* found = nullptr;
+  InListBaseLink<Graph>::range arenas = gFrameArenas->Children.All();
+  for (; !arenas.Empty(); arenas.PopFront())
+  {
+    if (strcmp(arenas.Front().Name.c_str(), name) == 0)
+      found = (FrameArena*)&arenas.Front();
+  }
+
+  if (found == nullptr)
+    found = new FrameArena(name, gFrameArenas);
+  gFrameArenaLock.Unlock();
+  return found;
+}
+
+FrameArena* GetFrameArena()
+{
+  static FrameArena* arena = GetNamedFrameArena("Default");
+  return arena;
+}
+
+void ResetFrameArenas()
+{
+  if (gFrameArenas == nullptr)
+    return;
+
+  InListBaseLink<Graph>::range arenas = gFrameArenas->Children.All();
+  for (; !arenas.Empty(); arenas.PopFront())
+    ((FrameArena&)arenas.Front()).Reset();
+}
+
+} // namespace Memory
+} // namespace Raverie
@@ -0,0 +1,119 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+#include "Graph.hpp"
+#include "Utility/SpinLock.hpp"
+
+namespace Raverie
+{
+namespace Memory
+{
+
+/// The frame arena is a linear allocator for data that only lives for a frame.
+/// Each thread bumps a pointer through its own chunks so allocating never
+/// locks and nothing is freed individually, all memory is reclaimed at once
+/// when the arena is reset at the end of the frame. The arena is double
+/// buffered, memory allocated during a frame stays valid until the end of the
+/// following frame so that it can be handed to another thread (e.g. the render
+/// queues that the renderer consumes while the next frame is built).
+class FrameArena : public Graph
+{
+public:
+  /// Threads past this count all share the last sub arena (behind a lock).
+  static const uint cMaxThreads = 64;
+  static const size_t cAlignment = 16;
+  static const size_t cDefaultChunkSize = 256 * 1024;
+
+  FrameArena(cstr name, Graph* parent, size_t chunkSize = cDefaultChunkSize);
+  ~FrameArena();
+
+  virtual void Print(size_t tabs, size_t flags);
+  MemPtr Allocate(size_t numberOfBytes);
+  /// Memory is only reclaimed by Reset, so this does nothing.
+  void Deallocate(MemPtr ptr, size_t numberOfBytes);
+
+  /// Ends the frame: the memory from the previous frame is reclaimed and the
+  /// memory from this frame stays valid through the next one. No thread may
+  /// be allocating from the arena while it is reset.
+  void Reset();
+  void CleanUp();
+
+  /// Bytes handed out during the last completed frame and the most handed
+  /// out in any frame (the watermark the chunk size should be tuned against).
+  size_t GetLastFrameBytes();
+  size_t GetPeakFrameBytes();
+
+private:
+  struct Chunk
+  {
+    Chunk* mNext;
+    size_t mSize;
+  };
+
+  struct ThreadArena
+  {
+    byte* mCurrent;
+    byte* mEnd;
+    Chunk* mChunks;
+    size_t mBytes;
+    size_t mAllocations;
+    // Keeps threads from sharing a cache line while bumping
+    byte mPadding[64];
+  };
+
+  void AddChunk(ThreadArena& arena, size_t numberOfBytes);
+  void Recycle(ThreadArena* arenas);
+
+  size_t mChunkSize;
+  uint mCurrentBuffer;
+  ThreadArena* mBuffers[2];
+
+  // Standard sized chunks are kept once allocated and reused between frames
+  SpinLock mFreeLock;
+  Chunk* mFreeChunks;
+  SpinLock mSharedLock;
+  size_t mDedicatedBytes;
+
+  size_t mLastFrameBytes;
+  size_t mPeakFrameBytes;
+};
+
+/// Finds or creates the frame arena for a subsystem (each reports its own
+/// watermarks under the "Frame" node of the memory graph).
+FrameArena* GetNamedFrameArena(cstr name);
+/// The arena used by frame allocators that were not given one.
+FrameArena* GetFrameArena();
+/// Resets every frame arena, called once at the end of each engine frame.
+void ResetFrameArenas();
+
+} // namespace Memory
+
+/// Allocator for containers that only live for a frame (or are cleared before
+/// the frame after next). Deallocation is free, the memory is reclaimed when
+/// the frame arenas are reset.
+class FrameAllocator : public Memory::StandardMemory
+{
+public:
+  FrameAllocator() : mArena(Memory::GetFrameArena())
+  {
+  }
+
+  FrameAllocator(cstr name) : mArena(Memory::GetNamedFrameArena(name))
+  {
+  }
+
+  FrameAllocator(Memory::FrameArena* arena) : mArena(arena)
+  {
+  }
+
+  MemPtr Allocate(size_t numberOfBytes)
+  {
+    return mArena->Allocate(numberOfBytes);
+  }
+  void Deallocate(MemPtr ptr, size_t numberOfBytes)
+  {
+    mArena->Deallocate(ptr, numberOfBytes);
+  }
+  Memory::FrameArena* mArena;
+};
+
+} // namespace Raverie
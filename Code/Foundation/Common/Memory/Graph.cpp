@@ -127,7 +127,10 @@ const size_t tabSize = 2;
 void Root::PrintAll()
 {
   if (RootGraph)
+  {
     Root::RootGraph->PrintGraph(Stats::ShowBytes | Stats::ShowTotal | Stats::ShowActive);
+    Heap::PrintSizeClasses();
+  }
 }
 
 class VistPrinter
@@ -206,8 +209,13 @@ void Graph::PrintHelper(size_t tabs, size_t flags, cstr /*name*/)
   }
 }
 
+void Graph::UpdateStats()
+{
+}
+
 void Graph::Compute(Stats& data)
 {
+  UpdateStats();
   data.Accumulate(mData);
   InListBaseLink<Graph>::range sub = Children.All();
   while (!sub.Empty())
@@ -20,7 +20,8 @@ struct Stats
     ShowBytes = 8,
     ShowTotal = 16,
     ShowLocal = 32,
-    ShowCount = 64
+    ShowCount = 64,
+    ShowSizeClasses = 128
   };
 
   MemCounterType Allocations;
@@ -88,6 +89,9 @@ public:
   void PrintGraph(size_t flags);
   void Print(size_t tabs, size_t flags);
 
+  // Called before the stats are read, for nodes that do not keep mData
+  // current on every allocation
+  virtual void UpdateStats();
   virtual void CleanUp();
   virtual ~Graph();
 
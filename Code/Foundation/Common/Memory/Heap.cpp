@@ -6,27 +6,361 @@ namespace Raverie
 namespace Memory
 {
 
+// Size classes are 16 byte steps up to 128 bytes, then 4 steps per power of
+// two up to 32k. The block size includes the allocation header.
+static const uint cSmallClassCount = 8;
+static const uint cSizeClassCount = 40;
+static const size_t cMaxClassSize = 32768;
+// Allocations larger than every size class are counted in an extra class
+static const uint cLargeClass = cSizeClassCount;
+static const uint cStatClassCount = cSizeClassCount + 1;
+
+// Slabs are carved into blocks of a single size class
+static const size_t cSlabSize = 64 * 1024;
+// Roughly how many bytes are moved between a thread cache and the shared free
+// list at once (a thread caches at most twice this per size class)
+static const size_t cBatchBytes = 16 * 1024;
+static const uint cMaxBatchCount = 64;
+
+static uint GetSizeClass(size_t blockSize)
+{
+  if (blockSize <= 128)
+    return (uint)((blockSize + 15) / 16) - 1;
+
+  u32 value = (u32)(blockSize - 1);
+  u32 log = 31 - CountLeadingZeros(value);
+  return cSmallClassCount + (log - 7) * 4 + ((value >> (log - 2)) & 3);
+}
+
+static size_t GetClassSize(uint sizeClass)
+{
+  if (sizeClass < cSmallClassCount)
+    return (sizeClass + 1) * 16;
+
+  uint step = sizeClass - cSmallClassCount;
+  size_t base = size_t(128) << (step / 4);
+  return base + (base / 4) * (step % 4 + 1);
+}
+
+static uint GetBatchCount(uint sizeClass)
+{
+  size_t count = cBatchBytes / GetClassSize(sizeClass);
+  return (uint)Math::Clamp(count, size_t(1), size_t(cMaxBatchCount));
+}
+
+// Per heap counters, updated from any thread. These are allocated separately
+// from the heap and never freed so that memory can still be returned to a heap
+// after the memory graph has been shut down.
+struct HeapStats
+{
+  Atomic<s64> mAllocations;
+  Atomic<s64> mBytes;
+  Atomic<s64> mPeakBytes;
+  Atomic<s64> mClassBlocks[cStatClassCount];
+  Atomic<s64> mClassBytes[cStatClassCount];
+  HeapStats* mNext;
+};
+
+// Every allocation is preceded by a header so that it can be freed through
+// any heap (the size passed to Deallocate is not trusted)
+struct AllocationHeader
+{
+  size_t mSize;
+  HeapStats* mStats;
+};
+
+static const size_t cHeaderSize = 16;
+static_assert(sizeof(AllocationHeader) <= cHeaderSize, "Allocation header must fit in its aligned size");
+
+struct FreeBlock
+{
+  FreeBlock* mNext;
+};
+
+// The free list for a size class that all threads share
+struct SizeClassList
+{
+  SpinLock mLock;
+  FreeBlock* mFree;
+  size_t mFreeCount;
+  size_t mSlabBytes;
+};
+
+struct ThreadCache
+{
+  FreeBlock* mFree[cSizeClassCount];
+  uint mCount[cSizeClassCount];
+};
+
+static SizeClassList gSizeClasses[cSizeClassCount];
+static RaverieThreadLocal ThreadCache* tThreadCache = nullptr;
+
+static SpinLock gHeapStatsLock;
+static HeapStats* gHeapStats = nullptr;
+
+static ThreadCache* GetThreadCache()
+{
+  ThreadCache* cache = tThreadCache;
+  if (cache == nullptr)
+  {
+    cache = (ThreadCache*)zAllocate(sizeof(ThreadCache));
+    memset(cache, 0, sizeof(ThreadCache));
+    tThreadCache = cache;
+  }
+  return cache;
+}
+
+// Moves a batch of blocks from the shared list into the thread cache,
+// carving a new slab if the shared list is empty
+static void RefillThreadCache(ThreadCache* cache, uint sizeClass)
+{
+  SizeClassList& list = gSizeClasses[sizeClass];
+  uint batchCount = GetBatchCount(sizeClass);
+
+  list.mLock.Lock();
+  if (list.mFree == nullptr)
+  {
+    size_t classSize = GetClassSize(sizeClass);
+    size_t blockCount = cSlabSize / classSize;
+    byte* slab = (byte*)zAllocate(blockCount * classSize);
+    for (size_t i = blockCount; i > 0; --i)
+    {
+      FreeBlock* block = (FreeBlock*)(slab + (i - 1) * classSize);
+      block->mNext = list.mFree;
+      list.mFree = block;
+    }
+    list.mFreeCount += blockCount;
+    list.mSlabBytes += blockCount * classSize;
+  }
+
+  for (uint i = 0; i < batchCount && list.mFree != nullptr; ++i)
+  {
+    FreeBlock* block = list.mFree;
+    list.mFree = block->mNext;
+    --list.mFreeCount;
+
+    block->mNext = cache->mFree[sizeClass];
+    cache->mFree[sizeClass] = block;
+    ++cache->mCount[sizeClass];
+  }
+  list.mLock.Unlock();
+}
+
+// Returns up to 'count' blocks from the thread cache to the shared list
+static void ReleaseToSizeClass(ThreadCache* cache, uint sizeClass, uint count)
+{
+  FreeBlock* first = cache->mFree[sizeClass];
+  if (first == nullptr || count == 0)
+    return;
+
+  // Find the end of the batch before taking the lock
+  FreeBlock* last = first;
+  uint released = 1;
+  while (released < count && last->mNext != nullptr)
+  {
+    last = last->mNext;
+    ++released;
+  }
+
+  cache->mFree[sizeClass] = last->mNext;
+  cache->mCount[sizeClass] -= released;
+
+  SizeClassList& list = gSizeClasses[sizeClass];
+  list.mLock.Lock();
+  last->mNext = list.mFree;
+  list.mFree = first;
+  list.mFreeCount += released;
+  list.mLock.Unlock();
+}
+
+static void RecordAllocation(HeapStats* stats, uint statClass, size_t numberOfBytes)
+{
+  stats->mAllocations.FetchAdd(1);
+  stats->mClassBlocks[statClass].FetchAdd(1);
+  stats->mClassBytes[statClass].FetchAdd((s64)numberOfBytes);
+
+  s64 bytes = stats->mBytes.FetchAdd((s64)numberOfBytes) + (s64)numberOfBytes;
+  s64 peak = stats->mPeakBytes;
+  while (bytes > peak)
+  {
+    stats->mPeakBytes.CompareExchange(bytes, peak);
+    peak = stats->mPeakBytes;
+  }
+}
+
+static void RecordDeallocation(HeapStats* stats, uint statClass, size_t numberOfBytes)
+{
+  stats->mClassBlocks[statClass].FetchSubtract(1);
+  stats->mClassBytes[statClass].FetchSubtract((s64)numberOfBytes);
+  stats->mBytes.FetchSubtract((s64)numberOfBytes);
+}
+
 Heap::Heap(cstr name, Graph* parent) : Graph(name, parent)
 {
-  //
+  mStats = new (zAllocate(sizeof(HeapStats))) HeapStats();
+  gHeapStatsLock.Lock();
+  mStats->mNext = gHeapStats;
+  gHeapStats = mStats;
+  gHeapStatsLock.Unlock();
 }
 
 MemPtr Heap::Allocate(size_t numberOfBytes)
 {
-  AddAllocation(numberOfBytes);
-  MemPtr mem = zAllocate(numberOfBytes);
-  return mem;
+#if UseSlabHeap
+  size_t blockSize = numberOfBytes + cHeaderSize;
+  AllocationHeader* header = nullptr;
+  uint statClass = cLargeClass;
+
+  if (blockSize <= cMaxClassSize)
+  {
+    statClass = GetSizeClass(blockSize);
+    ThreadCache* cache = GetThreadCache();
+    if (cache->mFree[statClass] == nullptr)
+      RefillThreadCache(cache, statClass);
+
+    FreeBlock* block = cache->mFree[statClass];
+    cache->mFree[statClass] = block->mNext;
+    --cache->mCount[statClass];
+    header = (AllocationHeader*)block;
+  }
+  else
+  {
+    header = (AllocationHeader*)zAllocate(blockSize);
+  }
+
+  header->mSize = numberOfBytes;
+  header->mStats = mStats;
+  RecordAllocation(mStats, statClass, numberOfBytes);
+  return (byte*)header + cHeaderSize;
+#else
+  RecordAllocation(mStats, cLargeClass, numberOfBytes);
+  return zAllocate(numberOfBytes);
+#endif
 }
 
 void Heap::Deallocate(MemPtr ptr, size_t numberOfBytes)
 {
-  RemoveAllocation(numberOfBytes);
+#if UseSlabHeap
+  if (ptr == nullptr)
+    return;
+
+  AllocationHeader* header = (AllocationHeader*)((byte*)ptr - cHeaderSize);
+  size_t size = header->mSize;
+  size_t blockSize = size + cHeaderSize;
+  if (blockSize > cMaxClassSize)
+  {
+    RecordDeallocation(header->mStats, cLargeClass, size);
+    zDeallocate(header);
+    return;
+  }
+
+  uint sizeClass = GetSizeClass(blockSize);
+  RecordDeallocation(header->mStats, sizeClass, size);
+
+  ThreadCache* cache = GetThreadCache();
+  FreeBlock* block = (FreeBlock*)header;
+  block->mNext = cache->mFree[sizeClass];
+  cache->mFree[sizeClass] = block;
+  ++cache->mCount[sizeClass];
+
+  // Keep the cache bounded so memory freed on one thread can be reused by others
+  uint batchCount = GetBatchCount(sizeClass);
+  if (cache->mCount[sizeClass] >= batchCount * 2)
+    ReleaseToSizeClass(cache, sizeClass, batchCount);
+#else
+  RecordDeallocation(mStats, cLargeClass, numberOfBytes);
   zDeallocate(ptr);
+#endif
+}
+
+void Heap::UpdateStats()
+{
+  s64 active = 0;
+  s64 dedicated = 0;
+  for (uint i = 0; i < cStatClassCount; ++i)
+  {
+    s64 blocks = mStats->mClassBlocks[i];
+    active += blocks;
+    if (i == cLargeClass)
+      dedicated += mStats->mClassBytes[i];
+    else
+      dedicated += blocks * (s64)GetClassSize(i);
+  }
+
+  mData.Allocations = (MemCounterType)(s64)mStats->mAllocations;
+  mData.Active = (MemCounterType)active;
+  mData.BytesAllocated = (MemCounterType)(s64)mStats->mBytes;
+  mData.PeakAllocated = (MemCounterType)(s64)mStats->mPeakBytes;
+  // The bytes taken from slabs, the difference from BytesAllocated is the
+  // space lost to size class rounding and headers
+  mData.BytesDedicated = (MemCounterType)dedicated;
 }
 
 void Heap::Print(size_t tabs, size_t flags)
 {
   PrintHelper(tabs, flags, "Heap");
+
+  if ((flags & Stats::ShowSizeClasses) == 0)
+    return;
+
+  for (uint i = 0; i < cStatClassCount; ++i)
+  {
+    s64 blocks = mStats->mClassBlocks[i];
+    if (blocks == 0)
+      continue;
+
+    s64 bytes = mStats->mClassBytes[i];
+    s64 reserved = (i == cLargeClass) ? bytes : blocks * (s64)GetClassSize(i);
+    float wasted = reserved != 0 ? 100.0f * float(reserved - bytes) / float(reserved) : 0.0f;
+    if (i == cLargeClass)
+      DebugPrint("%*s   large: %8lld blocks %12lld bytes\n", int((tabs + 1) * 2), "", blocks, bytes);
+    else
+      DebugPrint("%*s%8u: %8lld blocks %12lld bytes %5.1f%% wasted\n", int((tabs + 1) * 2), "", (uint)GetClassSize(i), blocks, bytes, wasted);
+  }
+}
+
+void Heap::PrintSizeClasses()
+{
+  // Blocks in use across every heap
+  s64 usedBlocks[cSizeClassCount] = {0};
+  gHeapStatsLock.Lock();
+  for (HeapStats* stats = gHeapStats; stats != nullptr; stats = stats->mNext)
+  {
+    for (uint i = 0; i < cSizeClassCount; ++i)
+      usedBlocks[i] += stats->mClassBlocks[i];
+  }
+  gHeapStatsLock.Unlock();
+
+  DebugPrint("%8s %12s %12s %12s %8s\n", "Class", "Reserved", "Used", "Free", "Frag");
+  for (uint i = 0; i < cSizeClassCount; ++i)
+  {
+    SizeClassList& list = gSizeClasses[i];
+    list.mLock.Lock();
+    size_t reserved = list.mSlabBytes;
+    size_t free = list.mFreeCount * GetClassSize(i);
+    list.mLock.Unlock();
+
+    if (reserved == 0)
+      continue;
+
+    // Anything not in use or on the shared free list is sitting in thread caches
+    size_t used = (size_t)usedBlocks[i] * GetClassSize(i);
+    float fragmentation = 100.0f * float(reserved - used) / float(reserved);
+    DebugPrint("%8u %12u %12u %12u %7.1f%%\n", (uint)GetClassSize(i), (uint)reserved, (uint)used, (uint)free, fragmentation);
+  }
+}
+
+void Heap::ReleaseThreadCache()
+{
+  ThreadCache* cache = tThreadCache;
+  if (cache == nullptr)
+    return;
+
+  for (uint i = 0; i < cSizeClassCount; ++i)
+    ReleaseToSizeClass(cache, i, cache->mCount[i]);
+
+  tThreadCache = nullptr;
+  zDeallocate(cache);
 }
 
 } // namespace Memory
@@ -2,15 +2,24 @@
 #pragma once
 #include "Graph.hpp"
 
+#ifndef UseSlabHeap
+#  define UseSlabHeap 1
+#endif
+
 namespace Raverie
 {
 namespace Memory
 {
 
-class HeapPrivate;
+struct HeapStats;
 
-/// Heap allocator. The heap allocator allocates memory directly from the
-/// system heap using malloc and free.
+/// Heap allocator. Small allocations are served from size class slabs shared
+/// by every heap: each thread keeps a cache of free blocks per size class and
+/// only touches the shared (locked) free lists to refill or return a batch.
+/// Allocations larger than the biggest size class go directly to the system
+/// heap. Every allocation records the heap it came from, so it may be freed
+/// through any heap (or on any thread). Define UseSlabHeap as 0 to allocate
+/// everything from the system heap.
 class Heap : public Graph
 {
 public:
@@ -19,6 +28,18 @@ public:
   void Deallocate(MemPtr ptr, size_t numberOfBytes);
 
   virtual void Print(size_t tabs, size_t flags);
+  void UpdateStats();
+
+  /// Prints the memory reserved by each size class across all heaps, how much
+  /// of it is in use and how much is waiting in free lists.
+  static void PrintSizeClasses();
+
+  /// Returns the calling thread's cached blocks to the shared free lists.
+  /// Called by threads before they exit.
+  static void ReleaseThreadCache();
+
+private:
+  HeapStats* mStats;
 };
 
 template <typename type>
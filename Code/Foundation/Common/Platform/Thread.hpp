@@ -9,6 +9,9 @@ extern const bool ThreadingEnabled;
 
 typedef unsigned long OsInt;
 
+// Platform specific thread data (only allocated when threading is enabled).
+struct ThreadPrivateData;
+
 /// Thread class manages Os threads.
 class Thread
 {
@@ -66,7 +69,7 @@ public:
 
 private:
   String mThreadName;
-  // TODO(trevor): To support threads, must add a handle/pointer to thread primitive here
+  ThreadPrivateData* mPrivate;
 };
 
 } // namespace Raverie
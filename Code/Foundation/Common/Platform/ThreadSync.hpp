@@ -3,6 +3,12 @@
 
 namespace Raverie
 {
+// Platform specific synchronization data (only allocated when threading is
+// enabled).
+struct ThreadLockPrivateData;
+struct OsEventPrivateData;
+struct SemaphorePrivateData;
+
 /// Thread Lock
 /// Safe to lock multiple times from the same thread
 class ThreadLock
@@ -10,11 +16,14 @@ class ThreadLock
 public:
   ThreadLock();
   ~ThreadLock();
+  // Copying creates a new independent primitive (the state is never shared).
+  ThreadLock(const ThreadLock& rhs);
+  ThreadLock& operator=(const ThreadLock& rhs);
   void Lock();
   void Unlock();
 
 private:
-  // TODO(trevor): To support threads, must add a handle/pointer to thread primitive here
+  ThreadLockPrivateData* mPrivate;
 };
 
 // Wrapper around an unnamed event.
@@ -23,6 +32,8 @@ class OsEvent
 public:
   OsEvent();
   ~OsEvent();
+  OsEvent(const OsEvent& rhs);
+  OsEvent& operator=(const OsEvent& rhs);
   void Initialize(bool manualReset = false, bool startSignaled = false);
   void Close();
   void Signal();
@@ -30,7 +41,7 @@ public:
   void Wait();
 
 private:
-  // TODO(trevor): To support threads, must add a handle/pointer to thread primitive here
+  OsEventPrivateData* mPrivate;
 };
 
 const int MaxSemaphoreCount = 0x0FFFFFFF;
@@ -41,13 +52,15 @@ class Semaphore
 public:
   Semaphore();
   ~Semaphore();
+  Semaphore(const Semaphore& rhs);
+  Semaphore& operator=(const Semaphore& rhs);
   void Increment();
   void Decrement();
   void Reset();
   void WaitAndDecrement();
 
 private:
-  // TODO(trevor): To support threads, must add a handle/pointer to thread primitive here
+  SemaphorePrivateData* mPrivate;
 };
 
 /// Not fully implemented as it's currently only needed for interprocess
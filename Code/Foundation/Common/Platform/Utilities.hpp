@@ -23,6 +23,9 @@ bool ErrorProcessHandler(ErrorSignaler::ErrorData& errorData);
 // Get the time in milliseconds for a double click.
 unsigned int GetDoubleClickTimeMs();
 
+// Get the number of logical processors available (always at least 1).
+uint GetProcessorCount();
+
 } // namespace Os
 
 // Generate a 64 bit unique Id. Uses system timer and mac
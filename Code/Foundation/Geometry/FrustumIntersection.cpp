@@ -46,6 +46,64 @@ Type AabbFrustumApproximation(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, co
   return inOrOut;
 }
 
+// Intersect four axis aligned bounding boxes with a frustum. Same test as
+// above, but with USESSE each plane is tested against all four boxes with one
+// set of vector instructions.
+uint AabbFrustumApproximation4(const real aabbMinX[4],
+                               const real aabbMinY[4],
+                               const real aabbMinZ[4],
+                               const real aabbMaxX[4],
+                               const real aabbMaxY[4],
+                               const real aabbMaxZ[4],
+                               const Vec4 frustumPlanes[6])
+{
+  uint insideMask = 0xF;
+
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec minX = UnAlignedLoad(aabbMinX);
+  SimVec minY = UnAlignedLoad(aabbMinY);
+  SimVec minZ = UnAlignedLoad(aabbMinZ);
+  SimVec maxX = UnAlignedLoad(aabbMaxX);
+  SimVec maxY = UnAlignedLoad(aabbMaxY);
+  SimVec maxZ = UnAlignedLoad(aabbMaxZ);
+
+  for (uint i = 0; i < 6 && insideMask != 0; ++i)
+  {
+    const Vec4& plane = frustumPlanes[i];
+
+    // The box's point furthest in the direction of the plane's normal only
+    // depends on the normal's signs, which are the same for all four boxes
+    SimVec pointX = plane.x >= real(0.0) ? maxX : minX;
+    SimVec pointY = plane.y >= real(0.0) ? maxY : minY;
+    SimVec pointZ = plane.z >= real(0.0) ? maxZ : minZ;
+
+    SimVec distance = Multiply(pointX, Set(plane.x));
+    distance = MultiplyAdd(pointY, Set(plane.y), distance);
+    distance = MultiplyAdd(pointZ, Set(plane.z), distance);
+    insideMask &= uint(MoveMask(GreaterEqual(distance, Set(plane.w))));
+  }
+#else
+  for (uint i = 0; i < 6 && insideMask != 0; ++i)
+  {
+    const Vec4& plane = frustumPlanes[i];
+    const real* pointX = plane.x >= real(0.0) ? aabbMaxX : aabbMinX;
+    const real* pointY = plane.y >= real(0.0) ? aabbMaxY : aabbMinY;
+    const real* pointZ = plane.z >= real(0.0) ? aabbMaxZ : aabbMinZ;
+
+    for (uint j = 0; j < 4; ++j)
+    {
+      real distance = pointX[j] * plane.x + pointY[j] * plane.y + pointZ[j] * plane.z;
+      if (distance < plane.w)
+        insideMask &= ~(1u << j);
+    }
+  }
+#endif
+
+  return insideMask;
+}
+
 /// Intersect a frustum with an oriented bounding box. The 6 planes of the
 /// frustum are assumed to be pointing inwards.
 Type FrustumObbApproximation(const Vec4 frustumPlanes[6], Vec3Param obbCenter, Vec3Param obbHalfExtents, Mat3Param obbBasis, Manifold* manifold)
@@ -323,6 +323,46 @@ Type AabbAabb(Vec3Param aabbOneMinPoint, Vec3Param aabbOneMaxPoint, Vec3Param aa
   return Point;
 }
 
+// Intersect an axis aligned bounding box with four others at once. Same
+// separating axis test as above, with USESSE each axis is tested against all
+// four boxes with one set of vector instructions.
+uint AabbAabb4(Vec3Param aabbMinPoint,
+               Vec3Param aabbMaxPoint,
+               const real aabbMinX[4],
+               const real aabbMinY[4],
+               const real aabbMinZ[4],
+               const real aabbMaxX[4],
+               const real aabbMaxY[4],
+               const real aabbMaxZ[4])
+{
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  // Separated along an axis if the box's max is less than the other's min or
+  // its min is greater than the other's max
+  SimVec separated = Less(UnAlignedLoad(aabbMaxX), Set(aabbMinPoint.x));
+  separated = OrVec(separated, Greater(UnAlignedLoad(aabbMinX), Set(aabbMaxPoint.x)));
+  separated = OrVec(separated, Less(UnAlignedLoad(aabbMaxY), Set(aabbMinPoint.y)));
+  separated = OrVec(separated, Greater(UnAlignedLoad(aabbMinY), Set(aabbMaxPoint.y)));
+  separated = OrVec(separated, Less(UnAlignedLoad(aabbMaxZ), Set(aabbMinPoint.z)));
+  separated = OrVec(separated, Greater(UnAlignedLoad(aabbMinZ), Set(aabbMaxPoint.z)));
+  return ~uint(MoveMask(separated)) & 0xF;
+#else
+  uint overlapMask = 0;
+  for (uint i = 0; i < 4; ++i)
+  {
+    if (aabbMaxX[i] < aabbMinPoint.x || aabbMinX[i] > aabbMaxPoint.x)
+      continue;
+    if (aabbMaxY[i] < aabbMinPoint.y || aabbMinY[i] > aabbMaxPoint.y)
+      continue;
+    if (aabbMaxZ[i] < aabbMinPoint.z || aabbMinZ[i] > aabbMaxPoint.z)
+      continue;
+    overlapMask |= 1u << i;
+  }
+  return overlapMask;
+#endif
+}
+
 // Intersect an axis aligned bounding box with a capsule.
 Type AabbCapsule(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, Manifold* manifold)
 {
@@ -483,6 +523,49 @@ Type AabbSphere(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param sphere
   // return None;
 }
 
+// Intersect four axis aligned bounding boxes with a sphere at once. The
+// closest point on each box to the sphere's center is compared against the
+// radius, with USESSE all four boxes are tested with one set of vector
+// instructions.
+uint AabbSphere4(const real aabbMinX[4],
+                 const real aabbMinY[4],
+                 const real aabbMinZ[4],
+                 const real aabbMaxX[4],
+                 const real aabbMaxY[4],
+                 const real aabbMaxZ[4],
+                 Vec3Param sphereCenter,
+                 real sphereRadius)
+{
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec centerX = Set(sphereCenter.x);
+  SimVec centerY = Set(sphereCenter.y);
+  SimVec centerZ = Set(sphereCenter.z);
+
+  // Distance from the center to the closest point on each box
+  SimVec deltaX = Subtract(centerX, Clamp(centerX, UnAlignedLoad(aabbMinX), UnAlignedLoad(aabbMaxX)));
+  SimVec deltaY = Subtract(centerY, Clamp(centerY, UnAlignedLoad(aabbMinY), UnAlignedLoad(aabbMaxY)));
+  SimVec deltaZ = Subtract(centerZ, Clamp(centerZ, UnAlignedLoad(aabbMinZ), UnAlignedLoad(aabbMaxZ)));
+
+  SimVec distanceSq = Multiply(deltaX, deltaX);
+  distanceSq = MultiplyAdd(deltaY, deltaY, distanceSq);
+  distanceSq = MultiplyAdd(deltaZ, deltaZ, distanceSq);
+  return uint(MoveMask(LessEqual(distanceSq, Set(sphereRadius * sphereRadius))));
+#else
+  uint overlapMask = 0;
+  for (uint i = 0; i < 4; ++i)
+  {
+    real deltaX = sphereCenter.x - Math::Clamp(sphereCenter.x, aabbMinX[i], aabbMaxX[i]);
+    real deltaY = sphereCenter.y - Math::Clamp(sphereCenter.y, aabbMinY[i], aabbMaxY[i]);
+    real deltaZ = sphereCenter.z - Math::Clamp(sphereCenter.z, aabbMinZ[i], aabbMaxZ[i]);
+    if (deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ <= sphereRadius * sphereRadius)
+      overlapMask |= 1u << i;
+  }
+  return overlapMask;
+#endif
+}
+
 // Intersect an axis aligned bounding box with a triangle.
 Type AabbTriangle(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param trianglePointA, Vec3Param trianglePointB, Vec3Param trianglePointC, Manifold* manifold)
 {
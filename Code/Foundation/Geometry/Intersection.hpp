@@ -521,6 +521,18 @@ Type SegmentTriangle(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param tri
 /// Intersect a ray with an axis aligned bounding box.
 Type RayAabb(Vec3Param rayStart, Vec3Param rayDirection, Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, IntersectionPoint* intersectionPoint = nullptr);
 
+/// Intersect a ray with four axis aligned bounding boxes at once. Each box
+/// component is given as an array of 4 values (structure of arrays). Returns a
+/// mask where bit i is set if the ray hits box i.
+uint RayAabb4(Vec3Param rayStart,
+              Vec3Param rayDirection,
+              const real aabbMinX[4],
+              const real aabbMinY[4],
+              const real aabbMinZ[4],
+              const real aabbMaxX[4],
+              const real aabbMaxY[4],
+              const real aabbMaxZ[4]);
+
 /// Intersect a ray with a capsule. If the result is "Segment", the second point
 /// isn't guaranteed to be on the surface of the capsule (for now).
 Type RayCapsule(Vec3Param rayStart, Vec3Param rayDirection, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, IntersectionPoint* intersectionPoint = nullptr);
@@ -583,6 +595,17 @@ Type RayTorus(Vec3Param rayStart, Vec3Param rayDirection, Vec3Param torusCenter,
 /// Intersect a segment with an axis aligned bounding box.
 Type SegmentAabb(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, IntersectionPoint* intersectionPoint = nullptr);
 
+/// Intersect a segment with four axis aligned bounding boxes at once (see
+/// RayAabb4). Returns a mask where bit i is set if the segment hits box i.
+uint SegmentAabb4(Vec3Param segmentStart,
+                  Vec3Param segmentEnd,
+                  const real aabbMinX[4],
+                  const real aabbMinY[4],
+                  const real aabbMinZ[4],
+                  const real aabbMaxX[4],
+                  const real aabbMaxY[4],
+                  const real aabbMaxZ[4]);
+
 /// Intersect a segment with a capsule.
 Type SegmentCapsule(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, IntersectionPoint* intersectionPoint = nullptr);
 
@@ -607,6 +630,17 @@ Type SegmentTriangle(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param tri
 /// Intersect an axis aligned bounding box with an axis aligned bounding box.
 Type AabbAabb(Vec3Param aabbOneMinPoint, Vec3Param aabbOneMaxPoint, Vec3Param aabbTwoMinPoint, Vec3Param aabbTwoMaxPoint, Manifold* manifold = nullptr);
 
+/// Intersect an axis aligned bounding box with four others at once (see
+/// RayAabb4). Returns a mask where bit i is set if box i overlaps the box.
+uint AabbAabb4(Vec3Param aabbMinPoint,
+               Vec3Param aabbMaxPoint,
+               const real aabbMinX[4],
+               const real aabbMinY[4],
+               const real aabbMinZ[4],
+               const real aabbMaxX[4],
+               const real aabbMaxY[4],
+               const real aabbMaxZ[4]);
+
 /// Intersect an axis aligned bounding box with a capsule.
 Type AabbCapsule(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, Manifold* manifold = nullptr);
 
@@ -617,6 +651,18 @@ Type AabbCapsule(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param capsu
 /// so it can return false positives.
 Type AabbFrustumApproximation(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, const Vec4 frustumPlanes[6], Manifold* manifold = nullptr);
 
+/// Intersect four axis aligned bounding boxes with a frustum at once. Each box
+/// component is given as an array of 4 values (structure of arrays). Uses the
+/// same approximation as AabbFrustumApproximation. Returns a mask where bit i is
+/// set if box i is not outside of the frustum.
+uint AabbFrustumApproximation4(const real aabbMinX[4],
+                               const real aabbMinY[4],
+                               const real aabbMinZ[4],
+                               const real aabbMaxX[4],
+                               const real aabbMaxY[4],
+                               const real aabbMaxZ[4],
+                               const Vec4 frustumPlanes[6]);
+
 /// Intersect an axis aligned bounding box with an oriented bounding box.
 Type AabbObb(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param obbCenter, Vec3Param obbHalfExtents, Mat3Param obbBasis, Manifold* manifold = nullptr);
 
@@ -626,6 +672,17 @@ Type AabbPlane(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param planeNo
 /// Intersect an axis aligned bounding box with a sphere.
 Type AabbSphere(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param sphereCenter, real sphereRadius, Manifold* manifold = nullptr);
 
+/// Intersect four axis aligned bounding boxes with a sphere at once (see
+/// RayAabb4). Returns a mask where bit i is set if box i overlaps the sphere.
+uint AabbSphere4(const real aabbMinX[4],
+                 const real aabbMinY[4],
+                 const real aabbMinZ[4],
+                 const real aabbMaxX[4],
+                 const real aabbMaxY[4],
+                 const real aabbMaxZ[4],
+                 Vec3Param sphereCenter,
+                 real sphereRadius);
+
 /// Intersect an axis aligned bounding box with a triangle.
 Type AabbTriangle(Vec3Param aabbMinPoint, Vec3Param aabbMaxPoint, Vec3Param trianglePointA, Vec3Param trianglePointB, Vec3Param trianglePointC, Manifold* manifold = nullptr);
 
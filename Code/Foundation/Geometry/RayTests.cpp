@@ -677,6 +677,77 @@ Type RayAabb(Vec3Param rayStart, Vec3Param rayDirection, Vec3Param aabbMinPoint,
   return None;
 }
 
+// Intersect a ray with four axis aligned bounding boxes at once. Same slab
+// test as RayAabb, with USESSE each slab is clipped against all four boxes with
+// one set of vector instructions. The ray's direction is the same for every
+// box so the parallel case is decided once per axis.
+uint RayAabb4(Vec3Param rayStart,
+              Vec3Param rayDirection,
+              const real aabbMinX[4],
+              const real aabbMinY[4],
+              const real aabbMinZ[4],
+              const real aabbMaxX[4],
+              const real aabbMaxY[4],
+              const real aabbMaxZ[4])
+{
+  const real* aabbMin[3] = {aabbMinX, aabbMinY, aabbMinZ};
+  const real* aabbMax[3] = {aabbMaxX, aabbMaxY, aabbMaxZ};
+  uint hitMask = 0xF;
+
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec tMin = Set(real(0.0));
+  SimVec tMax = Set(Math::PositiveMax());
+  for (uint i = 0; i < 3; ++i)
+  {
+    SimVec minVec = UnAlignedLoad(aabbMin[i]);
+    SimVec maxVec = UnAlignedLoad(aabbMax[i]);
+    SimVec start = Set(rayStart[i]);
+
+    // Ray is parallel to slab. No hit if the origin is not within the slab.
+    if (Math::IsZero(rayDirection[i]))
+    {
+      hitMask &= ~uint(MoveMask(OrVec(Less(start, minVec), Greater(start, maxVec))));
+      continue;
+    }
+
+    SimVec ood = Set(real(1.0) / rayDirection[i]);
+    SimVec t1 = Multiply(Subtract(minVec, start), ood);
+    SimVec t2 = Multiply(Subtract(maxVec, start), ood);
+    tMin = Max(tMin, Min(t1, t2));
+    tMax = Min(tMax, Max(t1, t2));
+  }
+  hitMask &= ~uint(MoveMask(Greater(tMin, tMax)));
+#else
+  for (uint j = 0; j < 4; ++j)
+  {
+    real tMin = real(0.0);
+    real tMax = Math::PositiveMax();
+    bool outsideSlab = false;
+    for (uint i = 0; i < 3; ++i)
+    {
+      if (Math::IsZero(rayDirection[i]))
+      {
+        outsideSlab |= (rayStart[i] < aabbMin[i][j]) || (rayStart[i] > aabbMax[i][j]);
+        continue;
+      }
+
+      real ood = real(1.0) / rayDirection[i];
+      real t1 = (aabbMin[i][j] - rayStart[i]) * ood;
+      real t2 = (aabbMax[i][j] - rayStart[i]) * ood;
+      tMin = Math::Max(tMin, Math::Min(t1, t2));
+      tMax = Math::Min(tMax, Math::Max(t1, t2));
+    }
+
+    if (outsideSlab || tMin > tMax)
+      hitMask &= ~(1u << j);
+  }
+#endif
+
+  return hitMask & 0xF;
+}
+
 // Intersect a ray with a capsule. If the result is "Segment", the second point
 // isn't guaranteed to be on the surface of the capsule (for now).
 Type RayCapsule(Vec3Param rayStart, Vec3Param rayDirection, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, IntersectionPoint* intersectionPoint)
@@ -323,6 +323,96 @@ Type SegmentAabb(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param aabbMin
   return Other;
 }
 
+// Intersect a segment with four axis aligned bounding boxes at once. Same
+// separating axis test as the quick version of SegmentAabb, with USESSE each
+// axis is tested against all four boxes with one set of vector instructions.
+uint SegmentAabb4(Vec3Param segmentStart,
+                  Vec3Param segmentEnd,
+                  const real aabbMinX[4],
+                  const real aabbMinY[4],
+                  const real aabbMinZ[4],
+                  const real aabbMaxX[4],
+                  const real aabbMaxY[4],
+                  const real aabbMaxZ[4])
+{
+  // Segment midpoint and halflength vector
+  Vec3 segmentMidpoint = real(0.5) * (segmentStart + segmentEnd);
+  Vec3 segmentHalflength = segmentEnd - segmentMidpoint;
+  Vec3 absSegment = Math::Abs(segmentHalflength);
+  // Epsilon term to counteract arithmetic errors when segment is (near)
+  // parallel to a coordinate axis
+  Vec3 absSegmentEps = absSegment + Vec3(cAabbSegmentEpsilon);
+
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec half = Set(real(0.5));
+  SimVec minX = UnAlignedLoad(aabbMinX);
+  SimVec minY = UnAlignedLoad(aabbMinY);
+  SimVec minZ = UnAlignedLoad(aabbMinZ);
+  SimVec maxX = UnAlignedLoad(aabbMaxX);
+  SimVec maxY = UnAlignedLoad(aabbMaxY);
+  SimVec maxZ = UnAlignedLoad(aabbMaxZ);
+
+  // Box half extents and the segment's midpoint relative to each box's center
+  SimVec extentX = Multiply(Subtract(maxX, minX), half);
+  SimVec extentY = Multiply(Subtract(maxY, minY), half);
+  SimVec extentZ = Multiply(Subtract(maxZ, minZ), half);
+  SimVec midX = Subtract(Set(segmentMidpoint.x), Multiply(Add(maxX, minX), half));
+  SimVec midY = Subtract(Set(segmentMidpoint.y), Multiply(Add(maxY, minY), half));
+  SimVec midZ = Subtract(Set(segmentMidpoint.z), Multiply(Add(maxZ, minZ), half));
+
+  // Try world coordinates as separating axes
+  SimVec separated = Greater(Abs(midX), Add(extentX, Set(absSegment.x)));
+  separated = OrVec(separated, Greater(Abs(midY), Add(extentY, Set(absSegment.y))));
+  separated = OrVec(separated, Greater(Abs(midZ), Add(extentZ, Set(absSegment.z))));
+
+  // Try cross products of segment direction vector with coordinate axes
+  SimVec segX = Set(segmentHalflength.x);
+  SimVec segY = Set(segmentHalflength.y);
+  SimVec segZ = Set(segmentHalflength.z);
+  SimVec epsX = Set(absSegmentEps.x);
+  SimVec epsY = Set(absSegmentEps.y);
+  SimVec epsZ = Set(absSegmentEps.z);
+
+  SimVec cross = Abs(Subtract(Multiply(midY, segZ), Multiply(midZ, segY)));
+  SimVec proj = MultiplyAdd(extentY, epsZ, Multiply(extentZ, epsY));
+  separated = OrVec(separated, Greater(cross, proj));
+
+  cross = Abs(Subtract(Multiply(midZ, segX), Multiply(midX, segZ)));
+  proj = MultiplyAdd(extentX, epsZ, Multiply(extentZ, epsX));
+  separated = OrVec(separated, Greater(cross, proj));
+
+  cross = Abs(Subtract(Multiply(midX, segY), Multiply(midY, segX)));
+  proj = MultiplyAdd(extentX, epsY, Multiply(extentY, epsX));
+  separated = OrVec(separated, Greater(cross, proj));
+
+  return ~uint(MoveMask(separated)) & 0xF;
+#else
+  uint hitMask = 0;
+  for (uint i = 0; i < 4; ++i)
+  {
+    Vec3 aabbMinPoint(aabbMinX[i], aabbMinY[i], aabbMinZ[i]);
+    Vec3 aabbMaxPoint(aabbMaxX[i], aabbMaxY[i], aabbMaxZ[i]);
+    Vec3 extents = real(0.5) * (aabbMaxPoint - aabbMinPoint);
+    Vec3 mid = segmentMidpoint - real(0.5) * (aabbMaxPoint + aabbMinPoint);
+
+    if (Math::Abs(mid.x) > (extents.x + absSegment.x) || Math::Abs(mid.y) > (extents.y + absSegment.y) || Math::Abs(mid.z) > (extents.z + absSegment.z))
+      continue;
+
+    if (Math::Abs(mid.y * segmentHalflength.z - mid.z * segmentHalflength.y) > extents.y * absSegmentEps.z + extents.z * absSegmentEps.y)
+      continue;
+    if (Math::Abs(mid.z * segmentHalflength.x - mid.x * segmentHalflength.z) > extents.x * absSegmentEps.z + extents.z * absSegmentEps.x)
+      continue;
+    if (Math::Abs(mid.x * segmentHalflength.y - mid.y * segmentHalflength.x) > extents.x * absSegmentEps.y + extents.y * absSegmentEps.x)
+      continue;
+
+    hitMask |= 1u << i;
+  }
+  return hitMask;
+#endif
+}
+
 // Intersect a segment with a capsule.
 Type SegmentCapsule(Vec3Param segmentStart, Vec3Param segmentEnd, Vec3Param capsulePointA, Vec3Param capsulePointB, real capsuleRadius, IntersectionPoint* intersectionPoint)
 {
@@ -0,0 +1,201 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+namespace Raverie
+{
+const bool ThreadingEnabled = true;
+
+struct ThreadPrivateData
+{
+  pthread_t mHandle;
+  Thread::EntryFunction mEntryFunction;
+  void* mInstance;
+
+  // Guards the completion state so that timed waits can be performed
+  // (pthreads has no portable timed join).
+  pthread_mutex_t mMutex;
+  pthread_cond_t mCompletedCondition;
+  bool mCompleted;
+  bool mJoined;
+  // Set when the owner closed the thread before it finished, at which point
+  // the thread owns this data and frees it when it exits.
+  bool mDetached;
+  OsInt mResult;
+};
+
+static void DestroyPrivateData(ThreadPrivateData* data)
+{
+  pthread_cond_destroy(&data->mCompletedCondition);
+  pthread_mutex_destroy(&data->mMutex);
+  delete data;
+}
+
+static void* ThreadEntryPoint(void* userData)
+{
+  ThreadPrivateData* data = (ThreadPrivateData*)userData;
+  OsInt result = data->mEntryFunction(data->mInstance);
+
+  // Hand any cached heap blocks back so other threads can reuse them
+  Memory::Heap::ReleaseThreadCache();
+
+  pthread_mutex_lock(&data->mMutex);
+  data->mResult = result;
+  data->mCompleted = true;
+  bool detached = data->mDetached;
+  pthread_cond_broadcast(&data->mCompletedCondition);
+  pthread_mutex_unlock(&data->mMutex);
+
+  // Nobody else references the data once the owner has let go of it
+  if (detached)
+    DestroyPrivateData(data);
+  return nullptr;
+}
+
+Thread::Thread() : mPrivate(nullptr)
+{
+}
+
+Thread::~Thread()
+{
+  Close();
+}
+
+bool Thread::IsValid()
+{
+  return mPrivate != nullptr;
+}
+
+bool Thread::Initialize(EntryFunction entryFunction, void* instance, StringParam threadName)
+{
+  ErrorIf(mPrivate != nullptr, "Thread '%s' was already initialized", threadName.c_str());
+  mThreadName = threadName;
+
+  ThreadPrivateData* data = new ThreadPrivateData();
+  data->mEntryFunction = entryFunction;
+  data->mInstance = instance;
+  data->mCompleted = false;
+  data->mJoined = false;
+  data->mDetached = false;
+  data->mResult = 0;
+  pthread_mutex_init(&data->mMutex, nullptr);
+  pthread_cond_init(&data->mCompletedCondition, nullptr);
+
+  int result = pthread_create(&data->mHandle, nullptr, &ThreadEntryPoint, data);
+  if (result != 0)
+  {
+    Error("Failed to create thread '%s' (error %d)", threadName.c_str(), result);
+    DestroyPrivateData(data);
+    return false;
+  }
+
+#if defined(__linux__)
+  // Linux limits thread names to 16 characters including the null terminator.
+  char name[16] = {0};
+  strncpy(name, threadName.c_str(), sizeof(name) - 1);
+  pthread_setname_np(data->mHandle, name);
+#endif
+
+  mPrivate = data;
+  return true;
+}
+
+void Thread::Close()
+{
+  if (mPrivate == nullptr)
+    return;
+
+  // Decide under the lock who frees the private data. If the thread is still
+  // running it is detached and takes ownership of the data, freeing it when it
+  // exits, otherwise it is joined (if it hasn't been already) and freed here.
+  ThreadPrivateData* data = mPrivate;
+  mPrivate = nullptr;
+
+  pthread_mutex_lock(&data->mMutex);
+  bool completed = data->mCompleted;
+  if (!completed)
+    data->mDetached = true;
+  pthread_t handle = data->mHandle;
+  pthread_mutex_unlock(&data->mMutex);
+
+  if (completed)
+  {
+    if (!data->mJoined)
+      pthread_join(handle, nullptr);
+    DestroyPrivateData(data);
+  }
+  else
+  {
+    // The data may already be gone here, only the copied handle is used
+    pthread_detach(handle);
+  }
+}
+
+OsInt Thread::WaitForCompletion()
+{
+  if (mPrivate == nullptr)
+    return 0;
+
+  if (!mPrivate->mJoined)
+  {
+    pthread_join(mPrivate->mHandle, nullptr);
+    mPrivate->mJoined = true;
+  }
+
+  return mPrivate->mResult;
+}
+
+OsInt Thread::WaitForCompletion(unsigned long milliseconds)
+{
+  if (mPrivate == nullptr)
+    return 0;
+
+  timespec deadline = {0, 0};
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += milliseconds / 1000;
+  deadline.tv_nsec += long(milliseconds % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  pthread_mutex_lock(&mPrivate->mMutex);
+  int result = 0;
+  while (!mPrivate->mCompleted && result != ETIMEDOUT)
+    result = pthread_cond_timedwait(&mPrivate->mCompletedCondition, &mPrivate->mMutex, &deadline);
+  bool completed = mPrivate->mCompleted;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+
+  if (!completed)
+    return 0;
+
+  return WaitForCompletion();
+}
+
+bool Thread::IsCompleted()
+{
+  if (mPrivate == nullptr)
+    return true;
+
+  pthread_mutex_lock(&mPrivate->mMutex);
+  bool completed = mPrivate->mCompleted;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+  return completed;
+}
+
+size_t Thread::GetThreadId()
+{
+  if (mPrivate == nullptr)
+    return 0;
+  return (size_t)mPrivate->mHandle;
+}
+
+size_t Thread::GetCurrentThreadId()
+{
+  return (size_t)pthread_self();
+}
+
+} // namespace Raverie
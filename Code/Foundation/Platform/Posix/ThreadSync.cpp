@@ -0,0 +1,232 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+#include <pthread.h>
+
+namespace Raverie
+{
+struct ThreadLockPrivateData
+{
+  pthread_mutex_t mMutex;
+};
+
+ThreadLock::ThreadLock() : mPrivate(new ThreadLockPrivateData())
+{
+  // The lock must be safe to take multiple times from the same thread.
+  pthread_mutexattr_t attributes;
+  pthread_mutexattr_init(&attributes);
+  pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&mPrivate->mMutex, &attributes);
+  pthread_mutexattr_destroy(&attributes);
+}
+
+ThreadLock::ThreadLock(const ThreadLock& rhs) : ThreadLock()
+{
+}
+
+ThreadLock& ThreadLock::operator=(const ThreadLock& rhs)
+{
+  return *this;
+}
+
+ThreadLock::~ThreadLock()
+{
+  pthread_mutex_destroy(&mPrivate->mMutex);
+  delete mPrivate;
+}
+
+void ThreadLock::Lock()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+}
+
+void ThreadLock::Unlock()
+{
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+struct OsEventPrivateData
+{
+  pthread_mutex_t mMutex;
+  pthread_cond_t mCondition;
+  bool mManualReset;
+  bool mSignaled;
+};
+
+// Events are usable before Initialize is called (as an auto reset event that
+// starts unsignaled), Initialize only changes the reset behavior and state.
+OsEvent::OsEvent() : mPrivate(new OsEventPrivateData())
+{
+  pthread_mutex_init(&mPrivate->mMutex, nullptr);
+  pthread_cond_init(&mPrivate->mCondition, nullptr);
+  mPrivate->mManualReset = false;
+  mPrivate->mSignaled = false;
+}
+
+OsEvent::OsEvent(const OsEvent& rhs) : OsEvent()
+{
+}
+
+OsEvent& OsEvent::operator=(const OsEvent& rhs)
+{
+  return *this;
+}
+
+OsEvent::~OsEvent()
+{
+  pthread_cond_destroy(&mPrivate->mCondition);
+  pthread_mutex_destroy(&mPrivate->mMutex);
+  delete mPrivate;
+}
+
+void OsEvent::Initialize(bool manualReset, bool startSignaled)
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  mPrivate->mManualReset = manualReset;
+  mPrivate->mSignaled = startSignaled;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void OsEvent::Close()
+{
+  Reset();
+}
+
+void OsEvent::Signal()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  mPrivate->mSignaled = true;
+
+  // A manual reset event releases every waiter, an auto reset event only one.
+  if (mPrivate->mManualReset)
+    pthread_cond_broadcast(&mPrivate->mCondition);
+  else
+    pthread_cond_signal(&mPrivate->mCondition);
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void OsEvent::Reset()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  mPrivate->mSignaled = false;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void OsEvent::Wait()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  while (!mPrivate->mSignaled)
+    pthread_cond_wait(&mPrivate->mCondition, &mPrivate->mMutex);
+
+  if (!mPrivate->mManualReset)
+    mPrivate->mSignaled = false;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+// Implemented with a condition variable rather than sem_t because
+// Reset must be able to clear the count atomically.
+struct SemaphorePrivateData
+{
+  pthread_mutex_t mMutex;
+  pthread_cond_t mCondition;
+  int mCount;
+};
+
+Semaphore::Semaphore() : mPrivate(new SemaphorePrivateData())
+{
+  pthread_mutex_init(&mPrivate->mMutex, nullptr);
+  pthread_cond_init(&mPrivate->mCondition, nullptr);
+  mPrivate->mCount = 0;
+}
+
+Semaphore::Semaphore(const Semaphore& rhs) : Semaphore()
+{
+}
+
+Semaphore& Semaphore::operator=(const Semaphore& rhs)
+{
+  return *this;
+}
+
+Semaphore::~Semaphore()
+{
+  pthread_cond_destroy(&mPrivate->mCondition);
+  pthread_mutex_destroy(&mPrivate->mMutex);
+  delete mPrivate;
+}
+
+void Semaphore::Increment()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  if (mPrivate->mCount < MaxSemaphoreCount)
+    ++mPrivate->mCount;
+  pthread_cond_signal(&mPrivate->mCondition);
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void Semaphore::Decrement()
+{
+  // Never blocks, if the count is already zero this does nothing.
+  pthread_mutex_lock(&mPrivate->mMutex);
+  if (mPrivate->mCount > 0)
+    --mPrivate->mCount;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void Semaphore::Reset()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  mPrivate->mCount = 0;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+void Semaphore::WaitAndDecrement()
+{
+  pthread_mutex_lock(&mPrivate->mMutex);
+  while (mPrivate->mCount == 0)
+    pthread_cond_wait(&mPrivate->mCondition, &mPrivate->mMutex);
+  --mPrivate->mCount;
+  pthread_mutex_unlock(&mPrivate->mMutex);
+}
+
+InterprocessMutex::InterprocessMutex()
+{
+}
+
+InterprocessMutex::~InterprocessMutex()
+{
+}
+
+void InterprocessMutex::Initialize(Status& status, const char* mutexName, bool failIfAlreadyExists)
+{
+}
+
+CountdownEvent::CountdownEvent() : mCount(0)
+{
+  // Nothing is outstanding, so waiting returns immediately.
+  mWaitEvent.Initialize(true, true);
+}
+
+void CountdownEvent::IncrementCount()
+{
+  mThreadLock.Lock();
+  if (mCount == 0)
+    mWaitEvent.Reset();
+  ++mCount;
+  mThreadLock.Unlock();
+}
+
+void CountdownEvent::DecrementCount()
+{
+  mThreadLock.Lock();
+  --mCount;
+  if (mCount == 0)
+    mWaitEvent.Signal();
+  mThreadLock.Unlock();
+}
+
+void CountdownEvent::Wait()
+{
+  mWaitEvent.Wait();
+}
+
+} // namespace Raverie
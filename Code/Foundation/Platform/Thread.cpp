@@ -5,7 +5,7 @@ namespace Raverie
 {
 const bool ThreadingEnabled = false;
 
-Thread::Thread()
+Thread::Thread() : mPrivate(nullptr)
 {
 }
 
@@ -3,10 +3,19 @@
 
 namespace Raverie
 {
-ThreadLock::ThreadLock()
+ThreadLock::ThreadLock() : mPrivate(nullptr)
 {
 }
 
+ThreadLock::ThreadLock(const ThreadLock& rhs) : mPrivate(nullptr)
+{
+}
+
+ThreadLock& ThreadLock::operator=(const ThreadLock& rhs)
+{
+  return *this;
+}
+
 ThreadLock::~ThreadLock()
 {
 }
@@ -19,10 +28,19 @@ void ThreadLock::Unlock()
 {
 }
 
-OsEvent::OsEvent()
+OsEvent::OsEvent() : mPrivate(nullptr)
+{
+}
+
+OsEvent::OsEvent(const OsEvent& rhs) : mPrivate(nullptr)
 {
 }
 
+OsEvent& OsEvent::operator=(const OsEvent& rhs)
+{
+  return *this;
+}
+
 OsEvent::~OsEvent()
 {
 }
@@ -47,8 +65,17 @@ void OsEvent::Wait()
 {
 }
 
-Semaphore::Semaphore()
+Semaphore::Semaphore() : mPrivate(nullptr)
+{
+}
+
+Semaphore::Semaphore(const Semaphore& rhs) : mPrivate(nullptr)
+{
+}
+
+Semaphore& Semaphore::operator=(const Semaphore& rhs)
 {
+  return *this;
 }
 
 Semaphore::~Semaphore()
@@ -83,16 +110,18 @@ void InterprocessMutex::Initialize(Status& status, const char* mutexName, bool f
 {
 }
 
-CountdownEvent::CountdownEvent()
+CountdownEvent::CountdownEvent() : mCount(0)
 {
 }
 
 void CountdownEvent::IncrementCount()
 {
+  ++mCount;
 }
 
 void CountdownEvent::DecrementCount()
 {
+  --mCount;
 }
 
 void CountdownEvent::Wait()
@@ -1,6 +1,7 @@
 // MIT Licensed (see LICENSE.md).
 #include "Precompiled.hpp"
 #include "PlatformCommunication.hpp"
+#include <unistd.h>
 
 namespace Raverie
 {
@@ -10,6 +11,11 @@ namespace Os
 
 void Sleep(uint ms)
 {
+#if defined(RaverieThreads)
+  timespec duration = {time_t(ms / 1000), long(ms % 1000) * 1000000};
+  while (nanosleep(&duration, &duration) != 0)
+    continue;
+#endif
 }
 
 bool ErrorProcessHandler(ErrorSignaler::ErrorData& errorData)
@@ -36,6 +42,16 @@ unsigned int GetDoubleClickTimeMs()
 {
   return 500;
 }
+
+uint GetProcessorCount()
+{
+#if defined(RaverieThreads) && defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (count > 0)
+    return uint(count);
+#endif
+  return 1;
+}
 } // namespace Os
 
 u64 GenerateUniqueId64()
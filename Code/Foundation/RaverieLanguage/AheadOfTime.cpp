@@ -0,0 +1,502 @@
+// MIT Licensed (see LICENSE.md).
+
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+bool AotCodeGenerator::CountCalls = false;
+const char* const AotCodeGenerator::ProjectRegistrationName = "Project";
+
+HashMap<GuidType, CompiledFunctionTable::Entry>& CompiledFunctionTable::GetEntries()
+{
+  static HashMap<GuidType, Entry> entries;
+  return entries;
+}
+
+void CompiledFunctionTable::Register(GuidType functionHash, u64 opcodeHash, CompiledFn compiled)
+{
+  ErrorIf(compiled == nullptr, "The compiled function must not be null");
+
+  Entry& entry = GetEntries()[functionHash];
+  entry.OpcodeHash = opcodeHash;
+  entry.Compiled = compiled;
+}
+
+CompiledFn CompiledFunctionTable::Find(Function* function)
+{
+  HashMap<GuidType, Entry>& entries = GetEntries();
+  if (entries.Empty() || function->CompactedOpcode.Empty())
+    return nullptr;
+
+  Entry* entry = entries.FindPointer(function->Hash);
+  if (entry == nullptr)
+    return nullptr;
+
+  // The script changed since the native code was generated
+  if (entry->OpcodeHash != AotCodeGenerator::ComputeOpcodeHash(function))
+    return nullptr;
+
+  return entry->Compiled;
+}
+
+void CompiledFunctionTable::Clear()
+{
+  GetEntries().Clear();
+}
+
+namespace NativeOperatorKind
+{
+enum Enum
+{
+  BinaryRValue,
+  BinaryLValue,
+  UnaryLValue,
+  CompareAndBranch
+};
+}
+
+// An opcode that we emit as plain C++ (rather than calling the instruction)
+struct NativeOperator
+{
+  Instruction::Enum Instruction;
+  NativeOperatorKind::Enum Kind;
+  cstr ArgumentType;
+  cstr ResultType;
+  cstr Operator;
+  bool IfTrue;
+};
+
+#define RaverieNativeBinary(Type, Name, ResultType, Operator) {Instruction::Name##Type, NativeOperatorKind::BinaryRValue, #Type, #ResultType, Operator, false},
+#define RaverieNativeAssignment(Type, Name, Operator) {Instruction::Name##Type, NativeOperatorKind::BinaryLValue, #Type, #Type, Operator, false},
+#define RaverieNativeUnary(Type, Name, Operator) {Instruction::Name##Type, NativeOperatorKind::UnaryLValue, #Type, #Type, Operator, false},
+#define RaverieNativeCompareAndBranch(Type, Name, Operator)                                                                                                                                            \
+  {Instruction::Name##Type##IfFalse, NativeOperatorKind::CompareAndBranch, #Type, "Boolean", Operator, false},                                                                                         \
+      {Instruction::Name##Type##IfTrue, NativeOperatorKind::CompareAndBranch, #Type, "Boolean", Operator, true},
+
+#define RaverieNativeOperators(Type)                                                                                                                                                                   \
+  RaverieNativeBinary(Type, Add, Type, "+") RaverieNativeBinary(Type, Subtract, Type, "-") RaverieNativeBinary(Type, Multiply, Type, "*")                                                              \
+      RaverieNativeBinary(Type, TestEquality, Boolean, "==") RaverieNativeBinary(Type, TestInequality, Boolean, "!=") RaverieNativeBinary(Type, TestLessThan, Boolean, "<")                            \
+          RaverieNativeBinary(Type, TestLessThanOrEqualTo, Boolean, "<=") RaverieNativeBinary(Type, TestGreaterThan, Boolean, ">")                                                                     \
+              RaverieNativeBinary(Type, TestGreaterThanOrEqualTo, Boolean, ">=") RaverieNativeAssignment(Type, AssignmentAdd, "+=") RaverieNativeAssignment(Type, AssignmentSubtract, "-=")            \
+                  RaverieNativeAssignment(Type, AssignmentMultiply, "*=") RaverieNativeUnary(Type, Increment, "++") RaverieNativeUnary(Type, Decrement, "--")                                          \
+                      RaverieNativeCompareAndBranch(Type, TestLessThan, "<") RaverieNativeCompareAndBranch(Type, TestLessThanOrEqualTo, "<=")                                                          \
+                          RaverieNativeCompareAndBranch(Type, TestGreaterThan, ">") RaverieNativeCompareAndBranch(Type, TestGreaterThanOrEqualTo, ">=")
+
+static const NativeOperator NativeOperators[] = {RaverieNativeOperators(Integer) RaverieNativeOperators(Real)};
+
+#undef RaverieNativeOperators
+#undef RaverieNativeCompareAndBranch
+#undef RaverieNativeUnary
+#undef RaverieNativeAssignment
+#undef RaverieNativeBinary
+
+static const NativeOperator* FindNativeOperator(Instruction::AlignedEnum instruction)
+{
+  for (size_t i = 0; i < RaverieCArrayCount(NativeOperators); ++i)
+  {
+    if (NativeOperators[i].Instruction == instruction)
+      return &NativeOperators[i];
+  }
+  return nullptr;
+}
+
+// Only locals and constants are read directly, any other operand may need a
+// handle dereference (and therefore a null check that throws)
+static bool IsNativeOperand(const Operand& operand)
+{
+  return operand.Type == OperandType::Local || operand.Type == OperandType::Constant;
+}
+
+static String GetNativeOperand(const Operand& operand, cstr type)
+{
+  if (operand.Type == OperandType::Constant)
+    return String::Format("(*(%s*)function->Constants.GetElement(%d))", type, operand.HandleConstantLocal);
+  return String::Format("(*(%s*)(frame + %d))", type, operand.HandleConstantLocal);
+}
+
+static String GetNativeLocal(OperandLocal local, cstr type)
+{
+  return String::Format("(*(%s*)(frame + %d))", type, local);
+}
+
+// Whether the native operator can be emitted for this particular opcode
+static bool CanEmitNative(const NativeOperator* native, const Opcode& opcode)
+{
+  if (native == nullptr)
+    return false;
+
+  switch (native->Kind)
+  {
+  case NativeOperatorKind::BinaryRValue:
+  case NativeOperatorKind::CompareAndBranch:
+  {
+    const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;
+    return IsNativeOperand(op.Left) && IsNativeOperand(op.Right);
+  }
+  case NativeOperatorKind::BinaryLValue:
+  {
+    const BinaryLValueOpcode& op = (const BinaryLValueOpcode&)opcode;
+    return op.Output.Type == OperandType::Local && IsNativeOperand(op.Right);
+  }
+  case NativeOperatorKind::UnaryLValue:
+  {
+    const UnaryLValueOpcode& op = (const UnaryLValueOpcode&)opcode;
+    return op.SingleOperand.Type == OperandType::Local;
+  }
+  }
+  return false;
+}
+
+static void HashValue(u64& hash, u64 value)
+{
+  // FNV-1a over the bytes of the value
+  for (size_t i = 0; i < sizeof(value); ++i)
+  {
+    hash ^= (value >> (i * 8)) & 0xFF;
+    hash *= 1099511628211ull;
+  }
+}
+
+static void HashOperand(u64& hash, const Operand& operand)
+{
+  // Hashed by field since the union and padding are not always initialized
+  HashValue(hash, (u64)operand.Type);
+  if (IsNativeOperand(operand))
+    HashValue(hash, (u64)(s64)operand.HandleConstantLocal);
+}
+
+static size_t GetOpcodeSize(Function* function, size_t index)
+{
+  Array<size_t>& offsets = function->OpcodeCompactedIndices;
+  if (index + 1 < offsets.Size())
+    return offsets[index + 1] - offsets[index];
+  return function->CompactedOpcode.Size() - offsets[index];
+}
+
+static const Opcode& GetOpcode(Function* function, size_t index)
+{
+  return *(const Opcode*)(function->CompactedOpcode.Data() + function->OpcodeCompactedIndices[index]);
+}
+
+u64 AotCodeGenerator::ComputeOpcodeHash(Function* function)
+{
+  u64 hash = 14695981039346656037ull;
+  HashValue(hash, function->CompactedOpcode.Size());
+
+  for (size_t i = 0; i < function->OpcodeCompactedIndices.Size(); ++i)
+  {
+    const Opcode& opcode = GetOpcode(function, i);
+    HashValue(hash, function->OpcodeCompactedIndices[i]);
+    HashValue(hash, (u64)opcode.Instruction);
+
+    // Jumps are emitted as gotos, so their targets are baked into the code
+    switch (opcode.Instruction)
+    {
+    case Instruction::IfFalseRelativeGoTo:
+    case Instruction::IfTrueRelativeGoTo:
+    {
+      const IfOpcode& op = (const IfOpcode&)opcode;
+      HashValue(hash, (u64)(s64)op.JumpOffset);
+      HashOperand(hash, op.Condition);
+      break;
+    }
+    case Instruction::RelativeGoTo:
+      HashValue(hash, (u64)(s64)((const RelativeJumpOpcode&)opcode).JumpOffset);
+      break;
+    case Instruction::PrepForFunctionCall:
+      HashValue(hash, (u64)(s64)((const PrepForFunctionCallOpcode&)opcode).JumpOffsetIfStatic);
+      break;
+    default:
+      break;
+    }
+
+    // As are the operands of anything we emit natively
+    const NativeOperator* native = FindNativeOperator(opcode.Instruction);
+    if (native == nullptr)
+      continue;
+
+    if (native->Kind == NativeOperatorKind::BinaryRValue || native->Kind == NativeOperatorKind::CompareAndBranch)
+    {
+      const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;
+      HashOperand(hash, op.Left);
+      HashOperand(hash, op.Right);
+      HashValue(hash, (u64)(s64)op.Output);
+    }
+    else if (native->Kind == NativeOperatorKind::BinaryLValue)
+    {
+      const BinaryLValueOpcode& op = (const BinaryLValueOpcode&)opcode;
+      HashOperand(hash, op.Output);
+      HashOperand(hash, op.Right);
+    }
+    else
+    {
+      HashOperand(hash, ((const UnaryLValueOpcode&)opcode).SingleOperand);
+    }
+  }
+
+  return hash;
+}
+
+static bool FunctionCallCountGreater(Function* left, Function* right)
+{
+  return left->CallCount.Load() > right->CallCount.Load();
+}
+
+void AotCodeGenerator::GetHotFunctions(Library* library, size_t minCalls, Array<Function*>& functionsOut)
+{
+  for (size_t i = 0; i < library->OwnedFunctions.Size(); ++i)
+  {
+    Function* function = library->OwnedFunctions[i];
+    if (function->CallCount.Load() >= minCalls && CanCompile(function))
+      functionsOut.PushBack(function);
+  }
+
+  Sort(functionsOut.All(), FunctionCallCountGreater);
+}
+
+// Gets the offset that each jump in the function may go to (other than the
+// next opcode), returns false if any of them is not the start of an opcode
+static bool GetJumpTargets(Function* function, HashSet<size_t>& targetsOut)
+{
+  HashSet<size_t> starts;
+  for (size_t i = 0; i < function->OpcodeCompactedIndices.Size(); ++i)
+    starts.Insert(function->OpcodeCompactedIndices[i]);
+
+  Array<size_t> targets;
+  for (size_t i = 0; i < function->OpcodeCompactedIndices.Size(); ++i)
+  {
+    const Opcode& opcode = GetOpcode(function, i);
+    size_t offset = function->OpcodeCompactedIndices[i];
+    size_t size = GetOpcodeSize(function, i);
+
+    switch (opcode.Instruction)
+    {
+    case Instruction::IfFalseRelativeGoTo:
+    case Instruction::IfTrueRelativeGoTo:
+      targets.PushBack(offset + ((const IfOpcode&)opcode).JumpOffset);
+      break;
+    case Instruction::RelativeGoTo:
+      targets.PushBack(offset + ((const RelativeJumpOpcode&)opcode).JumpOffset);
+      break;
+    case Instruction::PrepForFunctionCall:
+      targets.PushBack(offset + ((const PrepForFunctionCallOpcode&)opcode).JumpOffsetIfStatic);
+      break;
+    default:
+    {
+      // The if opcode that follows a compare-and-branch decides where it goes
+      if (Instruction::GetUnfused((Instruction::Enum)opcode.Instruction) != opcode.Instruction)
+      {
+        const IfOpcode& ifOpcode = *(const IfOpcode*)((const byte*)&opcode + size);
+        targets.PushBack(offset + size + ifOpcode.JumpOffset);
+        targets.PushBack(offset + size + sizeof(IfOpcode));
+      }
+      break;
+    }
+    }
+  }
+
+  for (size_t i = 0; i < targets.Size(); ++i)
+  {
+    if (starts.Contains(targets[i]) == false)
+      return false;
+    targetsOut.Insert(targets[i]);
+  }
+  return true;
+}
+
+bool AotCodeGenerator::CanCompile(Function* function)
+{
+  if (function->CompactedOpcode.Empty() || function->OpcodeCompactedIndices.Empty())
+    return false;
+
+  HashSet<size_t> targets;
+  return GetJumpTargets(function, targets);
+}
+
+static void GenerateTimeoutCheck(StringBuilder& builder, size_t offset)
+{
+  builder.Append(String::Format("    if (state->Timeouts.Empty() == false && state->ThrowExceptionOnTimeout(report))\n"
+                                "    {\n"
+                                "      programCounter = %d;\n"
+                                "      longjmp(ourFrame->ExceptionJump, ExceptionJumpResult);\n"
+                                "    }\n",
+                                (int)offset));
+}
+
+static void GenerateNativeOpcode(StringBuilder& builder, const NativeOperator* native, const Opcode& opcode, size_t offset, size_t size)
+{
+  switch (native->Kind)
+  {
+  case NativeOperatorKind::BinaryRValue:
+  {
+    const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;
+    builder.Append(String::Format("    %s = %s %s %s;\n",
+                                  GetNativeLocal(op.Output, native->ResultType).c_str(),
+                                  GetNativeOperand(op.Left, native->ArgumentType).c_str(),
+                                  native->Operator,
+                                  GetNativeOperand(op.Right, native->ArgumentType).c_str()));
+    break;
+  }
+  case NativeOperatorKind::BinaryLValue:
+  {
+    const BinaryLValueOpcode& op = (const BinaryLValueOpcode&)opcode;
+    builder.Append(String::Format("    %s %s %s;\n",
+                                  GetNativeOperand(op.Output, native->ArgumentType).c_str(),
+                                  native->Operator,
+                                  GetNativeOperand(op.Right, native->ArgumentType).c_str()));
+    break;
+  }
+  case NativeOperatorKind::UnaryLValue:
+  {
+    const UnaryLValueOpcode& op = (const UnaryLValueOpcode&)opcode;
+    builder.Append(String::Format("    %s%s;\n", native->Operator, GetNativeOperand(op.SingleOperand, native->ArgumentType).c_str()));
+    break;
+  }
+  case NativeOperatorKind::CompareAndBranch:
+  {
+    // The if opcode directly follows us, and its jump is relative to itself
+    const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;
+    const IfOpcode& ifOpcode = *(const IfOpcode*)((const byte*)&opcode + size);
+    size_t ifOffset = offset + size;
+
+    builder.Append(String::Format("    Boolean result = %s %s %s;\n",
+                                  GetNativeOperand(op.Left, native->ArgumentType).c_str(),
+                                  native->Operator,
+                                  GetNativeOperand(op.Right, native->ArgumentType).c_str()));
+    builder.Append(String::Format("    %s = result;\n", GetNativeLocal(op.Output, "Boolean").c_str()));
+    GenerateTimeoutCheck(builder, ifOffset);
+    builder.Append(String::Format("    if (result == %s)\n"
+                                  "      goto Opcode%d;\n"
+                                  "    goto Opcode%d;\n",
+                                  native->IfTrue ? "true" : "false",
+                                  (int)(ifOffset + ifOpcode.JumpOffset),
+                                  (int)(ifOffset + sizeof(IfOpcode))));
+    break;
+  }
+  }
+}
+
+static void GenerateFunction(StringBuilder& builder, Function* function, size_t functionIndex)
+{
+  HashSet<size_t> targets;
+  GetJumpTargets(function, targets);
+
+  builder.Append(String::Format("// %s\n", function->ToString().c_str()));
+  builder.Append(String::Format("static void CompiledFunction%d(ExecutableState* state, Call& call, ExceptionReport& report, PerFrameData* ourFrame)\n", (int)functionIndex));
+  builder.Append("{\n"
+                 "  Function* function = ourFrame->CurrentFunction;\n"
+                 "  const byte* opcode = function->CompactedOpcode.Data();\n"
+                 "  byte* frame = ourFrame->Frame;\n"
+                 "  size_t& programCounter = ourFrame->ProgramCounter;\n");
+
+  for (size_t i = 0; i < function->OpcodeCompactedIndices.Size(); ++i)
+  {
+    const Opcode& opcode = GetOpcode(function, i);
+    size_t offset = function->OpcodeCompactedIndices[i];
+    size_t size = GetOpcodeSize(function, i);
+
+    builder.Append("\n");
+    if (targets.Contains(offset))
+      builder.Append(String::Format("Opcode%d:\n", (int)offset));
+    builder.Append(String::Format("  // %s\n", Instruction::Names[opcode.Instruction]));
+    builder.Append("  {\n");
+
+    const NativeOperator* native = FindNativeOperator(opcode.Instruction);
+    if (CanEmitNative(native, opcode))
+    {
+      GenerateNativeOpcode(builder, native, opcode, offset, size);
+    }
+    else if (opcode.Instruction == Instruction::RelativeGoTo)
+    {
+      GenerateTimeoutCheck(builder, offset);
+      builder.Append(String::Format("    goto Opcode%d;\n", (int)(offset + ((const RelativeJumpOpcode&)opcode).JumpOffset)));
+    }
+    else if ((opcode.Instruction == Instruction::IfFalseRelativeGoTo || opcode.Instruction == Instruction::IfTrueRelativeGoTo) &&
+             IsNativeOperand(((const IfOpcode&)opcode).Condition))
+    {
+      const IfOpcode& op = (const IfOpcode&)opcode;
+      GenerateTimeoutCheck(builder, offset);
+      builder.Append(String::Format("    if (%s == %s)\n"
+                                    "      goto Opcode%d;\n",
+                                    GetNativeOperand(op.Condition, "Boolean").c_str(),
+                                    opcode.Instruction == Instruction::IfTrueRelativeGoTo ? "true" : "false",
+                                    (int)(offset + op.JumpOffset)));
+    }
+    else
+    {
+      // Everything else runs the same instruction the interpreter would
+      builder.Append(String::Format("    programCounter = %d;\n", (int)offset));
+      builder.Append(String::Format("    VirtualMachine::Instruction%s(state, call, report, programCounter, ourFrame, *(const Opcode*)(opcode + %d));\n",
+                                    Instruction::Names[opcode.Instruction],
+                                    (int)offset));
+
+      if (opcode.Instruction == Instruction::Return)
+      {
+        builder.Append("    return;\n");
+      }
+      else if (Instruction::GetUnfused((Instruction::Enum)opcode.Instruction) != opcode.Instruction)
+      {
+        const IfOpcode& ifOpcode = *(const IfOpcode*)((const byte*)&opcode + size);
+        size_t ifOffset = offset + size;
+        builder.Append(String::Format("    if (programCounter == %d)\n"
+                                      "      goto Opcode%d;\n"
+                                      "    goto Opcode%d;\n",
+                                      (int)(ifOffset + ifOpcode.JumpOffset),
+                                      (int)(ifOffset + ifOpcode.JumpOffset),
+                                      (int)(ifOffset + sizeof(IfOpcode))));
+      }
+      else if (opcode.Instruction == Instruction::IfFalseRelativeGoTo || opcode.Instruction == Instruction::IfTrueRelativeGoTo ||
+               opcode.Instruction == Instruction::PrepForFunctionCall)
+      {
+        ByteCodeOffset jumpOffset = opcode.Instruction == Instruction::PrepForFunctionCall ? ((const PrepForFunctionCallOpcode&)opcode).JumpOffsetIfStatic
+                                                                                           : ((const IfOpcode&)opcode).JumpOffset;
+        builder.Append(String::Format("    if (programCounter != %d)\n"
+                                      "      goto Opcode%d;\n",
+                                      (int)(offset + size),
+                                      (int)(offset + jumpOffset)));
+      }
+    }
+
+    builder.Append("  }\n");
+  }
+
+  builder.Append("}\n\n");
+}
+
+String AotCodeGenerator::Generate(const Array<Function*>& functions, StringParam registrationName)
+{
+  StringBuilder builder;
+  builder.Append("// MIT Licensed (see LICENSE.md).\n"
+                 "// Generated by the AotCodeGenerator from script opcode, do not modify.\n"
+                 "// Each function is only linked if its script is unchanged (otherwise the\n"
+                 "// interpreter runs it), so this file can safely be regenerated at any time.\n\n"
+                 "#include \"Precompiled.hpp\"\n\n"
+                 "namespace Raverie\n"
+                 "{\n");
+
+  Array<Function*> compiled;
+  for (size_t i = 0; i < functions.Size(); ++i)
+  {
+    Function* function = functions[i];
+    if (CanCompile(function) == false)
+      continue;
+
+    GenerateFunction(builder, function, compiled.Size());
+    compiled.PushBack(function);
+  }
+
+  builder.Append(String::Format("void RegisterCompiledFunctions%s()\n{\n", registrationName.c_str()));
+  for (size_t i = 0; i < compiled.Size(); ++i)
+  {
+    Function* function = compiled[i];
+    builder.Append(String::Format("  CompiledFunctionTable::Register(0x%llxull, 0x%llxull, &CompiledFunction%d);\n",
+                                  (unsigned long long)function->Hash,
+                                  (unsigned long long)ComputeOpcodeHash(function),
+                                  (int)i));
+  }
+  builder.Append("}\n"
+                 "} // namespace Raverie\n");
+
+  return builder.ToString();
+}
+} // namespace Raverie
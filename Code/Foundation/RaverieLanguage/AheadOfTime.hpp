@@ -0,0 +1,69 @@
+// MIT Licensed (see LICENSE.md).
+
+#pragma once
+
+namespace Raverie
+{
+// Holds the native versions of script functions that were compiled ahead of
+// time. Functions are linked to their native version when their library is
+// built (see Function::Compiled), but only if the opcode they were generated
+// from is unchanged, otherwise the function keeps running in the interpreter
+class CompiledFunctionTable
+{
+public:
+  // Registers a native function generated by the AotCodeGenerator (generated
+  // code calls this from its registration function, which must run before any
+  // of the script libraries are built)
+  static void Register(GuidType functionHash, u64 opcodeHash, CompiledFn compiled);
+
+  // Finds the native version of a function (or null if there is none, or if
+  // the function's opcode no longer matches the one it was generated from)
+  static CompiledFn Find(Function* function);
+
+  // Removes all registered functions (functions already linked keep theirs)
+  static void Clear();
+
+private:
+  struct Entry
+  {
+    u64 OpcodeHash;
+    CompiledFn Compiled;
+  };
+
+  static HashMap<GuidType, Entry>& GetEntries();
+};
+
+// Emits C++ from the compacted opcode of hot script functions (the second
+// execution tier). Opcodes that can be expressed directly (integer and real
+// math, comparisons, and jumps) become native code, everything else calls
+// straight into the same VirtualMachine instruction the interpreter runs.
+// Running with '-AotOutput <file>' counts calls and writes the file on exit,
+// building with RAVERIE_AOT_SOURCE set to that file compiles it in and
+// RaverieSetup calls its registration function
+class AotCodeGenerator
+{
+public:
+  // Whether the interpreter counts calls to each function (off by default so
+  // calls don't pay for it unless we're gathering hot functions)
+  static bool CountCalls;
+
+  // The registration name used for the file compiled in by RAVERIE_AOT_SOURCE
+  static const char* const ProjectRegistrationName;
+
+  // Hashes everything about a function's opcode that the generated code
+  // depends on, so that stale native code is never linked
+  static u64 ComputeOpcodeHash(Function* function);
+
+  // Gets every function in the library that was called at least 'minCalls'
+  // times, sorted from the most called to the least
+  static void GetHotFunctions(Library* library, size_t minCalls, Array<Function*>& functionsOut);
+
+  // Generates a C++ file that contains the native version of each function and
+  // a 'void RegisterCompiledFunctions<registrationName>()' function that
+  // registers them all with the CompiledFunctionTable
+  static String Generate(const Array<Function*>& functions, StringParam registrationName);
+
+  // Whether we can generate native code for a function (it must have opcode)
+  static bool CanCompile(Function* function);
+};
+} // namespace Raverie
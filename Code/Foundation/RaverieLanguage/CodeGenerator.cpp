@@ -447,8 +447,7 @@ void CodeGenerator::GenerateIfRoot(IfRootNode*& node, GeneratorContext* context)
     // Generate an opcode that will jump if the given conditional-expression is
     // false For now, we'll leave out the "jump to" address as we don't yet know
     // where to go The jump-to address will be filled in upon the post pass
-    IfOpcode& ifOpcode = function->AllocateOpcode<IfOpcode>(Instruction::IfFalseRelativeGoTo, DebugOrigin::If, ifPart->Condition->Location);
-    ifOpcode.Condition = ifPart->Condition->Access;
+    IfOpcode& ifOpcode = CreateIfOpcode(function, Instruction::IfFalseRelativeGoTo, ifPart->Condition->Access, DebugOrigin::If, ifPart->Condition->Location);
 
     // Loop through all the statements and generate opcode for each
     this->GenerateStatements(context, ifPart);
@@ -606,8 +605,7 @@ void CodeGenerator::GenerateWhile(WhileNode*& node, GeneratorContext* context)
   // Generate an opcode that will jump if the given conditional-expression is
   // false For now, we'll leave out the "jump to" address as we don't yet know
   // where to go The jump-to address will be filled in upon the post pass
-  IfOpcode& ifOpcode = function->AllocateOpcode<IfOpcode>(Instruction::IfFalseRelativeGoTo, DebugOrigin::While, node->Condition->Location);
-  ifOpcode.Condition = node->Condition->Access;
+  IfOpcode& ifOpcode = CreateIfOpcode(function, Instruction::IfFalseRelativeGoTo, node->Condition->Access, DebugOrigin::While, node->Condition->Location);
 
   // Generate all the statements code and continues
   GenerateLoopStatementsAndContinues(context, node);
@@ -655,8 +653,7 @@ void CodeGenerator::GenerateDoWhile(DoWhileNode*& node, GeneratorContext* contex
   // Generate an opcode that will jump if the given conditional-expression is
   // false For now, we'll leave out the "jump to" address as we don't yet know
   // where to go The jump-to address will be filled in upon the post pass
-  IfOpcode& ifOpcode = function->AllocateOpcode<IfOpcode>(Instruction::IfTrueRelativeGoTo, DebugOrigin::DoWhile, node->Condition->Location);
-  ifOpcode.Condition = node->Condition->Access;
+  IfOpcode& ifOpcode = CreateIfOpcode(function, Instruction::IfTrueRelativeGoTo, node->Condition->Access, DebugOrigin::DoWhile, node->Condition->Location);
   ifOpcode.JumpOffset = jumpOffset;
 
   // Store the index that we'd like to jump back to at the end of the loop
@@ -724,8 +721,7 @@ void CodeGenerator::GenerateFor(ForNode*& node, GeneratorContext* context)
   // Generate an opcode that will jump if the given conditional-expression is
   // false For now, we'll leave out the "jump to" address as we don't yet know
   // where to go The jump-to address will be filled in upon the post pass
-  IfOpcode& ifOpcode = function->AllocateOpcode<IfOpcode>(Instruction::IfFalseRelativeGoTo, DebugOrigin::For, node->Condition->Location);
-  ifOpcode.Condition = node->Condition->Access;
+  IfOpcode& ifOpcode = CreateIfOpcode(function, Instruction::IfFalseRelativeGoTo, node->Condition->Access, DebugOrigin::For, node->Condition->Location);
 
   // Generate all the statements code, the continues
   GenerateLoopStatementsAndContinues(context, node);
@@ -2093,6 +2089,30 @@ void CodeGenerator::GenerateHandleInitialize(Function* function, Type* type, con
   }
 }
 
+IfOpcode& CodeGenerator::CreateIfOpcode(Function* function, Instruction::Enum instruction, const Operand& condition, DebugOrigin::Enum debugOrigin, const CodeLocation& location)
+{
+  // If the last opcode we generated is a comparison that wrote the condition,
+  // turn it into a compare-and-branch that also runs the if opcode after it
+  // The if opcode itself is still generated so that jump offsets, debugging,
+  // and anything jumping directly to the if are all unchanged
+  size_t currentIndex = function->GetCurrentOpcodeIndex();
+  if (condition.Type == OperandType::Local && condition.FieldOffset == 0 && function->OpcodeCompactedIndices.Empty() == false)
+  {
+    size_t lastIndex = function->OpcodeCompactedIndices.Back();
+    if (lastIndex + sizeof(BinaryRValueOpcode) == currentIndex)
+    {
+      BinaryRValueOpcode& comparison = *(BinaryRValueOpcode*)function->OpcodeBuilder.GetRelativeElement(lastIndex);
+      Instruction::Enum fused = Instruction::GetCompareAndBranch((Instruction::Enum)comparison.Instruction, instruction);
+      if (fused != Instruction::InvalidInstruction && comparison.Output == condition.HandleConstantLocal)
+        comparison.Instruction = fused;
+    }
+  }
+
+  IfOpcode& ifOpcode = function->AllocateOpcode<IfOpcode>(instruction, debugOrigin, location);
+  ifOpcode.Condition = condition;
+  return ifOpcode;
+}
+
 void CodeGenerator::CreateLocal(Function* function, size_t size, Operand& accessOut)
 {
   // All r-value binary operations result in a value on the stack
@@ -204,6 +204,10 @@ private:
   // Create a conversion opcode
   void CreateConversionOpcode(Function* function, TypeCastNode& node, Instruction::Enum instruction, DebugOrigin::Enum debugOrigin);
 
+  // Create an if opcode that jumps based on the condition, fusing it with the
+  // comparison right before it into a compare-and-branch when possible
+  IfOpcode& CreateIfOpcode(Function* function, Instruction::Enum instruction, const Operand& condition, DebugOrigin::Enum debugOrigin, const CodeLocation& location);
+
   // Determine the proper opcode for unary operations
   void GenerateUnaryOp(Function* function, UnaryOperatorNode& node, DebugOrigin::Enum debugOrigin);
 
@@ -29,7 +29,7 @@ bool NativeVirtualInfo::Validate()
 }
 
 Function::Function() :
-    Hash(0), BoundFunction(nullptr), NativeConstructor(nullptr), FunctionType(nullptr), RequiredStackSpace(0), This(nullptr), SourceLibrary(nullptr), OwningProperty(nullptr), IsVirtual(false)
+    Hash(0), BoundFunction(nullptr), NativeConstructor(nullptr), FunctionType(nullptr), RequiredStackSpace(0), This(nullptr), SourceLibrary(nullptr), OwningProperty(nullptr), IsVirtual(false), CallCount(0), Compiled(nullptr)
 {
 }
 
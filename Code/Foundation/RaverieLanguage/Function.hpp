@@ -225,6 +225,16 @@ public:
   // are in debugging)
   HashMap<size_t, CodeLocation> OpcodeLocationToCodeLocation;
 
+  // How many times the interpreter has run this function (used to find the hot
+  // functions that are worth compiling ahead of time). Only counted while
+  // AotCodeGenerator::CountCalls is set, and atomic since script functions may
+  // be called from any thread
+  Atomic<size_t> CallCount;
+
+  // The native version of this function generated by the AotCodeGenerator, or
+  // null if the function always runs in the interpreter
+  CompiledFn Compiled;
+
 #ifdef RaverieDebug
   PodArray<Opcode*> OpcodeDebug;
 #endif
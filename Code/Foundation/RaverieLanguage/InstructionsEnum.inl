@@ -36,6 +36,12 @@
       RaverieEnumValue(BitwiseAnd##Type) RaverieEnumValue(AssignmentBitshiftLeft##Type) RaverieEnumValue(AssignmentBitshiftRight##Type) RaverieEnumValue(AssignmentBitwiseOr##Type)                    \
           RaverieEnumValue(AssignmentBitwiseXor##Type) RaverieEnumValue(AssignmentBitwiseAnd##Type)
 
+// Comparison fused with the conditional jump that follows it
+#define RaverieCompareAndBranchInstructions(Type)                                                                                                                                                      \
+  RaverieEnumValue(TestLessThan##Type##IfFalse) RaverieEnumValue(TestLessThan##Type##IfTrue) RaverieEnumValue(TestLessThanOrEqualTo##Type##IfFalse)                                                    \
+      RaverieEnumValue(TestLessThanOrEqualTo##Type##IfTrue) RaverieEnumValue(TestGreaterThan##Type##IfFalse) RaverieEnumValue(TestGreaterThan##Type##IfTrue)                                           \
+          RaverieEnumValue(TestGreaterThanOrEqualTo##Type##IfFalse) RaverieEnumValue(TestGreaterThanOrEqualTo##Type##IfTrue)
+
 // Core instructions
 RaverieEnumValue(InvalidInstruction)
 
@@ -99,3 +105,6 @@ RaverieEnumValue(InvalidInstruction)
                                                                                                                 RaverieEnumValue(ConvertDowncast) RaverieEnumValue(ConvertToAny)
                                                                                                                     RaverieEnumValue(ConvertFromAny) RaverieEnumValue(AnyDynamicMemberGet)
                                                                                                                         RaverieEnumValue(AnyDynamicMemberSet)
+
+    // Superinstructions (see CodeGenerator::CreateIfOpcode)
+    RaverieCompareAndBranchInstructions(Integer) RaverieCompareAndBranchInstructions(Real)
@@ -1346,6 +1346,9 @@ LibraryRef LibraryBuilder::CreateLibrary()
     function->CompactedOpcode.Resize(function->OpcodeBuilder.RelativeSize());
     function->OpcodeBuilder.RelativeCompact(function->CompactedOpcode.Data());
 
+    // Link the function to its native version if it was compiled ahead of time
+    function->Compiled = CompiledFunctionTable::Find(function);
+
     // Add the function to the library so it can be looked up
     function->SourceLibrary = library.Object;
   }
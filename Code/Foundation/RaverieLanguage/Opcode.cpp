@@ -10,6 +10,42 @@ const char* Instruction::Names[] = {
 #undef RaverieEnumValue
 };
 
+#define RaverieCompareAndBranchComparisons(Type, Case)                                                                                                                                                 \
+  Case(TestLessThan##Type) Case(TestLessThanOrEqualTo##Type) Case(TestGreaterThan##Type) Case(TestGreaterThanOrEqualTo##Type)
+
+Instruction::Enum Instruction::GetCompareAndBranch(Enum comparison, Enum ifInstruction)
+{
+  bool ifTrue = (ifInstruction == IfTrueRelativeGoTo);
+
+  switch (comparison)
+  {
+#define RaverieCompareAndBranchCase(Name)                                                                                                                                                              \
+  case Name:                                                                                                                                                                                           \
+    return ifTrue ? Name##IfTrue : Name##IfFalse;
+    RaverieCompareAndBranchComparisons(Integer, RaverieCompareAndBranchCase)
+    RaverieCompareAndBranchComparisons(Real, RaverieCompareAndBranchCase)
+#undef RaverieCompareAndBranchCase
+  default:
+    return InvalidInstruction;
+  }
+}
+
+Instruction::Enum Instruction::GetUnfused(Enum instruction)
+{
+  switch (instruction)
+  {
+#define RaverieCompareAndBranchCase(Name)                                                                                                                                                              \
+  case Name##IfFalse:                                                                                                                                                                                  \
+  case Name##IfTrue:                                                                                                                                                                                   \
+    return Name;
+    RaverieCompareAndBranchComparisons(Integer, RaverieCompareAndBranchCase)
+    RaverieCompareAndBranchComparisons(Real, RaverieCompareAndBranchCase)
+#undef RaverieCompareAndBranchCase
+  default:
+    return instruction;
+  }
+}
+
 Operand::Operand() : Type(OperandType::NotSet), HandleConstantLocal(0), FieldOffset(0)
 {
 }
@@ -22,6 +22,14 @@ enum Enum
 
 // The names of the instructions (for reflection and debugging)
 extern const char* Names[];
+
+// Returns the fused compare-and-branch instruction for a comparison followed by
+// the given if instruction, or InvalidInstruction if the pair cannot be fused
+Enum GetCompareAndBranch(Enum comparison, Enum ifInstruction);
+
+// If the instruction is a compare-and-branch this returns the comparison it was
+// fused from (the if opcode always follows it), otherwise the instruction itself
+Enum GetUnfused(Enum instruction);
 } // namespace Instruction
 
 namespace DebugOrigin
@@ -180,6 +180,10 @@ typedef void (*ThreadLockFn)(bool lock);
 // The C++ function that's bound to the script function
 typedef void (*BoundFn)(Call& call, ExceptionReport& report);
 
+// A script function that was compiled ahead of time into C++ (runs in place of
+// the interpreter on the frame that was already set up for the call)
+typedef void (*CompiledFn)(ExecutableState* state, Call& call, ExceptionReport& report, PerFrameData* ourFrame);
+
 // Every time we created a handle manager, we expect an index back of this type
 typedef size_t HandleManagerId;
 
@@ -296,6 +300,7 @@ String GetDocumentationCStringOrEmpty(cstr string);
 #include "RangeBinding.hpp"
 #include "Tokenizer.hpp"
 #include "VirtualMachine.hpp"
+#include "AheadOfTime.hpp"
 #include "Base64.hpp"
 #include "DataDrivenLexer.hpp"
 #include "Wrapper.hpp"
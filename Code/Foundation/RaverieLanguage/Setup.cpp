@@ -4,6 +4,11 @@
 
 namespace Raverie
 {
+#if defined(RaverieAotCompiledFunctions)
+// Defined in the file generated by the AotCodeGenerator (see RAVERIE_AOT_SOURCE)
+void RegisterCompiledFunctionsProject();
+#endif
+
 RaverieSetup* RaverieSetup::Instance = nullptr;
 
 RaverieSetup::RaverieSetup(SetupFlags::Type flags)
@@ -18,6 +23,12 @@ RaverieSetup::RaverieSetup(SetupFlags::Type flags)
   // Make sure the jump table is initialized
   VirtualMachine::InitializeJumpTable();
 
+  // Functions compiled ahead of time are linked as libraries are built, so
+  // they must be registered before any library is
+#if defined(RaverieAotCompiledFunctions)
+  RegisterCompiledFunctionsProject();
+#endif
+
   // The user can disable runtime documentation processing by passing in a flag
   // to RaverieStartup However, if the user defines 'RaverieDisableDocumentation',
   // this will completely disable both compile-time and runtime documentation
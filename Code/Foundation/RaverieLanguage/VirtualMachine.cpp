@@ -355,24 +355,25 @@ RaverieForceInline T& GetOperand(PerFrameData* stackFrame, PerFrameData* reportF
   abort();
 }
 
-// Reusable code for the if opcodes
+// Checking a timeout queries the timer, so only do it when a timeout is active
+// (PushTimeout always updates the timer before the first timeout starts)
+RaverieForceInline bool CheckTimeout(ExecutableState* state, ExceptionReport& report)
+{
+  return state->Timeouts.Empty() == false && state->ThrowExceptionOnTimeout(report);
+}
+
+// Reusable code for the if opcodes, once the condition is known
 template <Boolean IfTrue>
-RaverieForceInline void IfHandler(PerFrameData* stackFrame, const Opcode& opcode)
+RaverieForceInline void IfJump(PerFrameData* stackFrame, const IfOpcode& op, Boolean result)
 {
   // Validate the timeout (this will throw an exception if we go beyond the time
   // we need to) This only really needs to be ran in jumps
-  if (stackFrame->State->ThrowExceptionOnTimeout(*stackFrame->Report))
+  if (CheckTimeout(stackFrame->State, *stackFrame->Report))
   {
     // Unwind our stack
     longjmp(stackFrame->ExceptionJump, ExceptionJumpResult);
   }
 
-  // Grab the rest of the data
-  const IfOpcode& op = (const IfOpcode&)opcode;
-
-  // Read the boolean value
-  Boolean result = GetOperand<Boolean>(stackFrame, stackFrame, op.Condition);
-
   // If the register evaluates to true...
   if (result == IfTrue)
   {
@@ -387,6 +388,18 @@ RaverieForceInline void IfHandler(PerFrameData* stackFrame, const Opcode& opcode
   }
 }
 
+// Reusable code for the if opcodes
+template <Boolean IfTrue>
+RaverieForceInline void IfHandler(PerFrameData* stackFrame, const Opcode& opcode)
+{
+  // Grab the rest of the data
+  const IfOpcode& op = (const IfOpcode&)opcode;
+
+  // Read the boolean value
+  Boolean result = GetOperand<Boolean>(stackFrame, stackFrame, op.Condition);
+  IfJump<IfTrue>(stackFrame, op, result);
+}
+
 RaverieForceInline void CopyHandlerEx(PerFrameData* ourFrame, PerFrameData* topFrame, const byte*& sourceOut, byte*& destinationOut, const CopyOpcode& op)
 {
   // When we copy to parameters, it's always a destination
@@ -673,6 +686,37 @@ VirtualInstructionFn InstructionTable[Instruction::Count] = {0};
   RaverieCaseBinaryLValue2(VectorType, ScalarType, AssignmentScalarModulo, GenericIsZeroThrow(ourFrame, right, "modulo"); GenericScalarMod(output, output, right));                                    \
   RaverieCaseBinaryLValue2(VectorType, ScalarType, AssignmentScalarPow, GenericScalarPow(output, output, right));
 
+// A comparison fused with the if opcode that directly follows it and reads its
+// result (the output is still written in case anything else reads it)
+#define RaverieCaseCompareAndBranch(WithType, operation, expression)                                                                                                                                   \
+  RaverieVirtualInstruction(operation##WithType##IfFalse)                                                                                                                                              \
+  {                                                                                                                                                                                                    \
+    const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;                                                                                                                                  \
+    const WithType& left = GetOperand<WithType>(ourFrame, ourFrame, op.Left);                                                                                                                          \
+    const WithType& right = GetOperand<WithType>(ourFrame, ourFrame, op.Right);                                                                                                                        \
+    Boolean& output = GetLocal<Boolean>(ourFrame->Frame, op.Output);                                                                                                                                   \
+    expression;                                                                                                                                                                                        \
+    programCounter += sizeof(BinaryRValueOpcode);                                                                                                                                                      \
+    IfJump<false>(ourFrame, *(const IfOpcode*)((const byte*)&opcode + sizeof(BinaryRValueOpcode)), output);                                                                                            \
+  }                                                                                                                                                                                                    \
+  RaverieVirtualInstruction(operation##WithType##IfTrue)                                                                                                                                               \
+  {                                                                                                                                                                                                    \
+    const BinaryRValueOpcode& op = (const BinaryRValueOpcode&)opcode;                                                                                                                                  \
+    const WithType& left = GetOperand<WithType>(ourFrame, ourFrame, op.Left);                                                                                                                          \
+    const WithType& right = GetOperand<WithType>(ourFrame, ourFrame, op.Right);                                                                                                                        \
+    Boolean& output = GetLocal<Boolean>(ourFrame->Frame, op.Output);                                                                                                                                   \
+    expression;                                                                                                                                                                                        \
+    programCounter += sizeof(BinaryRValueOpcode);                                                                                                                                                      \
+    IfJump<true>(ourFrame, *(const IfOpcode*)((const byte*)&opcode + sizeof(BinaryRValueOpcode)), output);                                                                                             \
+  }
+
+// Less and greater comparison fused with a conditional jump
+#define RaverieCompareAndBranchCases(WithType)                                                                                                                                                         \
+  RaverieCaseCompareAndBranch(WithType, TestLessThan, output = left < right);                                                                                                                          \
+  RaverieCaseCompareAndBranch(WithType, TestLessThanOrEqualTo, output = left <= right);                                                                                                                \
+  RaverieCaseCompareAndBranch(WithType, TestGreaterThan, output = left > right);                                                                                                                       \
+  RaverieCaseCompareAndBranch(WithType, TestGreaterThanOrEqualTo, output = left >= right);
+
 // Special integral operators, generic numeric operators, copy, equality, and
 // comparison
 #define RaverieIntegralCases(WithType)                                                                                                                                                                 \
@@ -897,7 +941,7 @@ RaverieVirtualInstruction(RelativeGoTo)
 {
   // Validate the timeout (this will throw an exception if we go beyond the time
   // we need to) This only really needs to be ran in jumps
-  if (state->ThrowExceptionOnTimeout(report))
+  if (CheckTimeout(state, report))
   {
     // Jump out so we don't run any more code
     longjmp(ourFrame->ExceptionJump, ExceptionJumpResult);
@@ -919,7 +963,7 @@ RaverieVirtualInstruction(PrepForFunctionCall)
 {
   // Validate the timeout (this will throw an exception if we go beyond the time
   // we need to) This only really needs to be ran in jumps
-  if (state->ThrowExceptionOnTimeout(report))
+  if (CheckTimeout(state, report))
   {
     // Jump out so we don't run any more code
     longjmp(ourFrame->ExceptionJump, ExceptionJumpResult);
@@ -1429,6 +1473,8 @@ RaverieIntegralCases(Byte) RaverieScalarCases(Byte) RaverieIntegralCases(Integer
         RaverieScalarCases(Real) RaverieVectorCases(Real2, Real, Boolean2) RaverieVectorCases(Real3, Real, Boolean3) RaverieVectorCases(Real4, Real, Boolean4) RaverieScalarCases(DoubleReal)
             RaverieIntegralCases(DoubleInteger) RaverieScalarCases(DoubleInteger)
 
+                RaverieCompareAndBranchCases(Integer) RaverieCompareAndBranchCases(Real)
+
                 RaverieEqualityCases(Boolean, Boolean) RaverieEqualityCases(Handle, Boolean) RaverieEqualityCases(Delegate, Boolean) RaverieEqualityCases(Any, Boolean)
 
                     RaverieCopyCases(Boolean)
@@ -1529,17 +1575,42 @@ void VirtualMachine::ExecuteNext(Call& call, ExceptionReport& report)
   RaverieLastRunningFunction = ourFrame->CurrentFunction;
   RaverieLastRunningOpcodeLength = ourFrame->CurrentFunction->CompactedOpcode.Size();
 
+  // Run the ahead of time compiled version of the function if there is one,
+  // unless a debugger needs the interpreter to send opcode events
+  Function* function = ourFrame->CurrentFunction;
+  if (AotCodeGenerator::CountCalls)
+    ++function->CallCount;
+  if (function->Compiled != nullptr && state->EnableDebugEvents == false)
+  {
+    function->Compiled(state, call, report, ourFrame);
+    return;
+  }
+
   // Loop through all the opcodes in the function
   // We don't need to check for the end since the return opcode will exit this
   // function
   RaverieLoop
   {
+    // Without debug events there is nothing to send around each opcode, so
+    // run opcodes back to back until a debugger enables them
+    while (state->EnableDebugEvents == false)
+    {
+      const Opcode& opcode = *(Opcode*)(compactedOpcode + programCounter);
+      InstructionTable[opcode.Instruction](state, call, report, programCounter, ourFrame, opcode);
+      if (opcode.Instruction == Instruction::Return)
+        return;
+    }
+
     // Grab the current opcode that we're executing
     const Opcode& opcode = *(Opcode*)(compactedOpcode + programCounter);
 
+    // Superinstructions are run as their original opcodes so that a debugger
+    // still steps (and breaks) on each of them
+    Instruction::Enum instruction = Instruction::GetUnfused((Instruction::Enum)opcode.Instruction);
+
     // If any pre opcode callbacks are set then send the event
     state->SendOpcodeEvent(Events::OpcodePreStep, ourFrame);
-    InstructionTable[opcode.Instruction](state, call, report, programCounter, ourFrame, opcode);
+    InstructionTable[instruction](state, call, report, programCounter, ourFrame, opcode);
 
     // If any post opcode callbacks are set then send the event
     state->SendOpcodeEvent(Events::OpcodePostStep, ourFrame);
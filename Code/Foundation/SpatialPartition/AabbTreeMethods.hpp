@@ -4,7 +4,7 @@
 namespace Raverie
 {
 
-DeclareEnum3(PartitionMethods, MinimizeVolumeSum, MinimuzeSurfaceAreaSum, MidPoint);
+DeclareEnum4(PartitionMethods, MinimizeVolumeSum, MinimuzeSurfaceAreaSum, MidPoint, BinnedSurfaceArea);
 
 template <typename NodeType>
 class PartitionNodeMethod
@@ -13,6 +13,18 @@ public:
   typedef uint (*PartitionNodeAxisMethod)(Array<NodeType*>&);
 };
 
+/// Runs function over [begin, end) split into ranges of at most grainSize,
+/// returning once every range has completed.
+typedef void (*TreeBuildRangeFunction)(void* userData, uint begin, uint end);
+typedef void (*TreeBuildParallelForFunction)(uint begin, uint end, uint grainSize, TreeBuildRangeFunction function, void* userData);
+
+/// When set, top down builds of large trees construct sibling subtrees in
+/// parallel through this function (installed by whoever owns the thread pool).
+extern TreeBuildParallelForFunction gTreeBuildParallelFor;
+
+/// Node count at which a top down build splits its subtrees across threads.
+const uint cParallelTreeBuildThreshold = 4096;
+
 /// Builds an Aabb tree using the passed in partition axis method.
 /// NOTE*  ObjectType must have a public Aabb member named mAabb.
 template <typename NodeType>
@@ -34,6 +46,12 @@ uint MinimizeSurfaceAreaSumNodes(Array<NodeType*>& leafNodes);
 template <typename NodeType>
 uint MidPointNodes(Array<NodeType*>& leafNodes);
 
+/// Partition axis method that approximates the surface area heuristic by
+/// bucketing node centers into a fixed number of bins per axis. Much cheaper
+/// to build than MinimizeSurfaceAreaSumNodes for large trees (no sorting).
+template <typename NodeType>
+uint BinnedSurfaceAreaNodes(Array<NodeType*>& leafNodes);
+
 //-------------------------------------Old functions (still used, can't remove)
 template <typename ObjectType>
 class PartitionMethod
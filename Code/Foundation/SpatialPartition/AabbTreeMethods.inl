@@ -18,6 +18,23 @@ bool NodeSortZ(const NodeType* left, const NodeType* right)
   return left->mAabb.GetCenter().z < right->mAabb.GetCenter().z;
 }
 
+/// One subtree of a top down build that is handed off to another thread.
+template <typename NodeType>
+struct TopDownBuildTask
+{
+  Array<NodeType*>* mLeafNodes;
+  typename PartitionNodeMethod<NodeType>::PartitionNodeAxisMethod mPartitionMethod;
+  NodeType* mResult;
+};
+
+template <typename NodeType>
+void BuildTreeTopDownTasks(void* userData, uint begin, uint end)
+{
+  TopDownBuildTask<NodeType>* tasks = (TopDownBuildTask<NodeType>*)userData;
+  for (uint i = begin; i < end; ++i)
+    tasks[i].mResult = BuildTreeTopDownNodes<NodeType>(*tasks[i].mLeafNodes, tasks[i].mPartitionMethod);
+}
+
 template <typename NodeType>
 NodeType* BuildTreeTopDownNodes(Array<NodeType*>& leafNodes, typename PartitionNodeMethod<NodeType>::PartitionNodeAxisMethod partitionMethod)
 {
@@ -46,8 +63,23 @@ NodeType* BuildTreeTopDownNodes(Array<NodeType*>& leafNodes, typename PartitionN
   left.Assign(leafNodes.Begin(), leafNodes.Begin() + separationIndex);
   right.Assign(leafNodes.Begin() + separationIndex, leafNodes.End());
 
-  NodeType* leftNode = BuildTreeTopDownNodes<NodeType>(left, partitionMethod);
-  NodeType* rightNode = BuildTreeTopDownNodes<NodeType>(right, partitionMethod);
+  NodeType* leftNode;
+  NodeType* rightNode;
+
+  // Each half is independent of the other, so large halves can be built at the
+  // same time (each half may split again further down).
+  if (gTreeBuildParallelFor != nullptr && leafNodes.Size() >= cParallelTreeBuildThreshold)
+  {
+    TopDownBuildTask<NodeType> tasks[2] = {{&left, partitionMethod, nullptr}, {&right, partitionMethod, nullptr}};
+    gTreeBuildParallelFor(0, 2, 1, &BuildTreeTopDownTasks<NodeType>, tasks);
+    leftNode = tasks[0].mResult;
+    rightNode = tasks[1].mResult;
+  }
+  else
+  {
+    leftNode = BuildTreeTopDownNodes<NodeType>(left, partitionMethod);
+    rightNode = BuildTreeTopDownNodes<NodeType>(right, partitionMethod);
+  }
 
   NodeType* parentNode = new NodeType();
   parentNode->SetChildren(leftNode, rightNode);
@@ -257,6 +289,110 @@ uint MidPointNodes(Array<NodeType*>& leafNodes)
   return leafNodes.Size() >> 1;
 }
 
+inline uint SurfaceAreaBinIndex(real center, real axisMin, real binScale, uint binCount)
+{
+  uint bin = (uint)((center - axisMin) * binScale);
+  return Math::Min(bin, binCount - 1);
+}
+
+template <typename NodeType>
+uint BinnedSurfaceAreaNodes(Array<NodeType*>& leafNodes)
+{
+  const uint cBinCount = 16;
+  uint size = leafNodes.Size();
+
+  // The bins are spread evenly across the bounds of the node centers.
+  Aabb centerBounds;
+  centerBounds.SetInvalid();
+  for (uint i = 0; i < size; ++i)
+    centerBounds.Expand(leafNodes[i]->mAabb.GetCenter());
+
+  uint bestAxis = 0;
+  uint bestBin = 0;
+  real bestCost = Math::PositiveMax();
+
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    real axisMin = centerBounds.mMin[axis];
+    real extent = centerBounds.mMax[axis] - axisMin;
+    // Every center is in the same spot on this axis, it can't be split.
+    if (extent <= Math::Epsilon())
+      continue;
+    real binScale = real(cBinCount) / extent;
+
+    Aabb binAabbs[cBinCount];
+    uint binCounts[cBinCount];
+    for (uint bin = 0; bin < cBinCount; ++bin)
+    {
+      binAabbs[bin].SetInvalid();
+      binCounts[bin] = 0;
+    }
+
+    for (uint i = 0; i < size; ++i)
+    {
+      Aabb& aabb = leafNodes[i]->mAabb;
+      uint bin = SurfaceAreaBinIndex(aabb.GetCenter()[axis], axisMin, binScale, cBinCount);
+      binAabbs[bin].Combine(aabb);
+      ++binCounts[bin];
+    }
+
+    // Sweep from the right to find the area and count of everything to the
+    // right of each split plane.
+    real rightAreas[cBinCount];
+    uint rightCounts[cBinCount];
+    Aabb rightAabb;
+    rightAabb.SetInvalid();
+    uint rightCount = 0;
+    for (uint bin = cBinCount - 1; bin > 0; --bin)
+    {
+      rightAabb.Combine(binAabbs[bin]);
+      rightCount += binCounts[bin];
+      rightAreas[bin] = rightAabb.GetSurfaceArea();
+      rightCounts[bin] = rightCount;
+    }
+
+    // Sweep from the left and evaluate the cost of splitting after each bin.
+    Aabb leftAabb;
+    leftAabb.SetInvalid();
+    uint leftCount = 0;
+    for (uint bin = 0; bin < cBinCount - 1; ++bin)
+    {
+      leftAabb.Combine(binAabbs[bin]);
+      leftCount += binCounts[bin];
+      if (leftCount == 0 || rightCounts[bin + 1] == 0)
+        continue;
+
+      real cost = leftAabb.GetSurfaceArea() * leftCount + rightAreas[bin + 1] * rightCounts[bin + 1];
+      if (cost < bestCost)
+      {
+        bestCost = cost;
+        bestAxis = axis;
+        bestBin = bin;
+      }
+    }
+  }
+
+  // All of the centers are (nearly) the same, just split down the middle.
+  if (bestCost == Math::PositiveMax())
+    return MidPointNodes(leafNodes);
+
+  // Partition in place so everything at or below the best bin is on the left.
+  real axisMin = centerBounds.mMin[bestAxis];
+  real binScale = real(cBinCount) / (centerBounds.mMax[bestAxis] - axisMin);
+  uint left = 0;
+  uint right = size;
+  while (left < right)
+  {
+    real center = leafNodes[left]->mAabb.GetCenter()[bestAxis];
+    if (SurfaceAreaBinIndex(center, axisMin, binScale, cBinCount) <= bestBin)
+      ++left;
+    else
+      Swap(leafNodes[left], leafNodes[--right]);
+  }
+
+  return left;
+}
+
 //------------------------------------- Old functions (still used, can't remove)
 
 template <typename NodeType, typename ObjectType>
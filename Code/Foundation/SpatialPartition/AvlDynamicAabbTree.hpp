@@ -4,46 +4,35 @@
 namespace Raverie
 {
 
-namespace Memory
-{
-class Pool;
-}
-
 /// Node used for the Avl balanced dynamic aabb tree. Different from the static
-/// tree node because we need a parent pointer. Different from the normal
-/// DynamicAabbTree because we need a height.
+/// tree node because we need a parent index. Different from the normal
+/// DynamicAabbTree because we need a height. Nodes live in the tree's
+/// contiguous node store and refer to each other by index.
 template <typename ClientDataType>
 struct AvlDynamicTreeNode
 {
   AvlDynamicTreeNode();
-  ~AvlDynamicTreeNode();
 
-  static Memory::Pool* sDynamicNodePool;
-  static void* operator new(size_t size);
-  static void operator delete(void* pMem, size_t size);
-
-  bool IsLeaf();
-  // Assumes that a parent exists
-  AvlDynamicTreeNode* GetSibling();
+  bool IsLeaf() const;
 
   Aabb mAabb;
-  ClientDataType mClientData;
-
-  AvlDynamicTreeNode* mParent;
-
   union
   {
     struct
     {
-      AvlDynamicTreeNode* mChild1;
-      AvlDynamicTreeNode* mChild2;
+      uint mChild1;
+      uint mChild2;
     };
-    AvlDynamicTreeNode* mChildren[2];
+    uint mChildren[2];
   };
+  /// While the node is on the free list this is the next free node.
+  uint mParent;
 
   /// The height of this current node. Height of 0 means a leaf node.
   /// Height increases as you go up the tree.
   uint mHeight;
+
+  ClientDataType mClientData;
 };
 
 /// Policy for the AvlDynamicAabbTree that determines
@@ -54,19 +43,20 @@ struct AvlDynamicTreePolicy : public BaseDynamicTreePolicy<AvlDynamicTreeNode<Cl
   typedef AvlDynamicTreeNode<ClientDataType> NodeType;
   typedef ClientDataType ClientDataTypeDef;
   typedef BaseDynamicTreePolicy<AvlDynamicTreeNode<ClientDataType>> BaseType;
+  typedef typename BaseType::NodeStore NodeStore;
 
   /// Inserts the given leaf node at the starting node. Generally, start is
   /// the root, but when updating a node it may be somewhere in the middle
   // of the tree.
-  static void InsertNode(NodeType*& root, NodeType* leafNode, NodeType* start);
+  static void InsertNode(NodeStore& nodes, uint& root, uint leafNode, uint start);
   /// Removes the given node. Returns the last node that did not have to be
   /// resized from removal.
-  static NodeType* RemoveNode(NodeType*& root, NodeType* leafNode);
+  static uint RemoveNode(NodeStore& nodes, uint& root, uint leafNode);
 
   // Takes the given node and performs an AVL rotation to balance it's children.
-  static NodeType* Balance(NodeType*& root, NodeType* node);
-  static NodeType* RotateUp(NodeType*& root, NodeType* oldParent, uint childIndex);
-  static void FixAabbAndHeight(NodeType* node);
+  static uint Balance(NodeStore& nodes, uint& root, uint node);
+  static uint RotateUp(NodeStore& nodes, uint& root, uint oldParent, uint childIndex);
+  static void FixAabbAndHeight(NodeStore& nodes, uint node);
 };
 
 /// A Hierarchical AabbTree that is meant for dynamic objects. Used to have a
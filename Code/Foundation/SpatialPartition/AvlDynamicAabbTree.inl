@@ -6,200 +6,176 @@ namespace Raverie
 template <typename ClientDataType>
 AvlDynamicTreeNode<ClientDataType>::AvlDynamicTreeNode()
 {
-  mChild1 = nullptr;
-  mChild2 = nullptr;
-  mParent = nullptr;
+  mChild1 = 0;
+  mChild2 = 0;
+  mParent = 0;
   mHeight = 0;
   GetDefaultClientDataValue(mClientData);
 }
 
 template <typename ClientDataType>
-AvlDynamicTreeNode<ClientDataType>::~AvlDynamicTreeNode()
+bool AvlDynamicTreeNode<ClientDataType>::IsLeaf() const
 {
-  delete mChild1;
-  delete mChild2;
+  return mChild1 == 0;
 }
 
 template <typename ClientDataType>
-Memory::Pool* AvlDynamicTreeNode<ClientDataType>::sDynamicNodePool = new Memory::Pool("DynamicNodes", Memory::GetNamedHeap("BroadPhase"), sizeof(AvlDynamicTreeNode<ClientDataType>), 200);
-
-template <typename ClientDataType>
-void* AvlDynamicTreeNode<ClientDataType>::operator new(size_t size)
-{
-  return sDynamicNodePool->Allocate(size);
-}
-
-template <typename ClientDataType>
-void AvlDynamicTreeNode<ClientDataType>::operator delete(void* pMem, size_t size)
-{
-  return sDynamicNodePool->Deallocate(pMem, size);
-}
-
-template <typename ClientDataType>
-bool AvlDynamicTreeNode<ClientDataType>::IsLeaf()
-{
-  return mChild1 == nullptr;
-}
-
-template <typename ClientDataType>
-AvlDynamicTreeNode<ClientDataType>* AvlDynamicTreeNode<ClientDataType>::GetSibling()
-{
-  if (mParent->mChild1 == this)
-    return mParent->mChild2;
-  return mParent->mChild1;
-}
-
-template <typename ClientDataType>
-void AvlDynamicTreePolicy<ClientDataType>::InsertNode(NodeType*& root, NodeType* leafNode, NodeType* start)
+void AvlDynamicTreePolicy<ClientDataType>::InsertNode(NodeStore& nodes, uint& root, uint leafNode, uint start)
 {
   // if we have no root, then this node is the root
-  if (root == nullptr)
+  if (root == NodeStore::cNullNode)
   {
     root = leafNode;
-    root->mParent = nullptr;
+    nodes[root].mParent = NodeStore::cNullNode;
     return;
   }
 
   // traverse until we find the correct leaf node to add at
-  NodeType* node = start;
-  while (!node->IsLeaf())
+  uint node = start;
+  while (!nodes[node].IsLeaf())
   {
     // expand the aabb's of our parent as we go down
-    node->mAabb = node->mAabb.Combined(leafNode->mAabb);
+    nodes[node].mAabb = nodes[node].mAabb.Combined(nodes[leafNode].mAabb);
     // choose the correct node between the left and right node
-    node = BaseType::SelectNode(node, leafNode);
+    node = BaseType::SelectNode(nodes, node, leafNode);
   }
 
   // all our objects must be on leaf nodes, so we have
   // to make a new internal node to put the old leaf and the new leaf
-  NodeType* oldParent = node->mParent;
-  NodeType* newParent = BaseType::CreateInternalNode(oldParent, node, leafNode);
-  newParent->mHeight = 1;
+  uint oldParent = nodes[node].mParent;
+  uint newParent = BaseType::CreateInternalNode(nodes, oldParent, node, leafNode);
+  nodes[newParent].mHeight = 1;
 
-  // deal with fixing the root pointer if the tree contained only 1 node
-  if (nullptr == oldParent)
+  // deal with fixing the root index if the tree contained only 1 node
+  if (oldParent == NodeStore::cNullNode)
     root = newParent;
 
-  NodeType* nodeToBalance = newParent;
-  while (nodeToBalance != nullptr)
+  uint nodeToBalance = newParent;
+  while (nodeToBalance != NodeStore::cNullNode)
   {
-    nodeToBalance = Balance(root, nodeToBalance);
+    nodeToBalance = Balance(nodes, root, nodeToBalance);
 
-    FixAabbAndHeight(nodeToBalance);
-    nodeToBalance = nodeToBalance->mParent;
+    FixAabbAndHeight(nodes, nodeToBalance);
+    nodeToBalance = nodes[nodeToBalance].mParent;
   }
 }
 
 template <typename ClientDataType>
-typename AvlDynamicTreePolicy<ClientDataType>::NodeType* AvlDynamicTreePolicy<ClientDataType>::RemoveNode(NodeType*& root, NodeType* leafNode)
+uint AvlDynamicTreePolicy<ClientDataType>::RemoveNode(NodeStore& nodes, uint& root, uint leafNode)
 {
-  ErrorIf(leafNode->mChild1 != nullptr, "Can only remove leaf nodes.");
-  ErrorIf(leafNode->mChild2 != nullptr, "Can only remove leaf nodes.");
+  ErrorIf(nodes[leafNode].mChild1 != NodeStore::cNullNode, "Can only remove leaf nodes.");
+  ErrorIf(nodes[leafNode].mChild2 != NodeStore::cNullNode, "Can only remove leaf nodes.");
 
   // deal with removing the root
   if (leafNode == root)
   {
-    root = nullptr;
+    root = NodeStore::cNullNode;
     return root;
   }
 
-  NodeType* parent = leafNode->mParent;
-  NodeType* grandParent = parent->mParent;
-  NodeType* sibling = leafNode->GetSibling();
+  uint parent = nodes[leafNode].mParent;
+  uint grandParent = nodes[parent].mParent;
+  uint sibling = nodes[parent].mChild1 == leafNode ? nodes[parent].mChild2 : nodes[parent].mChild1;
   // if our parent is the root, then our sibling will have to
   // become the new root
-  if (grandParent == nullptr)
+  if (grandParent == NodeStore::cNullNode)
   {
-    BaseType::DeleteNode(root);
-    sibling->mParent = nullptr;
+    BaseType::DeleteNode(nodes, root);
+    nodes[sibling].mParent = NodeStore::cNullNode;
     root = sibling;
     return root;
   }
 
   // set our sibling to be where our old parent was,
   // then delete our parent
-  if (grandParent->mChild1 == parent)
-    grandParent->mChild1 = sibling;
+  NodeType& grandParentNode = nodes[grandParent];
+  if (grandParentNode.mChild1 == parent)
+    grandParentNode.mChild1 = sibling;
   else
-    grandParent->mChild2 = sibling;
-  sibling->mParent = grandParent;
-  BaseType::DeleteNode(parent);
+    grandParentNode.mChild2 = sibling;
+  nodes[sibling].mParent = grandParent;
+  BaseType::DeleteNode(nodes, parent);
 
   // work up the tree shrinking the Aabb's to account for us being removed
-  while (grandParent)
+  while (grandParent != NodeStore::cNullNode)
   {
-    grandParent = Balance(root, grandParent);
+    grandParent = Balance(nodes, root, grandParent);
 
-    FixAabbAndHeight(grandParent);
-    grandParent = grandParent->mParent;
+    FixAabbAndHeight(nodes, grandParent);
+    grandParent = nodes[grandParent].mParent;
   }
 
   return grandParent;
 }
 
 template <typename ClientDataType>
-typename AvlDynamicTreePolicy<ClientDataType>::NodeType* AvlDynamicTreePolicy<ClientDataType>::Balance(NodeType*& root, NodeType* node)
+uint AvlDynamicTreePolicy<ClientDataType>::Balance(NodeStore& nodes, uint& root, uint node)
 {
-  if (node->mHeight < 2)
+  NodeType& nodeData = nodes[node];
+  if (nodeData.mHeight < 2)
     return node;
 
-  NodeType* B = node->mChild1;
-  NodeType* C = node->mChild2;
-  int balance = C->mHeight - B->mHeight;
+  uint heightB = nodes[nodeData.mChild1].mHeight;
+  uint heightC = nodes[nodeData.mChild2].mHeight;
+  int balance = int(heightC) - int(heightB);
 
   if (balance > 1)
-    return RotateUp(root, node, 1);
+    return RotateUp(nodes, root, node, 1);
   else if (balance < -1)
-    return RotateUp(root, node, 0);
+    return RotateUp(nodes, root, node, 0);
   return node;
 }
 
 template <typename ClientDataType>
-typename AvlDynamicTreePolicy<ClientDataType>::NodeType* AvlDynamicTreePolicy<ClientDataType>::RotateUp(NodeType*& root, NodeType* oldParent, uint childIndex)
+uint AvlDynamicTreePolicy<ClientDataType>::RotateUp(NodeStore& nodes, uint& root, uint oldParent, uint childIndex)
 {
-  NodeType* newParent = oldParent->mChildren[childIndex];
+  NodeType& oldParentNode = nodes[oldParent];
+  uint newParent = oldParentNode.mChildren[childIndex];
+  NodeType& newParentNode = nodes[newParent];
   uint largeIndex, smallIndex;
-  NodeType* smallChild;
+  uint smallChild;
 
-  if (newParent->mChild1->mHeight > newParent->mChild2->mHeight)
+  if (nodes[newParentNode.mChild1].mHeight > nodes[newParentNode.mChild2].mHeight)
     largeIndex = 0;
   else
     largeIndex = 1;
   smallIndex = (largeIndex + 1) % 2;
-  smallChild = newParent->mChildren[smallIndex];
+  smallChild = newParentNode.mChildren[smallIndex];
 
   // swap new and old parent
-  newParent->mChildren[smallIndex] = oldParent;
-  newParent->mParent = oldParent->mParent;
-  oldParent->mParent = newParent;
+  newParentNode.mChildren[smallIndex] = oldParent;
+  newParentNode.mParent = oldParentNode.mParent;
+  oldParentNode.mParent = newParent;
   // fix the new parent's parent if it exists to point back down correctly
-  if (newParent->mParent != nullptr)
+  if (newParentNode.mParent != NodeStore::cNullNode)
   {
-    if (newParent->mParent->mChild1 == oldParent)
-      newParent->mParent->mChild1 = newParent;
+    NodeType& grandParentNode = nodes[newParentNode.mParent];
+    if (grandParentNode.mChild1 == oldParent)
+      grandParentNode.mChild1 = newParent;
     else
-      newParent->mParent->mChild2 = newParent;
+      grandParentNode.mChild2 = newParent;
   }
   else
     root = newParent;
   // put the small child under c
-  oldParent->mChildren[childIndex] = smallChild;
-  smallChild->mParent = oldParent;
+  oldParentNode.mChildren[childIndex] = smallChild;
+  nodes[smallChild].mParent = oldParent;
   // fix the aabbs and heights of the old and new parent
-  FixAabbAndHeight(oldParent);
-  FixAabbAndHeight(newParent);
+  FixAabbAndHeight(nodes, oldParent);
+  FixAabbAndHeight(nodes, newParent);
 
   return newParent;
 }
 
 template <typename ClientDataType>
-void AvlDynamicTreePolicy<ClientDataType>::FixAabbAndHeight(NodeType* node)
+void AvlDynamicTreePolicy<ClientDataType>::FixAabbAndHeight(NodeStore& nodes, uint node)
 {
-  NodeType* child1 = node->mChild1;
-  NodeType* child2 = node->mChild2;
-  node->mHeight = 1 + Math::Max(child1->mHeight, child2->mHeight);
-  node->mAabb = child1->mAabb;
-  node->mAabb.Combine(child2->mAabb);
+  NodeType& nodeData = nodes[node];
+  const NodeType& child1 = nodes[nodeData.mChild1];
+  const NodeType& child2 = nodes[nodeData.mChild2];
+  nodeData.mHeight = 1 + Math::Max(child1.mHeight, child2.mHeight);
+  nodeData.mAabb = child1.mAabb;
+  nodeData.mAabb.Combine(child2.mAabb);
 }
 
 template <typename ClientDataType>
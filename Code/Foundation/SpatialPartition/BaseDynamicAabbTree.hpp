@@ -6,20 +6,22 @@ namespace Raverie
 
 /// Base policy for DynamicAabbTrees.
 /// Contains core functionality that all other AabbTreePolicies need to have.
+/// Nodes are referred to by their index in the tree's node store.
 template <typename NodeType>
 struct BaseDynamicTreePolicy
 {
   typedef NodeType NodeTypeDef;
+  typedef DynamicTreeNodeStore<NodeType> NodeStore;
 
   /// Given a parent node and a leaf node, determines which
   /// child the new leaf should be placed with.
-  static NodeType* SelectNode(NodeType* parent, NodeType* newLeaf);
+  static uint SelectNode(NodeStore& nodes, uint parent, uint newLeaf);
   /// Creates a new internal node from the old parent and two new children.
-  /// links all pointers and expands the aabb to deal with the children
-  static NodeType* CreateInternalNode(NodeType* oldParent, NodeType* oldChild, NodeType* newChild);
+  /// links all indices and expands the aabb to deal with the children
+  static uint CreateInternalNode(NodeStore& nodes, uint oldParent, uint oldChild, uint newChild);
   /// Deletes just one node in the tree. Does nothing but unlinks the children
-  /// from the node. The children must still have their parent pointers fixed.
-  static void DeleteNode(NodeType* node);
+  /// from the node. The children must still have their parent indices fixed.
+  static void DeleteNode(NodeStore& nodes, uint node);
 };
 
 /// A Hierarchical AabbTree that is meant for dynamic objects. Used to have a
@@ -40,41 +42,123 @@ public:
   typedef BaseBroadPhaseData<ClientDataType> DataType;
 
   typedef typename PolicyType::NodeType NodeType;
-  typedef Pair<NodeType*, NodeType*> NodePair;
-  typedef Array<NodeType*> NodeArray;
+  typedef DynamicTreeNodeStore<NodeType> NodeStore;
+  /// Queries traverse the tree with an explicit stack of node indices.
+  typedef uint StackEntryType;
+  typedef Pair<uint, uint> NodePair;
+  typedef Array<uint> NodeIndexArray;
   typedef Array<NodePair> NodePairArray;
 
   /// A range for iterating through the leaf nodes of the tree. Used to
   /// perform queries without having to provide a callback function.
   /// Note: this range will become completely invalidated if any operations are
   /// performed on the tree.
-  template <typename QueryType, typename ArrayType = Array<NodeType*>, typename QueryPolicyType = BroadPhasePolicy<QueryType, Aabb>>
-  struct BaseTreeRange : public BroadPhaseTreeRange<ClientDataType, NodeType, QueryType, QueryPolicyType, ArrayType>
+  template <typename QueryType, typename ArrayType = NodeIndexArray, typename QueryPolicyType = BroadPhasePolicy<QueryType, Aabb>>
+  struct BaseTreeRange
   {
-    typedef BroadPhaseTreeRange<ClientDataType, NodeType, QueryType, QueryPolicyType, ArrayType> BaseType;
-
     /// Constructs a range using the default Policy.
-    BaseTreeRange(ArrayType* scratchBuffer, NodeType* root, const QueryType& queryObj) : BaseType(scratchBuffer, root, queryObj, QueryPolicyType())
+    BaseTreeRange(ArrayType* scratchBuffer, NodeStore* nodes, uint root, const QueryType& queryObj) : mQueryObj(queryObj)
     {
+      Initialize(scratchBuffer, nodes, root);
     }
 
     /// Constructs a range using the policy type passed in.
-    BaseTreeRange(ArrayType* scratchBuffer, NodeType* root, const QueryType& queryObj, QueryPolicyType policy) : BaseType(scratchBuffer, root, queryObj, policy)
+    BaseTreeRange(ArrayType* scratchBuffer, NodeStore* nodes, uint root, const QueryType& queryObj, QueryPolicyType policy) : mQueryObj(queryObj), mPolicy(policy)
+    {
+      Initialize(scratchBuffer, nodes, root);
+    }
+
+    void PopFront()
     {
+      mScratchSpace->PopBack();
+      SkipDead();
     }
+
+    ClientDataType& Front()
+    {
+      return proxyFront().mClientData;
+    }
+
+    bool Empty() const
+    {
+      return mScratchSpace->Empty();
+    }
+
+    // temporary now so that the proxy can be retrieved
+    NodeType& proxyFront()
+    {
+      ErrorIf(mScratchSpace->Empty(), "Cannot pop an empty range.");
+      return (*mNodes)[mScratchSpace->Back()];
+    }
+
+    /// The index of the current leaf (what query callbacks are given).
+    uint nodeFront()
+    {
+      ErrorIf(mScratchSpace->Empty(), "Cannot pop an empty range.");
+      return mScratchSpace->Back();
+    }
+
+    void Initialize(ArrayType* scratchBuffer, NodeStore* nodes, uint root)
+    {
+      mNodes = nodes;
+      mScratchSpace = scratchBuffer;
+      mScratchSpace->Clear();
+      if (root != NodeStore::cNullNode)
+        mScratchSpace->PushBack(root);
+      SkipDead();
+    }
+
+    void SkipDead()
+    {
+      ArrayType& stack = *mScratchSpace;
+      while (!stack.Empty())
+      {
+        NodeType& node = (*mNodes)[stack.Back()];
+
+        // if this node doesn't overlap the query, we don't care
+        if (!mPolicy.Overlap(mQueryObj, node.mAabb))
+        {
+          stack.PopBack();
+          continue;
+        }
+
+        // if it is a leaf then return it
+        if (node.IsLeaf())
+          return;
+
+        // otherwise replace it with both of its children
+        stack.Back() = node.mChild1;
+        stack.PushBack(node.mChild2);
+      }
+    }
+
+    QueryType mQueryObj;
+    QueryPolicyType mPolicy;
+    NodeStore* mNodes;
+    ArrayType* mScratchSpace;
   };
 
   /// A range for iterating through the self pairs of this tree.
   /// Used to determine all potential overlaps within the tree itself.
   /// Note: this range will become completely invalidated if any operations are
   /// performed on the tree.
-  struct SelfQueryRange : public BroadPhaseTreeSelfRange<BaseTreeType, BoxQueryPairCheck<ClientDataType>>
+  struct SelfQueryRange
   {
-    typedef BroadPhaseTreeSelfRange<BaseTreeType, BoxQueryPairCheck<ClientDataType>> BaseType;
+    typedef Pair<ClientDataType, ClientDataType> PairType;
 
-    SelfQueryRange(NodePairArray* scratchBuffer, NodeType* root) : BaseType(scratchBuffer, root)
-    {
-    }
+    SelfQueryRange(NodePairArray* scratchBuffer, const NodeStore* nodes, uint root);
+
+    void PopFront();
+    PairType& Front();
+    NodePair& proxyFront();
+    bool Empty() const;
+
+    void SkipDead();
+
+    NodePair mNodePair;
+    PairType mPair;
+    const NodeStore* mNodes;
+    NodePairArray* mScratchSpace;
   };
 
   BaseDynamicAabbTree();
@@ -89,11 +173,13 @@ public:
   /// Returns the Node Aabb of the given proxy.
   Aabb GetFatAabb(BroadPhaseProxy& proxy);
   uint GetTotalProxyCount() const;
+  /// Returns the node with the given index (as passed to query callbacks).
+  NodeType& GetNode(uint index);
 
   void DrawEntireTree();
   void Draw(int level);
-  void DrawTree(NodeType* node);
-  void DrawLevel(NodeType* node, uint currLevel, uint level);
+  void DrawTree(uint node);
+  void DrawLevel(uint node, uint currLevel, uint level);
   /// Deletes the entire tree in one shot.
   void Clear();
 
@@ -107,15 +193,15 @@ public:
   /// the range how to collide an Aabb with a QueryType through a
   /// function called Overlap. Most implementations should just call Query
   /// which uses the policy BroadPhasePolicy<QueryType,Aabb>. A scratch buffer
-  /// array must also be provided for handling allocations. In general, one
-  /// should use the forRangeBroadphaseTreePolicy macro instead of calling this
-  /// directly.
+  /// array (of StackEntryType) must also be provided for handling allocations.
+  /// In general, one should use the forRangeBroadphaseTreePolicy macro instead
+  /// of calling this directly.
   template <typename QueryType, typename ArrayType, typename Policy>
   BaseTreeRange<QueryType, ArrayType, Policy> QueryWithPolicy(const QueryType& queryObj, ArrayType& scratchBuffer, Policy policy)
   {
-    typedef BaseTreeRange<QueryType, ArrayType> RangeType;
+    typedef BaseTreeRange<QueryType, ArrayType, Policy> RangeType;
 
-    return RangeType(&scratchBuffer, mRoot, queryObj, policy);
+    return RangeType(&scratchBuffer, &mNodes, mRoot, queryObj, policy);
   }
 
   /// The same functionality as the QueryWithPolicy function except
@@ -127,16 +213,16 @@ public:
   {
     typedef BaseTreeRange<QueryType, ArrayType> RangeType;
 
-    return RangeType(&scratchBuffer, mRoot, queryObj);
+    return RangeType(&scratchBuffer, &mNodes, mRoot, queryObj);
   }
 
   /// Callback is expected to have a method called
-  /// QueryCallback(NodeType* node1, NodeType* node2) (world space trees)
+  /// QueryCallback(uint node1, uint node2) (world space trees)
   template <typename CallbackType>
   void QuerySelfTree(CallbackType* callback);
 
   /// Callback is expected to have a method called
-  /// QueryCallback(NodeType* thisNode, NodeType* otherNode) (world space trees)
+  /// QueryCallback(uint thisNode, uint otherNode) (world space trees)
   template <typename CallbackType>
   void QueryTree(CallbackType* callback, const BaseTreeType* tree);
 
@@ -146,9 +232,10 @@ public:
 
 protected:
   /// Updates the given leaf with the passed in aabb.
-  void Update(NodeType* leafNode, Aabb& aabb);
+  void Update(uint leafNode, Aabb& aabb);
 
-  NodeType* mRoot;
+  NodeStore mNodes;
+  uint mRoot;
   uint mProxyCount;
 };
 
@@ -12,64 +12,168 @@ static const real cAabbFatScaleFactor = real(1.2);
 } // namespace BaseDynamicTreeInternal
 
 template <typename NodeType>
-typename BaseDynamicTreePolicy<NodeType>::NodeTypeDef* BaseDynamicTreePolicy<NodeType>::SelectNode(NodeType* parent, NodeType* newLeaf)
+uint BaseDynamicTreePolicy<NodeType>::SelectNode(NodeStore& nodes, uint parent, uint newLeaf)
 {
+  NodeType& parentNode = nodes[parent];
   // if there is no child 2 then we have to select child1
-  if (parent->mChild2 == nullptr)
-    return parent->mChild1;
+  if (parentNode.mChild2 == NodeStore::cNullNode)
+    return parentNode.mChild1;
 
-  Vec3 child1Pos = parent->mChild1->mAabb.GetCenter();
-  Vec3 child2Pos = parent->mChild2->mAabb.GetCenter();
-  Vec3 leafPos = newLeaf->mAabb.GetCenter();
+  Vec3 child1Pos = nodes[parentNode.mChild1].mAabb.GetCenter();
+  Vec3 child2Pos = nodes[parentNode.mChild2].mAabb.GetCenter();
+  Vec3 leafPos = nodes[newLeaf].mAabb.GetCenter();
 
   real child1Dist = (child1Pos - leafPos).LengthSq();
   real child2Dist = (child2Pos - leafPos).LengthSq();
   if (child1Dist < child2Dist)
-    return parent->mChild1;
-  return parent->mChild2;
+    return parentNode.mChild1;
+  return parentNode.mChild2;
 }
 
 template <typename NodeType>
-typename BaseDynamicTreePolicy<NodeType>::NodeTypeDef* BaseDynamicTreePolicy<NodeType>::CreateInternalNode(NodeType* oldParent, NodeType* oldChild, NodeType* newChild)
+uint BaseDynamicTreePolicy<NodeType>::CreateInternalNode(NodeStore& nodes, uint oldParent, uint oldChild, uint newChild)
 {
-  NodeType* internalNode = new NodeType();
+  // allocate before taking any references since the storage may grow
+  uint internalIndex = nodes.Allocate();
+  NodeType& internalNode = nodes[internalIndex];
 
-  // link the internal node pointers
-  internalNode->mChild1 = oldChild;
-  internalNode->mChild2 = newChild;
-  internalNode->mParent = oldParent;
+  // link the internal node indices
+  internalNode.mChild1 = oldChild;
+  internalNode.mChild2 = newChild;
+  internalNode.mParent = oldParent;
 
-  // link the children pointers
-  oldChild->mParent = internalNode;
-  newChild->mParent = internalNode;
+  // link the children indices
+  nodes[oldChild].mParent = internalIndex;
+  nodes[newChild].mParent = internalIndex;
 
-  // replace the correct child pointer for our old parent
-  if (oldParent != nullptr)
+  // replace the correct child index for our old parent
+  if (oldParent != NodeStore::cNullNode)
   {
-    if (oldParent->mChild1 == oldChild)
-      oldParent->mChild1 = internalNode;
+    NodeType& oldParentNode = nodes[oldParent];
+    if (oldParentNode.mChild1 == oldChild)
+      oldParentNode.mChild1 = internalIndex;
     else
-      oldParent->mChild2 = internalNode;
+      oldParentNode.mChild2 = internalIndex;
   }
 
   // compute the internal node's aabb
-  internalNode->mAabb = oldChild->mAabb;
-  internalNode->mAabb = internalNode->mAabb.Combined(newChild->mAabb);
+  internalNode.mAabb = nodes[oldChild].mAabb;
+  internalNode.mAabb = internalNode.mAabb.Combined(nodes[newChild].mAabb);
 
-  return internalNode;
+  return internalIndex;
 }
 
 template <typename NodeType>
-void BaseDynamicTreePolicy<NodeType>::DeleteNode(NodeType* node)
+void BaseDynamicTreePolicy<NodeType>::DeleteNode(NodeStore& nodes, uint node)
 {
-  node->mChild1 = node->mChild2 = nullptr;
-  delete node;
+  nodes.Free(node);
+}
+
+template <typename PolicyType>
+BaseDynamicAabbTree<PolicyType>::SelfQueryRange::SelfQueryRange(NodePairArray* scratchBuffer, const NodeStore* nodes, uint root)
+{
+  mNodes = nodes;
+  mScratchSpace = scratchBuffer;
+  mScratchSpace->Clear();
+
+  if (root != NodeStore::cNullNode && !(*mNodes)[root].IsLeaf())
+  {
+    NodePairArray& nodePairs = *mScratchSpace;
+    nodePairs.PushBack(MakePair((*mNodes)[root].mChild1, (*mNodes)[root].mChild2));
+
+    for (uint i = 0; i < nodePairs.Size(); ++i)
+    {
+      const NodeType& nodeA = (*mNodes)[nodePairs[i].first];
+      const NodeType& nodeB = (*mNodes)[nodePairs[i].second];
+
+      if (!nodeA.IsLeaf())
+        nodePairs.PushBack(MakePair(nodeA.mChild1, nodeA.mChild2));
+      if (!nodeB.IsLeaf())
+        nodePairs.PushBack(MakePair(nodeB.mChild1, nodeB.mChild2));
+    }
+  }
+
+  SkipDead();
+}
+
+template <typename PolicyType>
+void BaseDynamicAabbTree<PolicyType>::SelfQueryRange::PopFront()
+{
+  mScratchSpace->PopBack();
+  SkipDead();
+}
+
+template <typename PolicyType>
+typename BaseDynamicAabbTree<PolicyType>::SelfQueryRange::PairType& BaseDynamicAabbTree<PolicyType>::SelfQueryRange::Front()
+{
+  return mPair;
+}
+
+template <typename PolicyType>
+typename BaseDynamicAabbTree<PolicyType>::NodePair& BaseDynamicAabbTree<PolicyType>::SelfQueryRange::proxyFront()
+{
+  return mNodePair;
+}
+
+template <typename PolicyType>
+bool BaseDynamicAabbTree<PolicyType>::SelfQueryRange::Empty() const
+{
+  return mScratchSpace->Empty();
+}
+
+template <typename PolicyType>
+void BaseDynamicAabbTree<PolicyType>::SelfQueryRange::SkipDead()
+{
+  NodePairArray& nodePairs = *mScratchSpace;
+  while (!nodePairs.Empty())
+  {
+    mNodePair = nodePairs.Back();
+
+    uint indexA = mNodePair.first;
+    uint indexB = mNodePair.second;
+    const NodeType& nodeA = (*mNodes)[indexA];
+    const NodeType& nodeB = (*mNodes)[indexB];
+
+    // if the nodes don't overlap, we don't care
+    if (!nodeA.mAabb.Overlap(nodeB.mAabb))
+    {
+      nodePairs.PopBack();
+      continue;
+    }
+
+    if (nodeA.IsLeaf())
+    {
+      if (nodeB.IsLeaf())
+      {
+        mPair = MakePair(nodeA.mClientData, nodeB.mClientData);
+        return;
+      }
+
+      nodePairs.PopBack();
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild2));
+    }
+    else if (nodeB.IsLeaf())
+    {
+      nodePairs.PopBack();
+      nodePairs.PushBack(MakePair(nodeA.mChild1, indexB));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, indexB));
+    }
+    else
+    {
+      nodePairs.PopBack();
+      nodePairs.PushBack(MakePair(nodeA.mChild1, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(nodeA.mChild1, nodeB.mChild2));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, nodeB.mChild2));
+    }
+  }
 }
 
 template <typename PolicyType>
 BaseDynamicAabbTree<PolicyType>::BaseDynamicAabbTree()
 {
-  mRoot = nullptr;
+  mRoot = NodeStore::cNullNode;
   mProxyCount = 0;
 }
 
@@ -91,24 +195,25 @@ void BaseDynamicAabbTree<PolicyType>::CreateProxy(BroadPhaseProxy& proxy, DataTy
     aabb.AttemptToCorrectInvalid();
   }
 
-  NodeType* node = new NodeType();
-  node->mClientData = data.mClientData;
-  node->mAabb = aabb;
+  uint nodeIndex = mNodes.Allocate();
+  NodeType& node = mNodes[nodeIndex];
+  node.mClientData = data.mClientData;
+  node.mAabb = aabb;
   Vec3 halfExtents = aabb.GetHalfExtents();
   halfExtents = Math::Min(halfExtents + BaseDynamicTreeInternal::cAabbFatFactor, halfExtents * BaseDynamicTreeInternal::cAabbFatScaleFactor);
-  node->mAabb.SetCenterAndHalfExtents(aabb.GetCenter(), halfExtents);
+  node.mAabb.SetCenterAndHalfExtents(aabb.GetCenter(), halfExtents);
 
-  PolicyType::InsertNode(mRoot, node, mRoot);
-  proxy = BroadPhaseProxy(node);
+  PolicyType::InsertNode(mNodes, mRoot, nodeIndex, mRoot);
+  proxy = BroadPhaseProxy(nodeIndex);
   ++mProxyCount;
 }
 
 template <typename PolicyType>
 void BaseDynamicAabbTree<PolicyType>::RemoveProxy(BroadPhaseProxy& proxy)
 {
-  NodeType* node = static_cast<NodeType*>(proxy.ToVoidPointer());
-  PolicyType::RemoveNode(mRoot, node);
-  delete node;
+  uint nodeIndex = proxy.ToU32();
+  PolicyType::RemoveNode(mNodes, mRoot, nodeIndex);
+  mNodes.Free(nodeIndex);
   --mProxyCount;
 }
 
@@ -124,25 +229,23 @@ void BaseDynamicAabbTree<PolicyType>::UpdateProxy(BroadPhaseProxy& proxy, DataTy
     aabb.AttemptToCorrectInvalid();
   }
 
-  NodeType* node = static_cast<NodeType*>(proxy.ToVoidPointer());
+  uint nodeIndex = proxy.ToU32();
   // there could be an update where our client data changed
   // so make sure to update it (ie. a remove->Insert)
-  node->mClientData = data.mClientData;
-  Update(node, aabb);
+  mNodes[nodeIndex].mClientData = data.mClientData;
+  Update(nodeIndex, aabb);
 }
 
 template <typename PolicyType>
 typename BaseDynamicAabbTree<PolicyType>::ClientDataType& BaseDynamicAabbTree<PolicyType>::GetClientData(BroadPhaseProxy& proxy)
 {
-  NodeType* node = static_cast<NodeType*>(proxy.ToVoidPointer());
-  return node->mClientData;
+  return mNodes[proxy.ToU32()].mClientData;
 }
 
 template <typename PolicyType>
 Aabb BaseDynamicAabbTree<PolicyType>::GetFatAabb(BroadPhaseProxy& proxy)
 {
-  NodeType* node = static_cast<NodeType*>(proxy.ToVoidPointer());
-  return node->mAabb;
+  return mNodes[proxy.ToU32()].mAabb;
 }
 
 template <typename PolicyType>
@@ -151,6 +254,12 @@ uint BaseDynamicAabbTree<PolicyType>::GetTotalProxyCount() const
   return mProxyCount;
 }
 
+template <typename PolicyType>
+typename BaseDynamicAabbTree<PolicyType>::NodeType& BaseDynamicAabbTree<PolicyType>::GetNode(uint index)
+{
+  return mNodes[index];
+}
+
 template <typename PolicyType>
 void BaseDynamicAabbTree<PolicyType>::DrawEntireTree()
 {
@@ -160,7 +269,7 @@ void BaseDynamicAabbTree<PolicyType>::DrawEntireTree()
 template <typename PolicyType>
 void BaseDynamicAabbTree<PolicyType>::Draw(int level)
 {
-  if (!mRoot)
+  if (mRoot == NodeStore::cNullNode)
     return;
 
   if (level == -1)
@@ -170,75 +279,75 @@ void BaseDynamicAabbTree<PolicyType>::Draw(int level)
 }
 
 template <typename PolicyType>
-void BaseDynamicAabbTree<PolicyType>::DrawTree(NodeType* node)
+void BaseDynamicAabbTree<PolicyType>::DrawTree(uint node)
 {
-  if (!node)
+  if (node == NodeStore::cNullNode)
     return;
 
-  gDebugDraw->Add(Debug::Obb(node->mAabb).Color(Color::MintCream));
+  gDebugDraw->Add(Debug::Obb(mNodes[node].mAabb).Color(Color::MintCream));
 
-  DrawTree(node->mChild1);
-  DrawTree(node->mChild2);
+  DrawTree(mNodes[node].mChild1);
+  DrawTree(mNodes[node].mChild2);
 }
 
 template <typename PolicyType>
-void BaseDynamicAabbTree<PolicyType>::DrawLevel(NodeType* node, uint currLevel, uint level)
+void BaseDynamicAabbTree<PolicyType>::DrawLevel(uint node, uint currLevel, uint level)
 {
-  if (!node)
+  if (node == NodeStore::cNullNode)
     return;
 
   if (currLevel == level)
   {
-    gDebugDraw->Add(Debug::Obb(node->mAabb).Color(Color::MintCream));
+    gDebugDraw->Add(Debug::Obb(mNodes[node].mAabb).Color(Color::MintCream));
     return;
   }
 
-  DrawLevel(node->mChild1, currLevel + 1, level);
-  DrawLevel(node->mChild2, currLevel + 1, level);
+  DrawLevel(mNodes[node].mChild1, currLevel + 1, level);
+  DrawLevel(mNodes[node].mChild2, currLevel + 1, level);
 }
 
 template <typename PolicyType>
 void BaseDynamicAabbTree<PolicyType>::Clear()
 {
-  delete mRoot;
-  mRoot = nullptr;
+  mNodes.Clear();
+  mRoot = NodeStore::cNullNode;
   mProxyCount = 0;
 }
 
 template <typename PolicyType>
 void BaseDynamicAabbTree<PolicyType>::Validate()
 {
-  NodeArray nodes;
-  nodes.Reserve(256);
-  nodes.PushBack(mRoot);
-
-  if (mRoot == nullptr)
+  if (mRoot == NodeStore::cNullNode)
     return;
 
-  ErrorIf(mRoot->mParent != nullptr, "Root should have a null Parent.");
+  ErrorIf(mNodes[mRoot].mParent != NodeStore::cNullNode, "Root should have a null Parent.");
+
+  NodeIndexArray nodes;
+  nodes.Reserve(256);
+  nodes.PushBack(mRoot);
 
   while (!nodes.Empty())
   {
-    NodeType* node = nodes.Back();
+    NodeType& node = mNodes[nodes.Back()];
     nodes.PopBack();
 
-    if (node->IsLeaf())
+    if (node.IsLeaf())
     {
-      ErrorIf(node->mChild1 != nullptr, "Leaf should have a null Child 1 pointer.");
-      ErrorIf(node->mChild2 != nullptr, "Leaf should have a null Child 2 pointer.");
+      ErrorIf(node.mChild1 != NodeStore::cNullNode, "Leaf should have a null Child 1 index.");
+      ErrorIf(node.mChild2 != NodeStore::cNullNode, "Leaf should have a null Child 2 index.");
     }
     else
     {
-      ErrorIf(node->mChild1 == nullptr, "Child 1 of an internal node should never be null.");
-      ErrorIf(node->mChild1 == nullptr, "Child 2 of an internal node should never be null.");
+      ErrorIf(node.mChild1 == NodeStore::cNullNode, "Child 1 of an internal node should never be null.");
+      ErrorIf(node.mChild2 == NodeStore::cNullNode, "Child 2 of an internal node should never be null.");
 
-      Aabb& parent = node->mAabb;
-      Aabb& child1 = node->mChild1->mAabb;
-      Aabb& child2 = node->mChild2->mAabb;
+      Aabb& parent = node.mAabb;
+      Aabb& child1 = mNodes[node.mChild1].mAabb;
+      Aabb& child2 = mNodes[node.mChild2].mAabb;
       ErrorIf(!parent.ContainsPoint(child1.mMax) || !parent.ContainsPoint(child1.mMin), "Parent Aabb does not contain child 1.");
       ErrorIf(!parent.ContainsPoint(child2.mMax) || !parent.ContainsPoint(child2.mMin), "Parent Aabb does not contain child 2.");
-      nodes.PushBack(node->mChild1);
-      nodes.PushBack(node->mChild2);
+      nodes.PushBack(node.mChild1);
+      nodes.PushBack(node.mChild2);
     }
   }
 }
@@ -246,10 +355,10 @@ void BaseDynamicAabbTree<PolicyType>::Validate()
 template <typename PolicyType>
 bool BaseDynamicAabbTree<PolicyType>::GetRootAabb(Aabb* aabb)
 {
-  if (!mRoot)
+  if (mRoot == NodeStore::cNullNode)
     return false;
 
-  *aabb = mRoot->mAabb;
+  *aabb = mNodes[mRoot].mAabb;
   return true;
 }
 
@@ -257,45 +366,44 @@ template <typename PolicyType>
 template <typename CallbackType>
 void BaseDynamicAabbTree<PolicyType>::QuerySelfTree(CallbackType* callback)
 {
-  TreeSelfQuery(callback, mRoot);
+  TreeSelfQuery(callback, mNodes, mRoot);
 }
 
 template <typename PolicyType>
 template <typename CallbackType>
 void BaseDynamicAabbTree<PolicyType>::QueryTree(CallbackType* callback, const BaseTreeType* tree)
 {
-  QueryTreeVsTree(callback, mRoot, tree->mRoot);
+  QueryTreeVsTree(callback, mNodes, mRoot, tree->mNodes, tree->mRoot);
 }
 
 template <typename PolicyType>
 typename BaseDynamicAabbTree<PolicyType>::SelfQueryRange BaseDynamicAabbTree<PolicyType>::QuerySelf(NodePairArray& scratchBuffer)
 {
-  return SelfQueryRange(scratchBuffer, mRoot);
+  return SelfQueryRange(&scratchBuffer, &mNodes, mRoot);
 }
 
 template <typename PolicyType>
-void BaseDynamicAabbTree<PolicyType>::Update(NodeType* leafNode, Aabb& aabb)
+void BaseDynamicAabbTree<PolicyType>::Update(uint leafNode, Aabb& aabb)
 {
   // our old Aabb contained our new one, so we don't have to do anything
-  if (leafNode->mAabb.ContainsPoint(aabb.mMin) && leafNode->mAabb.ContainsPoint(aabb.mMax))
+  Aabb& leafAabb = mNodes[leafNode].mAabb;
+  if (leafAabb.ContainsPoint(aabb.mMin) && leafAabb.ContainsPoint(aabb.mMax))
     return;
 
   // remove the leaf node
-  NodeType* node = PolicyType::RemoveNode(mRoot, leafNode);
-  if (node == nullptr)
-    node = mRoot;
+  PolicyType::RemoveNode(mNodes, mRoot, leafNode);
 
   // set the new fattened aabb
   Vec3 center = aabb.GetCenter();
   Vec3 halfExtents = aabb.GetHalfExtents();
   halfExtents = Math::Min(halfExtents + BaseDynamicTreeInternal::cAabbFatFactor, halfExtents * BaseDynamicTreeInternal::cAabbFatScaleFactor);
-  leafNode->mAabb.SetCenterAndHalfExtents(center, halfExtents);
+  mNodes[leafNode].mAabb.SetCenterAndHalfExtents(center, halfExtents);
 
   // we could update at the last unaffected node, but there is no guarantee that
   // the new node is contained within that. We could iterate back up and find
   // the node to Insert from, but the speed of that is debatable. Instead,
   // just Insert from the root for now.
-  PolicyType::InsertNode(mRoot, leafNode, mRoot);
+  PolicyType::InsertNode(mNodes, mRoot, leafNode, mRoot);
 }
 
 } // namespace Raverie
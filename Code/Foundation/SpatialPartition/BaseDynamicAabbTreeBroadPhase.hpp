@@ -48,7 +48,7 @@ public:
   virtual void Cleanup(){};
 
 public:
-  void QueryCallback(void* thisProxy, void* otherProxy);
+  void QueryCallback(uint thisNode, uint otherNode);
 
 protected:
   void SingleObjectQuery();
@@ -61,16 +61,17 @@ protected:
   void AddQueryResult(Aabb& aabb);
 
   TreeType mTree;
-  /// The proxy currently being queried. Used to avoid self pairs.
-  NodeType* mQueryNode;
+  /// The node currently being queried. Used to avoid self pairs.
+  uint mQueryNode;
 
   // Temporarily Disabled: Leaks in the editor because nothing cleans up
   // mNodesToQuery
   /// The proxies that have been inserted/updated since the last query.
   /// We only need to return pairs where at least 1 object is moving.
-  // Array<NodeType*> mNodesToQuery;
+  // Array<uint> mNodesToQuery;
 
-  typedef HashSet<NodePointerPair> PairSet;
+  /// Pairs of node indices (lexicographic ids) so that duplicates are removed.
+  typedef HashSet<PairId> PairSet;
   PairSet mPairs;
 
   BaseDAabbTreeSelfQuery::Enum mSelfQueryPolicy;
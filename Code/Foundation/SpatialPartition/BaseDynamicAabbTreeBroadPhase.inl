@@ -12,6 +12,7 @@ BaseDynamicAabbTreeBroadPhase<TreeType>::BaseDynamicAabbTreeBroadPhase()
   // mNodesToQuery.SetAllocator(allocator);
   mPairs.SetAllocator(allocator);
 
+  mQueryNode = 0;
   mSelfQueryPolicy = BaseDAabbTreeSelfQuery::FullTree;
   mSingleObjectCountQuery = 20;
   mBuildTreeObjectCountQuery = static_cast<uint>(-1);
@@ -38,11 +39,10 @@ template <typename TreeType>
 void BaseDynamicAabbTreeBroadPhase<TreeType>::CreateProxy(BroadPhaseProxy& proxy, BroadPhaseData& data)
 {
   mTree.CreateProxy(proxy, data);
-  NodeType* node = static_cast<NodeType*>(proxy.ToVoidPointer());
 
   // Temporarily Disabled: Leaks in the editor because nothing cleans up
   // mNodesToQuery
-  // mNodesToQuery.PushBack(node);
+  // mNodesToQuery.PushBack(proxy.ToU32());
 }
 
 template <typename TreeType>
@@ -67,10 +67,10 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::RemoveProxy(BroadPhaseProxy& proxy
 
   // also have to see if the item was on our query array, if so
   // we have to remove it
-  // typename Array<NodeType*>::range range = mNodesToQuery.All();
+  // Array<uint>::range range = mNodesToQuery.All();
   // for(; !range.Empty(); range.PopFront())
   //{
-  //  if(range.Front() == proxy.ToVoidPointer())
+  //  if(range.Front() == proxy.ToU32())
   //  {
   //    mNodesToQuery.Erase(&range.Front());
   //    return;
@@ -92,7 +92,7 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::UpdateProxy(BroadPhaseProxy& proxy
   mTree.UpdateProxy(proxy, data);
   // Temporarily Disabled: Leaks in the editor because nothing cleans up
   // mNodesToQuery
-  // mNodesToQuery.PushBack(static_cast<NodeType*>(proxy.ToVoidPointer()));
+  // mNodesToQuery.PushBack(proxy.ToU32());
 }
 
 template <typename TreeType>
@@ -199,16 +199,16 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::RegisterCollisions()
 }
 
 template <typename TreeType>
-void BaseDynamicAabbTreeBroadPhase<TreeType>::QueryCallback(void* thisProxy, void* otherProxy)
+void BaseDynamicAabbTreeBroadPhase<TreeType>::QueryCallback(uint thisNode, uint otherNode)
 {
-  if (thisProxy == otherProxy)
+  if (thisNode == otherNode)
     return;
 
   // we need to somehow prevent duplicates, so we are using a set. However,
   // we need a unique key for our hash. So use the proxies
-  //(also the node pointers) in the pair. When we need the client data,
+  //(also the node indices) in the pair. When we need the client data,
   // we can retrieve the pair and therefore client data.
-  mPairs.Insert(NodePointerPair(thisProxy, otherProxy));
+  mPairs.Insert(GetLexicographicId(thisNode, otherNode));
 }
 
 template <typename TreeType>
@@ -217,13 +217,13 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::SingleObjectQuery()
   // Temporarily Disabled: Leaks in the editor because nothing cleans up
   // mNodesToQuery
 
-  // typename Array<NodeType*>::range range = mNodesToQuery.All();
+  // Array<uint>::range range = mNodesToQuery.All();
   // for(; !range.Empty(); range.PopFront())
   //{
   //  mQueryNode = range.Front();
-  //  AddQueryResult(mQueryNode->mAabb);
+  //  AddQueryResult(mTree.GetNode(mQueryNode).mAabb);
   //}
-  // mQueryNode = nullptr;
+  // mQueryNode = 0;
 }
 
 template <typename TreeType>
@@ -240,13 +240,13 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::PartialTreeQuery()
   // query that tree against ourselves.
   // BroadPhaseProxy proxy;
   // TreeType queryTree;
-  // typename Array<NodeType*>::range range = mNodesToQuery.All();
+  // Array<uint>::range range = mNodesToQuery.All();
   // for(; !range.Empty(); range.PopFront())
   //{
   //  mQueryNode = range.Front();
   //  BroadPhaseData data;
-  //  data.mAabb = mQueryNode->mAabb;
-  //  data.mClientData = mQueryNode->mClientData;
+  //  data.mAabb = mTree.GetNode(mQueryNode).mAabb;
+  //  data.mClientData = mTree.GetNode(mQueryNode).mClientData;
   //  queryTree.CreateProxy(proxy,data);
   //}
   //
@@ -261,14 +261,14 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::FullTreeQuery()
   // TreeType::SelfQueryRange range = mTree.QuerySelf();
   // for(; !range.Empty(); range.PopFront())
   //{
-  //  TreeType::SelfQueryRange::NodePair& pair = range.proxyFront();
+  //  typename TreeType::NodePair& pair = range.proxyFront();
 
   //  //we need to somehow prevent duplicates, so we are using a set. However,
   //  //we need a unique key for our hash. So use the proxies
-  //  //(also the node pointers) in the pair. When we need the client data,
+  //  //(also the node indices) in the pair. When we need the client data,
   //  //we can retrieve the pair and therefore client data.
 
-  //  mPairs.Insert(NodePointerPair(pair.first,pair.second));
+  //  mPairs.Insert(GetLexicographicId(pair.first,pair.second));
   //}
 }
 
@@ -281,10 +281,9 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::FillOutResults(ClientPairArray& re
   typename PairSet::range pairRange = mPairs.All();
   for (; !pairRange.Empty(); pairRange.PopFront())
   {
-    NodeType *node1, *node2;
-    NodePointerPair& pair = pairRange.Front();
-    pair.Convert(node1, node2);
-    results.PushBack(ClientPair(node1->mClientData, node2->mClientData));
+    u32 node1, node2;
+    UnPackLexicographicId(node1, node2, pairRange.Front());
+    results.PushBack(ClientPair(mTree.GetNode(node1).mClientData, mTree.GetNode(node2).mClientData));
   }
   mPairs.Clear();
 }
@@ -294,17 +293,17 @@ void BaseDynamicAabbTreeBroadPhase<TreeType>::AddQueryResult(Aabb& aabb)
 {
   forRangeBroadphaseTree(typename TreeType, mTree, Aabb, aabb)
   {
-    void* proxy1 = &range.proxyFront();
-    void* proxy2 = mQueryNode;
-    if (proxy1 == proxy2)
+    uint node1 = range.nodeFront();
+    uint node2 = mQueryNode;
+    if (node1 == node2)
       continue;
 
     // we need to somehow prevent duplicates, so we are using a set. However,
     // we need a unique key for our hash. So use the proxies
-    //(also the node pointers) in the pair. When we need the client data,
+    //(also the node indices) in the pair. When we need the client data,
     // we can retrieve the pair and therefore client data.
 
-    mPairs.Insert(NodePointerPair(proxy1, proxy2));
+    mPairs.Insert(GetLexicographicId(node1, node2));
   }
 }
 
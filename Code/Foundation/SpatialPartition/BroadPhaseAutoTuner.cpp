@@ -0,0 +1,580 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+/// Adds the time spent in a scope to a running total.
+struct AutoTunerTimeScope
+{
+  AutoTunerTimeScope(Timer& timer, double& total) : mTimer(timer), mTotal(total)
+  {
+    mStart = mTimer.UpdateAndGetTime();
+  }
+
+  ~AutoTunerTimeScope()
+  {
+    mTotal += mTimer.UpdateAndGetTime() - mStart;
+  }
+
+  Timer& mTimer;
+  double& mTotal;
+  double mStart;
+};
+
+BroadPhaseCostWindow::BroadPhaseCostWindow()
+{
+  mNext = 0;
+}
+
+void BroadPhaseCostWindow::Add(float cost, uint windowSize)
+{
+  if (mSamples.Size() < windowSize)
+  {
+    mSamples.PushBack(cost);
+    return;
+  }
+
+  mSamples[mNext] = cost;
+  mNext = (mNext + 1) % mSamples.Size();
+}
+
+void BroadPhaseCostWindow::Clear()
+{
+  mSamples.Clear();
+  mNext = 0;
+}
+
+bool BroadPhaseCostWindow::IsFull(uint windowSize) const
+{
+  return mSamples.Size() >= windowSize;
+}
+
+float BroadPhaseCostWindow::Average() const
+{
+  if (mSamples.Empty())
+    return 0.0f;
+
+  float total = 0.0f;
+  for (uint i = 0; i < mSamples.Size(); ++i)
+    total += mSamples[i];
+  return total / float(mSamples.Size());
+}
+
+BroadPhaseAutoTuner::TunedType::TunedType()
+{
+  mActiveFrameTime = 0.0;
+  mCandidate = nullptr;
+  mCandidateFrameTime = 0.0;
+  mRebuildCursor = 0;
+  mNextCandidate = 0;
+  mFramesUntilTrial = 0;
+}
+
+RaverieDefineType(BroadPhaseAutoTuner, builder, type)
+{
+}
+
+BroadPhaseAutoTuner::BroadPhaseAutoTuner()
+{
+  mWindowSize = 60;
+  mTrialInterval = 600;
+  mRebuildBatchSize = 1024;
+  mSwitchRatio = 0.8f;
+  mAbortRatio = 4.0f;
+
+  // Give the level some time to settle before the first trial
+  for (uint i = 0; i < BroadPhase::Size; ++i)
+    mTuned[i].mFramesUntilTrial = mTrialInterval;
+}
+
+BroadPhaseAutoTuner::~BroadPhaseAutoTuner()
+{
+  // The active broad phases are deleted by the package
+  for (uint i = 0; i < BroadPhase::Size; ++i)
+    delete mTuned[i].mCandidate;
+}
+
+void BroadPhaseAutoTuner::RecordFrameResults(const Array<NodePointerPair>& results)
+{
+  for (uint type = 0; type < BroadPhase::Size; ++type)
+    UpdateTuning(type);
+}
+
+void BroadPhaseAutoTuner::CreateProxy(uint type, BroadPhaseProxy& proxy, BroadPhaseData& data)
+{
+  uint index = GetNewProxyIndex(type);
+  proxy = BroadPhaseProxy(index);
+
+  ObjectEntry& entry = mObjects[type][index];
+  entry.mData = data;
+  entry.mValid = true;
+
+  TunedType& tuned = mTuned[type];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->CreateProxy(tuned.mActiveProxies[index], data);
+  }
+
+  if (InCandidate(type, index))
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->CreateProxy(tuned.mCandidateProxies[index], data);
+  }
+}
+
+void BroadPhaseAutoTuner::CreateProxies(uint type, BroadPhaseObjectArray& objects)
+{
+  // Hand out every index first since growing the proxy arrays moves them
+  for (uint i = 0; i < objects.Size(); ++i)
+  {
+    BroadPhaseObject& obj = objects[i];
+    uint index = GetNewProxyIndex(type);
+    *obj.mProxy = BroadPhaseProxy(index);
+
+    ObjectEntry& entry = mObjects[type][index];
+    entry.mData = obj.mData;
+    entry.mValid = true;
+  }
+
+  TunedType& tuned = mTuned[type];
+  BroadPhaseObjectArray internalObjects;
+  internalObjects.Reserve(objects.Size());
+  for (uint i = 0; i < objects.Size(); ++i)
+  {
+    BroadPhaseObject& obj = objects[i];
+    internalObjects.PushBack(BroadPhaseObject(&tuned.mActiveProxies[obj.mProxy->ToU32()], obj.mData));
+  }
+
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->CreateProxies(internalObjects);
+  }
+
+  if (tuned.mCandidate == nullptr)
+    return;
+
+  internalObjects.Clear();
+  for (uint i = 0; i < objects.Size(); ++i)
+  {
+    BroadPhaseObject& obj = objects[i];
+    uint index = obj.mProxy->ToU32();
+    if (InCandidate(type, index))
+      internalObjects.PushBack(BroadPhaseObject(&tuned.mCandidateProxies[index], obj.mData));
+  }
+
+  if (!internalObjects.Empty())
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->CreateProxies(internalObjects);
+  }
+}
+
+void BroadPhaseAutoTuner::RemoveProxy(uint type, BroadPhaseProxy& proxy)
+{
+  uint index = proxy.ToU32();
+  TunedType& tuned = mTuned[type];
+
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->RemoveProxy(tuned.mActiveProxies[index]);
+  }
+  tuned.mActiveProxies[index] = BroadPhaseProxy(uint(-1));
+
+  if (InCandidate(type, index))
+  {
+    {
+      AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+      tuned.mCandidate->RemoveProxy(tuned.mCandidateProxies[index]);
+    }
+    tuned.mCandidateProxies[index] = BroadPhaseProxy(uint(-1));
+  }
+
+  mObjects[type][index].mValid = false;
+  mFreeIndices[type].PushBack(index);
+}
+
+void BroadPhaseAutoTuner::RemoveProxies(uint type, ProxyHandleArray& proxies)
+{
+  TunedType& tuned = mTuned[type];
+  ProxyHandleArray internalProxies;
+  internalProxies.Reserve(proxies.Size());
+  for (uint i = 0; i < proxies.Size(); ++i)
+    internalProxies.PushBack(&tuned.mActiveProxies[proxies[i]->ToU32()]);
+
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->RemoveProxies(internalProxies);
+  }
+
+  if (tuned.mCandidate != nullptr)
+  {
+    internalProxies.Clear();
+    for (uint i = 0; i < proxies.Size(); ++i)
+    {
+      uint index = proxies[i]->ToU32();
+      if (InCandidate(type, index))
+        internalProxies.PushBack(&tuned.mCandidateProxies[index]);
+    }
+
+    if (!internalProxies.Empty())
+    {
+      AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+      tuned.mCandidate->RemoveProxies(internalProxies);
+    }
+  }
+
+  for (uint i = 0; i < proxies.Size(); ++i)
+  {
+    uint index = proxies[i]->ToU32();
+    tuned.mActiveProxies[index] = BroadPhaseProxy(uint(-1));
+    if (InCandidate(type, index))
+      tuned.mCandidateProxies[index] = BroadPhaseProxy(uint(-1));
+
+    mObjects[type][index].mValid = false;
+    mFreeIndices[type].PushBack(index);
+  }
+}
+
+void BroadPhaseAutoTuner::UpdateProxy(uint type, BroadPhaseProxy& proxy, BroadPhaseData& data)
+{
+  uint index = proxy.ToU32();
+  mObjects[type][index].mData = data;
+
+  TunedType& tuned = mTuned[type];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->UpdateProxy(tuned.mActiveProxies[index], data);
+  }
+
+  if (InCandidate(type, index))
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->UpdateProxy(tuned.mCandidateProxies[index], data);
+  }
+}
+
+void BroadPhaseAutoTuner::UpdateProxies(uint type, BroadPhaseObjectArray& objects)
+{
+  TunedType& tuned = mTuned[type];
+  BroadPhaseObjectArray internalObjects;
+  internalObjects.Reserve(objects.Size());
+  for (uint i = 0; i < objects.Size(); ++i)
+  {
+    BroadPhaseObject& obj = objects[i];
+    uint index = obj.mProxy->ToU32();
+    mObjects[type][index].mData = obj.mData;
+    internalObjects.PushBack(BroadPhaseObject(&tuned.mActiveProxies[index], obj.mData));
+  }
+
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[type]->UpdateProxies(internalObjects);
+  }
+
+  if (tuned.mCandidate == nullptr)
+    return;
+
+  internalObjects.Clear();
+  for (uint i = 0; i < objects.Size(); ++i)
+  {
+    BroadPhaseObject& obj = objects[i];
+    uint index = obj.mProxy->ToU32();
+    if (InCandidate(type, index))
+      internalObjects.PushBack(BroadPhaseObject(&tuned.mCandidateProxies[index], obj.mData));
+  }
+
+  if (!internalObjects.Empty())
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->UpdateProxies(internalObjects);
+  }
+}
+
+void BroadPhaseAutoTuner::SelfQuery(ClientPairArray& results)
+{
+  TunedType& tuned = mTuned[BroadPhase::Dynamic];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Dynamic]->SelfQuery(results);
+  }
+
+  if (IsMeasuring(BroadPhase::Dynamic))
+  {
+    mCandidateResults.Clear();
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->SelfQuery(mCandidateResults);
+  }
+}
+
+void BroadPhaseAutoTuner::Query(BroadPhaseData& data, ClientPairArray& results)
+{
+  TunedType& tuned = mTuned[BroadPhase::Static];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Static]->Query(data, results);
+  }
+
+  if (IsMeasuring(BroadPhase::Static))
+  {
+    mCandidateResults.Clear();
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->Query(data, mCandidateResults);
+  }
+}
+
+void BroadPhaseAutoTuner::BatchQuery(BroadPhaseDataArray& data, ClientPairArray& results)
+{
+  TunedType& tuned = mTuned[BroadPhase::Static];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Static]->BatchQuery(data, results);
+  }
+
+  if (IsMeasuring(BroadPhase::Static))
+  {
+    mCandidateResults.Clear();
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->BatchQuery(data, mCandidateResults);
+  }
+}
+
+void BroadPhaseAutoTuner::QueryBoth(BroadPhaseData& data, ClientPairArray& results)
+{
+  Query(data, results);
+
+  TunedType& tuned = mTuned[BroadPhase::Dynamic];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Dynamic]->Query(data, results);
+  }
+
+  if (IsMeasuring(BroadPhase::Dynamic))
+  {
+    mCandidateResults.Clear();
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->Query(data, mCandidateResults);
+  }
+}
+
+void BroadPhaseAutoTuner::Construct()
+{
+  TunedType& tuned = mTuned[BroadPhase::Static];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Static]->Construct();
+  }
+
+  if (IsMeasuring(BroadPhase::Static))
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->Construct();
+  }
+}
+
+void BroadPhaseAutoTuner::RegisterCollisions()
+{
+  TunedType& tuned = mTuned[BroadPhase::Dynamic];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    mBroadPhases[BroadPhase::Dynamic]->RegisterCollisions();
+  }
+
+  if (IsMeasuring(BroadPhase::Dynamic))
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    tuned.mCandidate->RegisterCollisions();
+  }
+}
+
+String BroadPhaseAutoTuner::GetActiveBroadPhaseName(uint type)
+{
+  return RaverieVirtualTypeId(mBroadPhases[type])->Name;
+}
+
+void BroadPhaseAutoTuner::CastIntoBroadphase(uint broadPhaseType, CastDataParam data, ProxyCastResults& results, CastFunction func)
+{
+  TunedType& tuned = mTuned[broadPhaseType];
+  {
+    AutoTunerTimeScope scope(mTimer, tuned.mActiveFrameTime);
+    (mBroadPhases[broadPhaseType]->*func)(data, results);
+  }
+
+  if (IsMeasuring(broadPhaseType))
+  {
+    ProxyCastResultArray candidateArray;
+    candidateArray.Resize(results.GetProxyCount());
+    ProxyCastResults candidateResults(candidateArray, results.Filter);
+
+    AutoTunerTimeScope scope(mTimer, tuned.mCandidateFrameTime);
+    (tuned.mCandidate->*func)(data, candidateResults);
+  }
+}
+
+uint BroadPhaseAutoTuner::GetNewProxyIndex(uint type)
+{
+  Array<uint>& freeList = mFreeIndices[type];
+  if (!freeList.Empty())
+  {
+    uint index = freeList.Back();
+    freeList.PopBack();
+    return index;
+  }
+
+  // Make room in every broad phase's proxies
+  TunedType& tuned = mTuned[type];
+  mObjects[type].PushBack();
+  tuned.mActiveProxies.PushBack(BroadPhaseProxy(uint(-1)));
+  if (tuned.mCandidate != nullptr)
+    tuned.mCandidateProxies.PushBack(BroadPhaseProxy(uint(-1)));
+  return mObjects[type].Size() - 1;
+}
+
+bool BroadPhaseAutoTuner::InCandidate(uint type, uint index)
+{
+  TunedType& tuned = mTuned[type];
+  return tuned.mCandidate != nullptr && index < tuned.mRebuildCursor;
+}
+
+bool BroadPhaseAutoTuner::IsMeasuring(uint type)
+{
+  // The candidate is only timed once it has every proxy
+  TunedType& tuned = mTuned[type];
+  return tuned.mCandidate != nullptr && tuned.mRebuildCursor == uint(-1);
+}
+
+void BroadPhaseAutoTuner::UpdateTuning(uint type)
+{
+  TunedType& tuned = mTuned[type];
+  float activeCost = float(tuned.mActiveFrameTime);
+  float candidateCost = float(tuned.mCandidateFrameTime);
+  tuned.mActiveFrameTime = 0.0;
+  tuned.mCandidateFrameTime = 0.0;
+  tuned.mActiveCost.Add(activeCost, mWindowSize);
+
+  if (tuned.mCandidate == nullptr)
+  {
+    if (tuned.mFramesUntilTrial > 0)
+      --tuned.mFramesUntilTrial;
+    else if (tuned.mActiveCost.IsFull(mWindowSize))
+      StartTrial(type);
+    return;
+  }
+
+  if (!IsMeasuring(type))
+  {
+    ContinueRebuild(type);
+    return;
+  }
+
+  // Don't keep running a broad phase that is obviously worse for this level
+  if (candidateCost > tuned.mActiveCost.Average() * mAbortRatio)
+  {
+    EndTrial(type, false);
+    return;
+  }
+
+  tuned.mCandidateCost.Add(candidateCost, mWindowSize);
+  if (!tuned.mCandidateCost.IsFull(mWindowSize))
+    return;
+
+  // The active window now covers the same frames as the candidate's
+  bool swap = tuned.mCandidateCost.Average() < tuned.mActiveCost.Average() * mSwitchRatio;
+  EndTrial(type, swap);
+}
+
+void BroadPhaseAutoTuner::StartTrial(uint type)
+{
+  TunedType& tuned = mTuned[type];
+
+  BroadPhaseLibrary* library = Z::gBroadPhaseLibrary;
+  Array<String> names;
+  library->EnumerateNamesOfType((BroadPhase::Type)type, names);
+  String activeName = GetActiveBroadPhaseName(type);
+
+  // Pick the next broad phase that isn't the active one
+  String candidateName;
+  for (uint i = 0; i < names.Size() && candidateName.Empty(); ++i)
+  {
+    uint index = (tuned.mNextCandidate + i) % names.Size();
+    if (BuildString(names[index], "BroadPhase") != activeName)
+    {
+      candidateName = names[index];
+      tuned.mNextCandidate = index + 1;
+    }
+  }
+
+  if (candidateName.Empty())
+  {
+    tuned.mFramesUntilTrial = mTrialInterval;
+    return;
+  }
+
+  tuned.mCandidate = library->CreateBroadPhase(candidateName);
+  if (tuned.mCandidate == nullptr)
+  {
+    tuned.mFramesUntilTrial = mTrialInterval;
+    return;
+  }
+
+  tuned.mCandidateProxies.Clear();
+  tuned.mCandidateProxies.Resize(mObjects[type].Size(), BroadPhaseProxy(uint(-1)));
+  tuned.mCandidateCost.Clear();
+  tuned.mRebuildCursor = 0;
+}
+
+void BroadPhaseAutoTuner::ContinueRebuild(uint type)
+{
+  TunedType& tuned = mTuned[type];
+  Array<ObjectEntry>& objects = mObjects[type];
+
+  uint start = tuned.mRebuildCursor;
+  uint end = Math::Min(start + mRebuildBatchSize, uint(objects.Size()));
+
+  BroadPhaseObjectArray batch;
+  batch.Reserve(end - start);
+  for (uint i = start; i < end; ++i)
+  {
+    if (objects[i].mValid)
+      batch.PushBack(BroadPhaseObject(&tuned.mCandidateProxies[i], objects[i].mData));
+  }
+
+  if (!batch.Empty())
+    tuned.mCandidate->CreateProxies(batch);
+
+  if (end < objects.Size())
+  {
+    tuned.mRebuildCursor = end;
+    return;
+  }
+
+  // Everything is in, any new proxies go straight into the candidate
+  tuned.mRebuildCursor = uint(-1);
+  if (type == BroadPhase::Static)
+    tuned.mCandidate->Construct();
+}
+
+void BroadPhaseAutoTuner::EndTrial(uint type, bool swap)
+{
+  TunedType& tuned = mTuned[type];
+
+  if (swap)
+  {
+    delete mBroadPhases[type];
+    mBroadPhases[type] = tuned.mCandidate;
+    tuned.mActiveProxies.Swap(tuned.mCandidateProxies);
+    tuned.mActiveCost = tuned.mCandidateCost;
+  }
+  else
+  {
+    delete tuned.mCandidate;
+  }
+
+  tuned.mCandidate = nullptr;
+  tuned.mCandidateProxies.Clear();
+  tuned.mCandidateCost.Clear();
+  tuned.mRebuildCursor = 0;
+  tuned.mFramesUntilTrial = mTrialInterval;
+}
+
+} // namespace Raverie
@@ -0,0 +1,122 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// The cost of a broad phase over the last few frames.
+class BroadPhaseCostWindow
+{
+public:
+  BroadPhaseCostWindow();
+
+  /// Adds the cost of a frame, pushing out the oldest frame once there are
+  /// windowSize frames.
+  void Add(float cost, uint windowSize);
+  void Clear();
+  bool IsFull(uint windowSize) const;
+  float Average() const;
+
+  Array<float> mSamples;
+  uint mNext;
+};
+
+/// A broad phase package that picks the cheapest broad phase for the current
+/// workload. Every so often one of the other registered broad phases is put on
+/// trial: its proxies are rebuilt a batch at a time over several frames, then
+/// it is run alongside the active broad phase for a window of frames. If it was
+/// clearly cheaper over that window it becomes the active broad phase, if not
+/// it is thrown away. Colliders only ever see proxies from this package (that
+/// index into a proxy array per broad phase) so a swap never touches them.
+class BroadPhaseAutoTuner : public BroadPhasePackage
+{
+public:
+  RaverieDeclareType(BroadPhaseAutoTuner, TypeCopyMode::ReferenceType);
+  BroadPhaseAutoTuner();
+  ~BroadPhaseAutoTuner();
+
+  /// Called once a frame, advances any trials and swaps broad phases.
+  void RecordFrameResults(const Array<NodePointerPair>& results) override;
+
+  void CreateProxy(uint type, BroadPhaseProxy& proxy, BroadPhaseData& data) override;
+  void CreateProxies(uint type, BroadPhaseObjectArray& objects) override;
+  void RemoveProxy(uint type, BroadPhaseProxy& proxy) override;
+  void RemoveProxies(uint type, ProxyHandleArray& proxies) override;
+  void UpdateProxy(uint type, BroadPhaseProxy& proxy, BroadPhaseData& data) override;
+  void UpdateProxies(uint type, BroadPhaseObjectArray& objects) override;
+
+  void SelfQuery(ClientPairArray& results) override;
+  void Query(BroadPhaseData& data, ClientPairArray& results) override;
+  void BatchQuery(BroadPhaseDataArray& data, ClientPairArray& results) override;
+  void QueryBoth(BroadPhaseData& data, ClientPairArray& results) override;
+
+  void Construct() override;
+  void RegisterCollisions() override;
+
+  /// The name of the broad phase currently in use for the given type.
+  String GetActiveBroadPhaseName(uint type);
+
+  /// How many frames costs are averaged over.
+  uint mWindowSize;
+  /// How many frames to wait between trials.
+  uint mTrialInterval;
+  /// How many proxies are inserted into a broad phase on trial each frame.
+  uint mRebuildBatchSize;
+  /// A broad phase on trial has to cost less than this fraction of the active
+  /// broad phase to replace it. Keeps two similar broad phases from thrashing.
+  float mSwitchRatio;
+  /// A trial is abandoned straight away if a single frame of the broad phase
+  /// on trial costs more than this many times the active broad phase.
+  float mAbortRatio;
+
+protected:
+  void CastIntoBroadphase(uint broadPhaseType, CastDataParam data, ProxyCastResults& results, CastFunction func) override;
+
+private:
+  /// The proxies and costs of the active broad phase of a type and the one on
+  /// trial (if any). The active broad phase itself is in mBroadPhases.
+  struct TunedType
+  {
+    TunedType();
+
+    Array<BroadPhaseProxy> mActiveProxies;
+    BroadPhaseCostWindow mActiveCost;
+    double mActiveFrameTime;
+
+    IBroadPhase* mCandidate;
+    Array<BroadPhaseProxy> mCandidateProxies;
+    BroadPhaseCostWindow mCandidateCost;
+    double mCandidateFrameTime;
+    /// Proxies with an index below this are in the candidate.
+    uint mRebuildCursor;
+    /// The next broad phase (by registered index) to put on trial.
+    uint mNextCandidate;
+    uint mFramesUntilTrial;
+  };
+
+  /// What the package knows about each proxy so a candidate can be built.
+  struct ObjectEntry
+  {
+    BroadPhaseData mData;
+    bool mValid;
+  };
+
+  uint GetNewProxyIndex(uint type);
+  bool InCandidate(uint type, uint index);
+  bool IsMeasuring(uint type);
+
+  void UpdateTuning(uint type);
+  void StartTrial(uint type);
+  void ContinueRebuild(uint type);
+  void EndTrial(uint type, bool swap);
+
+  TunedType mTuned[BroadPhase::Size];
+  Array<ObjectEntry> mObjects[BroadPhase::Size];
+  Array<uint> mFreeIndices[BroadPhase::Size];
+  Timer mTimer;
+
+  /// Results from the broad phases on trial are only used for timing.
+  ClientPairArray mCandidateResults;
+};
+
+} // namespace Raverie
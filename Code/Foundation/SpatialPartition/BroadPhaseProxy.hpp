@@ -20,6 +20,8 @@ struct BroadPhaseProxy
   }
   explicit BroadPhaseProxy(u32 proxy)
   {
+    // Clear the whole union so that a non-zero index is never a null proxy
+    mProxy = nullptr;
     mIntProxy = proxy;
   }
 
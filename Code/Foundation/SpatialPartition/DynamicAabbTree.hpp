@@ -4,34 +4,23 @@
 namespace Raverie
 {
 
-namespace Memory
-{
-class Pool;
-}
-
 /// Node used for the dynamic aabb tree. Different from the static
-/// tree node because we need a parent pointer.
+/// tree node because we need a parent index. Nodes live in the tree's
+/// contiguous node store and refer to each other by index.
 template <typename ClientDataType>
 struct DynamicTreeNode
 {
   DynamicTreeNode();
-  ~DynamicTreeNode();
-
-  static Memory::Pool* sDynamicNodePool;
-  static void* operator new(size_t size);
-  static void operator delete(void* pMem, size_t size);
 
-  bool IsLeaf();
-  // Assumes that a parent exists
-  DynamicTreeNode* GetSibling();
+  bool IsLeaf() const;
 
   Aabb mAabb;
-  ClientDataType mClientData;
-
-  DynamicTreeNode* mParent;
+  uint mChild1;
+  uint mChild2;
+  /// While the node is on the free list this is the next free node.
+  uint mParent;
 
-  DynamicTreeNode* mChild1;
-  DynamicTreeNode* mChild2;
+  ClientDataType mClientData;
 };
 
 /// Policy for the DynamicAabbTree that determines
@@ -42,14 +31,15 @@ struct DynamicTreePolicy : public BaseDynamicTreePolicy<DynamicTreeNode<ClientDa
   typedef DynamicTreeNode<ClientDataType> NodeType;
   typedef ClientDataType ClientDataTypeDef;
   typedef BaseDynamicTreePolicy<DynamicTreeNode<ClientDataType>> BaseType;
+  typedef typename BaseType::NodeStore NodeStore;
 
   /// Inserts the given leaf node at the starting node. Generally, start is
   /// the root, but when updating a node it may be somewhere in the middle
   // of the tree.
-  static void InsertNode(NodeType*& root, NodeType* leafNode, NodeType* start);
+  static void InsertNode(NodeStore& nodes, uint& root, uint leafNode, uint start);
   /// Removes the given node. Returns the last node that did not have to be
   /// resized from removal.
-  static NodeType* RemoveNode(NodeType*& root, NodeType* leafNode);
+  static uint RemoveNode(NodeStore& nodes, uint& root, uint leafNode);
 };
 
 /// A Hierarchical AabbTree that is meant for dynamic objects. Used to have a
@@ -64,6 +54,7 @@ public:
   typedef BaseDynamicAabbTree<DynamicTreePolicy<ClientDataType>> BaseType;
   typedef typename BaseType::PolicyTypeDef MyPolicyType;
 
+  using BaseType::mNodes;
   using BaseType::mRoot;
 
   DynamicAabbTree();
@@ -4,88 +4,175 @@
 namespace Raverie
 {
 
-// Callback is expected to have a method called QueryCallback (world space
-// trees)
+/// Contiguous storage for the nodes of a dynamic aabb tree. Nodes refer to each
+/// other by 32-bit index instead of by pointer so the array can grow without
+/// fixing up any links and traversal walks one block of memory. Freed nodes are
+/// threaded onto a free list (through their parent index) and reused first.
+/// Index 0 is never handed out so that it can be used as the null index (and so
+/// that a proxy to a valid node is never a null proxy).
+template <typename NodeType>
+struct DynamicTreeNodeStore
+{
+  static const uint cNullNode = 0;
+
+  DynamicTreeNodeStore();
+
+  /// Returns the index of a default constructed node. Any references to nodes
+  /// are invalidated since the storage may grow.
+  uint Allocate();
+  void Free(uint index);
+  /// Frees every node at once.
+  void Clear();
+
+  NodeType& operator[](uint index);
+  const NodeType& operator[](uint index) const;
+
+  Array<NodeType> mNodes;
+  uint mFreeList;
+};
+
+template <typename NodeType>
+DynamicTreeNodeStore<NodeType>::DynamicTreeNodeStore()
+{
+  mFreeList = cNullNode;
+}
+
+template <typename NodeType>
+uint DynamicTreeNodeStore<NodeType>::Allocate()
+{
+  if (mFreeList != cNullNode)
+  {
+    uint index = mFreeList;
+    mFreeList = mNodes[index].mParent;
+    mNodes[index] = NodeType();
+    return index;
+  }
+
+  // reserve the null node the first time anything is allocated
+  if (mNodes.Empty())
+    mNodes.PushBack(NodeType());
+
+  mNodes.PushBack(NodeType());
+  return mNodes.Size() - 1;
+}
+
+template <typename NodeType>
+void DynamicTreeNodeStore<NodeType>::Free(uint index)
+{
+  ErrorIf(index == cNullNode || index >= mNodes.Size(), "Invalid node index.");
+
+  NodeType& node = mNodes[index];
+  node.mChild1 = node.mChild2 = cNullNode;
+  node.mParent = mFreeList;
+  mFreeList = index;
+}
+
+template <typename NodeType>
+void DynamicTreeNodeStore<NodeType>::Clear()
+{
+  mNodes.Clear();
+  mFreeList = cNullNode;
+}
+
+template <typename NodeType>
+NodeType& DynamicTreeNodeStore<NodeType>::operator[](uint index)
+{
+  return mNodes[index];
+}
+
+template <typename NodeType>
+const NodeType& DynamicTreeNodeStore<NodeType>::operator[](uint index) const
+{
+  return mNodes[index];
+}
+
+// Callback is expected to have a method called
+// QueryCallback(uint nodeA, uint nodeB) (world space trees)
 template <typename CallbackType, typename NodeType>
-void TreeSelfQuery(CallbackType* callback, NodeType* root)
+void TreeSelfQuery(CallbackType* callback, const DynamicTreeNodeStore<NodeType>& nodes, uint root)
 {
-  if (root == nullptr || root->IsLeaf())
+  if (root == nodes.cNullNode || nodes[root].IsLeaf())
     return;
 
-  typedef Pair<NodeType*, NodeType*> NodePair;
+  typedef Pair<uint, uint> NodePair;
   static Array<NodePair> nodePairs;
 
   nodePairs.Reserve(256);
-  nodePairs.PushBack(MakePair(root->mChild1, root->mChild2));
+  nodePairs.PushBack(MakePair(nodes[root].mChild1, nodes[root].mChild2));
 
   for (uint i = 0; i < nodePairs.Size(); ++i)
   {
-    NodePair& pair = nodePairs[i];
-    NodeType* nodeA = pair.first;
-    NodeType* nodeB = pair.second;
-
-    if (!nodeA->IsLeaf())
-      nodePairs.PushBack(MakePair(nodeA->mChild1, nodeA->mChild2));
-    if (!nodeB->IsLeaf())
-      nodePairs.PushBack(MakePair(nodeB->mChild1, nodeB->mChild2));
+    const NodeType& nodeA = nodes[nodePairs[i].first];
+    const NodeType& nodeB = nodes[nodePairs[i].second];
+
+    if (!nodeA.IsLeaf())
+      nodePairs.PushBack(MakePair(nodeA.mChild1, nodeA.mChild2));
+    if (!nodeB.IsLeaf())
+      nodePairs.PushBack(MakePair(nodeB.mChild1, nodeB.mChild2));
   }
 
   while (!nodePairs.Empty())
   {
-    NodeType* nodeA = nodePairs.Back().first;
-    NodeType* nodeB = nodePairs.Back().second;
+    uint indexA = nodePairs.Back().first;
+    uint indexB = nodePairs.Back().second;
     nodePairs.PopBack();
 
+    const NodeType& nodeA = nodes[indexA];
+    const NodeType& nodeB = nodes[indexB];
+
     // if the nodes don't overlap, we don't care
-    if (!nodeA->mAabb.Overlap(nodeB->mAabb))
+    if (!nodeA.mAabb.Overlap(nodeB.mAabb))
       continue;
 
-    if (nodeA->IsLeaf())
+    if (nodeA.IsLeaf())
     {
-      if (nodeB->IsLeaf())
+      if (nodeB.IsLeaf())
       {
-        callback->QueryCallback(nodeA, nodeB);
+        callback->QueryCallback(indexA, indexB);
         continue;
       }
-      nodePairs.PushBack(MakePair(nodeA, nodeB->mChild1));
-      nodePairs.PushBack(MakePair(nodeA, nodeB->mChild2));
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild2));
     }
-    else if (nodeB->IsLeaf())
+    else if (nodeB.IsLeaf())
     {
-      nodePairs.PushBack(MakePair(nodeA->mChild1, nodeB));
-      nodePairs.PushBack(MakePair(nodeA->mChild2, nodeB));
+      nodePairs.PushBack(MakePair(nodeA.mChild1, indexB));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, indexB));
     }
     else
     {
-      nodePairs.PushBack(MakePair(nodeA->mChild1, nodeB->mChild1));
-      nodePairs.PushBack(MakePair(nodeA->mChild1, nodeB->mChild2));
-      nodePairs.PushBack(MakePair(nodeA->mChild2, nodeB->mChild1));
-      nodePairs.PushBack(MakePair(nodeA->mChild2, nodeB->mChild2));
+      nodePairs.PushBack(MakePair(nodeA.mChild1, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(nodeA.mChild1, nodeB.mChild2));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, nodeB.mChild2));
     }
   }
 }
 
 template <typename CallbackType, typename NodeType>
-void QueryTreeVsTree(CallbackType* callback, NodeType* rootA, NodeType* rootB)
+void QueryTreeVsTree(CallbackType* callback, const DynamicTreeNodeStore<NodeType>& nodesA, uint rootA, const DynamicTreeNodeStore<NodeType>& nodesB, uint rootB)
 {
-  if (rootA == nullptr || rootB == nullptr)
+  if (rootA == nodesA.cNullNode || rootB == nodesB.cNullNode)
     return;
 
   // not that it matters, but this is always ordered such that pair.first is
   // from this treeA and pair.second is from treeB.
-  typedef Pair<NodeType*, NodeType*> NodePair;
-  Array<NodePair> nodes;
-  nodes.Reserve(256);
-  nodes.PushBack(MakePair(rootA, rootB));
+  typedef Pair<uint, uint> NodePair;
+  Array<NodePair> nodePairs;
+  nodePairs.Reserve(256);
+  nodePairs.PushBack(MakePair(rootA, rootB));
 
-  while (!nodes.Empty())
+  while (!nodePairs.Empty())
   {
-    NodeType* nodeA = nodes.Back().first;
-    NodeType* nodeB = nodes.Back().second;
-    nodes.PopBack();
+    uint indexA = nodePairs.Back().first;
+    uint indexB = nodePairs.Back().second;
+    nodePairs.PopBack();
+
+    const NodeType& nodeA = nodesA[indexA];
+    const NodeType& nodeB = nodesB[indexB];
 
     // if the nodes don't overlap, we don't care
-    if (!nodeA->mAabb.Overlap(nodeB->mAabb))
+    if (!nodeA.mAabb.Overlap(nodeB.mAabb))
       continue;
 
     // here's the 3 cases for what to do with a node:
@@ -97,32 +184,32 @@ void QueryTreeVsTree(CallbackType* callback, NodeType* rootA, NodeType* rootB)
     // Efficient Collision Detection of Complex Deformable Models using AABB
     // Trees)
 
-    if (nodeA->IsLeaf())
+    if (nodeA.IsLeaf())
     {
-      if (nodeB->IsLeaf())
+      if (nodeB.IsLeaf())
       {
-        callback->QueryCallback(nodeA, nodeB);
+        callback->QueryCallback(indexA, indexB);
         continue;
       }
-      nodes.PushBack(MakePair(nodeA, nodeB->mChild1));
-      nodes.PushBack(MakePair(nodeA, nodeB->mChild2));
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild1));
+      nodePairs.PushBack(MakePair(indexA, nodeB.mChild2));
     }
-    else if (nodeB->IsLeaf())
+    else if (nodeB.IsLeaf())
     {
-      nodes.PushBack(MakePair(nodeA->mChild1, nodeB));
-      nodes.PushBack(MakePair(nodeA->mChild2, nodeB));
+      nodePairs.PushBack(MakePair(nodeA.mChild1, indexB));
+      nodePairs.PushBack(MakePair(nodeA.mChild2, indexB));
     }
     else
     {
-      if (nodeA->mAabb.GetVolume() > nodeB->mAabb.GetVolume())
+      if (nodeA.mAabb.GetVolume() > nodeB.mAabb.GetVolume())
       {
-        nodes.PushBack(MakePair(nodeA->mChild1, nodeB));
-        nodes.PushBack(MakePair(nodeA->mChild2, nodeB));
+        nodePairs.PushBack(MakePair(nodeA.mChild1, indexB));
+        nodePairs.PushBack(MakePair(nodeA.mChild2, indexB));
       }
       else
       {
-        nodes.PushBack(MakePair(nodeA, nodeB->mChild1));
-        nodes.PushBack(MakePair(nodeA, nodeB->mChild2));
+        nodePairs.PushBack(MakePair(indexA, nodeB.mChild1));
+        nodePairs.PushBack(MakePair(indexA, nodeB.mChild2));
       }
     }
   }
@@ -0,0 +1,173 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// An object stored in the HierarchicalGrid. The level and cell are cached
+/// when the object is inserted or updated so the grid can be rebuilt by
+/// sorting on the cell key alone.
+template <typename ClientDataType>
+struct HierarchicalGridObject
+{
+  typedef BaseBroadPhaseData<ClientDataType> DataType;
+
+  DataType mData;
+  /// Level, then cell coordinates packed so that all the objects of a level
+  /// (and of a cell within a level) are contiguous once sorted.
+  u64 mCellKey;
+  int mCell[3];
+  uint mLevel;
+  bool mValid;
+};
+
+/// A multi-level uniform grid. Each level doubles the cell size of the level
+/// below it and every object is stored once, in the cell of the smallest level
+/// that is at least as big as the object, keyed by the cell containing the
+/// object's min corner. An object can then only overlap objects whose min
+/// corner is in a neighboring cell, so queries only visit a handful of cells
+/// per level and the cost scales linearly with the number of objects (as long
+/// as objects are not all piled into a few cells). Cells are found by hashing
+/// the packed cell key. Objects too big for the top level are kept aside and
+/// tested against everything. Adds, updates and removes are deferred until the
+/// next query, at which point the grid is rebuilt with a radix sort.
+template <typename ClientDataType>
+class HierarchicalGrid
+{
+public:
+  typedef BaseBroadPhaseData<ClientDataType> DataType;
+  typedef HierarchicalGridObject<ClientDataType> ObjectType;
+  typedef Array<ObjectType> ObjectArray;
+
+  /// The number of levels, the top level's cells are 2^(cLevelCount - 1)
+  /// times larger than the base cell size.
+  static const uint cLevelCount = 8;
+  /// Objects too big for every level are given this level.
+  static const uint cOversizedLevel = cLevelCount;
+  /// Cell coordinates are stored in 20 bits per axis, coordinates past
+  /// +/- cCellRange are clamped to the edge of the grid.
+  static const int cCellBits = 20;
+  static const int cCellRange = 1 << (cCellBits - 1);
+
+  HierarchicalGrid();
+  ~HierarchicalGrid();
+
+  void Serialize(Serializer& stream);
+
+  /// Inserts the given data and fills out the proxy for future operations on
+  /// data.
+  void CreateProxy(BroadPhaseProxy& proxy, DataType& data);
+  /// Removes the object that the given proxy points to.
+  void RemoveProxy(BroadPhaseProxy& proxy);
+  /// Updates the data that the proxy points to with the new data.
+  void UpdateProxy(BroadPhaseProxy& proxy, DataType& data);
+
+  /// Sets the size of the cells on the lowest level. This should be about the
+  /// size of the most common (smallest) objects. Re-buckets every object.
+  void SetCellSize(real cellSize);
+  real GetCellSize() const;
+
+  /// Sorts the objects into their cells if anything has changed since the
+  /// last rebuild. Queries call this automatically.
+  void Rebuild();
+
+  /// Calls callback->QueryCallback(clientDataA, clientDataB) once for every
+  /// pair of objects whose aabbs overlap.
+  template <typename CallbackType>
+  void SelfQuery(CallbackType* callback);
+
+  /// Calls callback->QueryCallback(clientData) for every object whose aabb
+  /// overlaps the query object according to the policy. The policy determines
+  /// if the queryObj and an Aabb overlap through a function called Overlap.
+  template <typename QueryType, typename Policy, typename CallbackType>
+  void QueryWithPolicy(const QueryType& queryObj, Policy policy, CallbackType* callback);
+
+  /// The same as QueryWithPolicy with the policy defaulted to
+  /// BroadPhasePolicy<QueryType, Aabb>.
+  template <typename QueryType, typename CallbackType>
+  void Query(const QueryType& queryObj, CallbackType* callback);
+
+private:
+  uint GetNewProxyIndex();
+  /// Computes the level, cell and cell key of an object from its aabb.
+  void PlaceObject(ObjectType& object);
+  uint GetLevel(const Aabb& aabb) const;
+  void GetCellCoordinates(Vec3Param point, uint level, int* coordinates) const;
+  static u64 GetCellKey(uint level, int x, int y, int z);
+
+  /// The cells of a level that could contain an object overlapping the
+  /// region. Returns false if the level is too big to be worth walking cell by
+  /// cell, in which case all of the level's objects should be tested.
+  bool GetCellRange(const Aabb& region, uint level, int* cellMin, int* cellMax) const;
+
+  /// The region of cells a query has to look at. Query types without a
+  /// bounding volume look at everything.
+  Aabb GetQueryRegion(const Aabb& aabb) const;
+  Aabb GetQueryRegion(const Sphere& sphere) const;
+  Aabb GetQueryRegion(const Frustum& frustum) const;
+  template <typename QueryType>
+  Aabb GetQueryRegion(const QueryType& queryObj) const;
+
+  /// Rays and segments walk the cells along their line instead of a region.
+  /// The line is start + direction * t for t in [0, tMax]. Returns false for
+  /// every other query type.
+  static bool GetQueryLine(const Ray& ray, Vec3& start, Vec3& direction, real& tMax);
+  static bool GetQueryLine(const Segment& segment, Vec3& start, Vec3& direction, real& tMax);
+  template <typename QueryType>
+  static bool GetQueryLine(const QueryType& queryObj, Vec3& start, Vec3& direction, real& tMax);
+  /// Clips a line to the bounds of the grid. Returns false if it misses them.
+  bool ClipLine(Vec3Param start, Vec3Param direction, real tMax, Vec3& clippedStart, Vec3& clippedEnd) const;
+
+  /// Queries the objects of a level that could overlap the line from start to
+  /// end by walking the cells it passes through (a 3d DDA).
+  template <typename QueryType, typename Policy, typename CallbackType>
+  void QueryLevelAlongLine(uint level, Vec3Param start, Vec3Param end, QueryType& query, Policy& policy, CallbackType* callback);
+  /// Queries every object of a level without looking at cells.
+  template <typename QueryType, typename Policy, typename CallbackType>
+  void QueryLevel(uint level, QueryType& query, Policy& policy, CallbackType* callback);
+  /// Queries the objects in one cell (if the coordinates are in the grid).
+  template <typename QueryType, typename Policy, typename CallbackType>
+  void QueryCell(uint level, int x, int y, int z, QueryType& query, Policy& policy, CallbackType* callback);
+
+  /// A contiguous run of sorted objects that share a cell.
+  struct CellRange
+  {
+    CellRange()
+    {
+    }
+    CellRange(uint start, uint count) : mStart(start), mCount(count)
+    {
+    }
+
+    uint mStart;
+    uint mCount;
+  };
+  typedef HashMap<u64, CellRange> CellMap;
+
+  /// Tests an object against every object in a cell.
+  template <typename CallbackType>
+  void TestCell(ObjectType& object, u64 cellKey, CallbackType* callback);
+  template <typename CallbackType>
+  void TestPair(ObjectType& objectA, ObjectType& objectB, CallbackType* callback);
+
+  ObjectArray mObjects;
+  Array<uint> mFreeIndices;
+
+  real mCellSize;
+  real mLevelCellSizes[cLevelCount];
+
+  /// Object indices sorted by cell key. The objects of level i are in
+  /// [mLevelStart[i], mLevelStart[i + 1]).
+  Array<uint> mSortedObjects;
+  Array<uint> mSortScratch;
+  uint mLevelStart[cLevelCount + 1];
+  Array<uint> mOversizedObjects;
+  CellMap mCells;
+  /// The bounds of every object in the grid as of the last rebuild.
+  Aabb mBounds;
+  bool mDirty;
+};
+
+} // namespace Raverie
+
+#include "Foundation/SpatialPartition/HierarchicalGrid.inl"
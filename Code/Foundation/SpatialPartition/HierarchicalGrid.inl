@@ -0,0 +1,597 @@
+// MIT Licensed (see LICENSE.md).
+
+namespace Raverie
+{
+
+template <typename ClientDataType>
+HierarchicalGrid<ClientDataType>::HierarchicalGrid()
+{
+  mDirty = false;
+  mBounds.SetInvalid();
+  for (uint i = 0; i <= cLevelCount; ++i)
+    mLevelStart[i] = 0;
+  SetCellSize(real(1.0));
+}
+
+template <typename ClientDataType>
+HierarchicalGrid<ClientDataType>::~HierarchicalGrid()
+{
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::Serialize(Serializer& stream)
+{
+  SerializeNameDefault(mCellSize, real(1.0));
+  if (stream.GetMode() == SerializerMode::Loading)
+    SetCellSize(mCellSize);
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::CreateProxy(BroadPhaseProxy& proxy, DataType& data)
+{
+  uint index = GetNewProxyIndex();
+  ObjectType& object = mObjects[index];
+  object.mData = data;
+  object.mValid = true;
+  PlaceObject(object);
+  mDirty = true;
+  proxy = BroadPhaseProxy((u32)index);
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::RemoveProxy(BroadPhaseProxy& proxy)
+{
+  uint index = proxy.ToU32();
+  ErrorIf(mObjects[index].mValid == false, "Removing an invalid proxy.");
+  mObjects[index].mValid = false;
+  mFreeIndices.PushBack(index);
+  mDirty = true;
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::UpdateProxy(BroadPhaseProxy& proxy, DataType& data)
+{
+  uint index = proxy.ToU32();
+  ObjectType& object = mObjects[index];
+  ErrorIf(object.mValid == false, "Updating an invalid proxy.");
+  object.mData = data;
+  PlaceObject(object);
+  mDirty = true;
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::SetCellSize(real cellSize)
+{
+  ErrorIf(cellSize <= real(0.0), "The cell size must be positive.");
+  mCellSize = cellSize;
+  for (uint i = 0; i < cLevelCount; ++i)
+    mLevelCellSizes[i] = cellSize * real(1 << i);
+
+  // every object has to be re-bucketed with the new sizes
+  for (uint i = 0; i < mObjects.Size(); ++i)
+  {
+    if (mObjects[i].mValid)
+      PlaceObject(mObjects[i]);
+  }
+  mDirty = true;
+}
+
+template <typename ClientDataType>
+real HierarchicalGrid<ClientDataType>::GetCellSize() const
+{
+  return mCellSize;
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::Rebuild()
+{
+  if (!mDirty)
+    return;
+  mDirty = false;
+
+  mSortedObjects.Clear();
+  mOversizedObjects.Clear();
+  mBounds.SetInvalid();
+  for (uint i = 0; i < mObjects.Size(); ++i)
+  {
+    ObjectType& object = mObjects[i];
+    if (!object.mValid)
+      continue;
+
+    mBounds.Combine(object.mData.mAabb);
+    if (object.mLevel == cOversizedLevel)
+      mOversizedObjects.PushBack(i);
+    else
+      mSortedObjects.PushBack(i);
+  }
+
+  // the level is the top of the key so this groups objects by level and then
+  // by cell within each level
+  ObjectArray& objects = mObjects;
+  mSortScratch.Resize(mSortedObjects.Size());
+  RadixSort(mSortedObjects.All(), mSortScratch.Data(), [&objects](uint index) { return objects[index].mCellKey; });
+
+  uint size = mSortedObjects.Size();
+  uint level = 0;
+  mLevelStart[0] = 0;
+  for (uint i = 0; i < size; ++i)
+  {
+    uint objectLevel = mObjects[mSortedObjects[i]].mLevel;
+    while (level < objectLevel)
+      mLevelStart[++level] = i;
+  }
+  while (level < cLevelCount)
+    mLevelStart[++level] = size;
+
+  // record where each cell's run of objects starts
+  mCells.Clear();
+  uint runStart = 0;
+  for (uint i = 1; i <= size; ++i)
+  {
+    u64 runKey = mObjects[mSortedObjects[runStart]].mCellKey;
+    if (i == size || mObjects[mSortedObjects[i]].mCellKey != runKey)
+    {
+      mCells.Insert(runKey, CellRange(runStart, i - runStart));
+      runStart = i;
+    }
+  }
+}
+
+template <typename ClientDataType>
+template <typename CallbackType>
+void HierarchicalGrid<ClientDataType>::SelfQuery(CallbackType* callback)
+{
+  Rebuild();
+
+  uint size = mSortedObjects.Size();
+  for (uint level = 0; level < cLevelCount; ++level)
+  {
+    for (uint i = mLevelStart[level]; i < mLevelStart[level + 1]; ++i)
+    {
+      ObjectType& object = mObjects[mSortedObjects[i]];
+
+      // the rest of the objects in our own cell
+      for (uint j = i + 1; j < size; ++j)
+      {
+        ObjectType& other = mObjects[mSortedObjects[j]];
+        if (other.mCellKey != object.mCellKey)
+          break;
+        TestPair(object, other, callback);
+      }
+
+      // objects on the same level can only overlap us if their min corner is
+      // in one of the neighboring cells. Each pair of neighboring cells is
+      // only checked from one side (the half of the neighbors that come
+      // after us) so a pair is never reported twice.
+      for (int z = -1; z <= 1; ++z)
+      {
+        for (int y = -1; y <= 1; ++y)
+        {
+          for (int x = -1; x <= 1; ++x)
+          {
+            int forward = z != 0 ? z : (y != 0 ? y : x);
+            if (forward <= 0)
+              continue;
+
+            int cell[3] = {object.mCell[0] + x, object.mCell[1] + y, object.mCell[2] + z};
+            if (cell[0] < -cCellRange || cell[0] >= cCellRange || cell[1] < -cCellRange || cell[1] >= cCellRange || cell[2] < -cCellRange ||
+                cell[2] >= cCellRange)
+              continue;
+
+            TestCell(object, GetCellKey(level, cell[0], cell[1], cell[2]), callback);
+          }
+        }
+      }
+
+      // pairs across levels are always found from the smaller object
+      for (uint otherLevel = level + 1; otherLevel < cLevelCount; ++otherLevel)
+      {
+        uint levelStart = mLevelStart[otherLevel];
+        uint levelEnd = mLevelStart[otherLevel + 1];
+        if (levelStart == levelEnd)
+          continue;
+
+        int cellMin[3], cellMax[3];
+        if (GetCellRange(object.mData.mAabb, otherLevel, cellMin, cellMax))
+        {
+          for (int z = cellMin[2]; z <= cellMax[2]; ++z)
+          {
+            for (int y = cellMin[1]; y <= cellMax[1]; ++y)
+            {
+              for (int x = cellMin[0]; x <= cellMax[0]; ++x)
+                TestCell(object, GetCellKey(otherLevel, x, y, z), callback);
+            }
+          }
+        }
+        else
+        {
+          for (uint j = levelStart; j < levelEnd; ++j)
+            TestPair(object, mObjects[mSortedObjects[j]], callback);
+        }
+      }
+    }
+  }
+
+  // the oversized objects have to be checked against everything
+  for (uint i = 0; i < mOversizedObjects.Size(); ++i)
+  {
+    ObjectType& object = mObjects[mOversizedObjects[i]];
+    for (uint j = 0; j < size; ++j)
+      TestPair(object, mObjects[mSortedObjects[j]], callback);
+    for (uint j = i + 1; j < mOversizedObjects.Size(); ++j)
+      TestPair(object, mObjects[mOversizedObjects[j]], callback);
+  }
+}
+
+template <typename ClientDataType>
+template <typename QueryType, typename Policy, typename CallbackType>
+void HierarchicalGrid<ClientDataType>::QueryWithPolicy(const QueryType& queryObj, Policy policy, CallbackType* callback)
+{
+  Rebuild();
+
+  QueryType query = queryObj;
+  Vec3 lineStart, lineDirection;
+  real lineLength;
+  if (GetQueryLine(queryObj, lineStart, lineDirection, lineLength))
+  {
+    // only the part of the line inside the grid can hit anything
+    Vec3 start, end;
+    if (!ClipLine(lineStart, lineDirection, lineLength, start, end))
+      return;
+
+    for (uint level = 0; level < cLevelCount; ++level)
+      QueryLevelAlongLine(level, start, end, query, policy, callback);
+  }
+  else
+  {
+    Aabb region = GetQueryRegion(queryObj);
+    if (!region.Overlap(mBounds))
+      return;
+
+    for (uint level = 0; level < cLevelCount; ++level)
+    {
+      if (mLevelStart[level] == mLevelStart[level + 1])
+        continue;
+
+      int cellMin[3], cellMax[3];
+      if (!GetCellRange(region, level, cellMin, cellMax))
+      {
+        QueryLevel(level, query, policy, callback);
+        continue;
+      }
+
+      for (int z = cellMin[2]; z <= cellMax[2]; ++z)
+      {
+        for (int y = cellMin[1]; y <= cellMax[1]; ++y)
+        {
+          for (int x = cellMin[0]; x <= cellMax[0]; ++x)
+            QueryCell(level, x, y, z, query, policy, callback);
+        }
+      }
+    }
+  }
+
+  for (uint i = 0; i < mOversizedObjects.Size(); ++i)
+  {
+    ObjectType& object = mObjects[mOversizedObjects[i]];
+    if (policy.Overlap(query, object.mData.mAabb))
+      callback->QueryCallback(object.mData.mClientData);
+  }
+}
+
+template <typename ClientDataType>
+template <typename QueryType, typename CallbackType>
+void HierarchicalGrid<ClientDataType>::Query(const QueryType& queryObj, CallbackType* callback)
+{
+  BroadPhasePolicy<QueryType, Aabb> policy;
+  QueryWithPolicy(queryObj, policy, callback);
+}
+
+template <typename ClientDataType>
+uint HierarchicalGrid<ClientDataType>::GetNewProxyIndex()
+{
+  if (mFreeIndices.Empty())
+  {
+    mObjects.PushBack();
+    return mObjects.Size() - 1;
+  }
+
+  uint index = mFreeIndices.Back();
+  mFreeIndices.PopBack();
+  return index;
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::PlaceObject(ObjectType& object)
+{
+  object.mLevel = GetLevel(object.mData.mAabb);
+  if (object.mLevel == cOversizedLevel)
+  {
+    object.mCell[0] = object.mCell[1] = object.mCell[2] = 0;
+    object.mCellKey = 0;
+    return;
+  }
+
+  GetCellCoordinates(object.mData.mAabb.mMin, object.mLevel, object.mCell);
+  object.mCellKey = GetCellKey(object.mLevel, object.mCell[0], object.mCell[1], object.mCell[2]);
+}
+
+template <typename ClientDataType>
+uint HierarchicalGrid<ClientDataType>::GetLevel(const Aabb& aabb) const
+{
+  Vec3 extents = aabb.mMax - aabb.mMin;
+  real size = Math::Max(extents.x, Math::Max(extents.y, extents.z));
+  for (uint i = 0; i < cLevelCount; ++i)
+  {
+    if (size <= mLevelCellSizes[i])
+      return i;
+  }
+  return cOversizedLevel;
+}
+
+template <typename ClientDataType>
+void HierarchicalGrid<ClientDataType>::GetCellCoordinates(Vec3Param point, uint level, int* coordinates) const
+{
+  real cellSize = mLevelCellSizes[level];
+  real minCell = real(-cCellRange);
+  real maxCell = real(cCellRange - 1);
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    real cell = Math::Floor(point[axis] / cellSize);
+    coordinates[axis] = (int)Math::Clamp(cell, minCell, maxCell);
+  }
+}
+
+template <typename ClientDataType>
+u64 HierarchicalGrid<ClientDataType>::GetCellKey(uint level, int x, int y, int z)
+{
+  u64 key = u64(level) << (3 * cCellBits);
+  key |= u64(x + cCellRange) << (2 * cCellBits);
+  key |= u64(y + cCellRange) << cCellBits;
+  key |= u64(z + cCellRange);
+  return key;
+}
+
+template <typename ClientDataType>
+bool HierarchicalGrid<ClientDataType>::GetCellRange(const Aabb& region, uint level, int* cellMin, int* cellMax) const
+{
+  GetCellCoordinates(region.mMin, level, cellMin);
+  GetCellCoordinates(region.mMax, level, cellMax);
+
+  // objects are keyed by their min corner and are no bigger than a cell, so an
+  // object in the cell before the region can still reach into it
+  int minCell = -cCellRange;
+  u64 cellCount = 1;
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    cellMin[axis] = Math::Max(cellMin[axis] - 1, minCell);
+    cellCount *= u64(cellMax[axis] - cellMin[axis] + 1);
+  }
+
+  // past this point it's cheaper to just test every object on the level
+  uint objectCount = mLevelStart[level + 1] - mLevelStart[level];
+  return cellCount <= u64(objectCount);
+}
+
+template <typename ClientDataType>
+Aabb HierarchicalGrid<ClientDataType>::GetQueryRegion(const Aabb& aabb) const
+{
+  return aabb;
+}
+
+template <typename ClientDataType>
+Aabb HierarchicalGrid<ClientDataType>::GetQueryRegion(const Sphere& sphere) const
+{
+  return ToAabb(sphere);
+}
+
+template <typename ClientDataType>
+Aabb HierarchicalGrid<ClientDataType>::GetQueryRegion(const Frustum& frustum) const
+{
+  return frustum.GetAabb();
+}
+
+template <typename ClientDataType>
+template <typename QueryType>
+Aabb HierarchicalGrid<ClientDataType>::GetQueryRegion(const QueryType& queryObj) const
+{
+  return mBounds;
+}
+
+template <typename ClientDataType>
+bool HierarchicalGrid<ClientDataType>::GetQueryLine(const Ray& ray, Vec3& start, Vec3& direction, real& tMax)
+{
+  start = ray.Start;
+  direction = ray.Direction;
+  tMax = Math::PositiveMax();
+  return true;
+}
+
+template <typename ClientDataType>
+bool HierarchicalGrid<ClientDataType>::GetQueryLine(const Segment& segment, Vec3& start, Vec3& direction, real& tMax)
+{
+  start = segment.Start;
+  direction = segment.End - segment.Start;
+  tMax = real(1.0);
+  return true;
+}
+
+template <typename ClientDataType>
+template <typename QueryType>
+bool HierarchicalGrid<ClientDataType>::GetQueryLine(const QueryType& queryObj, Vec3& start, Vec3& direction, real& tMax)
+{
+  return false;
+}
+
+template <typename ClientDataType>
+bool HierarchicalGrid<ClientDataType>::ClipLine(Vec3Param start, Vec3Param direction, real tMax, Vec3& clippedStart, Vec3& clippedEnd) const
+{
+  if (!mBounds.Valid())
+    return false;
+
+  // slab test against each axis of the bounds
+  real tMin = real(0.0);
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    if (direction[axis] == real(0.0))
+    {
+      if (start[axis] < mBounds.mMin[axis] || start[axis] > mBounds.mMax[axis])
+        return false;
+      continue;
+    }
+
+    real t0 = (mBounds.mMin[axis] - start[axis]) / direction[axis];
+    real t1 = (mBounds.mMax[axis] - start[axis]) / direction[axis];
+    tMin = Math::Max(tMin, Math::Min(t0, t1));
+    tMax = Math::Min(tMax, Math::Max(t0, t1));
+    if (tMin > tMax)
+      return false;
+  }
+
+  clippedStart = start + direction * tMin;
+  clippedEnd = start + direction * tMax;
+  return true;
+}
+
+template <typename ClientDataType>
+template <typename QueryType, typename Policy, typename CallbackType>
+void HierarchicalGrid<ClientDataType>::QueryLevelAlongLine(uint level, Vec3Param start, Vec3Param end, QueryType& query, Policy& policy, CallbackType* callback)
+{
+  uint objectCount = mLevelStart[level + 1] - mLevelStart[level];
+  if (objectCount == 0)
+    return;
+
+  int cell[3], endCell[3];
+  GetCellCoordinates(start, level, cell);
+  GetCellCoordinates(end, level, endCell);
+
+  // set up the walk, t goes from 0 at the start to 1 at the end
+  Vec3 delta = end - start;
+  real cellSize = mLevelCellSizes[level];
+  int step[3];
+  int stepsLeft[3];
+  real tNext[3];
+  real tDelta[3];
+  uint stepCount = 0;
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    step[axis] = endCell[axis] >= cell[axis] ? 1 : -1;
+    stepsLeft[axis] = Math::Abs(endCell[axis] - cell[axis]);
+    stepCount += uint(stepsLeft[axis]);
+    if (stepsLeft[axis] == 0)
+    {
+      tNext[axis] = Math::PositiveMax();
+      tDelta[axis] = Math::PositiveMax();
+      continue;
+    }
+
+    real boundary = real(cell[axis] + (step[axis] > 0 ? 1 : 0)) * cellSize;
+    tNext[axis] = (boundary - start[axis]) / delta[axis];
+    tDelta[axis] = cellSize / Math::Abs(delta[axis]);
+  }
+
+  // objects are keyed by their min corner and are no bigger than a cell, so
+  // anything touching a cell has its key in that cell or the one before it on
+  // each axis. The first cell needs all 8 of those, every step after only adds
+  // the 4 on the new layer. Past the point where that's more cells than there
+  // are objects it's cheaper to just test every object on the level.
+  if (8 + 4 * u64(stepCount) > u64(objectCount))
+  {
+    QueryLevel(level, query, policy, callback);
+    return;
+  }
+
+  for (int z = -1; z <= 0; ++z)
+  {
+    for (int y = -1; y <= 0; ++y)
+    {
+      for (int x = -1; x <= 0; ++x)
+        QueryCell(level, cell[0] + x, cell[1] + y, cell[2] + z, query, policy, callback);
+    }
+  }
+
+  for (uint i = 0; i < stepCount; ++i)
+  {
+    // step along whichever axis reaches its next cell boundary first (only
+    // axes that haven't reached the end cell yet, so the walk always ends
+    // exactly in the end cell)
+    uint axis = 3;
+    for (uint a = 0; a < 3; ++a)
+    {
+      if (stepsLeft[a] != 0 && (axis == 3 || tNext[a] < tNext[axis]))
+        axis = a;
+    }
+
+    cell[axis] += step[axis];
+    tNext[axis] += tDelta[axis];
+    --stepsLeft[axis];
+
+    // the layer of cells that wasn't covered by the previous cell
+    int coordinates[3];
+    coordinates[axis] = step[axis] > 0 ? cell[axis] : cell[axis] - 1;
+    uint axisU = (axis + 1) % 3;
+    uint axisV = (axis + 2) % 3;
+    for (int v = -1; v <= 0; ++v)
+    {
+      for (int u = -1; u <= 0; ++u)
+      {
+        coordinates[axisU] = cell[axisU] + u;
+        coordinates[axisV] = cell[axisV] + v;
+        QueryCell(level, coordinates[0], coordinates[1], coordinates[2], query, policy, callback);
+      }
+    }
+  }
+}
+
+template <typename ClientDataType>
+template <typename QueryType, typename Policy, typename CallbackType>
+void HierarchicalGrid<ClientDataType>::QueryLevel(uint level, QueryType& query, Policy& policy, CallbackType* callback)
+{
+  for (uint i = mLevelStart[level]; i < mLevelStart[level + 1]; ++i)
+  {
+    ObjectType& object = mObjects[mSortedObjects[i]];
+    if (policy.Overlap(query, object.mData.mAabb))
+      callback->QueryCallback(object.mData.mClientData);
+  }
+}
+
+template <typename ClientDataType>
+template <typename QueryType, typename Policy, typename CallbackType>
+void HierarchicalGrid<ClientDataType>::QueryCell(uint level, int x, int y, int z, QueryType& query, Policy& policy, CallbackType* callback)
+{
+  if (x < -cCellRange || x >= cCellRange || y < -cCellRange || y >= cCellRange || z < -cCellRange || z >= cCellRange)
+    return;
+
+  CellRange* cell = mCells.FindPointer(GetCellKey(level, x, y, z));
+  if (cell == nullptr)
+    return;
+
+  for (uint i = cell->mStart; i < cell->mStart + cell->mCount; ++i)
+  {
+    ObjectType& object = mObjects[mSortedObjects[i]];
+    if (policy.Overlap(query, object.mData.mAabb))
+      callback->QueryCallback(object.mData.mClientData);
+  }
+}
+
+template <typename ClientDataType>
+template <typename CallbackType>
+void HierarchicalGrid<ClientDataType>::TestCell(ObjectType& object, u64 cellKey, CallbackType* callback)
+{
+  CellRange* cell = mCells.FindPointer(cellKey);
+  if (cell == nullptr)
+    return;
+
+  for (uint i = cell->mStart; i < cell->mStart + cell->mCount; ++i)
+    TestPair(object, mObjects[mSortedObjects[i]], callback);
+}
+
+template <typename ClientDataType>
+template <typename CallbackType>
+void HierarchicalGrid<ClientDataType>::TestPair(ObjectType& objectA, ObjectType& objectB, CallbackType* callback)
+{
+  if (objectA.mData.mAabb.Overlap(objectB.mData.mAabb))
+    callback->QueryCallback(objectA.mData.mClientData, objectB.mData.mClientData);
+}
+
+} // namespace Raverie
@@ -0,0 +1,183 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+/// Collects the self query pairs of the grid.
+struct HierarchicalGridPairCallback
+{
+  HierarchicalGridPairCallback(ClientPairArray* results) : mResults(results)
+  {
+  }
+
+  void QueryCallback(void* clientDataA, void* clientDataB)
+  {
+    mResults->PushBack(ClientPair(clientDataA, clientDataB));
+  }
+
+  ClientPairArray* mResults;
+};
+
+/// Pairs every object found by a query with the data that was queried.
+struct HierarchicalGridQueryCallback
+{
+  HierarchicalGridQueryCallback(void* clientData, ClientPairArray* results) : mClientData(clientData), mResults(results)
+  {
+  }
+
+  void QueryCallback(void* clientData)
+  {
+    mResults->PushBack(ClientPair(mClientData, clientData));
+  }
+
+  void* mClientData;
+  ClientPairArray* mResults;
+};
+
+/// Refines every object found by a cast with one of the simple cast callbacks.
+template <typename RefineCallbackType>
+struct HierarchicalGridCastCallback
+{
+  HierarchicalGridCastCallback(RefineCallbackType* callback, CastDataParam castData) : mCallback(callback), mCastData(castData)
+  {
+  }
+
+  void QueryCallback(void* clientData)
+  {
+    mCallback->Refine(clientData, mCastData);
+  }
+
+  RefineCallbackType* mCallback;
+  CastDataParam mCastData;
+};
+
+RaverieDefineType(HierarchicalGridBroadPhase, builder, type)
+{
+  RaverieBindGetterSetterProperty(CellSize);
+}
+
+void HierarchicalGridBroadPhase::Serialize(Serializer& stream)
+{
+  IBroadPhase::Serialize(stream);
+  mGrid.Serialize(stream);
+}
+
+void HierarchicalGridBroadPhase::CreateProxy(BroadPhaseProxy& proxy, BroadPhaseData& data)
+{
+  mGrid.CreateProxy(proxy, data);
+}
+
+void HierarchicalGridBroadPhase::CreateProxies(BroadPhaseObjectArray& objects)
+{
+  BroadPhaseObjectArray::range range = objects.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    BroadPhaseObject& obj = range.Front();
+    mGrid.CreateProxy(*obj.mProxy, obj.mData);
+  }
+}
+
+void HierarchicalGridBroadPhase::RemoveProxy(BroadPhaseProxy& proxy)
+{
+  mGrid.RemoveProxy(proxy);
+}
+
+void HierarchicalGridBroadPhase::RemoveProxies(ProxyHandleArray& proxies)
+{
+  ProxyHandleArray::range range = proxies.All();
+  for (; !range.Empty(); range.PopFront())
+    mGrid.RemoveProxy(*range.Front());
+}
+
+void HierarchicalGridBroadPhase::UpdateProxy(BroadPhaseProxy& proxy, BroadPhaseData& data)
+{
+  mGrid.UpdateProxy(proxy, data);
+}
+
+void HierarchicalGridBroadPhase::UpdateProxies(BroadPhaseObjectArray& objects)
+{
+  BroadPhaseObjectArray::range range = objects.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    BroadPhaseObject& obj = range.Front();
+    mGrid.UpdateProxy(*obj.mProxy, obj.mData);
+  }
+}
+
+void HierarchicalGridBroadPhase::SelfQuery(ClientPairArray& results)
+{
+  results.Insert(results.End(), mDataPairs.All());
+}
+
+void HierarchicalGridBroadPhase::Query(BroadPhaseData& data, ClientPairArray& results)
+{
+  HierarchicalGridQueryCallback callback(data.mClientData, &results);
+  mGrid.Query(data.mAabb, &callback);
+}
+
+void HierarchicalGridBroadPhase::BatchQuery(BroadPhaseDataArray& data, ClientPairArray& results)
+{
+  for (uint i = 0; i < data.Size(); ++i)
+    Query(data[i], results);
+}
+
+void HierarchicalGridBroadPhase::CastRay(CastDataParam castData, ProxyCastResults& results)
+{
+  SimpleRayCallback callback(mCastRayCallBack, &results);
+  HierarchicalGridCastCallback<SimpleRayCallback> castCallback(&callback, castData);
+  mGrid.Query(castData.GetRay(), &castCallback);
+}
+
+void HierarchicalGridBroadPhase::CastSegment(CastDataParam castData, ProxyCastResults& results)
+{
+  SimpleSegmentCallback callback(mCastSegmentCallBack, &results);
+  HierarchicalGridCastCallback<SimpleSegmentCallback> castCallback(&callback, castData);
+  mGrid.Query(castData.GetSegment(), &castCallback);
+}
+
+void HierarchicalGridBroadPhase::CastAabb(CastDataParam castData, ProxyCastResults& results)
+{
+  SimpleAabbCallback callback(mCastAabbCallBack, &results);
+  HierarchicalGridCastCallback<SimpleAabbCallback> castCallback(&callback, castData);
+  mGrid.Query(castData.GetAabb(), &castCallback);
+}
+
+void HierarchicalGridBroadPhase::CastSphere(CastDataParam castData, ProxyCastResults& results)
+{
+  SimpleSphereCallback callback(mCastSphereCallBack, &results);
+  HierarchicalGridCastCallback<SimpleSphereCallback> castCallback(&callback, castData);
+  mGrid.Query(castData.GetSphere(), &castCallback);
+}
+
+void HierarchicalGridBroadPhase::CastFrustum(CastDataParam castData, ProxyCastResults& results)
+{
+  SimpleFrustumCallback callback(mCastFrustumCallBack, &results);
+  HierarchicalGridCastCallback<SimpleFrustumCallback> castCallback(&callback, castData);
+  mGrid.Query(castData.GetFrustum(), &castCallback);
+}
+
+void HierarchicalGridBroadPhase::RegisterCollisions()
+{
+  mDataPairs.Clear();
+
+  HierarchicalGridPairCallback callback(&mDataPairs);
+  mGrid.SelfQuery(&callback);
+}
+
+real HierarchicalGridBroadPhase::GetCellSize()
+{
+  return mGrid.GetCellSize();
+}
+
+void HierarchicalGridBroadPhase::SetCellSize(real cellSize)
+{
+  if (cellSize <= real(0.0))
+  {
+    DoNotifyWarning("Invalid cell size", "The cell size of a hierarchical grid must be positive.");
+    return;
+  }
+  mGrid.SetCellSize(cellSize);
+}
+
+} // namespace Raverie
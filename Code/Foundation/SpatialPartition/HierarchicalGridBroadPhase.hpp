@@ -0,0 +1,56 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// A BroadPhase built on a multi-level hashed grid. Works best with large
+/// numbers of similarly sized objects (e.g. projectiles) where its cost grows
+/// linearly with the number of objects. Every change rebuilds the grid on the
+/// next query, so it is mostly suited to scenes where most objects move.
+class HierarchicalGridBroadPhase : public IBroadPhase
+{
+public:
+  RaverieDeclareType(HierarchicalGridBroadPhase, TypeCopyMode::ReferenceType);
+
+  virtual void Serialize(Serializer& stream);
+  virtual void Draw(int level, uint debugDrawFlags)
+  {
+  }
+
+  virtual void CreateProxy(BroadPhaseProxy& proxy, BroadPhaseData& data);
+  virtual void CreateProxies(BroadPhaseObjectArray& objects);
+  virtual void RemoveProxy(BroadPhaseProxy& proxy);
+  virtual void RemoveProxies(ProxyHandleArray& proxies);
+  virtual void UpdateProxy(BroadPhaseProxy& proxy, BroadPhaseData& data);
+  virtual void UpdateProxies(BroadPhaseObjectArray& objects);
+
+  virtual void SelfQuery(ClientPairArray& results);
+  virtual void Query(BroadPhaseData& data, ClientPairArray& results);
+  virtual void BatchQuery(BroadPhaseDataArray& data, ClientPairArray& results);
+
+  virtual void Construct(){};
+
+  virtual void CastRay(CastDataParam data, ProxyCastResults& results);
+  virtual void CastSegment(CastDataParam data, ProxyCastResults& results);
+  virtual void CastAabb(CastDataParam data, ProxyCastResults& results);
+  virtual void CastSphere(CastDataParam data, ProxyCastResults& results);
+  virtual void CastFrustum(CastDataParam data, ProxyCastResults& results);
+
+  virtual void RegisterCollisions();
+
+  virtual void Cleanup(){};
+
+  /// The size of the cells on the lowest level of the grid. This should be
+  /// about the size of the most common (smallest) objects.
+  real GetCellSize();
+  void SetCellSize(real cellSize);
+
+private:
+  typedef HierarchicalGrid<void*> BroadPhaseType;
+  BroadPhaseType mGrid;
+
+  ClientPairArray mDataPairs;
+};
+
+} // namespace Raverie
@@ -32,8 +32,16 @@ public:
   void RemoveProxy(BroadPhaseProxy& proxy);
   void RemoveProxies(ProxyHandleArray& proxies);
   void UpdateProxy(BroadPhaseProxy& proxy, DataType& data);
+  /// Moves the boxes right away (so queries see the new positions) but defers
+  /// sorting the endpoints and updating the pairs until UpdatePairs is called.
   void UpdateProxies(DataObjectArray& objects);
 
+  /// Sorts the endpoints of everything moved through UpdateProxies and brings
+  /// the pairs up to date. Anything that needs sorted endpoints calls this
+  /// first, so it only has to be called directly to control when the work
+  /// happens (e.g. once per frame after all updates).
+  void UpdatePairs();
+
   /// A range for performing a re-entrant cast into Sap. A policy must be
   /// provided that tells the range how to collide an Aabb with a QueryType
   /// through a function called Overlap. Most implementations should just
@@ -63,6 +71,9 @@ private:
   void Setup();
   void MakeSentinel();
   uint GetNewBoxIndex();
+  /// Picks the axis the box centers vary the most on. Sweeping that axis
+  /// visits the fewest boxes that overlap on it but not on the other axes.
+  void ChooseSweepAxis();
 
   // helpers
 
@@ -106,6 +117,24 @@ private:
   template <uint Axis>
   void BatchEndPointRemove();
 
+  // deferred update sorting
+
+  /// Whether the endpoints on an axis are close enough to sorted that an
+  /// insertion sort is cheaper than a radix sort (boxes moved only a little).
+  template <uint Axis>
+  bool IsNearlySorted() const;
+  /// Insertion sorts an axis, adding and removing pairs as endpoints swap.
+  template <uint Axis>
+  void InsertionSortAxis();
+  /// Radix sorts an axis without touching the pairs.
+  template <uint Axis>
+  void RadixSortAxis();
+  /// Finds every pair by sweeping the given axis.
+  template <uint Axis>
+  void SweepPairs(typename PairManagerType::PairMap& pairs);
+  /// Replaces every pair with the pairs found by sweeping the sweep axis.
+  void RebuildPairs();
+
   // internal endpoint updates
 
   // Given a box and its index, create its endpoints
@@ -152,6 +181,14 @@ private:
   Array<uint> mOpenIndices;
   // Where the endpoints are stored for each axis.
   EndPointArray mAxes[3];
+
+  // The axis batch operations sweep over to find pairs.
+  uint mSweepAxis;
+  // Set when UpdateProxies has moved endpoints without sorting them.
+  bool mEndpointsDirty;
+  // Scratch space for sorting and sweeping.
+  EndPointArray mSortScratch;
+  Array<uint> mActiveBoxes;
 };
 
 } // namespace Raverie
@@ -38,6 +38,8 @@ Sap<ClientDataType>::~Sap()
 template <typename ClientDataType>
 void Sap<ClientDataType>::CreateProxy(BroadPhaseProxy& proxy, DataType& data)
 {
+  UpdatePairs();
+
   // Create the box from the physics component.
   BoxType box(data);
 
@@ -55,6 +57,8 @@ void Sap<ClientDataType>::CreateProxy(BroadPhaseProxy& proxy, DataType& data)
 template <typename ClientDataType>
 void Sap<ClientDataType>::CreateProxies(DataObjectArray& objects)
 {
+  UpdatePairs();
+
   // need to keep track of what boxes we were inserting
   Array<uint> insertBoxes;
   insertBoxes.Reserve(objects.Size());
@@ -85,6 +89,8 @@ void Sap<ClientDataType>::CreateProxies(DataObjectArray& objects)
     *(objects[i].mProxy) = BroadPhaseProxy((u32)index);
   }
 
+  ChooseSweepAxis();
+
   // mark an object as just being inserted by nulling it's obj ptr.
   // have to do this here because the copy constructor cannot make this
   // ptr work properly and the box array may be resized above.
@@ -96,13 +102,18 @@ void Sap<ClientDataType>::CreateProxies(DataObjectArray& objects)
   }
 
   // sort all of the endpoints to be in the correct spot
-  uint startIndex;
-  BatchSort<0>(newEndpoints[0]);
-  BatchSort<1>(newEndpoints[1]);
-  startIndex = BatchSort<2>(newEndpoints[2]);
+  uint startIndices[3];
+  startIndices[0] = BatchSort<0>(newEndpoints[0]);
+  startIndices[1] = BatchSort<1>(newEndpoints[1]);
+  startIndices[2] = BatchSort<2>(newEndpoints[2]);
 
   // add all of the pairs that we just created
-  BatchPairAdd<2>(startIndex);
+  if (mSweepAxis == 0)
+    BatchPairAdd<0>(startIndices[0]);
+  else if (mSweepAxis == 1)
+    BatchPairAdd<1>(startIndices[1]);
+  else
+    BatchPairAdd<2>(startIndices[2]);
 
   // fill back out the obj ptr that we used to
   // signify this box was just added
@@ -117,6 +128,8 @@ void Sap<ClientDataType>::CreateProxies(DataObjectArray& objects)
 template <typename ClientDataType>
 void Sap<ClientDataType>::RemoveProxy(BroadPhaseProxy& proxy)
 {
+  UpdatePairs();
+
   uint boxNum = proxy.ToU32();
   ErrorIf(boxNum >= mBoxes.Size() || mBoxes[boxNum].mObj == nullptr, "Invalid proxy removed. Proxy did not reference a valid object.");
 
@@ -141,6 +154,9 @@ void Sap<ClientDataType>::RemoveProxy(BroadPhaseProxy& proxy)
 template <typename ClientDataType>
 void Sap<ClientDataType>::RemoveProxies(ProxyHandleArray& proxies)
 {
+  UpdatePairs();
+  ChooseSweepAxis();
+
   // null out all of the box obj ptrs
   ProxyHandleArray::range range = proxies.All();
   for (; !range.Empty(); range.PopFront())
@@ -152,8 +168,12 @@ void Sap<ClientDataType>::RemoveProxies(ProxyHandleArray& proxies)
     mOpenIndices.PushBack(boxIndex);
   }
 
-  // let's pretend the z axis is the one of most variance...
-  BatchPairRemove<2>();
+  if (mSweepAxis == 0)
+    BatchPairRemove<0>();
+  else if (mSweepAxis == 1)
+    BatchPairRemove<1>();
+  else
+    BatchPairRemove<2>();
 
   // remove all deleted endpoints
   BatchEndPointRemove<0>();
@@ -164,6 +184,8 @@ void Sap<ClientDataType>::RemoveProxies(ProxyHandleArray& proxies)
 template <typename ClientDataType>
 void Sap<ClientDataType>::UpdateProxy(BroadPhaseProxy& proxy, DataType& data)
 {
+  UpdatePairs();
+
   uint index = proxy.ToU32();
   ErrorIf(index >= mBoxes.Size() || mBoxes[index].mObj == nullptr, "Invalid proxy updated. Proxy did not reference a valid object.");
 
@@ -179,14 +201,70 @@ void Sap<ClientDataType>::UpdateProxy(BroadPhaseProxy& proxy, DataType& data)
 template <typename ClientDataType>
 void Sap<ClientDataType>::UpdateProxies(DataObjectArray& objects)
 {
+  // Deferred updates rebuild the pairs from scratch when the endpoints are too
+  // far out of order, which would drop the references other Saps hold on a
+  // shared pair manager. Multi-Sap has to update one proxy at a time.
+  if (!mStandAlone)
+  {
+    typename DataObjectArray::range range = objects.All();
+    while (!range.Empty())
+    {
+      DataObjectType& object = range.Front();
+      range.PopFront();
+
+      Sap::UpdateProxy(*object.mProxy, object.mData);
+    }
+    return;
+  }
+
   typename DataObjectArray::range range = objects.All();
-  while (!range.Empty())
+  for (; !range.Empty(); range.PopFront())
   {
     DataObjectType& object = range.Front();
-    range.PopFront();
+    uint index = object.mProxy->ToU32();
+    ErrorIf(index >= mBoxes.Size() || mBoxes[index].mObj == nullptr, "Invalid proxy updated. Proxy did not reference a valid object.");
+
+    // there could be an update where our client data changed
+    // so make sure to update it (ie. a remove->Insert)
+    BoxType& box = mBoxes[index];
+    box.mData.mClientData = object.mData.mClientData;
 
-    Sap::UpdateProxy(*object.mProxy, object.mData);
+    // just move the endpoint values, they are sorted all at once later
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      box.UpdateBox(axis, object.mData);
+      mAxes[axis][mIndices[GetBoxMin(axis, index)]].mVal = box.mMins[axis];
+      mAxes[axis][mIndices[GetBoxMax(axis, index)]].mVal = box.mMaxs[axis];
+    }
   }
+
+  mEndpointsDirty = true;
+}
+
+template <typename ClientDataType>
+void Sap<ClientDataType>::UpdatePairs()
+{
+  if (!mEndpointsDirty)
+    return;
+  mEndpointsDirty = false;
+
+  // When the boxes only moved a little since the last update (the common case)
+  // the endpoints are nearly sorted and an insertion sort only has to do a few
+  // swaps, each of which adds or removes a pair. Otherwise it is cheaper to
+  // radix sort every axis and sweep for all of the pairs again.
+  if (IsNearlySorted<0>() && IsNearlySorted<1>() && IsNearlySorted<2>())
+  {
+    InsertionSortAxis<0>();
+    InsertionSortAxis<1>();
+    InsertionSortAxis<2>();
+    return;
+  }
+
+  RadixSortAxis<0>();
+  RadixSortAxis<1>();
+  RadixSortAxis<2>();
+  ChooseSweepAxis();
+  RebuildPairs();
 }
 
 template <typename ClientDataType>
@@ -206,12 +284,15 @@ SapRange<ClientDataType, QueryType> Sap<ClientDataType>::Query(const QueryType&
 template <typename ClientDataType>
 SapPairRange<ClientDataType> Sap<ClientDataType>::QuerySelf()
 {
+  UpdatePairs();
   return SapPairRange<ClientDataType>(mPairManager);
 }
 
 template <typename ClientDataType>
 void Sap<ClientDataType>::Clear()
 {
+  UpdatePairs();
+
   // Null out all of the box obj ptrs making sure to ignore the sentinel
   for (uint i = 1; i < mBoxes.Size(); ++i)
   {
@@ -219,8 +300,12 @@ void Sap<ClientDataType>::Clear()
     mOpenIndices.PushBack(i);
   }
 
-  // let's pretend the z axis is the one of most variance...
-  BatchPairRemove<2>();
+  if (mSweepAxis == 0)
+    BatchPairRemove<0>();
+  else if (mSweepAxis == 1)
+    BatchPairRemove<1>();
+  else
+    BatchPairRemove<2>();
 
   // remove all deleted endpoints
   BatchEndPointRemove<0>();
@@ -291,6 +376,8 @@ void Sap<ClientDataType>::Draw(int level, uint debugDrawFlags)
 template <typename ClientDataType>
 void Sap<ClientDataType>::Validate()
 {
+  UpdatePairs();
+
   for (uint i = 0; i < mBoxes.Size(); ++i)
   {
     BoxType& box = mBoxes[i];
@@ -369,6 +456,9 @@ void Sap<ClientDataType>::Setup()
   mAxes[1].Reserve(objectStartSize * 2);
   mAxes[2].Reserve(objectStartSize * 2);
 
+  mSweepAxis = 2;
+  mEndpointsDirty = false;
+
   MakeSentinel();
 }
 
@@ -427,6 +517,45 @@ uint Sap<ClientDataType>::GetNewBoxIndex()
   return index;
 }
 
+template <typename ClientDataType>
+void Sap<ClientDataType>::ChooseSweepAxis()
+{
+  real sums[3] = {0, 0, 0};
+  real squaredSums[3] = {0, 0, 0};
+  uint count = 0;
+
+  // skip the sentinel
+  for (uint i = 1; i < mBoxes.Size(); ++i)
+  {
+    BoxType& box = mBoxes[i];
+    if (!box.Valid())
+      continue;
+
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      real center = (box.mMins[axis] + box.mMaxs[axis]) * real(0.5);
+      sums[axis] += center;
+      squaredSums[axis] += center * center;
+    }
+    ++count;
+  }
+
+  if (count == 0)
+    return;
+
+  real bestVariance = -Math::PositiveMax();
+  for (uint axis = 0; axis < 3; ++axis)
+  {
+    real mean = sums[axis] / count;
+    real variance = squaredSums[axis] / count - mean * mean;
+    if (variance > bestVariance)
+    {
+      bestVariance = variance;
+      mSweepAxis = axis;
+    }
+  }
+}
+
 template <typename ClientDataType>
 uint Sap<ClientDataType>::GetBoxIndex(uint axis, uint index)
 {
@@ -704,6 +833,125 @@ void Sap<ClientDataType>::BatchEndPointRemove()
   axis.Resize(insertPosition + 1);
 }
 
+template <typename ClientDataType>
+template <uint Axis>
+bool Sap<ClientDataType>::IsNearlySorted() const
+{
+  const EndPointArray& axis = mAxes[Axis];
+
+  // Count the endpoints that are smaller than the one before them. A handful
+  // of these (relative to the size) means the boxes barely moved.
+  uint outOfOrder = 0;
+  uint size = axis.Size();
+  for (uint i = 1; i < size; ++i)
+  {
+    if (axis[i - 1].mVal > axis[i].mVal)
+      ++outOfOrder;
+  }
+
+  const uint cInsertionSortRatio = 16;
+  return outOfOrder * cInsertionSortRatio <= size;
+}
+
+template <typename ClientDataType>
+template <uint Axis>
+void Sap<ClientDataType>::InsertionSortAxis()
+{
+  EndPointArray& axis = mAxes[Axis];
+
+  // The sentinels never move. Shifting is stable (strictly greater only) so a
+  // box's min can never pass its own max and create a pair with itself.
+  uint end = axis.Size() - 1;
+  for (uint i = 2; i < end; ++i)
+  {
+    uint index = i;
+    while (axis[index - 1].mVal > axis[index].mVal)
+    {
+      ShiftLeft<Axis>(index, true);
+      --index;
+    }
+  }
+}
+
+template <typename ClientDataType>
+template <uint Axis>
+void Sap<ClientDataType>::RadixSortAxis()
+{
+  EndPointArray& axis = mAxes[Axis];
+
+  // leave the sentinels at either end
+  uint count = axis.Size() - 2;
+  mSortScratch.Resize(count);
+  RadixSort(axis.SubRange(1, count), mSortScratch.Data(), &EndPointType::GetSortKey);
+
+  for (uint i = 1; i <= count; ++i)
+    mIndices[axis[i].GetIndex()] = i;
+}
+
+template <typename ClientDataType>
+template <uint Axis>
+void Sap<ClientDataType>::SweepPairs(typename PairManagerType::PairMap& pairs)
+{
+  typedef typename PairManagerType::ReferencedPair ReferencedPair;
+  typedef typename PairManagerType::ClientPairType ClientPairType;
+
+  EndPointArray& axis = mAxes[Axis];
+  Array<uint>& activeBoxes = mActiveBoxes;
+  activeBoxes.Clear();
+
+  // make sure to ignore the sentinels
+  uint size = axis.Size() - 1;
+  for (uint i = 1; i < size; ++i)
+  {
+    EndPointType& endpoint = axis[i];
+    uint boxIndex = endpoint.GetIndex() / 6;
+
+    // this box is done overlapping anything later on this axis
+    if (!endpoint.isMin())
+    {
+      for (uint j = 0; j < activeBoxes.Size(); ++j)
+      {
+        if (activeBoxes[j] == boxIndex)
+        {
+          activeBoxes[j] = activeBoxes.Back();
+          activeBoxes.PopBack();
+          break;
+        }
+      }
+      continue;
+    }
+
+    // everything active overlaps this box on this axis
+    DataType& data1 = mBoxes[boxIndex].mData;
+    for (uint j = 0; j < activeBoxes.Size(); ++j)
+    {
+      uint otherIndex = activeBoxes[j];
+      if (!CheckRemainingAxesOverlap<Axis>(boxIndex, otherIndex))
+        continue;
+
+      DataType& data2 = mBoxes[otherIndex].mData;
+      PairId pairId;
+      if (PairManagerType::GetPairId(data1, data2, pairId))
+        pairs.Insert(pairId, ReferencedPair(1, ClientPairType(data1, data2)));
+    }
+    activeBoxes.PushBack(boxIndex);
+  }
+}
+
+template <typename ClientDataType>
+void Sap<ClientDataType>::RebuildPairs()
+{
+  typename PairManagerType::PairMap pairs;
+  if (mSweepAxis == 0)
+    SweepPairs<0>(pairs);
+  else if (mSweepAxis == 1)
+    SweepPairs<1>(pairs);
+  else
+    SweepPairs<2>(pairs);
+
+  mPairManager->ReplacePairs(pairs);
+}
+
 template <typename ClientDataType>
 template <uint Axis>
 void Sap<ClientDataType>::InsertEndpoint(BoxType& box, uint index)
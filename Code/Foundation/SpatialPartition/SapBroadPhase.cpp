@@ -113,6 +113,8 @@ void SapBroadPhase::CastFrustum(CastDataParam castData, ProxyCastResults& result
 
 void SapBroadPhase::RegisterCollisions()
 {
+  // Sort everything that moved this frame at once
+  mSap.UpdatePairs();
 }
 
 } // namespace Raverie
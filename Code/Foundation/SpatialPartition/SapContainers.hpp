@@ -22,7 +22,9 @@ public:
   SapPairManager(){};
   ~SapPairManager(){};
 
-  void AddPair(DataType& data1, DataType& data2)
+  /// Computes the key of a pair. Returns false if both client datas are the
+  /// same (an object can't pair with itself).
+  static bool GetPairId(DataType& data1, DataType& data2, PairId& pairId)
   {
     // get the id's of the two client data's
     HashPolicy<ClientDataType> hasher;
@@ -30,10 +32,18 @@ public:
     uint id2 = hasher(data2.mClientData);
     // make sure the aren't the same
     if (id1 == id2)
-      return;
+      return false;
 
     // get the lexicographic index of this pair
-    PairId index = GetLexicographicId(id1, id2);
+    pairId = GetLexicographicId(id1, id2);
+    return true;
+  }
+
+  void AddPair(DataType& data1, DataType& data2)
+  {
+    PairId index;
+    if (!GetPairId(data1, data2, index))
+      return;
 
     // since this manager is designed for multi-sap, we need to
     // keep track of how many Sap's have inserted this key. Therefore,
@@ -78,6 +88,13 @@ public:
       --r.Front().second.first;
   }
 
+  /// Replaces every pair with the given pairs (each with one reference).
+  /// Only valid for a stand alone Sap.
+  void ReplacePairs(PairMap& newPairs)
+  {
+    mPairs.Swap(newPairs);
+  }
+
   void Clear()
   {
     // Remove all the pairs that were stored.
@@ -139,6 +156,18 @@ struct SapEndPoint
     return mVal > rhs.mVal;
   }
 
+  /// Returns the value as an unsigned key that sorts in the same order as the
+  /// value does (used to radix sort the endpoints).
+  static u32 GetSortKey(const SapEndPoint& endpoint)
+  {
+    static_assert(sizeof(real) == sizeof(u32), "Sort keys assume a 32-bit real.");
+    u32 bits;
+    memcpy(&bits, &endpoint.mVal, sizeof(bits));
+    // Negative values sort backwards, so flip all of their bits. Positive
+    // values just need to sort after the negative ones.
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+  }
+
   /// The highest bit is a flag signifying if this is a min
   /// or max while the rest is used to store the index.
   uint mIndex;
@@ -4,6 +4,8 @@
 namespace Raverie
 {
 
+TreeBuildParallelForFunction gTreeBuildParallelFor = nullptr;
+
 RaverieDefineStaticLibrary(SpatialPartitionLibrary)
 {
   builder.CreatableInScriptDefault = false;
@@ -16,6 +18,7 @@ RaverieDefineStaticLibrary(SpatialPartitionLibrary)
   RaverieInitializeType(SapBroadPhase);
   RaverieInitializeType(DynamicAabbTreeBroadPhase);
   RaverieInitializeType(AvlDynamicAabbTreeBroadPhase);
+  RaverieInitializeType(HierarchicalGridBroadPhase);
   RaverieInitializeType(DynamicBroadphasePropertyExtension);
   RaverieInitializeType(StaticBroadphasePropertyExtension);
 
@@ -43,6 +43,8 @@ public:
 #include "SapContainers.hpp"
 #include "Sap.hpp"
 #include "SapBroadPhase.hpp"
+#include "HierarchicalGrid.hpp"
+#include "HierarchicalGridBroadPhase.hpp"
 #include "AabbTreeNode.hpp"
 #include "AabbTreeMethods.hpp"
 #include "StaticAabbTree.hpp"
@@ -50,3 +52,4 @@ public:
 #include "BroadPhasePackage.hpp"
 #include "BroadPhaseCreator.hpp"
 #include "BroadPhaseTracker.hpp"
+#include "BroadPhaseAutoTuner.hpp"
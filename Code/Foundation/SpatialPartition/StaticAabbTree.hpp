@@ -4,26 +4,126 @@
 namespace Raverie
 {
 
-/// A range for iterating through the leaf nodes of the StaticAabbTree. Used to
-/// perform queries without having to provide a callback function.
-/// Note: this range will become completely invalidated if any operations are
-/// performed on the StaticAabbTree.
-template <typename ClientDataType, typename QueryType, typename ArrayType = Array<AabbNode<ClientDataType>*>, typename PolicyType = BroadPhasePolicy<QueryType, Aabb>>
-struct StaticTreeRange : public BroadPhaseTreeRange<ClientDataType, AabbNode<ClientDataType>, QueryType, PolicyType, ArrayType>
+/// A node of the flattened form of a StaticAabbTree that queries walk. The
+/// bounds of the children are stored per axis (structure of arrays) so that
+/// every child can be tested against a query at once with simd instructions.
+struct WideAabbNode
+{
+  static const uint cMaxChildren = 4;
+  /// Set on a child index that refers to a leaf instead of another wide node.
+  static const uint cLeafBit = 0x80000000;
+
+  WideAabbNode();
+
+  void SetChild(uint index, const Aabb& aabb, uint child);
+  Aabb GetChildAabb(uint index) const;
+
+  real mMinX[cMaxChildren];
+  real mMinY[cMaxChildren];
+  real mMinZ[cMaxChildren];
+  real mMaxX[cMaxChildren];
+  real mMaxY[cMaxChildren];
+  real mMaxZ[cMaxChildren];
+  /// Either the index of a wide node or, with cLeafBit set, of a leaf.
+  uint mChildren[cMaxChildren];
+  uint mCount;
+};
+
+/// Tests every child of a wide node against a query object with the policy,
+/// returning a mask where bit i is set if child i overlaps. The default tests
+/// one child at a time, the common policies are specialized below to test all
+/// of the children at once.
+template <typename QueryType, typename PolicyType>
+struct WideNodeOverlap
+{
+  static uint Overlap(PolicyType& policy, QueryType& queryObj, const WideAabbNode& node)
+  {
+    uint mask = 0;
+    for (uint i = 0; i < node.mCount; ++i)
+    {
+      Aabb aabb = node.GetChildAabb(i);
+      if (policy.Overlap(queryObj, aabb))
+        mask |= 1 << i;
+    }
+    return mask;
+  }
+};
+
+template <>
+struct WideNodeOverlap<Ray, BroadPhasePolicy<Ray, Aabb>>
+{
+  static uint Overlap(BroadPhasePolicy<Ray, Aabb>& policy, Ray& ray, const WideAabbNode& node)
+  {
+    return Intersection::RayAabb4(ray.Start, ray.Direction, node.mMinX, node.mMinY, node.mMinZ, node.mMaxX, node.mMaxY, node.mMaxZ);
+  }
+};
+
+template <>
+struct WideNodeOverlap<Segment, BroadPhasePolicy<Segment, Aabb>>
+{
+  static uint Overlap(BroadPhasePolicy<Segment, Aabb>& policy, Segment& segment, const WideAabbNode& node)
+  {
+    return Intersection::SegmentAabb4(segment.Start, segment.End, node.mMinX, node.mMinY, node.mMinZ, node.mMaxX, node.mMaxY, node.mMaxZ);
+  }
+};
+
+template <>
+struct WideNodeOverlap<Aabb, BroadPhasePolicy<Aabb, Aabb>>
 {
-  typedef BroadPhaseTreeRange<ClientDataType, AabbNode<ClientDataType>, QueryType, PolicyType, ArrayType> BaseType;
+  static uint Overlap(BroadPhasePolicy<Aabb, Aabb>& policy, Aabb& aabb, const WideAabbNode& node)
+  {
+    return Intersection::AabbAabb4(aabb.mMin, aabb.mMax, node.mMinX, node.mMinY, node.mMinZ, node.mMaxX, node.mMaxY, node.mMaxZ);
+  }
+};
 
-  /// Constructs a range using the default BroadPhase.
-  StaticTreeRange(ArrayType* scratchBuffer, typename BaseType::NodeTypeDef* root, const QueryType& queryObj) : BaseType(scratchBuffer, root, queryObj, PolicyType())
+template <>
+struct WideNodeOverlap<Sphere, BroadPhasePolicy<Sphere, Aabb>>
+{
+  static uint Overlap(BroadPhasePolicy<Sphere, Aabb>& policy, Sphere& sphere, const WideAabbNode& node)
   {
+    return Intersection::AabbSphere4(node.mMinX, node.mMinY, node.mMinZ, node.mMaxX, node.mMaxY, node.mMaxZ, sphere.mCenter, sphere.mRadius);
   }
+};
 
-  /// Constructs a range using the policy type passed in.
-  StaticTreeRange(ArrayType* scratchBuffer, typename BaseType::NodeTypeDef* root, const QueryType& queryObj, PolicyType policy) : BaseType(scratchBuffer, root, queryObj, policy)
+template <>
+struct WideNodeOverlap<Frustum, BroadPhasePolicy<Frustum, Aabb>>
+{
+  static uint Overlap(BroadPhasePolicy<Frustum, Aabb>& policy, Frustum& frustum, const WideAabbNode& node)
   {
+    return Intersection::AabbFrustumApproximation4(node.mMinX, node.mMinY, node.mMinZ, node.mMaxX, node.mMaxY, node.mMaxZ, frustum.GetIntersectionData());
   }
 };
 
+/// A range for iterating through the leaf nodes of the StaticAabbTree. Used to
+/// perform queries without having to provide a callback function.
+/// Note: this range will become completely invalidated if any operations are
+/// performed on the StaticAabbTree.
+template <typename ClientDataType, typename QueryType, typename ArrayType = Array<uint>, typename PolicyType = BroadPhasePolicy<QueryType, Aabb>>
+struct StaticTreeRange
+{
+  typedef ClientDataType ClientDataTypeDef;
+  typedef AabbNode<ClientDataType> NodeTypeDef;
+  typedef Array<WideAabbNode> WideNodeArray;
+  typedef Array<NodeTypeDef*> LeafArray;
+
+  StaticTreeRange(ArrayType* scratchBuffer, const WideNodeArray* nodes, const LeafArray* leaves, const QueryType& queryObj, PolicyType policy);
+
+  void PopFront();
+  ClientDataType& Front();
+  bool Empty() const;
+
+  // temporary now so that the proxy can be retrieved
+  NodeTypeDef& proxyFront();
+
+  void SkipDead();
+
+  QueryType mQueryObj;
+  PolicyType mPolicy;
+  const WideNodeArray* mNodes;
+  const LeafArray* mLeaves;
+  ArrayType* mScratchSpace;
+};
+
 /// An AabbTree specialized for static objects. This tree is preferable in the
 /// case where objects are not moving over the DynamicAabbTree because more time
 /// is spent in building the tree. This allows the tree to build itself more
@@ -36,9 +136,12 @@ public:
   typedef StaticAabbTree<ClientDataType> TreeType;
   typedef AabbNode<ClientDataType> NodeType;
   typedef NodeType* NodePointer;
+  /// Queries traverse the wide nodes with an explicit stack of child indices.
+  typedef uint StackEntryType;
   typedef BaseBroadPhaseData<ClientDataType> DataType;
   typedef Array<NodePointer> NodeArray;
   typedef HashSet<NodePointer> NodeSet;
+  typedef Array<WideAabbNode> WideNodeArray;
 
   typedef Pair<NodePointer, DataType> UpdatePair;
   typedef Array<UpdatePair> UpdateArray;
@@ -97,7 +200,7 @@ public:
   {
     typedef StaticTreeRange<ClientDataType, QueryType, ArrayType, Policy> RangeType;
 
-    return RangeType(&scratchBuffer, mRoot, queryObj, policy);
+    return RangeType(&scratchBuffer, &mWideNodes, &mWideLeaves, queryObj, policy);
   }
 
   /// The same functionality as the QueryWithPolicy function except
@@ -109,12 +212,18 @@ public:
   {
     typedef StaticTreeRange<ClientDataType, QueryType, ArrayType> RangeType;
 
-    return RangeType(&scratchBuffer, mRoot, queryObj);
+    return RangeType(&scratchBuffer, &mWideNodes, &mWideLeaves, queryObj, BroadPhasePolicy<QueryType, Aabb>());
   }
 
   /// Sets the current partition method.
   void SetPartitionMethod(PartitionMethods::Enum method);
 
+  /// Sets how many children (2 to WideAabbNode::cMaxChildren) each node that
+  /// queries walk can have. Construct collapses the binary tree into nodes of
+  /// this size, wider nodes mean a shallower tree with more children tested at
+  /// once. Takes effect on the next construction.
+  void SetBranchingFactor(uint branchingFactor);
+
 private:
   template <typename ClientDataTypeOther>
   friend void SerializeAabbTree(Serializer& stream, StaticAabbTree<ClientDataTypeOther>& tree);
@@ -130,12 +239,20 @@ private:
   /// not in the removal set into the passed in array.
   void DeleteInternalNodes(NodeArray& leafNodes);
 
+  /// Flattens the binary tree into the wide nodes that queries walk.
+  void BuildWideNodes();
+  uint BuildWideNode(NodePointer node);
+
   ConstructionMethod mConstructMethod;
   StopCriteria mStopCriteria;
   uint mXPrimitives;
   PartitionMethods::Enum mPartitionMethod;
+  uint mBranchingFactor;
 
   NodePointer mRoot;
+  /// The flattened tree, the root is the first node (when there is one).
+  WideNodeArray mWideNodes;
+  NodeArray mWideLeaves;
   NodeArray mNodesAdded;
   UpdateArray mUpdateNodes;
   NodeSet mNodesRemoved;
@@ -3,6 +3,103 @@
 namespace Raverie
 {
 
+inline WideAabbNode::WideAabbNode()
+{
+  // Unused children are inverted boxes so that they can never be hit.
+  Aabb invalid;
+  invalid.SetInvalid();
+  for (uint i = 0; i < cMaxChildren; ++i)
+    SetChild(i, invalid, 0);
+  mCount = 0;
+}
+
+inline void WideAabbNode::SetChild(uint index, const Aabb& aabb, uint child)
+{
+  mMinX[index] = aabb.mMin.x;
+  mMinY[index] = aabb.mMin.y;
+  mMinZ[index] = aabb.mMin.z;
+  mMaxX[index] = aabb.mMax.x;
+  mMaxY[index] = aabb.mMax.y;
+  mMaxZ[index] = aabb.mMax.z;
+  mChildren[index] = child;
+}
+
+inline Aabb WideAabbNode::GetChildAabb(uint index) const
+{
+  Aabb aabb;
+  aabb.mMin = Vec3(mMinX[index], mMinY[index], mMinZ[index]);
+  aabb.mMax = Vec3(mMaxX[index], mMaxY[index], mMaxZ[index]);
+  return aabb;
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::StaticTreeRange(
+    ArrayType* scratchBuffer, const WideNodeArray* nodes, const LeafArray* leaves, const QueryType& queryObj, PolicyType policy) :
+    mQueryObj(queryObj),
+    mPolicy(policy),
+    mNodes(nodes),
+    mLeaves(leaves)
+{
+  mScratchSpace = scratchBuffer;
+  mScratchSpace->Clear();
+  if (!mNodes->Empty())
+    mScratchSpace->PushBack(0);
+  SkipDead();
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+void StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::PopFront()
+{
+  mScratchSpace->PopBack();
+  SkipDead();
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+ClientDataType& StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::Front()
+{
+  return proxyFront().mClientData;
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+bool StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::Empty() const
+{
+  return mScratchSpace->Size() == 0;
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+typename StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::NodeTypeDef& StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::proxyFront()
+{
+  uint size = mScratchSpace->Size();
+  ErrorIf(size == 0, "Cannot pop an empty range.");
+  uint leafIndex = (*mScratchSpace)[size - 1] & ~WideAabbNode::cLeafBit;
+  return *(*mLeaves)[leafIndex];
+}
+
+template <typename ClientDataType, typename QueryType, typename ArrayType, typename PolicyType>
+void StaticTreeRange<ClientDataType, QueryType, ArrayType, PolicyType>::SkipDead()
+{
+  ArrayType& stack = *mScratchSpace;
+  while (!stack.Empty())
+  {
+    // leaves were already tested when their parent was opened
+    uint entry = stack.Back();
+    if (entry & WideAabbNode::cLeafBit)
+      return;
+
+    stack.PopBack();
+    const WideAabbNode& node = (*mNodes)[entry];
+    uint mask = WideNodeOverlap<QueryType, PolicyType>::Overlap(mPolicy, mQueryObj, node);
+    mask &= (1 << node.mCount) - 1;
+
+    // push in reverse so that the first child is visited first
+    for (uint i = node.mCount; i > 0; --i)
+    {
+      if (mask & (1 << (i - 1)))
+        stack.PushBack(node.mChildren[i - 1]);
+    }
+  }
+}
+
 template <typename ClientDataType>
 StaticAabbTree<ClientDataType>::StaticAabbTree()
 {
@@ -12,6 +109,7 @@ StaticAabbTree<ClientDataType>::StaticAabbTree()
   mConstructMethod = TopDown;
   mStopCriteria = XPrimitives;
   SetPartitionMethod(PartitionMethods::MinimizeVolumeSum);
+  mBranchingFactor = WideAabbNode::cMaxChildren;
 }
 
 template <typename ClientDataType>
@@ -134,6 +232,8 @@ void StaticAabbTree<ClientDataType>::Construct()
   // now build the tree from all of these leaf nodes
   mRoot = BuildTreeTopDownNodes<NodeType>(mNodesAdded, CurrPartitionMethod);
   mNodesAdded.Clear();
+
+  BuildWideNodes();
 }
 
 template <typename ClientDataType>
@@ -203,6 +303,15 @@ void StaticAabbTree<ClientDataType>::SetPartitionMethod(PartitionMethods::Enum m
     CurrPartitionMethod = &MinimizeSurfaceAreaSumNodes<NodeType>;
   else if (mPartitionMethod == PartitionMethods::MidPoint)
     CurrPartitionMethod = &MidPointNodes<NodeType>;
+  else if (mPartitionMethod == PartitionMethods::BinnedSurfaceArea)
+    CurrPartitionMethod = &BinnedSurfaceAreaNodes<NodeType>;
+}
+
+template <typename ClientDataType>
+void StaticAabbTree<ClientDataType>::SetBranchingFactor(uint branchingFactor)
+{
+  uint maxChildren = WideAabbNode::cMaxChildren;
+  mBranchingFactor = Math::Clamp(branchingFactor, 2u, maxChildren);
 }
 
 template <typename ClientDataType>
@@ -220,6 +329,9 @@ void StaticAabbTree<ClientDataType>::DrawTree(NodePointer node)
 template <typename ClientDataType>
 void StaticAabbTree<ClientDataType>::DeleteInternalNodes(Array<NodePointer>& leafNodes)
 {
+  mWideNodes.Clear();
+  mWideLeaves.Clear();
+
   if (mRoot == nullptr)
     return;
 
@@ -255,6 +367,82 @@ void StaticAabbTree<ClientDataType>::DeleteInternalNodes(Array<NodePointer>& lea
   mNodesRemoved.Clear();
 }
 
+template <typename ClientDataType>
+void StaticAabbTree<ClientDataType>::BuildWideNodes()
+{
+  mWideNodes.Clear();
+  mWideLeaves.Clear();
+  if (mRoot == nullptr)
+    return;
+
+  mWideNodes.Reserve(mProxyCount);
+  mWideLeaves.Reserve(mProxyCount);
+  BuildWideNode(mRoot);
+}
+
+template <typename ClientDataType>
+uint StaticAabbTree<ClientDataType>::BuildWideNode(NodePointer node)
+{
+  // The root can be a lone leaf, otherwise start from the binary children
+  NodePointer children[WideAabbNode::cMaxChildren];
+  uint count = 0;
+  if (node->IsLeaf())
+    children[count++] = node;
+  else
+  {
+    children[count++] = node->mChild1;
+    children[count++] = node->mChild2;
+  }
+
+  // Pull grandchildren up into this node until it is full, always opening the
+  // internal child with the largest surface area (the one most likely to be hit).
+  while (count < mBranchingFactor)
+  {
+    uint largest = count;
+    real largestArea = -Math::PositiveMax();
+    for (uint i = 0; i < count; ++i)
+    {
+      if (children[i]->IsLeaf())
+        continue;
+
+      real area = children[i]->mAabb.GetSurfaceArea();
+      if (area > largestArea)
+      {
+        largest = i;
+        largestArea = area;
+      }
+    }
+
+    if (largest == count)
+      break;
+
+    NodePointer opened = children[largest];
+    children[largest] = opened->mChild1;
+    children[count++] = opened->mChild2;
+  }
+
+  // References into mWideNodes are invalidated by the recursion, use the index
+  uint index = mWideNodes.Size();
+  mWideNodes.PushBack(WideAabbNode());
+  mWideNodes[index].mCount = count;
+
+  for (uint i = 0; i < count; ++i)
+  {
+    NodePointer child = children[i];
+    uint childIndex;
+    if (child->IsLeaf())
+    {
+      childIndex = mWideLeaves.Size() | WideAabbNode::cLeafBit;
+      mWideLeaves.PushBack(child);
+    }
+    else
+      childIndex = BuildWideNode(child);
+
+    mWideNodes[index].SetChild(i, child->mAabb, childIndex);
+  }
+  return index;
+}
+
 template <typename ClientDataType>
 void SerializeAabbTree(Serializer& stream, StaticAabbTree<ClientDataType>& tree)
 {
@@ -271,6 +459,7 @@ void SerializeAabbTree(Serializer& stream, StaticAabbTree<ClientDataType>& tree)
     {
       tree.mRoot = SerializeAabbTree<ClientDataType>(stream);
       tree.CountProxies();
+      tree.BuildWideNodes();
       stream.EndPolymorphic();
     }
   }
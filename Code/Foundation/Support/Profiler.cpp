@@ -208,7 +208,12 @@ ScopeTimer::~ScopeTimer()
   ProfileSystem* system = ProfileSystem::Instance;
   ProfileTime endTime = system->GetTime();
   ProfileTime duration = endTime - mStartTime;
-  mData->EnterRecord(duration);
+
+  // Records aren't thread safe, so scopes run on worker threads (such as job
+  // system tasks) only show up in traces. Time them from around the work that
+  // was handed out instead.
+  if (Thread::IsMainThread())
+    mData->EnterRecord(duration);
 
   if (system->mIsRecording && duration != 0)
   {
@@ -106,6 +106,23 @@ public:
 // 1.375MB per block at 44 bytes per StreamedVertex.
 typedef PodBlockArray<StreamedVertex, 15> StreamedVertexArray;
 
+// Allocates render queue data from the "Graphics" frame arena. Render queues
+// are cleared once the renderer is done with them, before their memory is
+// reclaimed at the end of the following frame.
+class RenderFrameAllocator : public FrameAllocator
+{
+public:
+  RenderFrameAllocator() : FrameAllocator(GetArena())
+  {
+  }
+
+  static Memory::FrameArena* GetArena()
+  {
+    static Memory::FrameArena* arena = Memory::GetNamedFrameArena("Graphics");
+    return arena;
+  }
+};
+
 /// Type of the texture, must match sampler type in shaders
 /// Texture2D - Standard 2 dimensional texture
 /// TextureCube - Uses texture as a cubemap
@@ -671,7 +688,7 @@ public:
 class FrameBlock
 {
 public:
-  Array<FrameNode> mFrameNodes;
+  Array<FrameNode, RenderFrameAllocator> mFrameNodes;
   RenderQueues* mRenderQueues;
 
   // Space data
@@ -682,8 +699,8 @@ public:
 class ViewBlock
 {
 public:
-  Array<ViewNode> mViewNodes;
-  Array<IndexRange> mRenderGroupRanges;
+  Array<ViewNode, RenderFrameAllocator> mViewNodes;
+  Array<IndexRange, RenderFrameAllocator> mRenderGroupRanges;
 
   // View transforms
   Mat4 mWorldToView;
@@ -13,6 +13,11 @@ AudioContent::AudioContent()
   EditMode = ContentEditMode::ContentItem;
 }
 
+bool AudioContent::CanBuildConcurrently()
+{
+  return true;
+}
+
 ContentItem* MakeAudioContent(ContentInitializer& initializer)
 {
   AudioContent* content = new AudioContent();
@@ -82,10 +87,16 @@ void SoundBuilder::BuildContent(BuildOptions& options)
     AudioFileEncoder::WriteFile(status, destFile, audioFile, mNormalize, mMaxVolume);
 
     if (status.Failed())
-      DoNotifyWarning("Error Processing Audio File", status.Message);
+    {
+      options.Failure = true;
+      options.Message = status.Message;
+    }
   }
   else
-    DoNotifyWarning("Error Processing Audio File", status.Message);
+  {
+    options.Failure = true;
+    options.Message = status.Message;
+  }
 }
 
 bool SoundBuilder::NeedsBuilding(BuildOptions& options)
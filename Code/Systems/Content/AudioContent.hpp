@@ -21,6 +21,9 @@ public:
   RaverieDeclareType(AudioContent, TypeCopyMode::ReferenceType);
 
   AudioContent();
+
+  // Content Item Interface
+  bool CanBuildConcurrently() override;
 };
 
 const String SoundExtension = ".snd";
@@ -364,10 +364,11 @@ unsigned AudioFileEncoder::Resample(unsigned fileSampleRate, unsigned channels,
 
     // Delete the buffer of input data
     delete[] buffersPerChannel[i];
-    // Set the buffer to the data in the array
-    buffersPerChannel[i] = newSamples.Data();
-    // Release the data from the array
-    newSamples.ReleaseData();
+    // Copy the resampled data into a buffer that can be deleted the same way
+    // (the array's memory belongs to its allocator)
+    buffersPerChannel[i] = new float[newFrames];
+    memcpy(buffersPerChannel[i], newSamples.Data(), sizeof(float) * newFrames);
+    newSamples.Clear();
   }
 
   return newFrames;
@@ -17,6 +17,9 @@ public:
 
   // Any Content Item Failed?
   bool Failure = false;
+  // Build regardless of file times (the content's hash changed since it was
+  // last built).
+  bool ForceBuild = false;
 
   String OutputPath;
   String SourcePath;
@@ -0,0 +1,263 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+// Holds the time an entry was last used, which is what eviction goes by
+static const String cLastUsedFile = "LastUsed";
+static const String cTemporaryExtension = ".tmp";
+// Temporary directories this old were left behind by a process that stopped
+// part way through storing an entry
+static const TimeType cStaleTemporarySeconds = 60 * 60;
+
+static void GetOutputFiles(ContentItem* contentItem, Array<String>& files)
+{
+  ResourceListing listing;
+  contentItem->BuildListing(listing);
+  forRange (ResourceEntry& entry, listing.All())
+  {
+    if (!entry.Location.Empty())
+      files.PushBack(entry.Location);
+  }
+}
+
+static bool CopyFileAndParents(StringParam dest, StringParam source)
+{
+  String directory = FilePath::GetDirectoryPath(dest);
+  if (!directory.Empty() && !DirectoryExists(directory))
+    CreateDirectoryAndParents(directory);
+  return CopyFile(dest, source);
+}
+
+ContentArtifactCache::ContentArtifactCache(StringParam directory, u64 maxSizeInBytes) :
+    mDirectory(directory),
+    mVersion(BuildString("Version-", GetRevisionNumberString(), "-", GetChangeSetString())),
+    mMaxSize(maxSizeInBytes),
+    mStored(false)
+{
+}
+
+bool ContentArtifactCache::IsEnabled()
+{
+  return !mDirectory.Empty();
+}
+
+bool ContentArtifactCache::Contains(StringParam key)
+{
+  if (!IsEnabled())
+    return false;
+
+  return DirectoryExists(GetEntryPath(key));
+}
+
+bool ContentArtifactCache::Fetch(StringParam key, ContentItem* contentItem, StringParam outputPath)
+{
+  if (!IsEnabled())
+    return false;
+
+  String entryPath = GetEntryPath(key);
+  if (!DirectoryExists(entryPath))
+    return false;
+
+  Array<String> files;
+  GetOutputFiles(contentItem, files);
+  if (files.Empty())
+    return false;
+
+  forRange (String& file, files.All())
+  {
+    if (!FileExists(FilePath::Combine(entryPath, file)))
+      return false;
+  }
+
+  forRange (String& file, files.All())
+  {
+    if (!CopyFileAndParents(FilePath::Combine(outputPath, file), FilePath::Combine(entryPath, file)))
+      return false;
+  }
+
+  MarkUsed(entryPath, Time::GetTime());
+  return true;
+}
+
+void ContentArtifactCache::Store(StringParam key, ContentItem* contentItem, StringParam outputPath)
+{
+  if (!IsEnabled())
+    return;
+
+  String entryPath = GetEntryPath(key);
+  if (DirectoryExists(entryPath))
+    return;
+
+  Array<String> files;
+  GetOutputFiles(contentItem, files);
+  if (files.Empty())
+    return;
+
+  // Copy into a temporary directory and move it into place once it's
+  // complete so other processes sharing the cache never see half an entry
+  String temporaryPath = BuildString(entryPath, ".", ToString(GenerateUniqueId64()), cTemporaryExtension);
+  CreateDirectoryAndParents(temporaryPath);
+
+  forRange (String& file, files.All())
+  {
+    String sourceFile = FilePath::Combine(outputPath, file);
+    if (!FileExists(sourceFile) || !CopyFileAndParents(FilePath::Combine(temporaryPath, file), sourceFile))
+    {
+      DeleteDirectory(temporaryPath);
+      return;
+    }
+  }
+
+  MarkUsed(temporaryPath, Time::GetTime());
+
+  // Another process may have stored the same entry in the meantime
+  if (DirectoryExists(entryPath) || !MoveFile(entryPath, temporaryPath))
+  {
+    DeleteDirectory(temporaryPath);
+    return;
+  }
+
+  mStored = true;
+}
+
+void ContentArtifactCache::Trim()
+{
+  if (!IsEnabled() || !mStored)
+    return;
+
+  ProfileScopeFunction();
+  mStored = false;
+
+  struct Entry
+  {
+    String mPath;
+    TimeType mLastUsed;
+    u64 mSize;
+  };
+
+  Array<Entry> entries;
+  Array<String> staleTemporaries;
+  TimeType now = Time::GetTime();
+  u64 totalSize = 0;
+  for (FileRange range(mDirectory); !range.Empty(); range.PopFront())
+  {
+    String entryPath = FilePath::Combine(mDirectory, range.Front());
+    if (!DirectoryExists(entryPath))
+      continue;
+
+    // Recent temporaries may still be being written by another process
+    if (FilePath::GetExtension(entryPath) == "tmp")
+    {
+      if (now - GetFileModifiedTime(entryPath) > cStaleTemporarySeconds)
+        staleTemporaries.PushBack(entryPath);
+      continue;
+    }
+
+    Entry& entry = entries.PushBack();
+    entry.mPath = entryPath;
+    entry.mLastUsed = GetLastUsed(entryPath);
+    entry.mSize = 0;
+    for (FileRange files(entryPath); !files.Empty(); files.PopFront())
+      entry.mSize += files.FrontEntry().mSize;
+
+    totalSize += entry.mSize;
+  }
+
+  forRange (String& temporaryPath, staleTemporaries.All())
+    DeleteDirectory(temporaryPath);
+
+  if (totalSize <= mMaxSize)
+    return;
+
+  Sort(entries.All(), [](const Entry& a, const Entry& b) { return a.mLastUsed < b.mLastUsed; });
+
+  uint evicted = 0;
+  for (uint i = 0; i < entries.Size() && totalSize > mMaxSize; ++i)
+  {
+    DeleteDirectory(entries[i].mPath);
+    totalSize -= entries[i].mSize;
+    ++evicted;
+  }
+
+  ZPrint("Evicted %u entries from the content artifact cache '%s'\n", evicted, mDirectory.c_str());
+}
+
+String ContentArtifactCache::GetEntryPath(StringParam key)
+{
+  // Builders can output something different for the same content in another
+  // engine version, so entries are only shared between matching versions
+  Sha1Builder builder;
+  builder.Append(mVersion);
+  builder.Append(key);
+  return FilePath::Combine(mDirectory, builder.OutputHashString());
+}
+
+void ContentArtifactCache::MarkUsed(StringParam entryPath, TimeType time)
+{
+  // The time is written out rather than taken from the file's modified time
+  // so it doesn't depend on the file system's time resolution
+  String lastUsedFile = FilePath::Combine(entryPath, cLastUsedFile);
+  String text = ToString((s64)time);
+  WriteToFile(lastUsedFile.c_str(), (const byte*)text.Data(), text.SizeInBytes());
+}
+
+TimeType ContentArtifactCache::GetLastUsed(StringParam entryPath)
+{
+  // Entries without a time are evicted first
+  String lastUsedFile = FilePath::Combine(entryPath, cLastUsedFile);
+  if (!FileExists(lastUsedFile))
+    return 0;
+
+  s64 time = 0;
+  ToValue(ReadFileIntoString(lastUsedFile), time);
+  return (TimeType)time;
+}
+
+void ContentArtifactCache::RunUnitTests()
+{
+  ContentCacheTestItem test("ContentArtifactCacheTest");
+  ContentItem* contentItem = test.mItem;
+  String cachePath = FilePath::Combine(test.mPath, "Cache");
+
+  // Every entry is one output file plus its small last used file, the cache
+  // is sized to fit two of them
+  const size_t outputSize = 1000;
+  Array<String> files;
+  GetOutputFiles(contentItem, files);
+  ErrorIf(files.Empty(), "A text item should output a file");
+  test.WriteOutput(files.Front(), String::Repeat('a', outputSize));
+
+  ContentArtifactCache disabled(String(), 0);
+  disabled.Store("A", contentItem, test.mOutputPath);
+  ErrorIf(disabled.Contains("A"), "An empty directory should disable the cache");
+
+  ContentArtifactCache cache(cachePath, outputSize * 5 / 2);
+  ErrorIf(cache.Fetch("A", contentItem, test.mOutputPath), "Nothing has been stored yet");
+
+  cache.Store("A", contentItem, test.mOutputPath);
+  cache.Store("B", contentItem, test.mOutputPath);
+  ErrorIf(!cache.Fetch("A", contentItem, test.mOutputPath), "A was stored");
+
+  // Trimming under the limit keeps everything
+  cache.Trim();
+  ErrorIf(!cache.Contains("A") || !cache.Contains("B"), "Two entries fit in the cache");
+
+  // Order the uses explicitly, A was used after B
+  cache.Store("C", contentItem, test.mOutputPath);
+  cache.MarkUsed(cache.GetEntryPath("A"), 200);
+  cache.MarkUsed(cache.GetEntryPath("B"), 100);
+  cache.MarkUsed(cache.GetEntryPath("C"), 300);
+  cache.Trim();
+  ErrorIf(!cache.Contains("A"), "A was used after B");
+  ErrorIf(cache.Contains("B"), "B was the least recently used entry");
+  ErrorIf(!cache.Contains("C"), "C was just stored");
+
+  // Nothing was stored since the last trim, so this does nothing
+  cache.MarkUsed(cache.GetEntryPath("A"), 0);
+  cache.Trim();
+  ErrorIf(!cache.Contains("A") || !cache.Contains("C"), "Trim should only run after a store");
+}
+
+} // namespace Raverie
@@ -0,0 +1,53 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// A store of built content shared by every checkout on the machine. Each
+/// entry is a directory named after a hash of a content key (see
+/// ContentBuildCache) and the engine version, holding the files a content item
+/// output when it was built, so a library in any checkout of the same version
+/// can copy the outputs instead of building the same asset again. Entries are
+/// evicted least recently used first once the store is over its size limit.
+class ContentArtifactCache
+{
+public:
+  /// An empty directory disables the cache.
+  ContentArtifactCache(StringParam directory, u64 maxSizeInBytes);
+
+  bool IsEnabled();
+
+  /// Is there an entry for the key?
+  bool Contains(StringParam key);
+
+  /// Copies the outputs stored for the key into the output path. Returns false
+  /// if there is no entry or it is missing any file the item lists.
+  bool Fetch(StringParam key, ContentItem* contentItem, StringParam outputPath);
+
+  /// Copies the files the item listed from the output path into a new entry.
+  void Store(StringParam key, ContentItem* contentItem, StringParam outputPath);
+
+  /// Removes the least recently used entries until the cache fits in its
+  /// size limit, along with temporary directories left behind by stores that
+  /// never finished. Only does anything if an entry was stored since the last
+  /// trim.
+  void Trim();
+
+  /// Stores entries in a temporary directory and checks that trimming evicts
+  /// the least recently used ones.
+  static void RunUnitTests();
+
+private:
+  String GetEntryPath(StringParam key);
+  void MarkUsed(StringParam entryPath, TimeType time);
+  TimeType GetLastUsed(StringParam entryPath);
+
+  String mDirectory;
+  /// Mixed into every key.
+  String mVersion;
+  u64 mMaxSize;
+  bool mStored;
+};
+
+} // namespace Raverie
@@ -0,0 +1,215 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+static const String cBuildCacheFile = "ContentBuildCache.txt";
+// Change this whenever a builder changes what it outputs so every item built
+// by an older version is rebuilt.
+static const String cBuildCacheVersion = "ContentBuildCache 1";
+static const size_t cKeySize = Sha1Builder::Sha1ByteSize * 2;
+
+ContentBuildCache::ContentBuildCache() : mModified(false)
+{
+}
+
+void ContentBuildCache::Load(StringParam outputPath)
+{
+  mOutputPath = outputPath;
+  mKeys.Clear();
+  mModified = false;
+
+  String cacheFile = FilePath::Combine(mOutputPath, cBuildCacheFile);
+  if (!FileExists(cacheFile))
+    return;
+
+  String text = ReadFileIntoString(cacheFile);
+  StringSplitRange lines = text.Split("\n");
+
+  // A cache from another version is thrown away
+  if (lines.Empty() || lines.Front() != cBuildCacheVersion)
+    return;
+
+  for (lines.PopFront(); !lines.Empty(); lines.PopFront())
+  {
+    StringRange line = lines.Front();
+    if (line.SizeInBytes() <= cKeySize + 1)
+      continue;
+
+    String key = line.SubStringFromByteIndices(0, cKeySize);
+    String filename = line.SubStringFromByteIndices(cKeySize + 1, line.SizeInBytes());
+    mKeys.Insert(filename, key);
+  }
+}
+
+void ContentBuildCache::Save()
+{
+  if (!mModified)
+    return;
+
+  StringBuilder builder;
+  builder.Append(cBuildCacheVersion);
+  builder.Append("\n");
+  forRange (auto& entry, mKeys.All())
+  {
+    builder.Append(entry.second);
+    builder.Append(" ");
+    builder.Append(entry.first);
+    builder.Append("\n");
+  }
+
+  String text = builder.ToString();
+  String cacheFile = FilePath::Combine(mOutputPath, cBuildCacheFile);
+  WriteToFile(cacheFile.c_str(), (const byte*)text.Data(), text.SizeInBytes());
+  mModified = false;
+}
+
+String ContentBuildCache::ComputeKey(ContentItem* contentItem)
+{
+  File file;
+  if (!file.Open(contentItem->GetFullPath(), FileMode::Read, FileAccessPattern::Sequential))
+    return String();
+
+  Sha1Builder builder;
+  builder.Append(cBuildCacheVersion);
+  builder.Append(RaverieVirtualTypeId(contentItem)->Name);
+  builder.Append(file);
+  file.Close();
+
+  // The builder settings are hashed from the item in memory rather than the
+  // meta file, so changes that haven't been saved yet are still seen
+  TextSaver saver;
+  saver.OpenBuffer();
+  saver.SerializePolymorphic(*contentItem);
+  builder.Append(saver.GetString());
+
+  return builder.OutputHashString();
+}
+
+bool ContentBuildCache::Contains(ContentItem* contentItem)
+{
+  return mKeys.ContainsKey(contentItem->Filename);
+}
+
+bool ContentBuildCache::IsUpToDate(ContentItem* contentItem, StringParam key)
+{
+  String* storedKey = mKeys.FindPointer(contentItem->Filename);
+  if (storedKey == nullptr || *storedKey != key)
+    return false;
+
+  ResourceListing listing;
+  contentItem->BuildListing(listing);
+  forRange (ResourceEntry& entry, listing.All())
+  {
+    if (!entry.Location.Empty() && !FileExists(FilePath::Combine(mOutputPath, entry.Location)))
+      return false;
+  }
+
+  return true;
+}
+
+void ContentBuildCache::Store(ContentItem* contentItem, StringParam key)
+{
+  String& storedKey = mKeys[contentItem->Filename];
+  if (storedKey != key)
+  {
+    storedKey = key;
+    mModified = true;
+  }
+}
+
+void ContentBuildCache::Remove(ContentItem* contentItem)
+{
+  if (mKeys.Erase(contentItem->Filename))
+    mModified = true;
+}
+
+static void WriteTestFile(StringParam path, StringParam text)
+{
+  WriteToFile(path.c_str(), (const byte*)text.Data(), text.SizeInBytes());
+}
+
+ContentCacheTestItem::ContentCacheTestItem(StringParam testName)
+{
+  mPath = FilePath::Combine(GetTemporaryDirectory(), testName);
+  if (DirectoryExists(mPath))
+    DeleteDirectory(mPath);
+
+  mLibrary.Name = testName;
+  mLibrary.SourcePath = FilePath::Combine(mPath, "Source");
+  mOutputPath = FilePath::Combine(mPath, "Output");
+  CreateDirectoryAndParents(mLibrary.SourcePath);
+  CreateDirectoryAndParents(mOutputPath);
+
+  ContentInitializer initializer;
+  initializer.Name = "Test";
+  initializer.Filename = "Test.txt";
+  initializer.Extension = "txt";
+  initializer.Library = &mLibrary;
+  mItem = Z::gContentSystem->CreatorsByExtension["txt"].MakeItem(initializer);
+  mItem->mLibrary = &mLibrary;
+  WriteSource("First");
+}
+
+ContentCacheTestItem::~ContentCacheTestItem()
+{
+  delete mItem;
+  DeleteDirectory(mPath);
+}
+
+void ContentCacheTestItem::WriteSource(StringParam text)
+{
+  WriteTestFile(mItem->GetFullPath(), text);
+}
+
+void ContentCacheTestItem::WriteOutput(StringParam file, StringParam text)
+{
+  WriteTestFile(FilePath::Combine(mOutputPath, file), text);
+}
+
+void ContentBuildCache::RunUnitTests()
+{
+  ContentCacheTestItem test("ContentBuildCacheTest");
+  ContentItem* contentItem = test.mItem;
+
+  ContentBuildCache cache;
+  cache.Load(test.mOutputPath);
+  String key = ComputeKey(contentItem);
+  ErrorIf(key.Empty(), "A text item should have a key");
+  ErrorIf(ComputeKey(contentItem) != key, "The same content should hash to the same key");
+  ErrorIf(cache.Contains(contentItem), "Nothing has been stored yet");
+  ErrorIf(cache.IsUpToDate(contentItem, key), "Nothing has been stored yet");
+
+  // A stored key only hits once the outputs exist
+  cache.Store(contentItem, key);
+  ErrorIf(!cache.Contains(contentItem), "The key was stored");
+  ErrorIf(cache.IsUpToDate(contentItem, key), "The output file hasn't been written");
+
+  ResourceListing listing;
+  contentItem->BuildListing(listing);
+  forRange (ResourceEntry& entry, listing.All())
+    test.WriteOutput(entry.Location, "Output");
+  ErrorIf(!cache.IsUpToDate(contentItem, key), "The key and outputs match");
+
+  // The keys survive a save and load
+  cache.Save();
+  ContentBuildCache loadedCache;
+  loadedCache.Load(test.mOutputPath);
+  ErrorIf(!loadedCache.IsUpToDate(contentItem, key), "The saved key should still hit");
+
+  // Changing the content misses even though the outputs still exist
+  test.WriteSource("Second");
+  String changedKey = ComputeKey(contentItem);
+  ErrorIf(changedKey == key, "Different content should hash to a different key");
+  ErrorIf(loadedCache.IsUpToDate(contentItem, changedKey), "The content changed");
+
+  // Changing it back hits again
+  test.WriteSource("First");
+  ErrorIf(!loadedCache.IsUpToDate(contentItem, ComputeKey(contentItem)), "The content is the same as when it was stored");
+
+  loadedCache.Remove(contentItem);
+  ErrorIf(loadedCache.Contains(contentItem), "The key was removed");
+}
+
+} // namespace Raverie
@@ -0,0 +1,65 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// Remembers a key for every content item built into a library's output
+/// folder. The key is a hash of everything that goes into building the item
+/// (the bytes of the source file and the item's builder settings), so an item
+/// whose key hasn't changed and whose output files still exist doesn't need to
+/// be built again no matter what the file times say, and an item whose key did
+/// change is rebuilt even if its source file looks older than its output.
+class ContentBuildCache
+{
+public:
+  ContentBuildCache();
+
+  /// Loads the keys saved in the given output folder (if there are any).
+  void Load(StringParam outputPath);
+  /// Saves the keys back to the output folder they were loaded from.
+  void Save();
+
+  /// Hashes the source file and the builder settings of a content item. Must
+  /// be called on the main thread (it serializes the item). Returns an empty
+  /// string if the item can't be cached (it has no source file).
+  static String ComputeKey(ContentItem* contentItem);
+
+  /// Is there any key stored for the item?
+  bool Contains(ContentItem* contentItem);
+  /// Is the stored key for the item the same as the given key and do all the
+  /// files the item outputs exist?
+  bool IsUpToDate(ContentItem* contentItem, StringParam key);
+
+  void Store(ContentItem* contentItem, StringParam key);
+  void Remove(ContentItem* contentItem);
+
+  /// Builds a text item in a temporary directory and checks that the cache
+  /// only hits while the content and its outputs are unchanged.
+  static void RunUnitTests();
+
+private:
+  String mOutputPath;
+  /// Content item file name to key.
+  HashMap<String, String> mKeys;
+  bool mModified;
+};
+
+/// A text content item in its own library under a temporary directory, for
+/// the content cache unit tests. The directory is deleted along with it.
+class ContentCacheTestItem
+{
+public:
+  ContentCacheTestItem(StringParam testName);
+  ~ContentCacheTestItem();
+
+  void WriteSource(StringParam text);
+  void WriteOutput(StringParam file, StringParam text);
+
+  String mPath;
+  String mOutputPath;
+  ContentLibrary mLibrary;
+  ContentItem* mItem;
+};
+
+} // namespace Raverie
@@ -198,6 +198,16 @@ void ContentItem::BuildContentItem(bool useJob)
   ProfileScopeFunctionArgs(Filename);
   BuildOptions options(mLibrary);
   BuildContentItem(options);
+  FinishBuild();
+}
+
+bool ContentItem::CanBuildConcurrently()
+{
+  return false;
+}
+
+void ContentItem::FinishBuild()
+{
 }
 
 void ContentItem::BuildListing(ResourceListing& listing)
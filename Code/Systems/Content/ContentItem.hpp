@@ -94,6 +94,14 @@ public:
   // libarary.
   void BuildContentItem(bool useJob);
 
+  // Can this item be built on a job thread? Only items whose builders read
+  // their own source and write their own output files can.
+  virtual bool CanBuildConcurrently();
+
+  // Called on the main thread after the content item has been built for any
+  // work that can't be done while building on a job thread.
+  virtual void FinishBuild();
+
   // Build the resource listing that this content item makes
   virtual void BuildListing(ResourceListing& listing);
 
@@ -117,6 +125,8 @@ public:
   virtual void OnInitialize();
 
 protected:
+  friend class ContentSystem;
+
   // Build the content item
   virtual void BuildContentItem(BuildOptions& buildOptions) = 0;
 };
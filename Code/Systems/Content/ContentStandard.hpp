@@ -31,6 +31,8 @@ public:
 #include "ContentItem.hpp"
 #include "ContentLibrary.hpp"
 #include "BuildOptions.hpp"
+#include "ContentBuildCache.hpp"
+#include "ContentArtifactCache.hpp"
 #include "ContentSystem.hpp"
 #include "ContentUtility.hpp"
 #include "ContentComposition.hpp"
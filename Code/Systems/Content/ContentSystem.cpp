@@ -77,6 +77,7 @@ ContentSystem::ContentSystem()
 {
   mHistoryEnabled = true;
   mIdCount = 0;
+  ArtifactCacheMaxSize = 0;
 
   // some special load order dependencies
   LoadOrderMap["FontDefinition"] = 5;
@@ -228,7 +229,7 @@ HandleOf<ResourcePackage> ContentSystem::BuildLibrary(Status& status, ContentLib
   Array<ContentItem*> items;
   items.Reserve(library->ContentItems.Size());
   items.Append(library->ContentItems.Values());
-  HandleOf<ResourcePackage> package = Z::gContentSystem->BuildContentItems(status, items, library, false);
+  HandleOf<ResourcePackage> package = Z::gContentSystem->BuildContentItems(status, items, library, true);
 
   String libraryPackageFile = FilePath::CombineWithExtension(outputPath, library->Name, ".pack");
   package->Save(libraryPackageFile);
@@ -683,36 +684,135 @@ HandleOf<ResourcePackage> ContentSystem::BuildContentItems(Status& status, Conte
 
   BuildOptions buildOptions(library);
 
-  bool allBuilt = true;
-
-  for (uint i = 0; i < toBuild.Size(); ++i)
+  ContentBuildCache cache;
+  cache.Load(package->Location);
+  ContentArtifactCache artifactCache(ArtifactCachePath, ArtifactCacheMaxSize);
+
+  // Work out what needs building on the main thread. Every item gets its own
+  // options so items building at the same time don't share failures.
+  uint itemCount = toBuild.Size();
+  Array<BuildOptions> itemOptions;
+  itemOptions.Reserve(itemCount);
+  Array<String> keys;
+  keys.Resize(itemCount);
+  Array<uint> serialItems;
+  Array<uint> concurrentItems;
+  Array<bool> built;
+  built.Resize(itemCount, false);
+  uint upToDateCount = 0;
+  uint fetchedCount = 0;
+
+  for (uint i = 0; i < itemCount; ++i)
   {
-    // Process from this contentItem down.
     ContentItem* contentItem = toBuild[i];
-    static const String cProcessing("Processing");
-    Z::gEngine->LoadingUpdate(cProcessing, library->Name, contentItem->Filename, ProgressType::Normal, (float)(i + 1) / toBuild.Size());
+    itemOptions.PushBack(buildOptions);
+    BuildOptions& options = itemOptions.Back();
+
+    keys[i] = ContentBuildCache::ComputeKey(contentItem);
+    if (!keys[i].Empty() && cache.Contains(contentItem))
+    {
+      if (cache.IsUpToDate(contentItem, keys[i]))
+      {
+        ++upToDateCount;
+        continue;
+      }
+
+      // The content changed since it was last built, so the file times
+      // (which may have gone backwards) can't be trusted
+      options.ForceBuild = true;
+    }
+
+    // Another checkout may have already built the same content
+    if (!keys[i].Empty() && artifactCache.Fetch(keys[i], contentItem, package->Location))
+    {
+      ++fetchedCount;
+      continue;
+    }
+
+    built[i] = true;
+    if (useJobs && contentItem->CanBuildConcurrently())
+      concurrentItems.PushBack(i);
+    else
+      serialItems.PushBack(i);
+  }
+
+  static const String cProcessing("Processing");
+  uint buildCount = serialItems.Size() + concurrentItems.Size();
+  uint processed = 0;
+
+  forRange (uint index, serialItems.All())
+  {
+    ContentItem* contentItem = toBuild[index];
+    ++processed;
+    Z::gEngine->LoadingUpdate(cProcessing, library->Name, contentItem->Filename, ProgressType::Normal, (float)processed / buildCount);
+
+    contentItem->BuildContentItem(itemOptions[index]);
+  }
+
+  // Build the independent items in batches of one item per thread so progress
+  // can still be reported between batches
+  uint batchSize = Math::Max(Z::gJobs->GetThreadCount(), 1u);
+  for (uint batchStart = 0; batchStart < concurrentItems.Size(); batchStart += batchSize)
+  {
+    uint batchEnd = Math::Min(batchStart + batchSize, concurrentItems.Size());
+    ContentItem* firstItem = toBuild[concurrentItems[batchStart]];
+    processed += batchEnd - batchStart;
+    Z::gEngine->LoadingUpdate(cProcessing, library->Name, firstItem->Filename, ProgressType::Normal, (float)processed / buildCount);
 
-    contentItem->BuildContentItem(useJobs);
+    auto buildRange = [&](uint begin, uint end) {
+      for (uint i = begin; i < end; ++i)
+      {
+        uint index = concurrentItems[i];
+        toBuild[index]->BuildContentItem(itemOptions[index]);
+      }
+    };
+    Z::gJobs->ParallelFor(batchStart, batchEnd, 1, buildRange);
+  }
+
+  if (upToDateCount != 0 || fetchedCount != 0)
+  {
+    ZPrint("Content library '%s': %u of %u items were up to date, %u were copied from the artifact cache\n",
+           library->Name.c_str(),
+           upToDateCount,
+           itemCount,
+           fetchedCount);
+  }
 
-    if (buildOptions.Failure)
+  for (uint i = 0; i < itemCount; ++i)
+  {
+    ContentItem* contentItem = toBuild[i];
+    BuildOptions& options = itemOptions[i];
+
+    // A failed item is reported on its own, it doesn't fail the library (which
+    // would stop the rest of its content from loading)
+    if (options.Failure)
+    {
+      ZPrint("Content Build Failed, %s\n", options.Message.c_str());
+      DoNotifyWarning(BuildString("Failed to build ", contentItem->Filename), options.Message);
+      cache.Remove(contentItem);
+    }
+    else if (!keys[i].Empty())
     {
-      ZPrint("Content Build Failed, %s\n", buildOptions.Message.c_str());
-      buildOptions.Failure = false;
-      buildOptions.Message = String();
-      allBuilt = false;
+      cache.Store(contentItem, keys[i]);
     }
 
+    contentItem->FinishBuild();
     contentItem->BuildListing(package->Resources);
 
+    // Items that changed their own meta file while building can't be shared,
+    // fetching the outputs wouldn't bring the meta changes along
+    if (built[i] && !options.Failure && !keys[i].Empty() && !contentItem->mNeedsEditorProcessing)
+      artifactCache.Store(keys[i], contentItem, package->Location);
+
     // Don't do this in the thread (do it after).
     if (contentItem->mNeedsEditorProcessing)
       package->EditorProcessing.PushBack(contentItem);
   }
 
-  Sort(package->Resources.All(), SortByLoadOrder());
+  cache.Save();
+  artifactCache.Trim();
 
-  if (!allBuilt)
-    status.SetFailed(String::Format("Failed to build content library '%s'", library->Name.c_str()));
+  Sort(package->Resources.All(), SortByLoadOrder());
 
   Z::gEngine->LoadingFinish();
   return package;
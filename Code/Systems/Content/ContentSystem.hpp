@@ -191,6 +191,9 @@ public:
   String PrebuiltContentPath;
   /// Where the tools (curl, crash handler, etc) are located
   String ToolPath;
+  /// Built content shared between checkouts. Empty disables the cache.
+  String ArtifactCachePath;
+  u64 ArtifactCacheMaxSize;
 
   HashSet<ContentItemId> mModifiedContentItems;
 
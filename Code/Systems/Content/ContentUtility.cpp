@@ -15,6 +15,9 @@ bool NeedToBuild(StringParam source, StringParam destination)
 
 bool NeedToBuild(BuildOptions& options, StringParam source, StringParam destination)
 {
+  if (options.ForceBuild)
+    return true;
+
   int fileCmp = CheckFileTime(destination, source);
 
   // destination is older
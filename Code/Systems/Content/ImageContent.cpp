@@ -21,7 +21,15 @@ void ImageContent::BuildContentItem(BuildOptions& options)
     if (bc->NeedsBuilding(options))
       bc->BuildContent(options);
   }
+}
 
+bool ImageContent::CanBuildConcurrently()
+{
+  return true;
+}
+
+void ImageContent::FinishBuild()
+{
   if (mReload)
   {
     ClearComponents();
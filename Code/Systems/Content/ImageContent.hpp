@@ -13,6 +13,8 @@ public:
   ImageContent();
 
   void BuildContentItem(BuildOptions& options) override;
+  bool CanBuildConcurrently() override;
+  void FinishBuild() override;
 
   bool mReload;
 };
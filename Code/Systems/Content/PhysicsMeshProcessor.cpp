@@ -99,7 +99,7 @@ void PhysicsMeshProcessor::WriteAabbTree(VertexPositionArray& vertices, IndexArr
 {
   // Build the Aabb-Tree
   StaticAabbTree<uint> aabbTree;
-  aabbTree.SetPartitionMethod(PartitionMethods::MinimizeVolumeSum);
+  aabbTree.SetPartitionMethod(PartitionMethods::BinnedSurfaceArea);
 
   // Dummy proxy. They will not be needed.
   BroadPhaseProxy proxy;
@@ -143,6 +143,10 @@ template <typename ResourceMananger>
 class BinaryDataFileLoader : public GenericDataLoader<ResourceMananger, DataFileFormat::Binary>
 {
 public:
+  bool CanLoadOnDemand() override
+  {
+    return true;
+  }
 };
 
 template <typename ResourceMananger, typename LoadPattern>
@@ -192,6 +196,11 @@ public:
 
     resource->SendModified();
   }
+
+  bool CanLoadOnDemand() override
+  {
+    return true;
+  }
 };
 
 } // namespace Raverie
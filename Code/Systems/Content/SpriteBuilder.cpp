@@ -82,10 +82,14 @@ RaverieDefineType(SpriteData, builder, type)
   type->AddAttribute(ObjectAttributes::cHidden);
 }
 
-bool SpriteSourceBuilder::NeedsBuilding(BuildOptions& options)
+void SpriteSourceBuilder::Initialize(ContentComposition* item)
 {
-  mOwner->EditMode = ContentEditMode::ResourceObject;
+  DirectBuilderComponent::Initialize(item);
+  item->EditMode = ContentEditMode::ResourceObject;
+}
 
+bool SpriteSourceBuilder::NeedsBuilding(BuildOptions& options)
+{
   return DirectBuilderComponent::NeedsBuilding(options);
 }
 
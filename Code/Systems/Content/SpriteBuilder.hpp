@@ -68,6 +68,7 @@ public:
   void SetBottom(int value);
 
   // BuilderComponent Interface
+  void Initialize(ContentComposition* item) override;
   void Generate(ContentInitializer& initializer) override;
   void BuildContent(BuildOptions& buildOptions) override;
   bool NeedsBuilding(BuildOptions& options) override;
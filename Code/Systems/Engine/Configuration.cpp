@@ -63,6 +63,9 @@ void ContentConfig::Serialize(Serializer& stream)
   SerializeNameDefault(ToolsDirectory, String());
   SerializeNameDefault(LibraryDirectories, LibraryDirectories);
   SerializeNameDefault(HistoryEnabled, true);
+  SerializeNameDefault(ArtifactCacheDirectory, String());
+  SerializeNameDefault(ArtifactCacheEnabled, false);
+  SerializeNameDefault(ArtifactCacheSizeMb, 4096u);
 }
 
 RaverieDefineType(UserConfig, builder, type)
@@ -95,6 +95,15 @@ public:
   Array<String> LibraryDirectories;
   /// History stores files instead of deleting them
   bool HistoryEnabled;
+  /// Built content is shared between every checkout on the machine through
+  /// this directory (defaults to ArtifactCache in the user's documents).
+  String ArtifactCacheDirectory;
+  /// Store and reuse built content in the artifact cache. Off by default as
+  /// the cache can take up to ArtifactCacheSizeMb of disk space.
+  bool ArtifactCacheEnabled;
+  /// The least recently used built content is removed once the artifact
+  /// cache grows past this many megabytes.
+  uint ArtifactCacheSizeMb;
 };
 
 /// Configuration component that Contains developer settings. Used to indicate a
@@ -162,6 +162,9 @@ void Engine::Update()
 
     ++mFrameCounter;
   }
+
+  // Everything allocated from the frame arenas two frames ago is reclaimed
+  Memory::ResetFrameArenas();
 }
 
 void Engine::Terminate()
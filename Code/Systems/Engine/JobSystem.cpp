@@ -4,6 +4,23 @@
 namespace Raverie
 {
 
+// How many times a waiting thread checks for work before it starts giving up
+// its time slice, and how many before it sleeps between checks
+static const uint cWaitSpinCount = 64;
+static const uint cWaitYieldCount = 1024;
+
+// Called by a thread waiting on other threads each time it found nothing to
+// help out with, so a long wait doesn't burn a whole core
+static void BackOff(uint& idleCount)
+{
+  ++idleCount;
+  if (idleCount < cWaitSpinCount)
+    return;
+
+  // Sleeping for zero only yields to other runnable threads
+  Os::Sleep(idleCount < cWaitYieldCount ? 0 : 1);
+}
+
 RaverieDefineType(Job, builder, type)
 {
 }
@@ -36,17 +53,103 @@ namespace Z
 JobSystem* gJobs = nullptr;
 }
 
-JobSystem::JobSystem()
+// The job system worker that belongs to the current thread (null if the thread
+// was not created by, or registered with, the job system).
+static RaverieThreadLocal JobWorker* sCurrentWorker = nullptr;
+
+JobTaskDeque::JobTaskDeque() : mTop(0), mBottom(0)
+{
+}
+
+bool JobTaskDeque::Push(JobTask* task)
+{
+  s64 bottom = AtomicLoad(&mBottom);
+  s64 top = AtomicLoad(&mTop);
+  if (bottom - top >= cCapacity)
+    return false;
+
+  AtomicStore((void* volatile*)&mTasks[bottom & (cCapacity - 1)], task);
+  AtomicStore(&mBottom, bottom + 1);
+  return true;
+}
+
+JobTask* JobTaskDeque::Pop()
+{
+  s64 bottom = AtomicLoad(&mBottom) - 1;
+  AtomicStore(&mBottom, bottom);
+  s64 top = AtomicLoad(&mTop);
+
+  // The deque was already empty.
+  if (top > bottom)
+  {
+    AtomicStore(&mBottom, top);
+    return nullptr;
+  }
+
+  JobTask* task = (JobTask*)AtomicLoad((void* volatile*)&mTasks[bottom & (cCapacity - 1)]);
+  if (top != bottom)
+    return task;
+
+  // This is the last task, so we're racing against any thieves for it.
+  if (!AtomicCompareExchange(&mTop, top + 1, top))
+    task = nullptr;
+  AtomicStore(&mBottom, top + 1);
+  return task;
+}
+
+JobTask* JobTaskDeque::Steal()
+{
+  s64 top = AtomicLoad(&mTop);
+  s64 bottom = AtomicLoad(&mBottom);
+  if (top >= bottom)
+    return nullptr;
+
+  JobTask* task = (JobTask*)AtomicLoad((void* volatile*)&mTasks[top & (cCapacity - 1)]);
+  if (!AtomicCompareExchange(&mTop, top + 1, top))
+    return nullptr;
+  return task;
+}
+
+bool JobTaskDeque::Empty()
+{
+  return AtomicLoad(&mTop) >= AtomicLoad(&mBottom);
+}
+
+JobWorker::JobWorker() : mJobSystem(nullptr), mNextTask(0), mIndex(0), mThread(nullptr)
+{
+  for (uint i = 0; i < JobTaskDeque::cCapacity; ++i)
+    mTaskRing[i].mActive = 0;
+}
+
+JobSystem::JobSystem() : mSleepingWorkers(0), mShuttingDown(false)
 {
+  // The main thread owns the first worker so it can queue and help run tasks.
+  JobWorker* mainWorker = new JobWorker();
+  mainWorker->mJobSystem = this;
+  mWorkers.PushBack(mainWorker);
+  sCurrentWorker = mainWorker;
+
   if (ThreadingEnabled)
   {
-    mWorkers.Resize(10);
+    // One worker per remaining core. Jobs may block for long periods of time,
+    // so always keep a couple of workers around even on small machines.
+    uint workerCount = Math::Max(Os::GetProcessorCount(), 3u) - 1;
+
+    for (uint i = 0; i < workerCount; ++i)
+    {
+      JobWorker* worker = new JobWorker();
+      worker->mJobSystem = this;
+      worker->mIndex = mWorkers.Size();
+      mWorkers.PushBack(worker);
+    }
 
-    for (uint i = 0; i < mWorkers.Size(); ++i)
+    // Start the threads only once every worker exists since any of them may
+    // immediately try to steal from the others.
+    for (uint i = 1; i < mWorkers.Size(); ++i)
     {
-      mWorkers[i] = new Thread();
-      Thread& thread = *mWorkers[i];
-      thread.Initialize(&Thread::ObjectEntryCreator<JobSystem, &JobSystem::WorkerThreadEntry>, this, "Background");
+      mWorkers[i]->mThread = new Thread();
+      Thread& thread = *mWorkers[i]->mThread;
+      thread.Initialize(&JobSystem::WorkerThreadEntry, mWorkers[i], "Background");
     }
   }
 }
@@ -64,16 +167,17 @@ JobSystem::~JobSystem()
   mPendingJobs.Clear();
   mLock.Unlock();
 
-  // Increment the counter but push no jobs
-  // allowing each background thread to unblock.
-  for (uint i = 0; i < mWorkers.Size(); ++i)
-    mJobCounter.Increment();
+  // Wake every background thread so that it sees the shutdown flag.
+  mShuttingDown = true;
+  for (uint i = 1; i < mWorkers.Size(); ++i)
+    mWorkSignal.Increment();
 
   // Wait for each thread to shutdown.
-  for (uint i = 0; i < mWorkers.Size(); ++i)
+  for (uint i = 1; i < mWorkers.Size(); ++i)
   {
-    Thread& thread = *mWorkers[i];
+    Thread& thread = *mWorkers[i]->mThread;
     thread.WaitForCompletion();
+    delete mWorkers[i]->mThread;
   }
 
   // Clear all active jobs now that all threads have stopped (may release the
@@ -83,7 +187,10 @@ JobSystem::~JobSystem()
   mActiveJobs.Clear();
   mLock.Unlock();
 
-  // Delete all threads.
+  if (sCurrentWorker == mWorkers[0])
+    sCurrentWorker = nullptr;
+
+  // Delete all workers.
   DeleteObjectsInContainer(mWorkers);
 }
 
@@ -128,12 +235,31 @@ bool JobSystem::AreAllJobsCompleted()
   return completed;
 }
 
-OsInt JobSystem::WorkerThreadEntry()
+OsInt JobSystem::WorkerThreadEntry(void* userData)
+{
+  JobWorker* worker = (JobWorker*)userData;
+  sCurrentWorker = worker;
+  worker->mJobSystem->RunWorker();
+  sCurrentWorker = nullptr;
+  return 0;
+}
+
+void JobSystem::RunWorker()
 {
-  for (;;)
+  while (!mShuttingDown)
   {
-    if (!RunOneJob())
-      return 0;
+    // Fine grained tasks always take priority over long running jobs.
+    if (RunOneTask())
+      continue;
+    if (RunOneJob())
+      continue;
+
+    // Announce that we're going to sleep before checking for work one last
+    // time. Anyone adding work after this point will see us and signal.
+    ++mSleepingWorkers;
+    if (!HasWork() && !mShuttingDown)
+      mWorkSignal.WaitAndDecrement();
+    --mSleepingWorkers;
   }
 }
 
@@ -152,17 +278,13 @@ void JobSystem::AddJob(Job* job)
   ++job->mRunCount;
   mLock.Unlock();
 
-  // Signal that a job has been added, which will unblock the waiting workers.
-  mJobCounter.Increment();
+  // Signal that a job has been added, which will unblock a waiting worker.
+  WakeWorkers(1);
 }
 
 bool JobSystem::RunOneJob()
 {
-  mJobCounter.WaitAndDecrement();
   Job* job = GetNextJob();
-
-  // No jobs and Semaphore release
-  // that means we are shutting down.
   if (job == nullptr)
     return false;
 
@@ -192,4 +314,167 @@ void JobSystem::JobComplete(Job* job)
     RunJob(job);
 }
 
+void JobSystem::AddTask(JobRangeFunction function, void* userData, uint begin, uint end, JobCounter* counter)
+{
+  JobWorker* worker = GetCurrentWorker();
+  if (!ThreadingEnabled || worker == nullptr)
+  {
+    function(userData, begin, end);
+    return;
+  }
+
+  if (counter)
+    ++counter->mCount;
+
+  JobTask* task = AllocateTask(worker);
+  task->mFunction = function;
+  task->mUserData = userData;
+  task->mBegin = begin;
+  task->mEnd = end;
+  task->mCounter = counter;
+
+  // The ring and deque are the same size, so an allocated task always fits.
+  worker->mDeque.Push(task);
+  WakeWorkers(1);
+}
+
+void JobSystem::WaitForCounter(JobCounter& counter)
+{
+  uint idleCount = 0;
+  while (!counter.IsComplete())
+  {
+    // Help out instead of blocking, the counter may depend on tasks that are
+    // sitting in our own deque.
+    if (RunOneTask())
+      idleCount = 0;
+    else
+      BackOff(idleCount);
+  }
+}
+
+void JobSystem::ParallelFor(uint begin, uint end, uint grainSize, JobRangeFunction function, void* userData)
+{
+  if (begin >= end)
+    return;
+
+  grainSize = Math::Max(grainSize, 1u);
+  JobWorker* worker = GetCurrentWorker();
+  if (!ThreadingEnabled || worker == nullptr || end - begin <= grainSize)
+  {
+    function(userData, begin, end);
+    return;
+  }
+
+  JobCounter counter;
+  uint taskCount = 0;
+  for (uint rangeBegin = begin; rangeBegin < end; rangeBegin += grainSize)
+  {
+    JobTask* task = AllocateTask(worker);
+    task->mFunction = function;
+    task->mUserData = userData;
+    task->mBegin = rangeBegin;
+    task->mEnd = Math::Min(rangeBegin + grainSize, end);
+    task->mCounter = &counter;
+    ++counter.mCount;
+    worker->mDeque.Push(task);
+    ++taskCount;
+
+    // Avoid overflow when the range ends near the maximum value of a uint.
+    if (end - rangeBegin <= grainSize)
+      break;
+  }
+
+  WakeWorkers(taskCount);
+  WaitForCounter(counter);
+}
+
+uint JobSystem::GetThreadCount()
+{
+  return mWorkers.Size();
+}
+
+bool JobSystem::RunOneTask()
+{
+  JobWorker* worker = GetCurrentWorker();
+  if (worker == nullptr)
+    return false;
+
+  JobTask* task = worker->mDeque.Pop();
+
+  // Our own deque is empty, try to steal from everyone else starting with our
+  // neighbor so that thieves spread out across the victims.
+  for (uint i = 1; task == nullptr && i < mWorkers.Size(); ++i)
+  {
+    JobWorker* victim = mWorkers[(worker->mIndex + i) % mWorkers.Size()];
+    task = victim->mDeque.Steal();
+  }
+
+  if (task == nullptr)
+    return false;
+
+  RunTask(task);
+  return true;
+}
+
+void JobSystem::RunTask(JobTask* task)
+{
+  task->mFunction(task->mUserData, task->mBegin, task->mEnd);
+
+  JobCounter* counter = task->mCounter;
+  // The owner may reuse the task as soon as it is no longer active, so
+  // everything must be read out of the task before this point.
+  AtomicStore(&task->mActive, 0);
+
+  if (counter)
+    --counter->mCount;
+}
+
+JobTask* JobSystem::AllocateTask(JobWorker* worker)
+{
+  JobTask* task = &worker->mTaskRing[worker->mNextTask];
+  worker->mNextTask = (worker->mNextTask + 1) % JobTaskDeque::cCapacity;
+
+  // If the ring wrapped around onto a task that is still outstanding, help run
+  // tasks until it completes rather than overwrite it.
+  uint idleCount = 0;
+  while (AtomicLoad(&task->mActive) != 0)
+  {
+    if (RunOneTask())
+      idleCount = 0;
+    else
+      BackOff(idleCount);
+  }
+
+  task->mActive = 1;
+  return task;
+}
+
+JobWorker* JobSystem::GetCurrentWorker()
+{
+  return sCurrentWorker;
+}
+
+bool JobSystem::HasWork()
+{
+  for (uint i = 0; i < mWorkers.Size(); ++i)
+  {
+    if (!mWorkers[i]->mDeque.Empty())
+      return true;
+  }
+
+  mLock.Lock();
+  bool hasJobs = !mPendingJobs.Empty();
+  mLock.Unlock();
+  return hasJobs;
+}
+
+void JobSystem::WakeWorkers(uint count)
+{
+  // Only pay for the semaphore when someone is actually asleep.
+  uint sleeping = (uint)Math::Max(mSleepingWorkers.Load(), 0);
+  count = Math::Min(count, sleeping);
+  for (uint i = 0; i < count; ++i)
+    mWorkSignal.Increment();
+}
+
 } // namespace Raverie
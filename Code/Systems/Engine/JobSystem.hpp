@@ -46,6 +46,79 @@ private:
   size_t mRunCount;
 };
 
+/// Counts outstanding tasks so that work can depend on other work finishing.
+/// Every task added with a counter increments it and decrements it once run.
+class JobCounter
+{
+public:
+  JobCounter() : mCount(0)
+  {
+  }
+
+  bool IsComplete() const
+  {
+    return mCount.Load() == 0;
+  }
+
+  Atomic<s32> mCount;
+};
+
+/// A function run by a task over the index range [begin, end).
+typedef void (*JobRangeFunction)(void* userData, uint begin, uint end);
+
+/// A lightweight unit of work. Tasks are not reference counted or heap
+/// allocated, they live in a ring owned by the thread that created them.
+struct JobTask
+{
+  JobRangeFunction mFunction;
+  void* mUserData;
+  uint mBegin;
+  uint mEnd;
+  JobCounter* mCounter;
+  // Set while the task is queued or running so the ring slot is not reused.
+  volatile s32 mActive;
+};
+
+/// Fixed capacity work-stealing deque (Chase-Lev). Only the owning thread may
+/// Push and Pop (from the bottom), any thread may Steal (from the top).
+class JobTaskDeque
+{
+public:
+  static const s64 cCapacity = 4096;
+
+  JobTaskDeque();
+
+  // Returns false if the deque is full.
+  bool Push(JobTask* task);
+  JobTask* Pop();
+  JobTask* Steal();
+  bool Empty();
+
+private:
+  volatile s64 mTop;
+  volatile s64 mBottom;
+  JobTask* volatile mTasks[cCapacity];
+};
+
+class JobSystem;
+
+/// Per thread state of the job system (the main thread and every worker).
+class JobWorker
+{
+public:
+  JobWorker();
+
+  JobSystem* mJobSystem;
+  JobTaskDeque mDeque;
+  // Tasks are allocated round robin from this ring. The ring is the same size
+  // as the deque so the deque can never overflow.
+  JobTask mTaskRing[JobTaskDeque::cCapacity];
+  uint mNextTask;
+  uint mIndex;
+  // Null for the main thread.
+  Thread* mThread;
+};
+
 class JobSystem : public EventObject
 {
 public:
@@ -57,7 +130,8 @@ public:
   // Add's a job to be worked on (can be called from any thread).
   // Note that a job can be queued up again after it completes.
   void AddJob(Job* job);
-  OsInt WorkerThreadEntry();
+  // Entry point of every worker thread (the user data is the JobWorker).
+  static OsInt WorkerThreadEntry(void* userData);
 
   // Runs until a slice of time is taken (only when ThreadingEnabled is false).
   // Returns false if there is no work to be done.
@@ -66,7 +140,37 @@ public:
 
   bool AreAllJobsCompleted();
 
+  // Queues a task that runs function over [begin, end). If a counter is given
+  // it is incremented now and decremented when the task completes. Only the
+  // main thread and worker threads can queue tasks, on any other thread (or
+  // when threading is disabled) the task runs immediately.
+  void AddTask(JobRangeFunction function, void* userData, uint begin, uint end, JobCounter* counter);
+
+  // Runs other tasks until the counter reaches zero.
+  void WaitForCounter(JobCounter& counter);
+
+  // Splits [begin, end) into ranges of at most grainSize, runs them across all
+  // workers and returns once every range has completed. The calling thread
+  // helps execute tasks while it waits.
+  void ParallelFor(uint begin, uint end, uint grainSize, JobRangeFunction function, void* userData);
+
+  // Same as above for any functor/lambda callable as functor(begin, end).
+  template <typename FunctorType>
+  void ParallelFor(uint begin, uint end, uint grainSize, const FunctorType& functor)
+  {
+    ParallelFor(begin, end, grainSize, &ParallelForThunk<FunctorType>, const_cast<FunctorType*>(&functor));
+  }
+
+  // The number of threads that execute tasks (workers plus the main thread).
+  uint GetThreadCount();
+
 private:
+  template <typename FunctorType>
+  static void ParallelForThunk(void* userData, uint begin, uint end)
+  {
+    (*(const FunctorType*)userData)(begin, end);
+  }
+
   // Takes a job from the job queue and runs it.
   // If no jobs are available, this will return false.
   bool RunOneJob();
@@ -75,11 +179,27 @@ private:
 
   void JobComplete(Job* job);
 
+  // Runs tasks and jobs on a worker thread until the system shuts down.
+  void RunWorker();
+
+  // Pops a task from this thread's deque (or steals one) and runs it.
+  // Returns false if no task could be found.
+  bool RunOneTask();
+  void RunTask(JobTask* task);
+  JobTask* AllocateTask(JobWorker* worker);
+  JobWorker* GetCurrentWorker();
+  bool HasWork();
+  void WakeWorkers(uint count);
+
   ThreadLock mLock;
   Array<HandleOf<Job>> mPendingJobs;
   Array<HandleOf<Job>> mActiveJobs;
-  Array<Thread*> mWorkers;
-  Semaphore mJobCounter;
+  // Index 0 is the main thread, the rest are worker threads.
+  Array<JobWorker*> mWorkers;
+  // Signaled when work is added and workers are sleeping.
+  Semaphore mWorkSignal;
+  Atomic<s32> mSleepingWorkers;
+  Atomic<bool> mShuttingDown;
   Job* GetNextJob();
   friend class Job;
 };
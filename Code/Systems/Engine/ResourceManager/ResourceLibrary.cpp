@@ -321,6 +321,8 @@ void ResourceLibrary::Unload()
 {
   ErrorIf(!Dependents.Empty(), "Cannot unload a Resource Library when other libraries depend on us");
 
+  Z::gResources->RemoveOnDemandEntries(this);
+
   // Call unload on every resource so that references to other resources within
   // the library can be cleared.
   forRange (Resource* resource, Resources.All())
@@ -170,6 +170,7 @@ void ResourceManager::AddResource(ResourceEntry& entry, Resource* resource)
 
 void ResourceManager::AddLoader(StringParam name, ResourceLoader* loader)
 {
+  loader->mManager = this;
   Z::gResources->AddLoader(name, loader);
 }
 
@@ -224,6 +225,9 @@ void ResourceManager::EnumerateResources(Array<String>& values)
 
 void ResourceManager::EnumerateResources(Array<Resource*>& values)
 {
+  // Everything is being asked for, so nothing can wait any longer
+  Z::gResources->LoadAllOnDemand(this);
+
   forRange (Resource* resource, AllResources())
     values.PushBack(resource);
 }
@@ -272,7 +276,7 @@ Resource* ResourceManager::GetResource(StringParam resourceString, ResourceNotFo
   ResourceId resourceId = ResourceNameMap.FindValue(resourceString, 0);
   if (resourceId)
   {
-    Resource* resource = ResourceIdMap.FindValue(resourceId, NULL);
+    Resource* resource = FindResource(resourceId);
     if (resource)
       return resource;
   }
@@ -297,7 +301,7 @@ Resource* ResourceManager::GetResource(StringParam resourceString, ResourceNotFo
 Resource* ResourceManager::GetResource(ResourceId resourceId, ResourceNotFound::Enum notFound)
 {
   // Try the id
-  Resource* resource = ResourceIdMap.FindValue(resourceId, nullptr);
+  Resource* resource = FindResource(resourceId);
   if (resource)
     return resource;
 
@@ -323,9 +327,17 @@ Resource* ResourceManager::GetDefaultResource()
   return GetResourceByName(DefaultResourceName);
 }
 
+Resource* ResourceManager::FindResource(ResourceId resourceId)
+{
+  Resource* resource = ResourceIdMap.FindValue(resourceId, nullptr);
+  if (resource == nullptr && resourceId != 0)
+    resource = Z::gResources->LoadOnDemand(resourceId, this);
+  return resource;
+}
+
 Resource* ResourceManager::GetResourceById(ResourceId id)
 {
-  Resource* resource = ResourceIdMap.FindValue(id, nullptr);
+  Resource* resource = FindResource(id);
   if (resource == nullptr)
     return GetFallbackResource();
   else
@@ -375,7 +387,7 @@ Resource* ResourceManager::GetFallbackResource()
 Resource* ResourceManager::GetResourceNameOrId(StringRange resourceName, ResourceId resourceId)
 {
   // Try the resource Id
-  Resource* resource = ResourceIdMap.FindValue(resourceId, nullptr);
+  Resource* resource = FindResource(resourceId);
   if (resource)
     return resource;
 
@@ -384,7 +396,7 @@ Resource* ResourceManager::GetResourceNameOrId(StringRange resourceName, Resourc
 
   // Either name was not found or the id is zero which is never used
   // so just return what was found in the id map
-  return ResourceIdMap.FindValue(resourceId, nullptr);
+  return FindResource(resourceId);
 }
 
 const String cNullResource = "null";
@@ -173,6 +173,8 @@ public:
   void AddResource(ResourceEntry& entry, Resource* resource);
 
 private:
+  // Finds a loaded resource or loads it if it's waiting to be loaded on demand.
+  Resource* FindResource(ResourceId resourceId);
   Resource* GetResourceNameOrId(StringRange name, ResourceId resourceId);
   Resource* GetResourceById(ResourceId id);
   Resource* GetResourceByName(StringParam name);
@@ -198,6 +200,16 @@ public:
   {
     return nullptr;
   }
+  // Can resources from this loader be registered when their package is loaded
+  // and only loaded the first time they are looked up? Only loaders of plain
+  // data that nothing else is built from at load time (like scripts) should.
+  virtual bool CanLoadOnDemand()
+  {
+    return false;
+  }
+
+  // The manager this loader was added by.
+  ResourceManager* mManager = nullptr;
 };
 
 // Manager Setup
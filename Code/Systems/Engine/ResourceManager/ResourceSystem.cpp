@@ -27,6 +27,7 @@ RaverieDefineType(ResourceSystem, builder, type)
 
 ResourceSystem::ResourceSystem()
 {
+  mLoadOnDemand = false;
 }
 
 void ResourceSystem::Initialize()
@@ -180,6 +181,10 @@ void ResourceSystem::ReloadPackage(ResourceLibrary* resourceLibrary, ResourcePac
     ResourceEntry& entry = package->Resources[i];
     entry.FullPath = FilePath::Combine(package->Location, entry.Location);
 
+    // A reloaded entry is loaded now even if it was waiting to be loaded on
+    // demand
+    mOnDemandEntries.Erase(entry.mResourceId);
+
     HandleOf<Resource> subResource = ResourceIdMap.FindValue(entry.mResourceId, nullptr);
     if (subResource)
       ReloadEntry(subResource, entry);
@@ -251,7 +256,64 @@ Resource* ResourceSystem::GetResourceByName(StringParam resourceIdAndName)
 
 Resource* ResourceSystem::GetResource(ResourceId resourceId)
 {
-  return ResourceIdMap.FindValue(resourceId, nullptr);
+  Resource* resource = ResourceIdMap.FindValue(resourceId, nullptr);
+  if (resource == nullptr && !mOnDemandEntries.Empty())
+    resource = LoadOnDemand(resourceId);
+  return resource;
+}
+
+Resource* ResourceSystem::LoadOnDemand(ResourceId resourceId, ResourceManager* manager)
+{
+  OnDemandEntry* onDemandEntry = mOnDemandEntries.FindPointer(resourceId);
+  if (onDemandEntry == nullptr)
+    return nullptr;
+
+  if (manager != nullptr && onDemandEntry->mManager != manager)
+    return nullptr;
+
+  // Take the entry out first so a lookup while loading can't load it again
+  ResourceEntry entry = onDemandEntry->mEntry;
+  mOnDemandEntries.Erase(resourceId);
+
+  Status status;
+  HandleOf<Resource> resource = LoadEntry(status, entry);
+  if (!resource)
+    return nullptr;
+
+  entry.mLibrary->Add(resource, false);
+  return resource;
+}
+
+void ResourceSystem::LoadAllOnDemand(ResourceManager* manager)
+{
+  Array<ResourceId> resourceIds;
+  forRange (OnDemandMapType::pair& pair, mOnDemandEntries.All())
+  {
+    if (pair.second.mManager == manager)
+      resourceIds.PushBack(pair.first);
+  }
+
+  forRange (ResourceId resourceId, resourceIds.All())
+    LoadOnDemand(resourceId, manager);
+}
+
+void ResourceSystem::RemoveOnDemandEntries(ResourceLibrary* library)
+{
+  Array<ResourceId> resourceIds;
+  forRange (OnDemandMapType::pair& pair, mOnDemandEntries.All())
+  {
+    if (pair.second.mEntry.mLibrary == library)
+      resourceIds.PushBack(pair.first);
+  }
+
+  forRange (ResourceId resourceId, resourceIds.All())
+  {
+    OnDemandEntry& onDemandEntry = mOnDemandEntries[resourceId];
+    ResourceManager* manager = onDemandEntry.mManager;
+    if (manager->ResourceNameMap.FindValue(onDemandEntry.mEntry.Name, 0) == resourceId)
+      manager->ResourceNameMap.Erase(onDemandEntry.mEntry.Name);
+    mOnDemandEntries.Erase(resourceId);
+  }
 }
 
 void ResourceSystem::LoadIntoLibrary(Status& status, ResourceLibrary* resourceLibrary, ResourcePackage* resourcePackage, bool isNew)
@@ -273,6 +335,20 @@ void ResourceSystem::LoadIntoLibrary(Status& status, ResourceLibrary* resourceLi
 
     entry.FullPath = FilePath::Combine(resourcePackage->Location, entry.Location);
 
+    // Register the resource's name now and load it the first time it's used
+    if (mLoadOnDemand && !isNew)
+    {
+      ResourceLoader* loader = mLoaderMap.FindValue(entry.Type, nullptr);
+      if (loader != nullptr && loader->mManager != nullptr && loader->CanLoadOnDemand() && FileExists(entry.FullPath))
+      {
+        OnDemandEntry& onDemandEntry = mOnDemandEntries[entry.mResourceId];
+        onDemandEntry.mEntry = entry;
+        onDemandEntry.mManager = loader->mManager;
+        loader->mManager->ResourceNameMap[entry.Name] = entry.mResourceId;
+        continue;
+      }
+    }
+
     Status entryStatus;
     HandleOf<Resource> resource = LoadEntry(entryStatus, entry);
     if (!entryStatus)
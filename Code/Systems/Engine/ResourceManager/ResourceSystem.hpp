@@ -66,6 +66,15 @@ public:
 
   void LoadIntoLibrary(Status& status, ResourceLibrary* resourceLibrary, ResourcePackage* resourcePackage, bool isNew);
 
+  // Loads a resource that was registered to be loaded on demand. If a manager
+  // is given, only a resource of that manager is loaded. Returns null if there
+  // is no such resource waiting to be loaded.
+  Resource* LoadOnDemand(ResourceId resourceId, ResourceManager* manager = nullptr);
+  // Loads every resource of the manager that is waiting to be loaded.
+  void LoadAllOnDemand(ResourceManager* manager);
+  // Forgets the resources of a library that were never loaded.
+  void RemoveOnDemandEntries(ResourceLibrary* library);
+
   ResourceLibrary* GetResourceLibraryFromCurrentType(BoundType* currentType);
 
   void SetupDefaults();
@@ -73,6 +82,21 @@ public:
   // Resources that were modified in the editor.
   HashSet<ResourceId> mModifiedResources;
 
+  // When set, resources whose loader allows it are only registered when their
+  // package is loaded and are loaded the first time they are looked up (by
+  // id, name or handle). Startup then only pays for what is actually used.
+  bool mLoadOnDemand;
+
+  struct OnDemandEntry
+  {
+    ResourceEntry mEntry;
+    ResourceManager* mManager;
+  };
+
+  // Resources that are registered but not loaded yet.
+  typedef HashMap<ResourceId, OnDemandEntry> OnDemandMapType;
+  OnDemandMapType mOnDemandEntries;
+
   // Map of resource library names to resource libraries
   typedef OrderedHashMap<String, ResourceLibrary*> LoadedSetMap;
   LoadedSetMap LoadedResourceLibraries;
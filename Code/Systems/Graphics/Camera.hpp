@@ -101,6 +101,10 @@ public:
   // Needed by GraphicsSpace to access graphical entries.
   Array<uint> mRenderGroupCounts;
   Array<IndexRange> mGraphicalIndexRanges;
+  // Per aabb in the GraphicsSpace's culling set, if it is inside this
+  // Camera's frustum.
+  Array<byte> mCullingResults;
+  Frustum mCullingFrustum;
 
   Array<uint> mRenderTaskRangeIndices;
   bool mRenderQueuesDataNeeded;
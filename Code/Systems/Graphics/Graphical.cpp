@@ -168,6 +168,11 @@ String Graphical::GetDefaultMaterialName()
   return MaterialManager::GetInstance()->DefaultResourceName;
 }
 
+bool Graphical::IsExtractionThreadSafe()
+{
+  return false;
+}
+
 bool Graphical::GetVisible()
 {
   return mVisible;
@@ -295,6 +300,7 @@ void Graphical::UpdateBroadPhaseAabb()
     data.mAabb = GetWorldAabb();
 
     mGraphicsSpace->mBroadPhase.UpdateProxy(mProxy, data);
+    mGraphicsSpace->mCullingSet.Update(this, data.mAabb);
   }
 }
 
@@ -65,6 +65,11 @@ public:
   virtual bool TestFrustum(const Frustum& frustum, CastInfo& castInfo);
   virtual void AddToSpace();
   virtual String GetDefaultMaterialName();
+  // If extraction only writes to the given nodes (and never to the shared
+  // buffers on RenderQueues) it may be run on worker threads. The world matrix
+  // of mTransform is cached before then, anything else that caches on read
+  // must not be touched.
+  virtual bool IsExtractionThreadSafe();
 
   // Properties
 
@@ -137,6 +142,8 @@ public:
 
   Link<Graphical> SpaceLink;
   BroadPhaseProxy mProxy;
+  // Index into the GraphicsSpace's culling set, only valid while mProxy is.
+  uint mCullingIndex;
   Transform* mTransform;
   GraphicsSpace* mGraphicsSpace;
 
@@ -247,11 +247,7 @@ void CollectShaders(RenderTasks* renderTasks, RenderQueues* renderQueues, Array<
 
 void GraphicsEngine::Update(bool debugger)
 {
-  // Do not try to run rendering while this job is going.
-  if (ThreadingEnabled)
-    return;
-
-  // Do any deferred tasks
+  // Do any deferred tasks (the renderer thread handles these when threaded)
   if (!ThreadingEnabled)
   {
     RendererThreadMain(mRendererJobQueue);
@@ -320,6 +316,10 @@ void GraphicsEngine::Update(bool debugger)
   Swap(mRenderTasksBack, mRenderTasksFront);
   Swap(mRenderQueuesBack, mRenderQueuesFront);
 
+  // The renderer is done with these queues, clear them now since their frame
+  // memory is reclaimed when the frame arenas are reset at the end of this frame
+  mRenderQueuesBack->Clear();
+
   // pass everything to the renderer, all rendering happens on this job
   mDoRenderTasksJob->mRenderTasks = mRenderTasksFront;
   mDoRenderTasksJob->mRenderQueues = mRenderQueuesFront;
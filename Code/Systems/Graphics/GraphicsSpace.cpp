@@ -75,6 +75,7 @@ void GraphicsSpace::RemoveGraphical(Graphical* graphical)
   if (graphical->mProxy.ToVoidPointer() != nullptr)
   {
     mBroadPhase.RemoveProxy(graphical->mProxy);
+    mCullingSet.Remove(graphical);
     graphical->mProxy = BroadPhaseProxy();
   }
 }
@@ -123,6 +124,7 @@ void GraphicsSpace::OnFrameUpdate(float frameDt)
       data.mClientData = &graphical;
       data.mAabb = graphical.GetWorldAabb();
       mBroadPhase.CreateProxy(graphical.mProxy, data);
+      mCullingSet.Add(&graphical, data.mAabb);
     }
   }
 
@@ -134,6 +136,8 @@ void GraphicsSpace::OnFrameUpdate(float frameDt)
   uint renderGroupCount = mGraphicsEngine->GetRenderGroupCount();
   ErrorIf(renderGroupCount == 0, "No render groups, core resources must be missing.");
 
+  CullCameras();
+
   // for each view object in use
   forRange (Camera& camera, mCameras.All())
   {
@@ -151,10 +155,14 @@ void GraphicsSpace::OnFrameUpdate(float frameDt)
     Mat3 rotation = Math::ToMatrix3(camera.mTransform->GetWorldRotation());
     Vec3 cameraDir = -rotation.BasisZ();
 
-    Frustum frustum = camera.GetFrustum(camera.mViewportInterface->GetAspectRatio());
-
-    // Visibility culled graphicals
-    forRangeBroadphaseTree(GraphicsBroadPhase, mBroadPhase, Frustum, frustum) AddToVisibleGraphicals(*range.Front(), camera, cameraPos, cameraDir, &frustum);
+    // Visibility culled graphicals, added in culling set order so that the
+    // results do not depend on which thread culled them
+    byte* cullingResults = camera.mCullingResults.Data();
+    for (uint i = 0; i < mCullingSet.Size(); ++i)
+    {
+      if (cullingResults[i])
+        AddToVisibleGraphicals(*mCullingSet.mGraphicals[i], camera, cameraPos, cameraDir, &camera.mCullingFrustum);
+    }
 
     // Not culled
     forRange (Graphical& graphical, mGraphicalsNeverCulled.All())
@@ -184,11 +192,11 @@ void GraphicsSpace::OnFrameUpdate(float frameDt)
     // This sort will have all entries correctly organized by RenderGroup
     // If a custom sort is enabled, it can then be re-sorted within that
     // RenderGroup
-    Sort(mVisibleGraphicals.SubRange(start, size));
+    SortGraphicalEntries(mVisibleGraphicals.SubRange(start, size));
 
     // Check for any RenderGroup with a custom sort and find its range of
     // elements
-    for (uint i = 0, rangeStart = 0; i < camera.mRenderGroupCounts.Size(); ++i)
+    for (uint i = 0, rangeStart = start; i < camera.mRenderGroupCounts.Size(); ++i)
     {
       uint rangeEnd = rangeStart + camera.mRenderGroupCounts[i];
 
@@ -199,7 +207,7 @@ void GraphicsSpace::OnFrameUpdate(float frameDt)
         sortEvent.mGraphicalEntries = mVisibleGraphicals.SubRange(rangeStart, rangeEnd - rangeStart);
         sortEvent.mRenderGroup = renderGroup;
         camera.mViewportInterface->SendSortEvent(&sortEvent);
-        Sort(mVisibleGraphicals.SubRange(rangeStart, rangeEnd - rangeStart));
+        SortGraphicalEntries(mVisibleGraphicals.SubRange(rangeStart, rangeEnd - rangeStart));
       }
 
       rangeStart = rangeEnd;
@@ -222,7 +230,7 @@ void GraphicsSpace::RenderQueuesUpdate(RenderTasks& renderTasks, RenderQueues& r
 
   FrameBlock& frameBlock = renderQueues.mFrameBlocks.PushBack();
   frameBlock.mRenderQueues = &renderQueues;
-  Array<FrameNode>& frameNodes = frameBlock.mFrameNodes;
+  Array<FrameNode, RenderFrameAllocator>& frameNodes = frameBlock.mFrameNodes;
 
   // link RenderTasks to FrameBlock
   uint frameBlockIndex = renderQueues.mFrameBlocks.Size() - 1;
@@ -236,152 +244,400 @@ void GraphicsSpace::RenderQueuesUpdate(RenderTasks& renderTasks, RenderQueues& r
 
   uint viewBlockStartIndex = renderQueues.mViewBlocks.Size();
 
-  // for each view object
-  forRange (Camera& camera, mCameras.All())
+  // Every visible entry can make at most one frame node, reserving up front
+  // means the node array is never reallocated while being filled.
+  frameNodes.Reserve(mVisibleGraphicals.Size());
+
   {
-    // if no render tasks associated with this camera, do nothing
-    if (!camera.mRenderQueuesDataNeeded)
-      continue;
-    camera.mRenderQueuesDataNeeded = false;
+    ProfileScopeTree("BuildRenderNodes", "RenderQueuesUpdate", Color::YellowGreen);
 
-    // add view block
-    ViewBlock& viewBlock = renderQueues.mViewBlocks.PushBack();
+    // for each view object
+    forRange (Camera& camera, mCameras.All())
+    {
+      // if no render tasks associated with this camera, do nothing
+      if (!camera.mRenderQueuesDataNeeded)
+        continue;
+      camera.mRenderQueuesDataNeeded = false;
 
-    // link RenderTasks to ViewBlock
-    uint viewBlockIndex = renderQueues.mViewBlocks.Size() - 1;
-    for (uint i = 0; i < camera.mRenderTaskRangeIndices.Size(); ++i)
-      renderTasks.mRenderTaskRanges[camera.mRenderTaskRangeIndices[i]].mViewBlockIndex = viewBlockIndex;
-    camera.mRenderTaskRangeIndices.Clear();
+      // add view block
+      ViewBlock& viewBlock = renderQueues.mViewBlocks.PushBack();
 
-    // get view block data
-    camera.GetViewData(viewBlock);
+      // link RenderTasks to ViewBlock
+      uint viewBlockIndex = renderQueues.mViewBlocks.Size() - 1;
+      for (uint i = 0; i < camera.mRenderTaskRangeIndices.Size(); ++i)
+        renderTasks.mRenderTaskRanges[camera.mRenderTaskRangeIndices[i]].mViewBlockIndex = viewBlockIndex;
+      camera.mRenderTaskRangeIndices.Clear();
 
-    uint totalViewNodesNeeded = 0;
-    Array<IndexRange> groupRanges;
-    size_t indexRangeIndex = 0;
-    IndexRange indexRange(0, 0);
-    if (camera.mGraphicalIndexRanges.Size())
-      indexRange = camera.mGraphicalIndexRanges[indexRangeIndex];
+      // get view block data
+      camera.GetViewData(viewBlock);
 
-    // Setup ranges for accessing RenderGroup entries.
-    for (uint i = 0, rangeStart = 0; i < camera.mRenderGroupCounts.Size(); ++i)
-    {
-      size_t groupCount = camera.mRenderGroupCounts[i];
-      uint rangeEnd = rangeStart;
-
-      // Graphical entries are guaranteed in RenderGroup order within
-      // mGraphicalIndexRanges, but the index ranges do not have to be adjacent
-      // with each other. If the current range is depleted then the RenderGroup
-      // entries are in the next range. This is a loop so that empty ranges in
-      // mGraphicalIndexRanges do not cause problems, even though there aren't
-      // any cases where they should be added.
-      while (indexRange.start + groupCount > indexRange.end)
-      {
-        // This case will never happen unless something is implemented
-        // incorrectly. Setting groupCount to 0 will allow
-        // viewBlock.mRenderGroupRanges to have the correct number of entries,
-        // preventing the renderer from accessing out of bounds.
-        if (indexRangeIndex + 1 >= camera.mGraphicalIndexRanges.Size())
-        {
-          Error("Camera has missing or corrupted index ranges for graphical "
-                "entries.");
-          groupCount = 0;
-          break;
-        }
-        ++indexRangeIndex;
+      uint totalViewNodesNeeded = 0;
+      Array<IndexRange, RenderFrameAllocator> groupRanges;
+      size_t indexRangeIndex = 0;
+      IndexRange indexRange(0, 0);
+      if (camera.mGraphicalIndexRanges.Size())
         indexRange = camera.mGraphicalIndexRanges[indexRangeIndex];
-      }
 
-      // If there are entries for this RenderGroup and this camera's render
-      // tasks are using it. If not used, no unneeded data will be extraced for
-      // these entries.
-      if (groupCount > 0 && camera.mUsedRenderGroupIds.Contains(i))
+      // Setup ranges for accessing RenderGroup entries.
+      for (uint i = 0, rangeStart = 0; i < camera.mRenderGroupCounts.Size(); ++i)
       {
-        rangeEnd += groupCount;
-        totalViewNodesNeeded += groupCount;
-        groupRanges.PushBack(IndexRange(indexRange.start, indexRange.start + groupCount));
-      }
+        size_t groupCount = camera.mRenderGroupCounts[i];
+        uint rangeEnd = rangeStart;
+
+        // Graphical entries are guaranteed in RenderGroup order within
+        // mGraphicalIndexRanges, but the index ranges do not have to be adjacent
+        // with each other. If the current range is depleted then the RenderGroup
+        // entries are in the next range. This is a loop so that empty ranges in
+        // mGraphicalIndexRanges do not cause problems, even though there aren't
+        // any cases where they should be added.
+        while (indexRange.start + groupCount > indexRange.end)
+        {
+          // This case will never happen unless something is implemented
+          // incorrectly. Setting groupCount to 0 will allow
+          // viewBlock.mRenderGroupRanges to have the correct number of entries,
+          // preventing the renderer from accessing out of bounds.
+          if (indexRangeIndex + 1 >= camera.mGraphicalIndexRanges.Size())
+          {
+            Error("Camera has missing or corrupted index ranges for graphical "
+                  "entries.");
+            groupCount = 0;
+            break;
+          }
+          ++indexRangeIndex;
+          indexRange = camera.mGraphicalIndexRanges[indexRangeIndex];
+        }
 
-      indexRange.start += groupCount;
+        // If there are entries for this RenderGroup and this camera's render
+        // tasks are using it. If not used, no unneeded data will be extraced for
+        // these entries.
+        if (groupCount > 0 && camera.mUsedRenderGroupIds.Contains(i))
+        {
+          rangeEnd += groupCount;
+          totalViewNodesNeeded += groupCount;
+          groupRanges.PushBack(IndexRange(indexRange.start, indexRange.start + groupCount));
+        }
 
-      viewBlock.mRenderGroupRanges.PushBack(IndexRange(rangeStart, rangeEnd));
-      rangeStart = rangeEnd;
-    }
+        indexRange.start += groupCount;
 
-    // allocate view nodes
-    viewBlock.mViewNodes.Reserve(totalViewNodesNeeded);
+        viewBlock.mRenderGroupRanges.PushBack(IndexRange(rangeStart, rangeEnd));
+        rangeStart = rangeEnd;
+      }
 
-    // make nodes for every graphical entry
-    forRange (IndexRange& indexRange, groupRanges.All())
-    {
-      uint start = indexRange.start;
-      uint size = indexRange.end - indexRange.start;
-      Array<GraphicalEntry>::range graphicals = mVisibleGraphicals.SubRange(start, size);
+      // allocate view nodes
+      viewBlock.mViewNodes.Reserve(totalViewNodesNeeded);
 
-      // assign references to graphicals in view nodes
-      forRange (GraphicalEntry& entry, graphicals)
+      // make nodes for every graphical entry
+      forRange (IndexRange& indexRange, groupRanges.All())
       {
-        GraphicalEntryData* data = entry.mData;
-        Graphical* graphical = data->mGraphical;
-        ViewNode& viewNode = viewBlock.mViewNodes.PushBack();
-        viewNode.mGraphicalEntry = &entry;
-        viewNode.mRenderGroupId = entry.mRenderGroupId;
-
-        // no frame node made for this entry yet
-        if (data->mFrameNodeIndex == -1)
+        uint start = indexRange.start;
+        uint size = indexRange.end - indexRange.start;
+        Array<GraphicalEntry>::range graphicals = mVisibleGraphicals.SubRange(start, size);
+
+        // assign references to graphicals in view nodes
+        forRange (GraphicalEntry& entry, graphicals)
         {
-          FrameNode& frameNode = frameNodes.PushBack();
-          frameNode.mGraphicalEntry = &entry;
-          data->mFrameNodeIndex = frameNodes.Size() - 1;
+          GraphicalEntryData* data = entry.mData;
+          Graphical* graphical = data->mGraphical;
+          ViewNode& viewNode = viewBlock.mViewNodes.PushBack();
+          viewNode.mGraphicalEntry = &entry;
+          viewNode.mRenderGroupId = entry.mRenderGroupId;
+
+          // no frame node made for this entry yet
+          if (data->mFrameNodeIndex == -1)
+          {
+            FrameNode& frameNode = frameNodes.PushBack();
+            frameNode.mGraphicalEntry = &entry;
+            data->mFrameNodeIndex = frameNodes.Size() - 1;
 
-          // per object shader input overrides
-          frameNode.mShaderInputRange.start = renderTasks.mShaderInputs.Size();
+            // per object shader input overrides
+            frameNode.mShaderInputRange.start = renderTasks.mShaderInputs.Size();
 
-          // from meta properties
-          forRange (PropertyShaderInput& input, graphical->mPropertyShaderInputs.All())
-          {
-            ShaderInputSetValue(input.mShaderInput, input.mMetaProperty->GetValue(input.mComponent));
-            renderTasks.mShaderInputs.PushBack(input.mShaderInput);
-          }
+            // from meta properties
+            forRange (PropertyShaderInput& input, graphical->mPropertyShaderInputs.All())
+            {
+              ShaderInputSetValue(input.mShaderInput, input.mMetaProperty->GetValue(input.mComponent));
+              renderTasks.mShaderInputs.PushBack(input.mShaderInput);
+            }
 
-          // from the graphical interface
-          if (ShaderInputs* shaderInputs = graphical->GetShaderInputs())
-            renderTasks.mShaderInputs.Append(shaderInputs->mShaderInputs.Values());
+            // from the graphical interface
+            if (ShaderInputs* shaderInputs = graphical->GetShaderInputs())
+              renderTasks.mShaderInputs.Append(shaderInputs->mShaderInputs.Values());
 
-          frameNode.mShaderInputRange.end = renderTasks.mShaderInputs.Size();
-        }
+            frameNode.mShaderInputRange.end = renderTasks.mShaderInputs.Size();
+          }
 
-        // assign references to frame nodes in view nodes
-        viewNode.mFrameNodeIndex = data->mFrameNodeIndex;
+          // assign references to frame nodes in view nodes
+          viewNode.mFrameNodeIndex = data->mFrameNodeIndex;
+        }
       }
     }
   }
 
-  // extract frame node data
-  forRange (FrameNode& node, frameNodes.All())
+  ExtractRenderData(frameBlock, renderQueues, viewBlockStartIndex);
+
+  // Waiting to send these events until after render data is collected
+  // to make sure that the list of cameras that are processed for broadphase
+  // is not modified before getting render data.
+  QueueVisibilityEvents(mGraphicals);
+  QueueVisibilityEvents(mGraphicalsNeverCulled);
+  QueueVisibilityEvents(mGraphicalsAlwaysCulled);
+
+  SendVisibilityEvents();
+}
+
+// Aabbs are frustum culled in parallel in blocks of this size.
+static const uint cCullingBlockSize = 1024;
+
+// Shared state for the frustum culling tasks, one task per camera and block.
+struct CameraCulling
+{
+  GraphicalCullingSet* mCullingSet;
+  Array<Camera*, RenderFrameAllocator>* mCameras;
+  uint mBlockCount;
+};
+
+static void CullCamerasRange(void* userData, uint begin, uint end)
+{
+  CameraCulling* culling = (CameraCulling*)userData;
+  GraphicalCullingSet& cullingSet = *culling->mCullingSet;
+
+  for (uint i = begin; i < end; ++i)
+  {
+    Camera* camera = (*culling->mCameras)[i / culling->mBlockCount];
+    uint blockStart = (i % culling->mBlockCount) * cCullingBlockSize;
+    uint blockEnd = Math::Min(blockStart + cCullingBlockSize, cullingSet.Size());
+    cullingSet.Cull(camera->mCullingFrustum, blockStart, blockEnd, camera->mCullingResults.Data());
+  }
+}
+
+void GraphicsSpace::CullCameras()
+{
+  ProfileScopeTree("FrustumCulling", "FrameUpdate", Color::SeaGreen);
+
+  Array<Camera*, RenderFrameAllocator> cameras;
+  forRange (Camera& camera, mCameras.All())
+  {
+    camera.mCullingFrustum = camera.GetFrustum(camera.mViewportInterface->GetAspectRatio());
+    camera.mCullingResults.Resize(mCullingSet.Size());
+    cameras.PushBack(&camera);
+  }
+
+  CameraCulling culling;
+  culling.mCullingSet = &mCullingSet;
+  culling.mCameras = &cameras;
+  culling.mBlockCount = (mCullingSet.Size() + cCullingBlockSize - 1) / cCullingBlockSize;
+
+  Z::gJobs->ParallelFor(0, cameras.Size() * culling.mBlockCount, 1, &CullCamerasRange, &culling);
+}
+
+static u64 GetGraphicalEntrySort(const GraphicalEntry& entry)
+{
+  return entry.mSort;
+}
+
+void GraphicsSpace::SortGraphicalEntries(GraphicalEntryRange entries)
+{
+  // Render group ids and sort values only use some of the key's bytes, which
+  // the radix sort skips, and it is stable so equal keys keep culling order.
+  mSortScratch.Resize(entries.Size());
+  RadixSort(entries, mSortScratch.Data(), &GetGraphicalEntrySort);
+}
+
+// Frame and view nodes are extracted in parallel in ranges of this size.
+static const uint cExtractionGrainSize = 256;
+
+// Shared state for the tasks of one extraction stage.
+struct RenderDataExtraction
+{
+  FrameBlock* mFrameBlock;
+  ViewBlock* mViewBlock;
+  // Per frame node, whether its graphical can be extracted on a worker thread.
+  Array<bool, RenderFrameAllocator>* mThreadSafe;
+};
+
+static void ExtractFrameDataRange(void* userData, uint begin, uint end)
+{
+  RenderDataExtraction* extraction = (RenderDataExtraction*)userData;
+  FrameBlock& frameBlock = *extraction->mFrameBlock;
+  Array<bool, RenderFrameAllocator>& threadSafe = *extraction->mThreadSafe;
+
+  for (uint i = begin; i < end; ++i)
   {
+    if (!threadSafe[i])
+      continue;
+
+    FrameNode& node = frameBlock.mFrameNodes[i];
     ((GraphicalEntry*)node.mGraphicalEntry)->mData->mGraphical->ExtractFrameData(node, frameBlock);
   }
+}
+
+static void ExtractViewDataRange(void* userData, uint begin, uint end)
+{
+  RenderDataExtraction* extraction = (RenderDataExtraction*)userData;
+  FrameBlock& frameBlock = *extraction->mFrameBlock;
+  ViewBlock& viewBlock = *extraction->mViewBlock;
+  Array<bool, RenderFrameAllocator>& threadSafe = *extraction->mThreadSafe;
 
-  // only process view blocks from this graphics space
-  for (uint i = viewBlockStartIndex; i < renderQueues.mViewBlocks.Size(); ++i)
+  for (uint i = begin; i < end; ++i)
   {
-    // extract view node data
-    ViewBlock& viewBlock = renderQueues.mViewBlocks[i];
-    forRange (ViewNode& node, viewBlock.mViewNodes.All())
+    ViewNode& node = viewBlock.mViewNodes[i];
+    if (!threadSafe[node.mFrameNodeIndex])
+      continue;
+
+    ((GraphicalEntry*)node.mGraphicalEntry)->mData->mGraphical->ExtractViewData(node, viewBlock, frameBlock);
+  }
+}
+
+void GraphicsSpace::ExtractRenderData(FrameBlock& frameBlock, RenderQueues& renderQueues, uint viewBlockStartIndex)
+{
+  Array<FrameNode, RenderFrameAllocator>& frameNodes = frameBlock.mFrameNodes;
+
+  // Graphicals that write to shared RenderQueues buffers (streamed vertices,
+  // skinning matrices) are extracted afterwards on this thread, in the same
+  // order as before, so the contents of those buffers stay deterministic.
+  Array<bool, RenderFrameAllocator> threadSafe;
+  threadSafe.Resize(frameNodes.Size());
+  for (uint i = 0; i < frameNodes.Size(); ++i)
+  {
+    Graphical* graphical = ((GraphicalEntry*)frameNodes[i].mGraphicalEntry)->mData->mGraphical;
+    threadSafe[i] = graphical->IsExtractionThreadSafe();
+
+    // A transform caches its world matrix (and its parents') the first time
+    // it's asked for it, allocating from a shared pool, so the cache is filled
+    // in here so that the workers only ever read from it.
+    if (threadSafe[i])
+      graphical->mTransform->GetWorldMatrix();
+  }
+
+  RenderDataExtraction extraction;
+  extraction.mFrameBlock = &frameBlock;
+  extraction.mViewBlock = nullptr;
+  extraction.mThreadSafe = &threadSafe;
+
+  // extract frame node data
+  {
+    ProfileScopeTree("ExtractFrameData", "RenderQueuesUpdate", Color::OliveDrab);
+    Z::gJobs->ParallelFor(0, frameNodes.Size(), cExtractionGrainSize, &ExtractFrameDataRange, &extraction);
+
+    for (uint i = 0; i < frameNodes.Size(); ++i)
     {
-      ((GraphicalEntry*)node.mGraphicalEntry)->mData->mGraphical->ExtractViewData(node, viewBlock, frameBlock);
+      if (threadSafe[i])
+        continue;
+
+      FrameNode& node = frameNodes[i];
+      ((GraphicalEntry*)node.mGraphicalEntry)->mData->mGraphical->ExtractFrameData(node, frameBlock);
     }
   }
 
-  // Waiting to send these events until after render data is collected
-  // to make sure that the list of cameras that are processed for broadphase
-  // is not modified before getting render data.
-  QueueVisibilityEvents(mGraphicals);
-  QueueVisibilityEvents(mGraphicalsNeverCulled);
-  QueueVisibilityEvents(mGraphicalsAlwaysCulled);
+  // View nodes read from their frame node, so every frame node must be
+  // extracted before starting on the view nodes.
+  {
+    ProfileScopeTree("ExtractViewData", "RenderQueuesUpdate", Color::DarkSeaGreen);
 
-  SendVisibilityEvents();
+    // only process view blocks from this graphics space
+    for (uint i = viewBlockStartIndex; i < renderQueues.mViewBlocks.Size(); ++i)
+    {
+      // extract view node data
+      ViewBlock& viewBlock = renderQueues.mViewBlocks[i];
+      extraction.mViewBlock = &viewBlock;
+      Z::gJobs->ParallelFor(0, viewBlock.mViewNodes.Size(), cExtractionGrainSize, &ExtractViewDataRange, &extraction);
+
+      forRange (ViewNode& node, viewBlock.mViewNodes.All())
+      {
+        if (threadSafe[node.mFrameNodeIndex])
+          continue;
+
+        ((GraphicalEntry*)node.mGraphicalEntry)->mData->mGraphical->ExtractViewData(node, viewBlock, frameBlock);
+      }
+    }
+  }
+}
+
+void GraphicalCullingSet::Add(Graphical* graphical, const Aabb& aabb)
+{
+  graphical->mCullingIndex = mGraphicals.Size();
+  mGraphicals.PushBack(graphical);
+  mMinX.PushBack(aabb.mMin.x);
+  mMinY.PushBack(aabb.mMin.y);
+  mMinZ.PushBack(aabb.mMin.z);
+  mMaxX.PushBack(aabb.mMax.x);
+  mMaxY.PushBack(aabb.mMax.y);
+  mMaxZ.PushBack(aabb.mMax.z);
+}
+
+void GraphicalCullingSet::Update(Graphical* graphical, const Aabb& aabb)
+{
+  uint index = graphical->mCullingIndex;
+  mMinX[index] = aabb.mMin.x;
+  mMinY[index] = aabb.mMin.y;
+  mMinZ[index] = aabb.mMin.z;
+  mMaxX[index] = aabb.mMax.x;
+  mMaxY[index] = aabb.mMax.y;
+  mMaxZ[index] = aabb.mMax.z;
+}
+
+void GraphicalCullingSet::Remove(Graphical* graphical)
+{
+  // Move the last entry into the removed slot
+  uint index = graphical->mCullingIndex;
+  uint last = mGraphicals.Size() - 1;
+
+  mGraphicals[index] = mGraphicals[last];
+  mGraphicals[index]->mCullingIndex = index;
+  mMinX[index] = mMinX[last];
+  mMinY[index] = mMinY[last];
+  mMinZ[index] = mMinZ[last];
+  mMaxX[index] = mMaxX[last];
+  mMaxY[index] = mMaxY[last];
+  mMaxZ[index] = mMaxZ[last];
+
+  mGraphicals.PopBack();
+  mMinX.PopBack();
+  mMinY.PopBack();
+  mMinZ.PopBack();
+  mMaxX.PopBack();
+  mMaxY.PopBack();
+  mMaxZ.PopBack();
+}
+
+uint GraphicalCullingSet::Size()
+{
+  return mGraphicals.Size();
+}
+
+void GraphicalCullingSet::Cull(const Frustum& frustum, uint begin, uint end, byte* results)
+{
+  const Vec4* planes = frustum.GetIntersectionData();
+
+  uint i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    uint mask = Intersection::AabbFrustumApproximation4(&mMinX[i], &mMinY[i], &mMinZ[i], &mMaxX[i], &mMaxY[i], &mMaxZ[i], planes);
+    results[i + 0] = mask & 1;
+    results[i + 1] = (mask >> 1) & 1;
+    results[i + 2] = (mask >> 2) & 1;
+    results[i + 3] = (mask >> 3) & 1;
+  }
+
+  if (i == end)
+    return;
+
+  // Pad the remaining aabbs out to a full set of four by repeating the last one
+  float minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+  for (uint j = 0; j < 4; ++j)
+  {
+    uint index = Math::Min(i + j, end - 1);
+    minX[j] = mMinX[index];
+    minY[j] = mMinY[index];
+    minZ[j] = mMinZ[index];
+    maxX[j] = mMaxX[index];
+    maxY[j] = mMaxY[index];
+    maxZ[j] = mMaxZ[index];
+  }
+
+  uint mask = Intersection::AabbFrustumApproximation4(minX, minY, minZ, maxX, maxY, maxZ, planes);
+  for (uint j = 0; i < end; ++i, ++j)
+    results[i] = (mask >> j) & 1;
 }
 
 void GraphicsSpace::AddToVisibleGraphicals(Graphical& graphical, Camera& camera, Vec3 cameraPos, Vec3 cameraDir, Frustum* frustum)
@@ -27,6 +27,30 @@ class RaycastResultList;
 
 typedef AvlDynamicAabbTree<Graphical*> GraphicsBroadPhase;
 
+/// World aabbs of all view culled Graphicals stored as a structure of arrays so
+/// that cameras can test four of them against their frustum at once. Kept in
+/// sync with the broad phase, which is still used for raycasts.
+class GraphicalCullingSet
+{
+public:
+  void Add(Graphical* graphical, const Aabb& aabb);
+  void Update(Graphical* graphical, const Aabb& aabb);
+  void Remove(Graphical* graphical);
+  uint Size();
+
+  /// Sets results[i] to 1 for every aabb in [begin, end) that is not outside of
+  /// the frustum and to 0 otherwise.
+  void Cull(const Frustum& frustum, uint begin, uint end, byte* results);
+
+  Array<Graphical*> mGraphicals;
+  Array<float> mMinX;
+  Array<float> mMinY;
+  Array<float> mMinZ;
+  Array<float> mMaxX;
+  Array<float> mMaxY;
+  Array<float> mMaxZ;
+};
+
 /// Core space component that manages all interactions between graphics related
 /// objects.
 class GraphicsSpace : public Component
@@ -53,6 +77,15 @@ public:
 
   void RenderTasksUpdate(RenderTasks& renderTasks);
   void RenderQueuesUpdate(RenderTasks& renderTasks, RenderQueues& renderQueues);
+  // Runs ExtractFrameData/ExtractViewData for all nodes made by this space,
+  // thread safe graphicals are extracted across the job system.
+  void ExtractRenderData(FrameBlock& frameBlock, RenderQueues& renderQueues, uint viewBlockStartIndex);
+
+  // Frustum culls mCullingSet for every camera across the job system, the
+  // results are written to each camera's mCullingResults.
+  void CullCameras();
+  // Sorts entries by their sort value without comparisons.
+  void SortGraphicalEntries(GraphicalEntryRange entries);
 
   void AddToVisibleGraphicals(Graphical& graphical, Camera& camera, Vec3 cameraPos, Vec3 cameraDir, Frustum* frustum = nullptr);
   void CreateDebugGraphicals();
@@ -90,8 +123,10 @@ public:
   void SendVisibilityEvents();
 
   GraphicsBroadPhase mBroadPhase;
+  GraphicalCullingSet mCullingSet;
 
   Array<GraphicalEntry> mVisibleGraphicals;
+  Array<GraphicalEntry> mSortScratch;
 
   Array<uint> mRenderTaskRangeIndices;
 
@@ -73,6 +73,11 @@ bool Model::TestFrustum(const Frustum& frustum, CastInfo& castInfo)
   return mMesh->TestFrustum(localFrustum);
 }
 
+bool Model::IsExtractionThreadSafe()
+{
+  return true;
+}
+
 Mesh* Model::GetMesh()
 {
   return mMesh;
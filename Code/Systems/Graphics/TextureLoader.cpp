@@ -95,4 +95,9 @@ HandleOf<Resource> TextureLoader::LoadFromBlock(ResourceEntry& entry)
   return nullptr;
 }
 
+bool TextureLoader::CanLoadOnDemand()
+{
+  return true;
+}
+
 } // namespace Raverie
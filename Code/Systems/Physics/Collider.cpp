@@ -72,7 +72,7 @@ void Collider::Serialize(Serializer& stream)
 {
   /// There's quite a few flags that only store run-time state that we need to
   /// ignore when serializing.
-  u32 mask = ColliderFlags::OnIsland | ColliderFlags::Uninitialized | ColliderFlags::HasPairFilter | ColliderFlags::MasslessBody | ColliderFlags::MasslessCollider | ColliderFlags::Seamless;
+  u32 mask = ColliderFlags::OnIsland | ColliderFlags::Uninitialized | ColliderFlags::HasPairFilter | ColliderFlags::MasslessBody | ColliderFlags::MasslessCollider | ColliderFlags::Seamless | ColliderFlags::Sleeping;
   // The default state is to be not ghost
   SerializeBits(stream, mState, ColliderFlags::Names, mask, ~ColliderFlags::Ghost);
 
@@ -571,6 +571,28 @@ Vec3 Collider::ComputePointVelocityInternal(Vec3Param worldPoint)
   return Vec3::cZero;
 }
 
+bool Collider::UsesContinuousCollision()
+{
+  RigidBody* body = GetActiveBody();
+  if (body == nullptr || !body->GetContinuousCollision() || !body->IsDynamic())
+    return false;
+  return mSpace->GetPhysicsSolverConfig()->mSpeculativeContacts;
+}
+
+Aabb Collider::ComputeSweptAabb()
+{
+  if (!UsesContinuousCollision())
+    return mAabb;
+
+  // Rotation isn't swept, the aabb only covers where the body's velocity will
+  // carry it this timestep
+  Vec3 displacement = GetActiveBody()->mVelocity * mSpace->mIterationDt;
+  Aabb sweptAabb = mAabb;
+  sweptAabb.Expand(mAabb.mMin + displacement);
+  sweptAabb.Expand(mAabb.mMax + displacement);
+  return sweptAabb;
+}
+
 bool Collider::NotCollideable() const
 {
   return mState.IsSet(ColliderFlags::Ghost | ColliderFlags::MasslessBody);
@@ -4,7 +4,7 @@
 namespace Raverie
 {
 
-DeclareBitField8(ColliderFlags, Ghost, SendsEvents, OnIsland, HasPairFilter, Uninitialized, Seamless, MasslessBody, MasslessCollider);
+DeclareBitField9(ColliderFlags, Ghost, SendsEvents, OnIsland, HasPairFilter, Uninitialized, Seamless, MasslessBody, MasslessCollider, Sleeping);
 
 /// A collider controls how collision detection is performed for an object.
 /// A collider also gives mass properties to a RigidBody (via the material and
@@ -215,6 +215,12 @@ public:
   /// rigid body.  Used in collision resolution and in determining the
   /// separating velocity of a point.
   Vec3 ComputePointVelocityInternal(Vec3Param worldPoint);
+  /// Does this collider's body use continuous collision (and does the space's
+  /// solver config allow it)?
+  bool UsesContinuousCollision();
+  /// The world-space aabb grown to cover the linear motion of this collider's
+  /// body over the current timestep if it uses continuous collision.
+  Aabb ComputeSweptAabb();
 
   /// This encompasses whether or not a collider is allowed to collide with
   /// anything. Currently ghost colliders and ones that have no mass in the
@@ -92,6 +92,16 @@ bool Contact::GetIsNew() const
   return mFlags.IsSet(ContactFlags::NewContact);
 }
 
+bool Contact::GetSpeculative() const
+{
+  return mFlags.IsSet(ContactFlags::Speculative);
+}
+
+void Contact::SetSpeculative(bool speculative)
+{
+  mFlags.SetState(ContactFlags::Speculative, speculative);
+}
+
 bool Contact::GetSendsEvents() const
 {
   return mManifold->GetSendsMessages();
@@ -150,11 +160,26 @@ void Contact::SetManifold(Manifold* manifold)
   UpdateManifoldInternal(manifold);
 }
 
-void Contact::UpdateManifold(Manifold* manifold)
+void Contact::UpdateManifold(Manifold* manifold, bool speculative)
 {
   mFlags.ClearFlag(ContactFlags::NewContact);
   UpdateManifoldInternal(manifold);
-  mManifold->AddPoints(manifold->Contacts, manifold->ContactCount);
+
+  // Speculative points are only a prediction, so no points (or their cached
+  // impulses) carry over to or from them
+  if (speculative || GetSpeculative())
+  {
+    mManifold->ContactCount = manifold->ContactCount;
+    for (uint i = 0; i < manifold->ContactCount; ++i)
+    {
+      mManifold->Contacts[i] = manifold->Contacts[i];
+      mManifold->Contacts[i].AccumulatedImpulse.ZeroOut();
+    }
+  }
+  else
+    mManifold->AddPoints(manifold->Contacts, manifold->ContactCount);
+
+  SetSpeculative(speculative);
 }
 
 void Contact::UpdateManifoldInternal(Manifold* manifold)
@@ -247,9 +272,13 @@ void Contact::ComputeMolecules(MoleculeWalker& fragments)
     // compute restitution as a bias term based upon the separating velocity
     real relativeVelocity = mManifold->GetSeparatingVelocity(i);
     real restitutionBias = real(0.0);
+    // a speculative contact lets the objects close the gap between them this
+    // timestep but no more (the negative penetration is the gap)
+    if (GetSpeculative())
+      restitutionBias = Math::Min(contact.Penetration, real(0.0)) / mContactManager->mSpace->mIterationDt;
     // only apply restitution if we are above a threshold,
     // otherwise instabilities can happen when we're near a resting state
-    if (relativeVelocity > velocityThreshold)
+    else if (relativeVelocity > velocityThreshold)
       restitutionBias = mManifold->Restitution * relativeVelocity;
 
     fragments[1].mImpulse = contact.AccumulatedImpulse[1];
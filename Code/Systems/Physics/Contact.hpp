@@ -16,7 +16,7 @@ class Contact;
 class ContactManager;
 class IConstraintSolver;
 
-DeclareBitField6(ContactFlags, OnIsland, Ghost, SkipsResolution, Valid, NewContact, Active);
+DeclareBitField7(ContactFlags, OnIsland, Ghost, SkipsResolution, Valid, NewContact, Active, Speculative);
 
 /// A constraint specifically for solving a non-penetration constraint.
 /// This should not be created anywhere but in the constraint solver.
@@ -43,13 +43,19 @@ public:
   void SetActive(bool active);
   bool GetIsNew() const;
   bool GetSendsEvents() const;
+  /// A speculative contact is between objects that aren't touching yet but
+  /// will be before the end of the timestep (see RigidBody.ContinuousCollision).
+  /// It only keeps the objects from closing more than the gap between them and
+  /// doesn't send collision events.
+  bool GetSpeculative() const;
+  void SetSpeculative(bool speculative);
 
   void UnLinkPair();
   virtual void Destroy(bool sendImmediately = false);
 
   void SetPair(ColliderPair& pair);
   void SetManifold(Manifold* manifold);
-  void UpdateManifold(Manifold* manifold);
+  void UpdateManifold(Manifold* manifold, bool speculative = false);
   void UpdateManifoldInternal(Manifold* manifold);
   Manifold* GetManifold();
 
@@ -22,7 +22,7 @@ ContactManager::~ContactManager()
   DestroyContacts();
 }
 
-Contact* ContactManager::AddManifold(Manifold& manifold)
+Contact* ContactManager::AddManifold(Manifold& manifold, bool speculative)
 {
   // Correct this manifold for 2d if it needs to be. If this returns
   // false then there are no points left in the manifold and
@@ -40,6 +40,7 @@ Contact* ContactManager::AddManifold(Manifold& manifold)
     contact->mContactManager = this;
     contact->SetPair(manifold.Objects);
     contact->SetManifold(new Manifold(manifold));
+    contact->SetSpeculative(speculative);
     ++contact->GetCollider(0)->mContactCount;
     ++contact->GetCollider(1)->mContactCount;
 
@@ -51,13 +52,28 @@ Contact* ContactManager::AddManifold(Manifold& manifold)
     // Can't change state in the middle of looping, otherwise broadphase
     // can get false positives due to order dependency on contact adding.
 
-    eventManager->BatchCollisionStartedEvent(contact->mManifold, mSpace);
+    // Speculative contacts haven't touched anything yet so their collision
+    // only starts once they do
+    if (!speculative)
+      eventManager->BatchCollisionStartedEvent(contact->mManifold, mSpace);
   }
   else
   {
-    contact->UpdateManifold(&manifold);
-    eventManager->BatchCollisionPersistedEvent(contact->mManifold, mSpace);
+    bool wasSpeculative = contact->GetSpeculative();
+    contact->UpdateManifold(&manifold, speculative);
+
+    if (!speculative && !wasSpeculative)
+      eventManager->BatchCollisionPersistedEvent(contact->mManifold, mSpace);
+    else if (!speculative)
+      eventManager->BatchCollisionStartedEvent(contact->mManifold, mSpace);
+    // The objects separated but will touch again within the timestep
+    else if (!wasSpeculative)
+      eventManager->BatchCollisionEndedEvent(contact->mManifold, mSpace, false);
   }
+
+  if (speculative)
+    return contact;
+
   // Whether or not this is a start or persisted collision,
   // we should batch up pre-solve events
   eventManager->BatchPreSolveEvent(contact->mManifold, mSpace);
@@ -78,6 +94,7 @@ void ContactManager::Remove(Contact* contact, bool sendImmediately)
   // Unlink the contact from the collider's and the constraint solvers
   --contact->GetCollider(0)->mContactCount;
   --contact->GetCollider(1)->mContactCount;
+  mSpace->ConstraintRemoved(contact->GetCollider(0), contact->GetCollider(1));
   contact->UnLinkPair();
 
   // Wake up both objects.
@@ -89,7 +106,9 @@ void ContactManager::Remove(Contact* contact, bool sendImmediately)
     manifold->Objects.B->ForceAwake();
   }
 
-  mSpace->mEventManager->BatchCollisionEndedEvent(manifold, mSpace, sendImmediately);
+  // Speculative contacts never started a collision
+  if (!contact->GetSpeculative())
+    mSpace->mEventManager->BatchCollisionEndedEvent(manifold, mSpace, sendImmediately);
 
   // We want the CollisionEnded event to have access to the manifold, but the
   // contact owns the manifold and would delete it, so delay destruct the
@@ -97,6 +116,29 @@ void ContactManager::Remove(Contact* contact, bool sendImmediately)
   mContactsToDestroy.PushBack(contact);
 }
 
+Contact* ContactManager::RestoreContact(Manifold& manifold, uint flags)
+{
+  Contact* contact = mContactPool->AllocateType<Contact>();
+
+  contact->mContactManager = this;
+  contact->SetPair(manifold.Objects);
+  contact->SetManifold(new Manifold(manifold));
+  // The contact isn't on any of the islands built before the restore
+  contact->mFlags.U32Field = flags;
+  contact->SetOnIsland(false);
+  ++contact->GetCollider(0)->mContactCount;
+  ++contact->GetCollider(1)->mContactCount;
+  return contact;
+}
+
+void ContactManager::RemoveForRestore(Contact* contact)
+{
+  --contact->GetCollider(0)->mContactCount;
+  --contact->GetCollider(1)->mContactCount;
+  contact->UnLinkPair();
+  mContactsToDestroy.PushBack(contact);
+}
+
 void ContactManager::DestroyContacts()
 {
   // Actually delete the memory of all the contacts
@@ -21,13 +21,21 @@ public:
   ~ContactManager();
 
   /// Gets the existing contact for this manifold or creates a new one if none
-  /// exists. Used when a collision has been detected.
-  Contact* AddManifold(Manifold& manifold);
+  /// exists. Used when a collision has been detected. Speculative manifolds are
+  /// for objects that will touch before the end of the timestep.
+  Contact* AddManifold(Manifold& manifold, bool speculative = false);
   /// Used when a collision no longer should exist.
   void RemoveManifold(Manifold* manifold);
   /// Used when a contact should be removed, maybe due to object deletion.
   void Remove(Contact* contact, bool sendImmediately = false);
 
+  /// Puts back a contact saved by a PhysicsSnapshot with the given manifold
+  /// and flags. Doesn't send any events or wake anything up.
+  Contact* RestoreContact(Manifold& manifold, uint flags);
+  /// Removes a contact that a PhysicsSnapshot is about to replace. Doesn't
+  /// send any events or wake anything up.
+  void RemoveForRestore(Contact* contact);
+
   /// Delete contacts that had been queued for delay destruction.
   void DestroyContacts();
 
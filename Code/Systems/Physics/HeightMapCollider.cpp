@@ -13,6 +13,7 @@ RaverieDefineType(HeightMapCollider, builder, type)
   RaverieBindDocumented();
 
   RaverieBindGetterSetterProperty(Thickness);
+  RaverieBindGetterSetterProperty(QuantizeHeights);
   RaverieBindMethod(ClearCachedEdgeAdjacency);
 }
 
@@ -20,12 +21,14 @@ HeightMapCollider::HeightMapCollider()
 {
   mType = cHeightMap;
   mLocalAabb.Zero();
+  mQuantizeHeights = false;
 }
 
 void HeightMapCollider::Serialize(Serializer& stream)
 {
   Collider::Serialize(stream);
   SerializeNameDefault(mThickness, 1.0f);
+  SerializeNameDefault(mQuantizeHeights, false);
 }
 
 void HeightMapCollider::Initialize(CogInitializer& initializer)
@@ -117,6 +120,19 @@ void HeightMapCollider::SetThickness(real thickness)
   ReloadAllPatches();
 }
 
+bool HeightMapCollider::GetQuantizeHeights() const
+{
+  return mQuantizeHeights;
+}
+
+void HeightMapCollider::SetQuantizeHeights(bool quantize)
+{
+  mQuantizeHeights = quantize;
+
+  // Build (or free) the quantized copies of the patches
+  ReloadAllPatches();
+}
+
 void HeightMapCollider::ClearCachedEdgeAdjacency()
 {
   mInfoMap.Clear();
@@ -124,16 +140,40 @@ void HeightMapCollider::ClearCachedEdgeAdjacency()
 
 HeightMapCollider::HeightMapRangeWrapper::HeightMapRangeWrapper(HeightMap* map, Aabb& aabb, real thickness)
 {
+  mQuantized = false;
+  mMap = map;
   mRange.SetLocal(map, aabb, thickness);
 }
 
+HeightMapCollider::HeightMapRangeWrapper::HeightMapRangeWrapper(HeightMap* map, QuantizedPatchMap* patches, Aabb& aabb, real thickness)
+{
+  mQuantized = true;
+  mMap = map;
+  mQuantizedRange.SetLocal(map, patches, aabb, thickness);
+}
+
 void HeightMapCollider::HeightMapRangeWrapper::PopFront()
 {
-  mRange.PopFront();
+  if (mQuantized)
+    mQuantizedRange.PopFront();
+  else
+    mRange.PopFront();
 }
 
 HeightMapCollider::HeightMapRangeWrapper::InternalObject& HeightMapCollider::HeightMapRangeWrapper::Front()
 {
+  if (mQuantized)
+  {
+    QuantizedHeightMapAabbRange::TriangleInfo& item = mQuantizedRange.Front();
+    AbsoluteIndex absIndex = mMap->GetAbsoluteIndex(item.mPatchIndex, item.mCellIndex);
+
+    uint key;
+    HeightMapCollider::TriangleIndexToKey(absIndex, item.mTriangleIndex, key);
+    mObj.Index = key;
+    mObj.Shape.BaseTri = item.mLocalTri;
+    return mObj;
+  }
+
   HeightMapAabbRange::TriangleInfo item = mRange.Front();
   AbsoluteIndex absIndex = mRange.mMap->GetAbsoluteIndex(item.mPatchIndex, item.mCellIndex);
   uint triIndex = mRange.mTriangleIndex;
@@ -150,6 +190,8 @@ HeightMapCollider::HeightMapRangeWrapper::InternalObject& HeightMapCollider::Hei
 
 bool HeightMapCollider::HeightMapRangeWrapper::Empty()
 {
+  if (mQuantized)
+    return mQuantizedRange.Empty();
   return mRange.Empty();
 }
 
@@ -160,10 +202,22 @@ Triangle HeightMapCollider::GetTriangle(uint key)
   AbsoluteIndex absIndex;
   HeightMapCollider::KeyToTriangleIndex(key, absIndex, triIndex);
 
-  // Fetch the quad from the height map
-  uint count;
+  // Fetch the quad from the height map (or the quantized copy of it)
+  uint count = 0;
   Triangle triangles[2];
-  mMap->GetQuadAtIndex(absIndex, triangles, count);
+  if (mQuantizeHeights)
+  {
+    PatchIndex patchIndex;
+    CellIndex cellIndex;
+    mMap->GetPatchAndCellIndex(absIndex, patchIndex, cellIndex);
+    QuantizedHeightPatch* patch = mQuantizedPatches.FindPointer(patchIndex);
+    if (patch != nullptr)
+      count = patch->GetCellTriangles(cellIndex, triangles);
+  }
+  else
+  {
+    mMap->GetQuadAtIndex(absIndex, triangles, count);
+  }
 
   // Have to restructure query if we want to eliminate this garbage return
   if (!count || (triIndex && count == 1))
@@ -177,6 +231,13 @@ Triangle HeightMapCollider::GetTriangle(uint key)
 
 HeightMapCollider::HeightMapRangeWrapper HeightMapCollider::GetOverlapRange(Aabb& localAabb)
 {
+  if (mQuantizeHeights)
+  {
+    HeightMapRangeWrapper range(mMap, &mQuantizedPatches, localAabb, mThickness);
+    range.mObj.Shape.ScaledDir = HeightMap::UpVector * -mThickness;
+    return range;
+  }
+
   HeightMapRangeWrapper range(mMap, localAabb, mThickness);
   // This only needs to be set once and it will persist through all objects in
   // the range
@@ -186,6 +247,9 @@ HeightMapCollider::HeightMapRangeWrapper HeightMapCollider::GetOverlapRange(Aabb
 
 bool HeightMapCollider::Cast(const Ray& localRay, ProxyResult& result, BaseCastFilter& filter)
 {
+  if (mQuantizeHeights)
+    return CastQuantized(localRay, result, filter);
+
   // Cast a local ray (already transformed by the collision manager) against the
   // internal height map
   HeightMapRayRange range = mMap->CastLocalRay(localRay);
@@ -227,6 +291,68 @@ bool HeightMapCollider::Cast(const Ray& localRay, ProxyResult& result, BaseCastF
   return true;
 }
 
+bool HeightMapCollider::CastQuantized(const Ray& localRay, ProxyResult& result, BaseCastFilter& filter)
+{
+  // Clip the ray against the bounds of all patches so the patch walk
+  // below has an end
+  Intersection::Interval interval;
+  Intersection::Type type = Intersection::RayAabb(localRay.Start, localRay.Direction, mLocalAabb.mMin, mLocalAabb.mMax, &interval);
+  if (type == Intersection::None)
+    return false;
+  real minT = Math::Max(interval.Min, real(0.0));
+  real maxT = interval.Max;
+
+  // Walk the patches under the ray in order, the first patch with a hit has
+  // the nearest hit. A ray straight down only ever touches one patch.
+  Vec2 projectedStart = Vec2(localRay.Start.x, localRay.Start.z);
+  Vec2 projectedDir = Vec2(localRay.Direction.x, localRay.Direction.z);
+  QuantizedHeightPatch::RayResult rayResult;
+  QuantizedHeightPatch* hitPatch = nullptr;
+  if (projectedDir.x == real(0.0) && projectedDir.y == real(0.0))
+  {
+    QuantizedHeightPatch* patch = mQuantizedPatches.FindPointer(mMap->GetPatchIndexFromLocal(projectedStart));
+    if (patch != nullptr && patch->CastRay(localRay.Start, localRay.Direction, rayResult))
+      hitPatch = patch;
+  }
+  else
+  {
+    PatchRayRange range(mMap, projectedStart, projectedDir, minT, maxT);
+    for (; !range.Empty(); range.PopFront())
+    {
+      QuantizedHeightPatch* patch = mQuantizedPatches.FindPointer(range.Front());
+      if (patch != nullptr && patch->CastRay(localRay.Start, localRay.Direction, rayResult))
+      {
+        hitPatch = patch;
+        break;
+      }
+    }
+  }
+
+  if (hitPatch == nullptr)
+    return false;
+
+  Triangle& tri = rayResult.mLocalTri;
+  Intersection::IntersectionPoint& point = rayResult.mIntersectionInfo;
+  result.mPoints[0] = point.Points[0];
+  result.mPoints[1] = point.Points[1];
+  result.mDistance = point.T;
+
+  // Same reflection normal as the regular cast
+  if (filter.IsSet(BaseCastFilterFlags::GetContactNormal))
+  {
+    Vec3 normal = Geometry::NormalFromPointOnTriangle(result.mPoints[0], tri[0], tri[1], tri[2]);
+    if (Dot(normal, tri[0] - localRay.Start) > 0)
+      normal *= real(-1.0f);
+
+    result.mContactNormal = normal;
+  }
+
+  AbsoluteIndex absIndex = mMap->GetAbsoluteIndex(hitPatch->mIndex, rayResult.mCellIndex);
+  HeightMapCollider::TriangleIndexToKey(absIndex, rayResult.mTriangleIndex, result.ShapeIndex);
+
+  return true;
+}
+
 HeightMap* HeightMapCollider::GetHeightMap()
 {
   return mMap;
@@ -257,7 +383,7 @@ void HeightMapCollider::KeyToTriangleIndex(uint key, AbsoluteIndex& absolueIndex
   absolueIndex = AbsoluteIndex(x, y);
 }
 
-void HeightMapCollider::LoadPatch(HeightMap* map, HeightPatch* mapPatch)
+void HeightMapCollider::LoadPatch(HeightMap* map, HeightPatch* mapPatch, HeightPatch* removedPatch)
 {
   // When loading a patch we don't actually need any triangle info. We do
   // however need to compute the local space aabb so we can properly broad and
@@ -270,12 +396,39 @@ void HeightMapCollider::LoadPatch(HeightMap* map, HeightPatch* mapPatch)
   // Extend the aabb on the bottom by the thickness
   patchAabb.mMin -= HeightMap::UpVector * mThickness;
 
+  if (mQuantizeHeights)
+  {
+    QuantizedHeightPatch& quantizedPatch = mQuantizedPatches[mapPatch->Index];
+    quantizedPatch.Build(map, mapPatch, removedPatch);
+
+    // The quantized patch also has the vertices shared with the next patches
+    // which can be outside of the patch's own height range
+    patchAabb.mMin.y = Math::Min(patchAabb.mMin.y, quantizedPatch.GetMinHeight() - mThickness);
+    patchAabb.mMax.y = Math::Max(patchAabb.mMax.y, quantizedPatch.GetMaxHeight());
+  }
+
   // Updating common size info (e.g. bounding volumes) should be handled by
   // the caller since they could be calling this multiple times
 }
 
+void HeightMapCollider::ReloadNeighborPatches(HeightMap* map, PatchIndexParam index, HeightPatch* removedPatch)
+{
+  if (!mQuantizeHeights)
+    return;
+
+  PatchIndex neighbors[] = {index - PatchIndex(1, 0), index - PatchIndex(0, 1), index - PatchIndex(1, 1)};
+  for (uint i = 0; i < 3; ++i)
+  {
+    HeightPatch* neighbor = map->GetPatchAtIndex(neighbors[i]);
+    if (neighbor != nullptr)
+      LoadPatch(map, neighbor, removedPatch);
+  }
+}
+
 void HeightMapCollider::ReloadAllPatches()
 {
+  mQuantizedPatches.Clear();
+
   // To reload all patches we simply walk over and call load on each
   // patch (this only updates bounding volume info)
   PatchMap::valuerange range = mMap->GetAllPatches();
@@ -293,6 +446,7 @@ void HeightMapCollider::OnHeightMapPatchAdded(HeightMapEvent* hEvent)
   // Create a new patch aabb and load/compute the patch's local space aabb
   mPatchAabbs.Insert(hEvent->Patch->Index, Aabb());
   LoadPatch(hEvent->Map, hEvent->Patch);
+  ReloadNeighborPatches(hEvent->Map, hEvent->Patch->Index);
 
   // Since our internal size changed make sure to run all common update code
   InternalSizeChanged();
@@ -302,6 +456,8 @@ void HeightMapCollider::OnHeightMapPatchRemoved(HeightMapEvent* hEvent)
 {
   // Remove a patch aabb
   mPatchAabbs.Erase(hEvent->Patch->Index);
+  mQuantizedPatches.Erase(hEvent->Patch->Index);
+  ReloadNeighborPatches(hEvent->Map, hEvent->Patch->Index, hEvent->Patch);
 
   // Since our internal size changed make sure to run all common update code
   InternalSizeChanged();
@@ -311,6 +467,7 @@ void HeightMapCollider::OnHeightMapPatchModified(HeightMapEvent* hEvent)
 {
   // One of the patches were modified. For simplicity just reload the patch.
   LoadPatch(hEvent->Map, hEvent->Patch);
+  ReloadNeighborPatches(hEvent->Map, hEvent->Patch->Index);
 
   // Since our internal size changed make sure to run all common update code
   InternalSizeChanged();
@@ -32,6 +32,13 @@ public:
   real GetThickness() const;
   void SetThickness(real thickness);
 
+  /// Collide against a compact copy of the height map where heights are
+  /// quantized to 16 bits per patch and a min/max quadtree is used to skip
+  /// regions of a patch. Uses much less memory per query and is faster for
+  /// large height maps at the cost of a tiny amount of height precision.
+  bool GetQuantizeHeights() const;
+  void SetQuantizeHeights(bool quantize);
+
   /// Clear the cached information used to avoid catching edges. Typically
   /// called internally by physics, but is exposed for manual triggering.
   void ClearCachedEdgeAdjacency();
@@ -50,6 +57,7 @@ public:
     };
 
     HeightMapRangeWrapper(HeightMap* map, Aabb& aabb, real thickness);
+    HeightMapRangeWrapper(HeightMap* map, QuantizedPatchMap* patches, Aabb& aabb, real thickness);
 
     // Range Interface
     void PopFront();
@@ -57,6 +65,9 @@ public:
     bool Empty();
 
     HeightMapAabbRange mRange;
+    QuantizedHeightMapAabbRange mQuantizedRange;
+    bool mQuantized;
+    HeightMap* mMap;
     InternalObject mObj;
   };
 
@@ -92,7 +103,13 @@ public:
 private:
   typedef HashMap<PatchIndex, Aabb> PatchAabbMap;
 
-  void LoadPatch(HeightMap* map, HeightPatch* mapPatch);
+  bool CastQuantized(const Ray& localRay, ProxyResult& result, BaseCastFilter& filter);
+  /// The removed patch is passed in when a neighbor is reloaded while
+  /// a patch is being removed (it is still in the map at that point).
+  void LoadPatch(HeightMap* map, HeightPatch* mapPatch, HeightPatch* removedPatch = nullptr);
+  /// Quantized patches copy the vertices they share with the next patches, so
+  /// the previous patches have to be reloaded whenever a patch changes.
+  void ReloadNeighborPatches(HeightMap* map, PatchIndexParam index, HeightPatch* removedPatch = nullptr);
   void ReloadAllPatches();
   void OnHeightMapPatchAdded(HeightMapEvent* hEvent);
   void OnHeightMapPatchRemoved(HeightMapEvent* hEvent);
@@ -101,6 +118,8 @@ private:
   real mThickness;
   Aabb mLocalAabb;
   PatchAabbMap mPatchAabbs;
+  bool mQuantizeHeights;
+  QuantizedPatchMap mQuantizedPatches;
 
   HeightMap* mMap;
   TriangleInfoMap mInfoMap;
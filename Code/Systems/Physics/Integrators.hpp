@@ -11,6 +11,10 @@ namespace Physics
 
 DeclareEnum4(IntegrationMethods, Euler, Verlet, Rk2, Rk4);
 
+/// Returns the change in angular velocity from the (implicitly integrated)
+/// gyroscopic torque.
+Vec3 SolveGyroscopic(RigidBody* body, float dt);
+
 // Integration is put in a struct so that it is easier to friend these functions
 struct Integration
 {
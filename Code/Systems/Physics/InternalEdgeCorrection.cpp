@@ -229,7 +229,7 @@ void GenerateInternalEdgeInfo(PhysicsMesh* mesh, TriangleInfoMap* infoMap)
     Triangle triA = mesh->GetTriangle(indexA);
     Aabb triAabb = ToAabb(triA);
 
-    Array<TreeType::NodeType*> scratchData;
+    Array<TreeType::StackEntryType> scratchData;
     AutoDeclare(range, tree.Query(triAabb, scratchData));
     for (; !range.Empty(); range.PopFront())
     // forRangeBroadphaseTree(StaticAabbTree<uint>, tree, Aabb, triAabb)
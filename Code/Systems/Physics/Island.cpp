@@ -176,48 +176,21 @@ void Island::UpdateSleep(real dt, bool allowSleeping, uint debugFlags)
   if (!allowSleeping)
     return;
 
-  real minSleepTime = Math::PositiveMax();
-
-  // Update the sleep timers of all objects
+  // Update the sleep timers of all objects. Whether they actually fall asleep
+  // is decided by their PersistentIsland (see IslandManager::UpdateSleep).
   Colliders::range range = mColliders.All();
 
   while (!range.Empty())
   {
-    RigidBody* body = range.Front().GetActiveBody();
+    Collider& collider = range.Front();
+    RigidBody* body = collider.GetActiveBody();
     range.PopFront();
 
     if (!body || body->GetStatic())
       continue;
 
-    if (body->UpdateSleepTimer(dt))
-    {
-      minSleepTime = Math::Min(minSleepTime, body->mSleepTimer);
-    }
-    else
-    {
-      if (debugFlags & PhysicsSpaceDebugDrawFlags::DrawSleepPreventors)
-      {
-        Aabb aabb = range.Front().mAabb;
-        gDebugDraw->Add(Debug::Obb(aabb).Color(Color::Aquamarine));
-      }
-
-      minSleepTime = real(0.0);
-    }
-  }
-
-  if (minSleepTime < cTimeToSleep)
-    return;
-
-  range = mColliders.All();
-
-  while (!range.Empty())
-  {
-    RigidBody* body = range.Front().GetActiveBody();
-    range.PopFront();
-
-    if (!body || body->IsAsleep())
-      continue;
-    body->PutToSleep();
+    if (!body->UpdateSleepTimer(dt) && (debugFlags & PhysicsSpaceDebugDrawFlags::DrawSleepPreventors))
+      gDebugDraw->Add(Debug::Obb(collider.mAabb).Color(Color::Aquamarine));
   }
 }
 
@@ -269,6 +242,13 @@ bool Island::ContainsCollider(const Collider* collider)
   return false;
 }
 
+PersistentIsland::PersistentIsland()
+{
+  mBodyCount = 0;
+  mRemovedConstraintCount = 0;
+  mAsleep = false;
+}
+
 } // namespace Physics
 
 } // namespace Raverie
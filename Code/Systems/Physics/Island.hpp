@@ -66,6 +66,27 @@ public:
   uint ColliderCount;
 };
 
+/// A group of dynamic bodies that are (or recently were) connected by contacts
+/// and joints. Unlike an Island, which is rebuilt from the awake objects every
+/// step, these persist between steps so a group can fall asleep as a whole and
+/// cost nothing while it's asleep. Groups are merged as soon as a constraint
+/// connects them but are only split lazily, when a group that has lost
+/// constraints is about to fall asleep.
+class PersistentIsland
+{
+public:
+  PersistentIsland();
+
+  Link<PersistentIsland> ManagerLink;
+  typedef InList<RigidBody, &RigidBody::mPersistentIslandLink> BodyList;
+  BodyList mBodies;
+  uint mBodyCount;
+  /// How many constraints (or bodies) were removed from this island since it
+  /// was last split. If this is zero the island is known to be connected.
+  uint mRemovedConstraintCount;
+  bool mAsleep;
+};
+
 } // namespace Physics
 
 } // namespace Raverie
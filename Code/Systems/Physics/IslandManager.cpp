@@ -194,6 +194,71 @@ struct CompositeTraversal
   }
 };
 
+// The dynamic body that moves the given collider (static and kinematic
+// children are moved by their dynamic parent). Null if no dynamic body moves it.
+RigidBody* GetDynamicRoot(Collider* collider)
+{
+  RigidBody* body = collider->GetActiveBody();
+  while (body != nullptr && !body->IsDynamic())
+    body = body->mParentBody;
+  return body;
+}
+
+// Only constraints that actually push bodies around keep them awake together
+bool ConnectsPersistentIslands(Contact* contact)
+{
+  return !contact->GetSpeculative() && !contact->GetGhost();
+}
+
+// Moves a body that is still in the island being split into the new island
+// being flood filled.
+void MoveToSplitIsland(RigidBody* body, PersistentIsland* oldIsland, PersistentIsland* newIsland, Array<RigidBody*>& stack)
+{
+  if (body == nullptr || body->mPersistentIsland != oldIsland)
+    return;
+
+  PersistentIsland::BodyList::Unlink(body);
+  newIsland->mBodies.PushBack(body);
+  ++newIsland->mBodyCount;
+  body->mPersistentIsland = newIsland;
+  stack.PushBack(body);
+}
+
+// Moves every body still connected to the given one (through its colliders
+// and those of the static/kinematic children it moves) into the new island.
+void MoveConnectedToSplitIsland(RigidBody* body, PersistentIsland* oldIsland, PersistentIsland* newIsland, Array<RigidBody*>& stack)
+{
+  RigidBody::CompositeColliderRange colliders = body->mColliders.All();
+  for (; !colliders.Empty(); colliders.PopFront())
+  {
+    Collider& collider = colliders.Front();
+
+    Collider::ContactEdgeList::range contacts = collider.mContactEdges.All();
+    for (; !contacts.Empty(); contacts.PopFront())
+    {
+      ContactEdge& edge = contacts.Front();
+      if (ConnectsPersistentIslands(edge.mContact))
+        MoveToSplitIsland(GetDynamicRoot(edge.mOther), oldIsland, newIsland, stack);
+    }
+
+    Collider::JointEdgeList::range joints = collider.mJointEdges.All();
+    for (; !joints.Empty(); joints.PopFront())
+    {
+      JointEdge& edge = joints.Front();
+      if (edge.mJoint->GetValid())
+        MoveToSplitIsland(GetDynamicRoot(edge.mOther), oldIsland, newIsland, stack);
+    }
+  }
+
+  RigidBody::BodyRange children = body->mChildBodies.All();
+  for (; !children.Empty(); children.PopFront())
+  {
+    RigidBody& child = children.Front();
+    if (!child.IsDynamic())
+      MoveConnectedToSplitIsland(&child, oldIsland, newIsland, stack);
+  }
+}
+
 struct NoPreProcessing
 {
   void PreProcess(IslandManager::IslandList& islands, Island*& newIsland)
@@ -267,11 +332,13 @@ IslandManager::IslandManager(PhysicsSolverConfig* config)
   mPostProcess = false;
   mSharedSolver = nullptr;
   mShareSolver = false;
+  mForceParallelSolve = false;
 }
 
 IslandManager::~IslandManager()
 {
   Clear();
+  ClearPersistentIslands();
 }
 
 void IslandManager::SetSpace(PhysicsSpace* space)
@@ -300,6 +367,16 @@ void IslandManager::BuildIslands(ColliderList& colliders)
 {
   Clear();
 
+  // Sleep timers are only accumulated once a step (bodies on an island had
+  // this cleared by Clear)
+  PersistentIslandList::range persistentIslands = mAwakeIslands.All();
+  for (; !persistentIslands.Empty(); persistentIslands.PopFront())
+  {
+    PersistentIsland::BodyList::range bodies = persistentIslands.Front().mBodies.All();
+    for (; !bodies.Empty(); bodies.PopFront())
+      bodies.Front().mState.ClearFlag(RigidBodyStates::SleepAccumulated);
+  }
+
   if (mShareSolver)
     mSharedSolver = GetNewSolver();
 
@@ -319,6 +396,8 @@ void IslandManager::BuildIslands(ColliderList& colliders)
   IslandList::range range = mIslands.All();
   for (; !range.Empty(); range.PopFront())
     ++mIslandCount;
+
+  UpdatePersistentIslands();
 }
 
 void IslandManager::PostProcessIslands()
@@ -384,16 +463,99 @@ void IslandManager::Solve(real dt, bool allowSleeping, uint debugFlags)
     islandRange = mIslands.All();
     for (; !islandRange.Empty(); islandRange.PopFront())
       islandRange.Front().UpdateSleep(dt, allowSleeping, debugFlags);
+  }
+  else if (mSpace->GetDeterministic() && !mForceParallelSolve)
+  {
+    SolveIslandsSerial(dt, allowSleeping, debugFlags);
+  }
+  else
+  {
+    SolveIslandsParallel(dt, allowSleeping, debugFlags);
+  }
 
-    return;
+  UpdateSleep(dt, allowSleeping);
+}
+
+// Solves the constraints of a range of islands (everything Island::Solve does
+// except for events and sleeping, which aren't thread safe)
+static void SolveIslandRange(void* userData, uint begin, uint end)
+{
+  Island** islands = (Island**)userData;
+  for (uint i = begin; i < end; ++i)
+  {
+    Island* island = islands[i];
+    island->CommitConstraints();
+
+    IConstraintSolver* solver = island->mSolver;
+    solver->UpdateData();
+    solver->WarmStart();
+    solver->SolveVelocities();
+    solver->Commit();
   }
+}
 
-  // solve all of the islands.
+void IslandManager::SolveIslandsSerial(real dt, bool allowSleeping, uint debugFlags)
+{
   IslandList::range islandRange = mIslands.All();
   for (; !islandRange.Empty(); islandRange.PopFront())
     islandRange.Front().Solve(dt, allowSleeping, debugFlags);
 }
 
+static bool IslandSizeSorter(Island* lhs, Island* rhs)
+{
+  return lhs->ContactCount + lhs->JointCount > rhs->ContactCount + rhs->JointCount;
+}
+
+void IslandManager::SolveIslandsParallel(real dt, bool allowSleeping, uint debugFlags)
+{
+  // Islands only share static objects (which the solvers don't change) and
+  // each one is solved start to finish by one task, so the results don't
+  // depend on the number of threads or the order the tasks run in. They do
+  // differ from a serial solve once large islands are coloured, which is why
+  // deterministic spaces always go through SolveIslandsSerial.
+  Array<Island*> islands;
+  islands.Reserve(mIslandCount);
+  IslandList::range islandRange = mIslands.All();
+  for (; !islandRange.Empty(); islandRange.PopFront())
+  {
+    Island* island = &islandRange.Front();
+    islands.PushBack(island);
+
+    // Large islands can't be split between tasks, so their constraints are
+    // graph coloured instead. This only depends on the island's size (never
+    // on the thread count) to keep the simulation deterministic. The wide
+    // solver already colours its contacts so it's left alone.
+    uint constraintCount = island->ContactCount + island->JointCount;
+    PhysicsSolverType::Enum solverType = mPhysicsSolverConfig->mSolverType;
+    bool colored = solverType == PhysicsSolverType::Threaded || solverType == PhysicsSolverType::Wide;
+    if (!colored && island->mOwnsSolver && constraintCount >= cColoredIslandConstraintCount)
+    {
+      delete island->mSolver;
+      island->SetSolver(CreateSolver(PhysicsSolverType::Threaded), true);
+    }
+  }
+
+  // Solve the largest islands first so one large island started last doesn't
+  // leave every other thread idle.
+  Sort(islands.All(), IslandSizeSorter);
+
+  {
+    // The solvers' own profile scopes only count on the main thread, so the
+    // whole parallel solve is timed here
+    ProfileScopeTree("SolveIslands", "ResolutionPhase", Color::DarkMagenta);
+    uint grainSize = Math::Max(uint(islands.Size()) / (Z::gJobs->GetThreadCount() * 8), 1u);
+    Z::gJobs->ParallelFor(0, uint(islands.Size()), grainSize, &SolveIslandRange, islands.Data());
+  }
+
+  islandRange = mIslands.All();
+  for (; !islandRange.Empty(); islandRange.PopFront())
+  {
+    Island& island = islandRange.Front();
+    island.mSolver->BatchEvents();
+    island.UpdateSleep(dt, allowSleeping, debugFlags);
+  }
+}
+
 void IslandManager::SolvePositions(real dt)
 {
   IslandList::range islandRange = mIslands.All();
@@ -435,6 +597,7 @@ void IslandManager::Clear()
   {
     mSharedSolver->Clear();
     delete mSharedSolver;
+    mSharedSolver = nullptr;
   }
 }
 
@@ -451,6 +614,323 @@ Island* IslandManager::GetObjectsIsland(const Collider* collider)
   return nullptr;
 }
 
+void IslandManager::UpdatePersistentIslands()
+{
+  // Every awake dynamic body needs an island to be able to fall asleep
+  RigidBodyList::range bodies = mSpace->mRigidBodies.All();
+  for (; !bodies.Empty(); bodies.PopFront())
+    GetPersistentIsland(&bodies.Front());
+
+  // Bodies solved together have to sleep together (static and kinematic
+  // bodies don't connect anything since they aren't moved by the solver)
+  IslandList::range range = mIslands.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Island& island = range.Front();
+
+    Island::ContactList::range contacts = island.mContacts.All();
+    for (; !contacts.Empty(); contacts.PopFront())
+    {
+      Contact& contact = contacts.Front();
+      if (ConnectsPersistentIslands(&contact))
+        MergePersistentIslands(GetDynamicRoot(contact.GetCollider(0)), GetDynamicRoot(contact.GetCollider(1)));
+    }
+
+    Island::JointList::range joints = island.mJoints.All();
+    for (; !joints.Empty(); joints.PopFront())
+    {
+      Joint& joint = joints.Front();
+      Collider* collider0 = joint.GetCollider(0);
+      Collider* collider1 = joint.GetCollider(1);
+      if (collider0 != nullptr && collider1 != nullptr)
+        MergePersistentIslands(GetDynamicRoot(collider0), GetDynamicRoot(collider1));
+    }
+  }
+}
+
+void IslandManager::UpdateSleep(real dt, bool allowSleeping)
+{
+  if (!allowSleeping)
+    return;
+
+  Array<PersistentIsland*> restingIslands;
+  PersistentIsland* splitIsland = nullptr;
+  real splitSleepTime = real(0.0);
+
+  PersistentIslandList::range range = mAwakeIslands.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    PersistentIsland* island = &range.Front();
+
+    real minSleepTime = Math::PositiveMax();
+    real maxSleepTime = real(0.0);
+    PersistentIsland::BodyList::range bodies = island->mBodies.All();
+    for (; !bodies.Empty(); bodies.PopFront())
+    {
+      // Bodies that weren't on an island this step (nothing is touching them)
+      // haven't had their timer updated yet
+      RigidBody& body = bodies.Front();
+      body.UpdateSleepTimer(dt);
+      minSleepTime = Math::Min(minSleepTime, body.mSleepTimer);
+      maxSleepTime = Math::Max(maxSleepTime, body.mSleepTimer);
+    }
+
+    if (minSleepTime >= cTimeToSleep)
+      restingIslands.PushBack(island);
+    else if (island->mRemovedConstraintCount != 0 && maxSleepTime > splitSleepTime)
+    {
+      splitIsland = island;
+      splitSleepTime = maxSleepTime;
+    }
+  }
+
+  Array<PersistentIsland*> newIslands;
+  // Some of this island wants to sleep but it might only be held awake by a
+  // body it isn't connected to anymore. Only one island is split a step to
+  // bound the cost, the pieces are checked for sleep next step.
+  if (splitIsland != nullptr)
+    SplitPersistentIsland(splitIsland, newIslands);
+
+  for (uint i = 0; i < restingIslands.Size(); ++i)
+  {
+    PersistentIsland* island = restingIslands[i];
+    if (island->mRemovedConstraintCount == 0)
+    {
+      SleepPersistentIsland(island);
+      continue;
+    }
+
+    // Split before sleeping so that waking one piece doesn't wake the rest
+    newIslands.Clear();
+    SplitPersistentIsland(island, newIslands);
+    for (uint j = 0; j < newIslands.Size(); ++j)
+      SleepPersistentIsland(newIslands[j]);
+  }
+
+  SleepRestingKinematics();
+}
+
+void IslandManager::SleepRestingKinematics()
+{
+  // The kinematic timers were updated by their solver island (Island::UpdateSleep)
+  Array<RigidBody*> kinematics;
+  IslandList::range range = mIslands.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    kinematics.Clear();
+    bool resting = true;
+    Island::Colliders::range colliders = range.Front().mColliders.All();
+    for (; !colliders.Empty(); colliders.PopFront())
+    {
+      RigidBody* body = colliders.Front().GetActiveBody();
+      if (body == nullptr || body->GetStatic() || body->IsAsleep())
+        continue;
+
+      if (body->IsDynamic() || body->mSleepTimer < cTimeToSleep)
+      {
+        resting = false;
+        break;
+      }
+      kinematics.PushBack(body);
+    }
+
+    if (!resting)
+      continue;
+
+    for (uint i = 0; i < kinematics.Size(); ++i)
+    {
+      if (!kinematics[i]->IsAsleep())
+        kinematics[i]->PutToSleep();
+    }
+  }
+}
+
+void IslandManager::WakeMovingBodies()
+{
+  // Asleep bodies only pick up velocity by being solved with awake bodies
+  IslandList::range range = mIslands.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Island::Colliders::range colliders = range.Front().mColliders.All();
+    for (; !colliders.Empty(); colliders.PopFront())
+    {
+      RigidBody* body = colliders.Front().GetActiveBody();
+      if (body == nullptr || !body->IsAsleep() || body->GetStatic())
+        continue;
+
+      if (body->mVelocity.LengthSq() != real(0.0) || body->mAngularVelocity.LengthSq() != real(0.0))
+        body->WakeUp();
+    }
+  }
+}
+
+void IslandManager::WakePersistentIsland(RigidBody* body)
+{
+  PersistentIsland* island = body->mPersistentIsland;
+  if (island == nullptr || !island->mAsleep)
+    return;
+
+  island->mAsleep = false;
+  PersistentIslandList::Unlink(island);
+  mAwakeIslands.PushBack(island);
+
+  // Waking a body comes back here, but the island is already awake by then
+  PersistentIsland::BodyList::range bodies = island->mBodies.All();
+  for (; !bodies.Empty(); bodies.PopFront())
+  {
+    RigidBody& islandBody = bodies.Front();
+    if (islandBody.IsAsleep())
+      islandBody.WakeUp();
+  }
+}
+
+void IslandManager::ConstraintRemoved(Collider* colliderA, Collider* colliderB)
+{
+  RigidBody* bodyA = GetDynamicRoot(colliderA);
+  RigidBody* bodyB = GetDynamicRoot(colliderB);
+  if (bodyA == nullptr || bodyB == nullptr || bodyA == bodyB)
+    return;
+
+  PersistentIsland* island = bodyA->mPersistentIsland;
+  if (island != nullptr && island == bodyB->mPersistentIsland)
+    ++island->mRemovedConstraintCount;
+}
+
+void IslandManager::RemoveBody(RigidBody* body)
+{
+  PersistentIsland* island = body->mPersistentIsland;
+  if (island == nullptr)
+    return;
+
+  PersistentIsland::BodyList::Unlink(body);
+  body->mPersistentIsland = nullptr;
+  --island->mBodyCount;
+  // The body might have been all that connected the rest of the island
+  ++island->mRemovedConstraintCount;
+
+  if (island->mBodyCount == 0)
+  {
+    PersistentIslandList::Unlink(island);
+    delete island;
+  }
+}
+
+PersistentIsland* IslandManager::GetPersistentIsland(RigidBody* body)
+{
+  if (body->mPersistentIsland != nullptr)
+    return body->mPersistentIsland;
+
+  PersistentIsland* island = new PersistentIsland();
+  island->mBodies.PushBack(body);
+  island->mBodyCount = 1;
+  body->mPersistentIsland = island;
+  mAwakeIslands.PushBack(island);
+  return island;
+}
+
+void IslandManager::MergePersistentIslands(RigidBody* bodyA, RigidBody* bodyB)
+{
+  if (bodyA == nullptr || bodyB == nullptr)
+    return;
+
+  PersistentIsland* islandA = GetPersistentIsland(bodyA);
+  PersistentIsland* islandB = GetPersistentIsland(bodyB);
+  if (islandA == islandB)
+    return;
+
+  // An asleep body was pulled into an awake island, the whole group it sleeps
+  // with has to come along
+  if (islandA->mAsleep)
+    WakePersistentIsland(bodyA);
+  if (islandB->mAsleep)
+    WakePersistentIsland(bodyB);
+
+  // Only the bodies of the smaller island have to be pointed at the new one
+  if (islandA->mBodyCount < islandB->mBodyCount)
+    Math::Swap(islandA, islandB);
+
+  PersistentIsland::BodyList::range bodies = islandB->mBodies.All();
+  for (; !bodies.Empty(); bodies.PopFront())
+    bodies.Front().mPersistentIsland = islandA;
+
+  islandA->mBodies.Splice(islandA->mBodies.End(), islandB->mBodies);
+  islandA->mBodyCount += islandB->mBodyCount;
+  islandA->mRemovedConstraintCount += islandB->mRemovedConstraintCount;
+
+  PersistentIslandList::Unlink(islandB);
+  delete islandB;
+}
+
+void IslandManager::SplitPersistentIsland(PersistentIsland* island, Array<PersistentIsland*>& newIslands)
+{
+  // Flood fill from each body that hasn't been reached yet. Bodies are moved
+  // to their new island when they're reached, so whatever is left in the old
+  // island hasn't been reached.
+  Array<RigidBody*> stack;
+  while (!island->mBodies.Empty())
+  {
+    PersistentIsland* newIsland = new PersistentIsland();
+    newIsland->mAsleep = island->mAsleep;
+    if (newIsland->mAsleep)
+      mAsleepIslands.PushBack(newIsland);
+    else
+      mAwakeIslands.PushBack(newIsland);
+    newIslands.PushBack(newIsland);
+
+    MoveToSplitIsland(&island->mBodies.Front(), island, newIsland, stack);
+    while (!stack.Empty())
+    {
+      RigidBody* body = stack.Back();
+      stack.PopBack();
+      MoveConnectedToSplitIsland(body, island, newIsland, stack);
+    }
+  }
+
+  PersistentIslandList::Unlink(island);
+  delete island;
+}
+
+void IslandManager::SleepPersistentIsland(PersistentIsland* island)
+{
+  island->mAsleep = true;
+  PersistentIslandList::Unlink(island);
+  mAsleepIslands.PushBack(island);
+
+  PersistentIsland::BodyList::range bodies = island->mBodies.All();
+  for (; !bodies.Empty(); bodies.PopFront())
+  {
+    // Someone listening to RigidBodySlept could have woken the island back up
+    if (!island->mAsleep)
+      return;
+
+    RigidBody& body = bodies.Front();
+    // Nothing asleep is looked at each step, so the colliders don't need to be
+    // in the space's per step lists either
+    mSpace->SetCollidersAsleep(&body, true);
+    if (!body.IsAsleep())
+      body.PutToSleep();
+  }
+}
+
+void IslandManager::ClearPersistentIslands()
+{
+  PersistentIslandList* lists[] = {&mAwakeIslands, &mAsleepIslands};
+  for (uint i = 0; i < 2; ++i)
+  {
+    while (!lists[i]->Empty())
+    {
+      PersistentIsland* island = &lists[i]->Front();
+      lists[i]->PopFront();
+
+      PersistentIsland::BodyList::range bodies = island->mBodies.All();
+      for (; !bodies.Empty(); bodies.PopFront())
+        bodies.Front().mPersistentIsland = nullptr;
+      island->mBodies.Clear();
+      delete island;
+    }
+  }
+}
+
 template <typename Policy>
 void IslandManager::CreateCompactIslands(Policy policy, ColliderList& colliders)
 {
@@ -538,16 +1018,23 @@ void IslandManager::CreateSingleIsland(Policy policy, ColliderList& colliders)
 }
 
 IConstraintSolver* IslandManager::GetNewSolver()
+{
+  return CreateSolver(mPhysicsSolverConfig->mSolverType);
+}
+
+IConstraintSolver* IslandManager::CreateSolver(PhysicsSolverType::Enum solverType)
 {
   IConstraintSolver* solver = nullptr;
-  if (mPhysicsSolverConfig->mSolverType == PhysicsSolverType::Basic)
+  if (solverType == PhysicsSolverType::Basic)
     solver = new BasicSolver();
-  else if (mPhysicsSolverConfig->mSolverType == PhysicsSolverType::GenericBasic)
+  else if (solverType == PhysicsSolverType::GenericBasic)
     solver = new GenericBasicSolver();
-  else if (mPhysicsSolverConfig->mSolverType == PhysicsSolverType::Normal)
+  else if (solverType == PhysicsSolverType::Normal)
     solver = new NormalSolver();
-  else if (mPhysicsSolverConfig->mSolverType == PhysicsSolverType::Threaded)
+  else if (solverType == PhysicsSolverType::Threaded)
     solver = new ThreadedSolver();
+  else if (solverType == PhysicsSolverType::Wide)
+    solver = new WideSolver();
   else
     ErrorIf(true, "Invalid Solver type specified.");
 
@@ -6,7 +6,7 @@ namespace Raverie
 
 /// What kind of a constraint solver should be used. A few pre-defined types
 /// meant for comparing performance.
-DeclareEnum4(PhysicsSolverType, Basic, Normal, GenericBasic, Threaded);
+DeclareEnum5(PhysicsSolverType, Basic, Normal, GenericBasic, Threaded, Wide);
 /// How should islands be built. Internal for testing (mostly legacy).
 DeclareEnum3(PhysicsIslandType, Composites, Kinematics, ForcedOne);
 /// What kind of pre-processing strategy should be used for merging islands.
@@ -16,11 +16,17 @@ namespace Physics
 {
 
 class Island;
+class PersistentIsland;
 
-/// Builds, solves and debug draws islands.
+/// Builds, solves and debug draws islands. Also keeps the persistent islands
+/// that decide when groups of bodies fall asleep.
 class IslandManager
 {
 public:
+  /// Islands with at least this many contacts and joints are solved with the
+  /// ThreadedSolver, whose graph coloured batches are solved in parallel.
+  static const uint cColoredIslandConstraintCount = 256;
+
   IslandManager(PhysicsSolverConfig* config);
   ~IslandManager();
 
@@ -30,12 +36,38 @@ public:
   void BuildIslands(ColliderList& colliders);
   void PostProcessIslands();
   void Solve(real dt, bool allowSleeping, uint debugFlags);
+  /// Solves every island's velocity constraints as independent tasks (largest
+  /// islands first). Events and sleeping are dealt with afterwards, serially
+  /// and in island order.
+  void SolveIslandsParallel(real dt, bool allowSleeping, uint debugFlags);
+  /// Solves every island start to finish in island order on this thread.
+  /// Used by deterministic spaces so the solve order never changes.
+  void SolveIslandsSerial(real dt, bool allowSleeping, uint debugFlags);
   void SolvePositions(real dt);
   void Draw(uint flags);
 
   void RemoveCollider(Collider* collider);
   void Clear();
 
+  /// Makes sure every awake dynamic body has a persistent island and merges
+  /// the islands of bodies connected by a contact or joint this step.
+  void UpdatePersistentIslands();
+  /// Puts persistent islands to sleep once every body in them has been at rest
+  /// for long enough. An island that lost constraints is split before it falls
+  /// asleep, and the most restful such island is split every step so a busy
+  /// body it used to touch can't keep it awake.
+  void UpdateSleep(real dt, bool allowSleeping);
+  /// Wakes any asleep body that was solved with awake bodies and started
+  /// moving. Only bodies on an island this step can have been moved.
+  void WakeMovingBodies();
+  /// Wakes every body in the given body's persistent island.
+  void WakePersistentIsland(RigidBody* body);
+  /// A contact or joint between the two colliders was removed, so their
+  /// island might not be connected anymore.
+  void ConstraintRemoved(Collider* colliderA, Collider* colliderB);
+  /// The body was removed from the space or stopped being dynamic.
+  void RemoveBody(RigidBody* body);
+
   /// Returns the Island that Contains the given collider. null if none exists.
   Island* GetObjectsIsland(const Collider* collider);
 
@@ -47,8 +79,23 @@ public:
   void CreateSingleIsland(Policy policy, ColliderList& colliders);
 
   IConstraintSolver* GetNewSolver();
+  IConstraintSolver* CreateSolver(PhysicsSolverType::Enum solverType);
   Island* CreateNewIsland();
 
+  /// Returns the body's persistent island, creating one if it has none.
+  PersistentIsland* GetPersistentIsland(RigidBody* body);
+  /// Merges the smaller island into the larger one (union by size).
+  void MergePersistentIslands(RigidBody* bodyA, RigidBody* bodyB);
+  /// Splits the island into the groups of its bodies that are still connected.
+  /// The first group stays in the island, the rest are added to newIslands.
+  void SplitPersistentIsland(PersistentIsland* island, Array<PersistentIsland*>& newIslands);
+  void SleepPersistentIsland(PersistentIsland* island);
+  /// Kinematic bodies aren't moved by the solver so they have no persistent
+  /// island. They fall asleep once they've been at rest for long enough and
+  /// everything they were solved with this step is asleep.
+  void SleepRestingKinematics();
+  void ClearPersistentIslands();
+
   uint mIslandCount;
   typedef InList<Island, &Island::ManagerLink> IslandList;
   IslandList mIslands;
@@ -64,6 +111,15 @@ public:
   PhysicsSpace* mSpace;
   bool mShareSolver;
   IConstraintSolver* mSharedSolver;
+  /// Solves a deterministic space's islands in parallel while everything else
+  /// (such as the pair order) stays deterministic. Only used to test that the
+  /// parallel solve matches the serial one.
+  bool mForceParallelSolve;
+
+  typedef InList<PersistentIsland, &PersistentIsland::ManagerLink> PersistentIslandList;
+  PersistentIslandList mAwakeIslands;
+  /// Nothing in an asleep island is looked at until something wakes it.
+  PersistentIslandList mAsleepIslands;
 };
 
 } // namespace Physics
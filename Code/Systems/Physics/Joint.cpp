@@ -113,6 +113,7 @@ void Joint::OnDestroy(uint flags)
   {
     mEdges[0].mCollider->ForceAwake();
     mEdges[1].mCollider->ForceAwake();
+    mSpace->ConstraintRemoved(mEdges[0].mCollider, mEdges[1].mCollider);
   }
   // Unlink from the colliders we were connected to. This also marks the joint
   // as not valid just in case any other calls happen that would rely on being
@@ -105,7 +105,7 @@ void PhysicsMesh::GenerateTree()
   mTree.DeleteTree();
 
   // Build the Aabb-Tree
-  mTree.SetPartitionMethod(PartitionMethods::MinimizeVolumeSum);
+  mTree.SetPartitionMethod(PartitionMethods::BinnedSurfaceArea);
 
   // Dummy proxy. They will not be needed.
   BroadPhaseProxy proxy;
@@ -87,7 +87,7 @@ void PhysicsQueue::ProcessQueue(BroadPhaseBatch& staticBatch, BroadPhaseBatch& d
 
 void PhysicsQueue::ColliderToBroadPhaseData(Collider* collider, BroadPhaseData& data)
 {
-  data.mAabb = collider->mAabb;
+  data.mAabb = collider->ComputeSweptAabb();
   data.mClientData = (void*)collider;
   data.mBoundingSphere = collider->mBoundingSphere;
 }
@@ -0,0 +1,451 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+namespace Physics
+{
+
+/// 64 bit FNV-1a over a block of memory.
+u64 HashBytes(u64 hash, const void* data, size_t size)
+{
+  const byte* bytes = (const byte*)data;
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+u64 HashBodyState(RigidBody* body)
+{
+  u64 hash = 0xcbf29ce484222325ull;
+  hash = HashBytes(hash, &body->mCenterOfMass, sizeof(body->mCenterOfMass));
+  hash = HashBytes(hash, &body->mRotationQuat, sizeof(body->mRotationQuat));
+  hash = HashBytes(hash, &body->mVelocity, sizeof(body->mVelocity));
+  hash = HashBytes(hash, &body->mAngularVelocity, sizeof(body->mAngularVelocity));
+  byte asleep = body->IsAsleep() ? 1 : 0;
+  hash = HashBytes(hash, &asleep, sizeof(asleep));
+  return hash;
+}
+
+u64 CombineBodyHash(u64 hash, u64 bodyHash)
+{
+  // Addition doesn't care about order. Mixing the body's hash first keeps
+  // similar bodies from cancelling each other out.
+  bodyHash ^= bodyHash >> 33;
+  bodyHash *= 0xff51afd7ed558ccdull;
+  bodyHash ^= bodyHash >> 33;
+  return hash + bodyHash;
+}
+
+/// The collider of the given object if it is still in the space.
+Collider* FindCollider(CogId id, PhysicsSpace* space)
+{
+  Cog* cog = id;
+  if (cog == nullptr)
+    return nullptr;
+
+  Collider* collider = cog->has(Collider);
+  if (collider == nullptr || collider->mSpace != space)
+    return nullptr;
+  return collider;
+}
+
+} // namespace Physics
+
+RaverieDefineType(PhysicsSnapshot, builder, type)
+{
+  RaverieBindDocumented();
+
+  RaverieBindGetter(BodyCount);
+  RaverieBindGetter(StateHash);
+  RaverieBindGetter(SizeInBytes);
+}
+
+void PhysicsSnapshot::Save(PhysicsSpace* space)
+{
+  mBodies.Clear();
+  mContacts.Clear();
+  mIslands.Clear();
+  mIslandBodies.Clear();
+  mColliders.Clear();
+  mColliderEdges.Clear();
+  mDynamicColliders.Clear();
+  mSleepingColliders.Clear();
+  mStateHash = space->ComputeStateHash();
+
+  HashMap<RigidBody*, uint> bodyIndices;
+  RigidBodyList* lists[] = {&space->mRigidBodies, &space->mInactiveRigidBodies};
+  for (uint i = 0; i < 2; ++i)
+  {
+    RigidBodyList::range range = lists[i]->All();
+    for (; !range.Empty(); range.PopFront())
+    {
+      RigidBody& body = range.Front();
+      if (!body.IsDynamic())
+        continue;
+
+      bodyIndices.Insert(&body, mBodies.Size());
+      BodyState& state = mBodies.PushBack();
+      state.mCog = body.GetOwner();
+      state.mCenterOfMass = body.mCenterOfMass;
+      state.mRotation = body.mRotationQuat;
+      state.mVelocity = body.mVelocity;
+      state.mAngularVelocity = body.mAngularVelocity;
+      state.mForceAccumulator = body.mForceAccumulator;
+      state.mTorqueAccumulator = body.mTorqueAccumulator;
+      state.mSleepTimer = body.mSleepTimer;
+      state.mAsleep = body.IsAsleep();
+      state.mSleepAccumulated = body.mState.IsSet(RigidBodyStates::SleepAccumulated);
+      state.mInactive = (i == 1);
+    }
+  }
+
+  // Every contact has at least one collider with a body, so walking the
+  // collider lists finds all of them
+  HashMap<Physics::Contact*, uint> contactIndices;
+  Array<Physics::Contact*> contacts;
+  SaveColliders(space->mDynamicColliders, mDynamicColliders, contactIndices, contacts);
+  SaveColliders(space->mSleepingColliders, mSleepingColliders, contactIndices, contacts);
+
+  // Islands are built by walking each collider's contacts in order, so that
+  // order is needed for the solve order to come out the same
+  HashSet<Collider*> saved;
+  for (uint i = 0; i < contacts.Size(); ++i)
+  {
+    SaveEdges(contacts[i]->GetCollider(0), contactIndices, saved);
+    SaveEdges(contacts[i]->GetCollider(1), contactIndices, saved);
+  }
+
+  Physics::IslandManager* islandManager = space->mIslandManager;
+  SaveIslands(islandManager->mAwakeIslands, bodyIndices);
+  SaveIslands(islandManager->mAsleepIslands, bodyIndices);
+}
+
+void PhysicsSnapshot::Restore(PhysicsSpace* space)
+{
+  Physics::IslandManager* islandManager = space->mIslandManager;
+  Physics::ContactManager* contactManager = space->mContactManager;
+
+  // The islands from the last step refer to the contacts that are about to be
+  // replaced. The next step builds new ones from scratch anyway.
+  islandManager->Clear();
+
+  HashSet<Physics::Contact*> found;
+  Array<Physics::Contact*> oldContacts;
+  ColliderList* colliderLists[] = {&space->mDynamicColliders, &space->mSleepingColliders};
+  for (uint i = 0; i < 2; ++i)
+  {
+    ColliderList::range colliders = colliderLists[i]->All();
+    for (; !colliders.Empty(); colliders.PopFront())
+    {
+      Collider::ContactEdgeList::range edges = colliders.Front().mContactEdges.All();
+      for (; !edges.Empty(); edges.PopFront())
+      {
+        Physics::Contact* contact = edges.Front().mContact;
+        if (found.Contains(contact))
+          continue;
+
+        found.Insert(contact);
+        oldContacts.PushBack(contact);
+      }
+    }
+  }
+  for (uint i = 0; i < oldContacts.Size(); ++i)
+    contactManager->RemoveForRestore(oldContacts[i]);
+
+  // Bodies are put back into their lists in the order they were saved
+  Array<RigidBody*> bodies;
+  bodies.Resize(mBodies.Size(), nullptr);
+  for (uint i = 0; i < mBodies.Size(); ++i)
+  {
+    BodyState& state = mBodies[i];
+    Cog* cog = state.mCog;
+    if (cog == nullptr)
+      continue;
+
+    RigidBody* body = cog->has(RigidBody);
+    if (body == nullptr || body->mSpace != space || !body->IsDynamic())
+      continue;
+    bodies[i] = body;
+
+    body->mCenterOfMass = state.mCenterOfMass;
+    body->mRotationQuat = state.mRotation;
+    body->InternalRecomputeOrientation();
+    body->GenerateIntegrationUpdate();
+
+    body->mVelocity = state.mVelocity;
+    body->mAngularVelocity = state.mAngularVelocity;
+    body->mForceAccumulator = state.mForceAccumulator;
+    body->mTorqueAccumulator = state.mTorqueAccumulator;
+    body->mSleepTimer = state.mSleepTimer;
+
+    // The sleep state is set directly, going through SetAsleep would send
+    // events and wake or sleep the body's whole island
+    body->mState.SetState(RigidBodyStates::Asleep, state.mAsleep);
+    body->mState.SetState(RigidBodyStates::SleepAccumulated, state.mSleepAccumulated);
+    space->SetCollidersAsleep(body, state.mAsleep);
+
+    RigidBodyList::Unlink(body);
+    if (state.mInactive)
+    {
+      space->mInactiveRigidBodies.PushBack(body);
+      space->mBodyStore.Remove(body);
+    }
+    else
+    {
+      space->mRigidBodies.PushBack(body);
+      space->mBodyStore.Add(body);
+    }
+  }
+
+  // Which bodies sleep together
+  islandManager->ClearPersistentIslands();
+  for (uint i = 0; i < mIslands.Size(); ++i)
+  {
+    IslandState& state = mIslands[i];
+    Physics::PersistentIsland* island = new Physics::PersistentIsland();
+    island->mAsleep = state.mAsleep;
+    island->mRemovedConstraintCount = state.mRemovedConstraintCount;
+    for (uint j = 0; j < state.mBodyCount; ++j)
+    {
+      RigidBody* body = bodies[mIslandBodies[state.mFirstBody + j]];
+      // The same as the body being removed from the island
+      if (body == nullptr)
+      {
+        ++island->mRemovedConstraintCount;
+        continue;
+      }
+
+      island->mBodies.PushBack(body);
+      ++island->mBodyCount;
+      body->mPersistentIsland = island;
+    }
+
+    if (island->mBodyCount == 0)
+      delete island;
+    else if (island->mAsleep)
+      islandManager->mAsleepIslands.PushBack(island);
+    else
+      islandManager->mAwakeIslands.PushBack(island);
+  }
+
+  RestoreColliders(space, mDynamicColliders, space->mDynamicColliders, false);
+  RestoreColliders(space, mSleepingColliders, space->mSleepingColliders, true);
+
+  // Contacts are recreated as they were, flags and all. Contacts with a
+  // collider that no longer exists are dropped.
+  Array<Physics::Contact*> contacts;
+  contacts.Resize(mContacts.Size(), nullptr);
+  for (uint i = 0; i < mContacts.Size(); ++i)
+  {
+    ContactState& state = mContacts[i];
+    Collider* colliderA = Physics::FindCollider(state.mColliders[0], space);
+    Collider* colliderB = Physics::FindCollider(state.mColliders[1], space);
+    if (colliderA == nullptr || colliderB == nullptr)
+      continue;
+
+    Physics::Manifold manifold = state.mManifold;
+    manifold.Objects.A = colliderA;
+    manifold.Objects.B = colliderB;
+    contacts[i] = contactManager->RestoreContact(manifold, state.mFlags);
+  }
+
+  for (uint i = 0; i < mColliders.Size(); ++i)
+  {
+    ColliderEdgeState& state = mColliders[i];
+    Collider* collider = Physics::FindCollider(state.mCollider, space);
+    if (collider == nullptr)
+      continue;
+
+    for (uint j = 0; j < state.mEdgeCount; ++j)
+    {
+      uint edgeIndex = mColliderEdges[state.mFirstEdge + j];
+      Physics::Contact* contact = contacts[edgeIndex / 2];
+      if (contact == nullptr)
+        continue;
+
+      Physics::ContactEdge* edge = &contact->mEdges[edgeIndex % 2];
+      Collider::ContactEdgeList::Unlink(edge);
+      collider->mContactEdges.PushBack(edge);
+    }
+  }
+}
+
+void PhysicsSnapshot::SaveIslands(Physics::IslandManager::PersistentIslandList& islands, HashMap<RigidBody*, uint>& bodyIndices)
+{
+  Physics::IslandManager::PersistentIslandList::range range = islands.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Physics::PersistentIsland& island = range.Front();
+    IslandState& state = mIslands.PushBack();
+    state.mFirstBody = mIslandBodies.Size();
+    state.mRemovedConstraintCount = island.mRemovedConstraintCount;
+    state.mAsleep = island.mAsleep;
+
+    Physics::PersistentIsland::BodyList::range bodies = island.mBodies.All();
+    for (; !bodies.Empty(); bodies.PopFront())
+    {
+      uint* index = bodyIndices.FindPointer(&bodies.Front());
+      if (index != nullptr)
+        mIslandBodies.PushBack(*index);
+    }
+    state.mBodyCount = mIslandBodies.Size() - state.mFirstBody;
+  }
+}
+
+void PhysicsSnapshot::SaveColliders(ColliderList& colliders, Array<CogId>& order, HashMap<Physics::Contact*, uint>& contactIndices, Array<Physics::Contact*>& contacts)
+{
+  ColliderList::range range = colliders.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Collider& collider = range.Front();
+    order.PushBack(collider.GetOwner());
+
+    Collider::ContactEdgeList::range edges = collider.mContactEdges.All();
+    for (; !edges.Empty(); edges.PopFront())
+    {
+      Physics::Contact* contact = edges.Front().mContact;
+      if (contactIndices.ContainsKey(contact))
+        continue;
+
+      contactIndices.Insert(contact, mContacts.Size());
+      contacts.PushBack(contact);
+
+      Physics::Manifold* manifold = contact->GetManifold();
+      ContactState& state = mContacts.PushBack();
+      state.mColliders[0] = manifold->Objects[0]->GetOwner();
+      state.mColliders[1] = manifold->Objects[1]->GetOwner();
+      state.mFlags = contact->mFlags.U32Field;
+      state.mManifold = *manifold;
+    }
+  }
+}
+
+void PhysicsSnapshot::SaveEdges(Collider* collider, HashMap<Physics::Contact*, uint>& contactIndices, HashSet<Collider*>& saved)
+{
+  if (saved.Contains(collider))
+    return;
+  saved.Insert(collider);
+
+  ColliderEdgeState& state = mColliders.PushBack();
+  state.mCollider = collider->GetOwner();
+  state.mFirstEdge = mColliderEdges.Size();
+
+  Collider::ContactEdgeList::range edges = collider->mContactEdges.All();
+  for (; !edges.Empty(); edges.PopFront())
+  {
+    Physics::ContactEdge& edge = edges.Front();
+    uint* index = contactIndices.FindPointer(edge.mContact);
+    if (index == nullptr)
+      continue;
+
+    uint side = (&edge == &edge.mContact->mEdges[0]) ? 0 : 1;
+    mColliderEdges.PushBack(*index * 2 + side);
+  }
+  state.mEdgeCount = mColliderEdges.Size() - state.mFirstEdge;
+}
+
+void PhysicsSnapshot::RestoreColliders(PhysicsSpace* space, Array<CogId>& order, ColliderList& colliders, bool asleep)
+{
+  for (uint i = 0; i < order.Size(); ++i)
+  {
+    Collider* collider = Physics::FindCollider(order[i], space);
+    // Only colliders with a body are in the awake and asleep lists
+    if (collider == nullptr || collider->GetActiveBody() == nullptr)
+      continue;
+    if (asleep && !collider->IsAsleep())
+      continue;
+
+    ColliderList::Unlink(collider);
+    collider->mState.SetState(ColliderFlags::Sleeping, asleep);
+    colliders.PushBack(collider);
+  }
+}
+
+// A few stacks of boxes on a static floor. Big enough for the boxes to collide,
+// push each other around and fall asleep, small enough for every island to be
+// solved without graph colouring.
+static Space* CreateTestSpace()
+{
+  Space* space = Z::gFactory->CreateSpace(CoreArchetypes::DefaultSpace, CreationFlags::Default, nullptr);
+  space->has(PhysicsSpace)->SetDeterministic(true);
+
+  Cog* floor = space->CreateAt(CoreArchetypes::Cube, Vec3(0, real(-0.5), 0), Vec3(20, 1, 20));
+  floor->has(RigidBody)->SetDynamicState(RigidBodyDynamicState::Static);
+
+  for (uint stack = 0; stack < 4; ++stack)
+  {
+    for (uint level = 0; level < 5; ++level)
+    {
+      // Offset each level a little so the stacks topple
+      Vec3 position(real(stack) * real(2.0) - real(3.0), real(level) + real(0.5), real(level) * real(0.1));
+      space->CreateAt(CoreArchetypes::Cube, position);
+    }
+  }
+
+  return space;
+}
+
+static void StepTestSpace(PhysicsSpace* space, uint stepCount)
+{
+  UpdateEvent updateEvent(0.016f, 0.016f, 0.0f, 0.0f);
+  for (uint i = 0; i < stepCount; ++i)
+    space->SystemLogicUpdate(&updateEvent);
+}
+
+void PhysicsSnapshot::RunUnitTests()
+{
+  const uint cStepCount = 120;
+
+  // Deterministic spaces solve their islands serially. Forcing the parallel
+  // solve leaves only that difference (turning off determinism would also
+  // change the pair order), and islands this small aren't coloured, so both
+  // have to end up the same.
+  Space* serialSpace = CreateTestSpace();
+  Space* parallelSpace = CreateTestSpace();
+  PhysicsSpace* serial = serialSpace->has(PhysicsSpace);
+  PhysicsSpace* parallel = parallelSpace->has(PhysicsSpace);
+  parallel->mIslandManager->mForceParallelSolve = true;
+
+  StepTestSpace(serial, cStepCount);
+  StepTestSpace(parallel, cStepCount);
+  ErrorIf(serial->ComputeStateHash() != parallel->ComputeStateHash(), "Solving islands in parallel changed the simulation");
+
+  // Rolling back and re-simulating has to give exactly the same result
+  HandleOf<PhysicsSnapshot> snapshot = serial->SaveSnapshot();
+  StepTestSpace(serial, cStepCount);
+  u64 expectedHash = serial->ComputeStateHash();
+
+  serial->RestoreSnapshot(snapshot);
+  ErrorIf(serial->ComputeStateHash() != snapshot->mStateHash, "Restoring a snapshot didn't restore the bodies");
+  StepTestSpace(serial, cStepCount);
+  ErrorIf(serial->ComputeStateHash() != expectedHash, "Re-simulating from a snapshot changed the simulation");
+
+  serialSpace->Destroy();
+  parallelSpace->Destroy();
+}
+
+uint PhysicsSnapshot::GetBodyCount()
+{
+  return mBodies.Size();
+}
+
+s64 PhysicsSnapshot::GetStateHash()
+{
+  return (s64)mStateHash;
+}
+
+uint PhysicsSnapshot::GetSizeInBytes()
+{
+  uint size = mBodies.Size() * sizeof(BodyState) + mContacts.Size() * sizeof(ContactState);
+  size += mIslands.Size() * sizeof(IslandState) + mIslandBodies.Size() * sizeof(uint);
+  size += mColliders.Size() * sizeof(ColliderEdgeState) + mColliderEdges.Size() * sizeof(uint);
+  size += (mDynamicColliders.Size() + mSleepingColliders.Size()) * sizeof(CogId);
+  return size;
+}
+
+} // namespace Raverie
@@ -0,0 +1,121 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// A binary copy of the simulated state of a PhysicsSpace: its dynamic bodies,
+/// every contact (with its flags and cached manifold), the persistent islands
+/// that decide when bodies sleep and the order of the space's lists.
+/// Restoring a snapshot puts all of it back exactly as it was (bit for bit) so
+/// a deterministic space can be rolled back and re-simulated. Snapshots refer
+/// to objects by id, so they are only valid in the space (and process) they
+/// were taken from. Kinematic and static bodies are driven by the game and
+/// joints keep their own state, so neither is stored.
+class PhysicsSnapshot : public ReferenceCountedObject
+{
+public:
+  RaverieDeclareType(PhysicsSnapshot, TypeCopyMode::ReferenceType);
+
+  /// The state of one dynamic body. Plain data so the whole array can be
+  /// copied or hashed as a block.
+  struct BodyState
+  {
+    CogId mCog;
+    Vec3 mCenterOfMass;
+    Quat mRotation;
+    Vec3 mVelocity;
+    Vec3 mAngularVelocity;
+    Vec3 mForceAccumulator;
+    Vec3 mTorqueAccumulator;
+    real mSleepTimer;
+    bool mAsleep;
+    bool mSleepAccumulated;
+    /// Whether the body was in the space's inactive list (bodies that fall
+    /// asleep only move there on the next step).
+    bool mInactive;
+  };
+
+  /// A contact and the colliders it is between (in the order of the
+  /// manifold's objects). The accumulated impulses of the manifold's points
+  /// are what warm start the solver, so they are part of the simulated state.
+  struct ContactState
+  {
+    CogId mColliders[2];
+    uint mFlags;
+    Physics::Manifold mManifold;
+  };
+
+  /// A persistent island, its bodies are mIslandBodies[mFirstBody] onwards.
+  struct IslandState
+  {
+    uint mFirstBody;
+    uint mBodyCount;
+    uint mRemovedConstraintCount;
+    bool mAsleep;
+  };
+
+  /// The contacts of a collider in the order they are traversed when islands
+  /// are built. Its edges are mColliderEdges[mFirstEdge] onwards, each one a
+  /// contact index times two plus the side of the contact the collider is on.
+  struct ColliderEdgeState
+  {
+    CogId mCollider;
+    uint mFirstEdge;
+    uint mEdgeCount;
+  };
+
+  /// Copies the simulated state of the space.
+  void Save(PhysicsSpace* space);
+  /// Restores the state of everything that still exists. Objects created after
+  /// the snapshot was taken are left alone and contacts with a collider that
+  /// was destroyed are dropped.
+  void Restore(PhysicsSpace* space);
+
+  /// The number of bodies stored.
+  uint GetBodyCount();
+  /// The hash of the stored state (the same value PhysicsSpace::StateHash
+  /// had when the snapshot was taken).
+  s64 GetStateHash();
+
+  /// The size of the stored state in bytes.
+  uint GetSizeInBytes();
+
+  /// Steps a deterministic space and checks that its state hash is the same
+  /// solved serially or in parallel and after a snapshot round trip. Run with
+  /// the RunUnitTests command line argument.
+  static void RunUnitTests();
+
+  Array<BodyState> mBodies;
+  Array<ContactState> mContacts;
+  Array<IslandState> mIslands;
+  /// Indices into mBodies.
+  Array<uint> mIslandBodies;
+  Array<ColliderEdgeState> mColliders;
+  Array<uint> mColliderEdges;
+  /// The order of the space's awake and asleep collider lists.
+  Array<CogId> mDynamicColliders;
+  Array<CogId> mSleepingColliders;
+  u64 mStateHash;
+
+private:
+  void SaveIslands(Physics::IslandManager::PersistentIslandList& islands, HashMap<RigidBody*, uint>& bodyIndices);
+  void SaveColliders(ColliderList& colliders, Array<CogId>& order, HashMap<Physics::Contact*, uint>& contactIndices, Array<Physics::Contact*>& contacts);
+  void SaveEdges(Collider* collider, HashMap<Physics::Contact*, uint>& contactIndices, HashSet<Collider*>& saved);
+  void RestoreColliders(PhysicsSpace* space, Array<CogId>& order, ColliderList& colliders, bool asleep);
+};
+
+namespace Physics
+{
+
+/// Hashes the simulated state of a body (position, rotation, velocities and
+/// sleep state). Works on the bits of the values so any difference at all
+/// between two simulations changes the hash.
+u64 HashBodyState(RigidBody* body);
+/// Combines body hashes in a way that doesn't depend on the order the bodies
+/// are visited in (bodies move between the space's lists as they sleep).
+u64 CombineBodyHash(u64 hash, u64 bodyHash);
+
+} // namespace Physics
+
+} // namespace Raverie
@@ -288,6 +288,9 @@ RaverieDefineType(PhysicsSolverConfig, builder, type)
   RaverieBindGetterSetterProperty(SolverIterationCount);
   RaverieBindGetterSetterProperty(PositionIterationCount);
   RaverieBindGetterSetterProperty(VelocityRestitutionThreshold);
+  RaverieBindGetterSetterProperty(SpeculativeContacts);
+  RaverieBindGetterSetterProperty(TimeOfImpactClamping);
+  RaverieBindGetterSetterProperty(SolverType);
 
   // @JoshD: Hide for now so these won't confuse anyone
   // These properties are only for showing people how constraints handle
@@ -295,13 +298,14 @@ RaverieDefineType(PhysicsSolverConfig, builder, type)
   // RaverieBindFieldProperty(mWarmStart);
   // RaverieBindFieldProperty(mCacheContacts);
   // RaverieBindGetterSetterProperty(SubCorrectionType);
-  // RaverieBindGetterSetterProperty(SolverType);
 
   RaverieBindGetterSetterProperty(PositionCorrectionType);
 }
 
 PhysicsSolverConfig::PhysicsSolverConfig()
 {
+  mSpeculativeContacts = true;
+  mTimeOfImpactClamping = true;
   mTangentType = PhysicsContactTangentTypes::OrthonormalTangents;
   mPositionCorrectionType = PhysicsSolverPositionCorrection::Baumgarte;
   mSolverType = PhysicsSolverType::Basic;
@@ -318,6 +322,8 @@ void PhysicsSolverConfig::Serialize(Serializer& stream)
   SerializeNameDefault(mSolverIterationCount, 15u);
   SerializeNameDefault(mPositionIterationCount, 3u);
   SerializeNameDefault(mVelocityRestitutionThreshold, real(3.0f));
+  SerializeNameDefault(mSpeculativeContacts, true);
+  SerializeNameDefault(mTimeOfImpactClamping, true);
   SerializeNameDefault(mWarmStart, true);
   SerializeNameDefault(mCacheContacts, true);
 
@@ -390,6 +396,26 @@ void PhysicsSolverConfig::SetVelocityRestitutionThreshold(real threshold)
   mVelocityRestitutionThreshold = threshold;
 }
 
+bool PhysicsSolverConfig::GetSpeculativeContacts()
+{
+  return mSpeculativeContacts;
+}
+
+void PhysicsSolverConfig::SetSpeculativeContacts(bool state)
+{
+  mSpeculativeContacts = state;
+}
+
+bool PhysicsSolverConfig::GetTimeOfImpactClamping()
+{
+  return mTimeOfImpactClamping;
+}
+
+void PhysicsSolverConfig::SetTimeOfImpactClamping(bool state)
+{
+  mTimeOfImpactClamping = state;
+}
+
 PhysicsSolverType::Enum PhysicsSolverConfig::GetSolverType() const
 {
   return mSolverType;
@@ -467,6 +493,8 @@ void PhysicsSolverConfig::CopyTo(PhysicsSolverConfig* destination)
   destination->mSolverIterationCount = mSolverIterationCount;
   destination->mPositionIterationCount = mPositionIterationCount;
   destination->mVelocityRestitutionThreshold = mVelocityRestitutionThreshold;
+  destination->mSpeculativeContacts = mSpeculativeContacts;
+  destination->mTimeOfImpactClamping = mTimeOfImpactClamping;
   destination->mWarmStart = mWarmStart;
   destination->mCacheContacts = mCacheContacts;
   destination->mTangentType = mTangentType;
@@ -129,9 +129,21 @@ public:
   /// relative velocity between the two objects is above this value.
   real GetVelocityRestitutionThreshold();
   void SetVelocityRestitutionThreshold(real threshold);
+  /// Should bodies with ContinuousCollision get contacts for objects they will
+  /// hit before the end of the timestep? The solver then only lets them close
+  /// the remaining gap instead of moving through the object.
+  bool GetSpeculativeContacts();
+  void SetSpeculativeContacts(bool state);
+  /// Should bodies with ContinuousCollision that would still move through a
+  /// speculative contact after solving only be moved up to the time of impact?
+  /// Catches what the solver couldn't resolve at the cost of losing the rest
+  /// of the timestep's motion for those bodies.
+  bool GetTimeOfImpactClamping();
+  void SetTimeOfImpactClamping(bool state);
 
   /// The kind of solver used. For the most part this is
-  /// internal and should only affect performance.
+  /// internal and should only affect performance. Wide solves several contacts
+  /// at once and is best for scenes with large stacks or piles.
   PhysicsSolverType::Enum GetSolverType() const;
   void SetSolverType(PhysicsSolverType::Enum solverType);
   /// What method should be used to fix errors in joints. Baumgarte fixes errors
@@ -158,6 +170,8 @@ public:
   uint mSolverIterationCount;
   uint mPositionIterationCount;
   real mVelocityRestitutionThreshold;
+  bool mSpeculativeContacts;
+  bool mTimeOfImpactClamping;
   /// Should warm starting be performed? This should always be true. Exposed
   /// property for debugging.
   bool mWarmStart;
@@ -125,12 +125,15 @@ RaverieDefineType(PhysicsSpace, builder, type)
   RaverieBindGetterSetterProperty(AllowSleep);
   RaverieBindGetterSetterProperty(Mode2D);
   RaverieBindGetterSetterProperty(Deterministic);
+  RaverieBindGetterSetterProperty(ContiguousIntegration);
   RaverieBindGetterSetterProperty(CollisionTable);
   RaverieBindGetterSetterProperty(PhysicsSolverConfig);
 
   // Broad-phase types
   RaverieBindFieldProperty(mDynamicBroadphaseType)->Add(new DynamicBroadphasePropertyExtension());
   RaverieBindFieldProperty(mStaticBroadphaseType)->Add(new StaticBroadphasePropertyExtension());
+  RaverieBindFieldProperty(mAutoTuneBroadPhases);
+  RaverieBindFieldProperty(mHierarchicalGridCellSize);
 
   RaverieBindMethod(AddPairFilter);
   RaverieBindMethod(AddHierarchyPairFilter);
@@ -139,6 +142,11 @@ RaverieDefineType(PhysicsSpace, builder, type)
 
   RaverieBindMethod(FlushPhysicsQueue);
 
+  // Lockstep
+  RaverieBindGetter(StateHash);
+  RaverieBindMethod(SaveSnapshot);
+  RaverieBindMethod(RestoreSnapshot);
+
   // Ray Cast
   RaverieBindOverloadedMethod(CastRayFirst, RaverieInstanceOverload(CastResult, const Ray&));
   RaverieBindOverloadedMethod(CastRayFirst, RaverieInstanceOverload(CastResult, const Ray&, CastFilter&));
@@ -147,6 +155,8 @@ RaverieDefineType(PhysicsSpace, builder, type)
   // Segment Cast
   RaverieBindOverloadedMethod(CastSegment, RaverieInstanceOverload(CastResultsRange, const Segment&, uint));
   RaverieBindOverloadedMethod(CastSegment, RaverieInstanceOverload(CastResultsRange, const Segment&, uint, CastFilter&));
+  RaverieBindOverloadedMethod(CastRays, RaverieInstanceOverload(void, CastBatch&));
+  RaverieBindOverloadedMethod(CastRays, RaverieInstanceOverload(void, CastBatch&, CastFilter&));
   // Volume Cast
   RaverieBindOverloadedMethod(CastAabb, RaverieInstanceOverload(CastResultsRange, const Aabb&, uint, CastFilter&));
   RaverieBindOverloadedMethod(CastSphere, RaverieInstanceOverload(CastResultsRange, const Sphere&, uint, CastFilter&));
@@ -190,6 +200,9 @@ PhysicsSpace::PhysicsSpace()
 
   mInvalidVelocityOccurred = false;
   mMaxVelocity = real(1e+10);
+  mAutoTuneBroadPhases = false;
+  mHierarchicalGridCellSize = real(1.0);
+  mStateHash = 0;
 }
 
 PhysicsSpace::~PhysicsSpace()
@@ -226,6 +239,8 @@ void PhysicsSpace::Serialize(Serializer& stream)
   // For now just save what broadphase to use, not any broadphase properties
   SerializeNameDefault(mDynamicBroadphaseType, RaverieTypeId(DynamicAabbTreeBroadPhase)->Name);
   SerializeNameDefault(mStaticBroadphaseType, RaverieTypeId(StaticAabbTreeBroadPhase)->Name);
+  SerializeNameDefault(mAutoTuneBroadPhases, false);
+  SerializeNameDefault(mHierarchicalGridCellSize, real(1.0));
 }
 
 void PhysicsSpace::Initialize(CogInitializer& initializer)
@@ -243,17 +258,26 @@ void PhysicsSpace::Initialize(CogInitializer& initializer)
   mEventManager->SetAllocator(mHeap);
   mCollisionManager = mPhysicsEngine->mCollisionManager;
 
-  // Create the broadphases
-  mBroadPhase = new BroadPhasePackage();
+  // Create the broadphases. The broadphase types are only a starting point
+  // when auto tuning, which is left off in the editor
+  bool editorMode = GetOwner()->GetSpace()->IsEditorMode();
+  if (mAutoTuneBroadPhases && !editorMode)
+    mBroadPhase = new BroadPhaseAutoTuner();
+  else
+    mBroadPhase = new BroadPhasePackage();
   // Switch the static broadphase to the DynamicAabbTree if in
   // editor mode (so moving static objects isn't slow)
   String staticBroadPhaseType = mStaticBroadphaseType;
-  if (GetOwner()->GetSpace()->IsEditorMode())
+  if (editorMode)
     staticBroadPhaseType = RaverieTypeId(DynamicAabbTreeBroadPhase)->Name;
 
   BroadPhaseLibrary* library = Z::gBroadPhaseLibrary;
-  mBroadPhase->AddBroadPhase(BroadPhase::Static, library->CreateBroadPhase(staticBroadPhaseType));
-  mBroadPhase->AddBroadPhase(BroadPhase::Dynamic, library->CreateBroadPhase(mDynamicBroadphaseType));
+  IBroadPhase* staticBroadPhase = library->CreateBroadPhase(staticBroadPhaseType);
+  IBroadPhase* dynamicBroadPhase = library->CreateBroadPhase(mDynamicBroadphaseType);
+  ApplyBroadPhaseSettings(staticBroadPhase);
+  ApplyBroadPhaseSettings(dynamicBroadPhase);
+  mBroadPhase->AddBroadPhase(BroadPhase::Static, staticBroadPhase);
+  mBroadPhase->AddBroadPhase(BroadPhase::Dynamic, dynamicBroadPhase);
   mBroadPhase->Initialize();
 
   mPhysicsEngine->AddSpace(this);
@@ -508,6 +532,57 @@ void PhysicsSpace::SetDeterministic(bool state)
   mStateFlags.SetState(PhysicsSpaceFlags::Deterministic, state);
 }
 
+s64 PhysicsSpace::GetStateHash() const
+{
+  return (s64)mStateHash;
+}
+
+u64 PhysicsSpace::ComputeStateHash()
+{
+  u64 hash = 0;
+  RigidBodyList* lists[] = {&mRigidBodies, &mInactiveRigidBodies};
+  for (uint i = 0; i < 2; ++i)
+  {
+    RigidBodyList::range range = lists[i]->All();
+    for (; !range.Empty(); range.PopFront())
+    {
+      RigidBody* body = &range.Front();
+      if (body->IsDynamic())
+        hash = Physics::CombineBodyHash(hash, Physics::HashBodyState(body));
+    }
+  }
+  return hash;
+}
+
+HandleOf<PhysicsSnapshot> PhysicsSpace::SaveSnapshot()
+{
+  PhysicsSnapshot* snapshot = new PhysicsSnapshot();
+  snapshot->Save(this);
+  return snapshot;
+}
+
+void PhysicsSpace::RestoreSnapshot(PhysicsSnapshot* snapshot)
+{
+  if (snapshot == nullptr)
+  {
+    DoNotifyException("Invalid snapshot", "Cannot restore a null snapshot.");
+    return;
+  }
+
+  snapshot->Restore(this);
+  mStateHash = snapshot->mStateHash;
+}
+
+bool PhysicsSpace::GetContiguousIntegration() const
+{
+  return mStateFlags.IsSet(PhysicsSpaceFlags::ContiguousIntegration);
+}
+
+void PhysicsSpace::SetContiguousIntegration(bool state)
+{
+  mStateFlags.SetState(PhysicsSpaceFlags::ContiguousIntegration, state);
+}
+
 CollisionGroupInstance* PhysicsSpace::GetCollisionGroupInstance(ResourceId groupId) const
 {
   return mCollisionTable->GetGroupInstance(groupId);
@@ -550,6 +625,7 @@ void PhysicsSpace::FixCollisionTable(CollisionTable* table)
   mCollisionTable = table;
   FixColliderCollisionGroups(mDynamicColliders);
   FixColliderCollisionGroups(mStaticColliders);
+  FixColliderCollisionGroups(mSleepingColliders);
 }
 
 PhysicsSolverConfig* PhysicsSpace::GetPhysicsSolverConfig()
@@ -648,6 +724,8 @@ void PhysicsSpace::IterateTimestep(real dt)
     IntegrateBodiesVelocity(dt);
   }
 
+  QueueContinuousBodies();
+
   // Update the queues so that broadphase and transform are correct. It is also
   // the appropriate time to update the kinematic states so that we can avoid
   // calculating velocity (sometimes incorrectly) more than once a frame.
@@ -671,7 +749,10 @@ void PhysicsSpace::IterateTimestep(real dt)
 
   {
     ProfileScopeTree("Position Integration", "Iteration", Color::Goldenrod);
+    Array<ClampedBody> clampedBodies;
+    ClampToTimesOfImpact(dt, clampedBodies);
     IntegrateBodiesPosition(dt);
+    RestoreClampedBodies(clampedBodies);
   }
 
   SolvePositions(dt);
@@ -683,10 +764,17 @@ void PhysicsSpace::IterateTimestep(real dt)
   UpdatePhysicsCarsTransforms(dt);
 
   PushBroadPhaseQueue();
+
+  // Hashing every body isn't free, so only lockstep spaces pay for it
+  if (GetDeterministic())
+    mStateHash = ComputeStateHash();
 }
 
 void PhysicsSpace::IntegrateBodiesVelocity(real dt)
 {
+  // The simd integration can round differently between builds, so
+  // deterministic spaces always integrate one body at a time
+  bool contiguous = GetContiguousIntegration() && !GetDeterministic();
   RigidBodyList::range range = mRigidBodies.All();
 
   while (!range.Empty())
@@ -706,19 +794,46 @@ void PhysicsSpace::IntegrateBodiesVelocity(real dt)
       // Change to the inactive list
       mRigidBodies.Erase(&body);
       mInactiveRigidBodies.PushBack(&body);
+      mBodyStore.Remove(&body);
       continue;
     }
 
     if (!body.GetStatic())
-      Physics::Integration::IntegrateVelocity(&body, dt);
+    {
+      if (contiguous)
+        mBodyStore.GatherVelocity(&body, dt);
+      else
+        Physics::Integration::IntegrateVelocity(&body, dt);
+    }
 
     body.mForceAccumulator.ZeroOut();
     body.mTorqueAccumulator.ZeroOut();
   }
+
+  if (contiguous)
+  {
+    mBodyStore.IntegrateVelocities(dt, mMaxVelocity);
+    mBodyStore.ScatterVelocities();
+  }
 }
 
 void PhysicsSpace::IntegrateBodiesPosition(real dt)
 {
+  if (GetContiguousIntegration() && !GetDeterministic())
+  {
+    RigidBodyList::range range = mRigidBodies.All();
+    for (; !range.Empty(); range.PopFront())
+    {
+      RigidBody& body = range.Front();
+      if (!body.GetStatic())
+        mBodyStore.GatherPosition(&body);
+    }
+
+    mBodyStore.IntegratePositions(dt);
+    mBodyStore.ScatterPositions(dt);
+    return;
+  }
+
   RigidBodyList::range range = mRigidBodies.All();
 
   while (!range.Empty())
@@ -760,6 +875,7 @@ void PhysicsSpace::BroadPhase()
     }
 
     ColliderToBroadPhaseData(&collider, broadPhaseData);
+    broadPhaseData.mAabb = collider.ComputeSweptAabb();
     dataArray.PushBack(broadPhaseData);
     range.PopFront();
   }
@@ -775,55 +891,289 @@ void PhysicsSpace::BroadPhase()
     Sort(mPossiblePairs.All(), &ClientPairSorter);
 }
 
+/// The manifolds found by one narrow phase task for a contiguous range of pairs.
+struct NarrowPhaseChunk
+{
+  Physics::ManifoldArray mManifolds;
+  /// The index of every pair that collided and where its manifolds end.
+  Array<uint> mPairIndices;
+  Array<uint> mManifoldEnds;
+  Array<bool> mSpeculative;
+};
+
 void PhysicsSpace::NarrowPhase()
 {
   ProfileScopeTree("NarrowPhase", "Iteration", Color::Salmon);
 
   HeapAllocator allocator(mHeap);
-  Physics::ManifoldArray tempManifolds;
-  tempManifolds.SetAllocator(allocator);
 
   Array<NodePointerPair> Collisions;
   Collisions.SetAllocator(allocator);
 
+  // Every pair test is independent, so the pairs are split into chunks that
+  // are tested in parallel, each into its own manifold array
   uint size = mPossiblePairs.Size();
-  for (unsigned pairIndex = 0; pairIndex < size; ++pairIndex)
+  uint chunkCount = (size + cNarrowPhaseGrainSize - 1) / cNarrowPhaseGrainSize;
+  Array<NarrowPhaseChunk> chunks;
+  chunks.Resize(chunkCount);
+  for (uint i = 0; i < chunkCount; ++i)
   {
-    ClientPair* clientPair = &mPossiblePairs[pairIndex];
-    Collider* collider1 = static_cast<Collider*>(clientPair->mClientData[0]);
-    Collider* collider2 = static_cast<Collider*>(clientPair->mClientData[1]);
-    // Convert the proxy to a collider
-    ColliderPair pair(collider1, collider2);
+    chunks[i].mManifolds.SetAllocator(allocator);
+    chunks[i].mPairIndices.SetAllocator(allocator);
+    chunks[i].mManifoldEnds.SetAllocator(allocator);
+    chunks[i].mSpeculative.SetAllocator(allocator);
+  }
+
+  Z::gJobs->ParallelFor(0, size, cNarrowPhaseGrainSize, [&](uint begin, uint end) {
+    // Without threading the whole range is run at once into the first chunk
+    NarrowPhaseChunk& chunk = chunks[begin / cNarrowPhaseGrainSize];
+    for (uint pairIndex = begin; pairIndex < end; ++pairIndex)
+    {
+      ClientPair* clientPair = &mPossiblePairs[pairIndex];
+      Collider* collider1 = static_cast<Collider*>(clientPair->mClientData[0]);
+      Collider* collider2 = static_cast<Collider*>(clientPair->mClientData[1]);
+      // Convert the proxy to a collider
+      ColliderPair pair(collider1, collider2);
+
+      // Test for collision
+      uint manifoldStart = chunk.mManifolds.Size();
+      bool speculative = false;
+      if (!mCollisionManager->TestCollision(pair, chunk.mManifolds))
+      {
+        chunk.mManifolds.Resize(manifoldStart);
+        if (!TestSpeculativeCollision(pair, chunk.mManifolds))
+          continue;
+        speculative = true;
+      }
 
-    // Test for collision
-    if (!mCollisionManager->TestCollision(pair, tempManifolds))
+      chunk.mPairIndices.PushBack(pairIndex);
+      chunk.mManifoldEnds.PushBack(chunk.mManifolds.Size());
+      chunk.mSpeculative.PushBack(speculative);
+    }
+  });
+
+  // Merge the chunks in pair order so contacts are created in the same order
+  // as a serial narrow phase (the order ClientPairSorter gave the pairs when
+  // the space is deterministic)
+  for (uint chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+  {
+    NarrowPhaseChunk& chunk = chunks[chunkIndex];
+    uint manifoldIndex = 0;
+    for (uint i = 0; i < chunk.mPairIndices.Size(); ++i)
     {
-      tempManifolds.Clear();
+      // If tracking is enabled, we need to record the collision
+      bool speculative = chunk.mSpeculative[i];
+      if (mBroadPhase->IsTracking() && !speculative)
+      {
+        ClientPair* clientPair = &mPossiblePairs[chunk.mPairIndices[i]];
+        NodePointerPair nodePair(clientPair->mClientData[0], clientPair->mClientData[1]);
+        Collisions.PushBack(nodePair);
+      }
+
+      // Add all manifolds to the contact manager
+      for (; manifoldIndex < chunk.mManifoldEnds[i]; ++manifoldIndex)
+      {
+        Physics::Manifold& manifold = chunk.mManifolds[manifoldIndex];
+        mContactManager->AddManifold(manifold, speculative);
+        manifold.Clear();
+      }
+    }
+  }
+
+  mBroadPhase->RecordFrameResults(Collisions);
+
+  // We have all connections for the frame so build the islands.
+  mIslandManager->BuildIslands(mDynamicColliders);
+}
+
+bool PhysicsSpace::TestSpeculativeCollision(ColliderPair& pair, Physics::ManifoldArray& manifolds)
+{
+  Collider* colliderA = pair.Top;
+  Collider* colliderB = pair.Bot;
+  if (!colliderA->UsesContinuousCollision() && !colliderB->UsesContinuousCollision())
+    return false;
+  // Ghosts never resolve so there's nothing to keep from tunneling
+  if (colliderA->GetGhost() || colliderB->GetGhost() || !colliderA->ShouldCollide(colliderB))
+    return false;
+  if (!CanComputeTimeOfImpact(colliderA, colliderB))
+    return false;
+
+  // Find the first time (if any) that the pair touches this timestep
+  real dt = mIterationDt;
+  TimeOfImpactData data(colliderA, colliderB, dt);
+  TimeOfImpact(&data);
+
+  uint firstImpact = uint(-1);
+  for (uint i = 0; i < data.ImpactTimes.Size(); ++i)
+  {
+    if (data.ImpactTimes[i] >= dt)
+      continue;
+    if (firstImpact == uint(-1) || data.ImpactTimes[i] < data.ImpactTimes[firstImpact])
+      firstImpact = i;
+  }
+  if (firstImpact == uint(-1))
+    return false;
+
+  // The impact's points are where the pair touches, move them back to where
+  // the objects are now so that the (negative) penetration is the gap left to
+  // close this timestep
+  real impactTime = data.ImpactTimes[firstImpact];
+  Physics::Manifold& impact = data.Manifolds[firstImpact];
+  Physics::ManifoldPoint points[cMaxContacts];
+  uint pointCount = 0;
+  for (uint i = 0; i < impact.ContactCount; ++i)
+  {
+    Physics::ManifoldPoint point = impact.Contacts[i];
+    point.WorldPoints[0] -= impact.Objects[0]->ComputePointVelocityInternal(point.WorldPoints[0]) * impactTime;
+    point.WorldPoints[1] -= impact.Objects[1]->ComputePointVelocityInternal(point.WorldPoints[1]) * impactTime;
+    point.Penetration = Math::Dot(point.WorldPoints[0] - point.WorldPoints[1], point.Normal);
+    if (point.Penetration < real(0.0))
+      points[pointCount++] = point;
+  }
+  if (pointCount == 0)
+    return false;
+
+  Physics::Manifold& manifold = manifolds.PushBack();
+  manifold.ContactId = impact.ContactId;
+  manifold.SetPair(impact.Objects);
+  manifold.SetPolicy(Physics::AddingPolicy::NormalManifold);
+  manifold.AddPoints(points, pointCount);
+  return true;
+}
+
+void PhysicsSpace::QueueContinuousBodies()
+{
+  if (!mPhysicsSolverConfig->mSpeculativeContacts)
+    return;
+
+  RigidBodyList::range range = mRigidBodies.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    RigidBody& body = range.Front();
+    if (!body.GetContinuousCollision() || body.IsAsleep())
       continue;
+
+    RigidBody::CompositeColliderRange colliders = body.mColliders.All();
+    for (; !colliders.Empty(); colliders.PopFront())
+    {
+      Collider& collider = colliders.Front();
+      if (collider.UsesContinuousCollision())
+        UpdateInBroadPhase(&collider);
     }
+  }
+}
 
-    // If tracking is enabled, we need to record the collision
-    if (mBroadPhase->IsTracking())
+/// Would the body close more than the gap of any of its speculative contacts
+/// (plus slop) with the velocity it was solved to?
+static bool OvershootsSpeculativeContact(RigidBody* body, real dt, real slop)
+{
+  RigidBody::CompositeColliderRange colliders = body->mColliders.All();
+  for (; !colliders.Empty(); colliders.PopFront())
+  {
+    Collider::ContactEdgeList::range edges = colliders.Front().mContactEdges.All();
+    for (; !edges.Empty(); edges.PopFront())
     {
-      NodePointerPair nodePair(clientPair->mClientData[0], clientPair->mClientData[1]);
-      Collisions.PushBack(nodePair);
+      Physics::Contact* contact = edges.Front().mContact;
+      if (!contact->GetSpeculative())
+        continue;
+
+      // The separating velocity is positive when closing and the penetration
+      // is the negative gap
+      Physics::Manifold* manifold = contact->GetManifold();
+      for (uint i = 0; i < manifold->ContactCount; ++i)
+      {
+        if (manifold->GetSeparatingVelocity(i) * dt + manifold->Contacts[i].Penetration > slop)
+          return true;
+      }
     }
+  }
+  return false;
+}
 
-    // Add all manifolds to the contact manager
-    for (uint i = 0; i < tempManifolds.Size(); ++i)
+/// The first time the body hits anything it has a speculative contact with.
+static real FirstTimeOfImpact(RigidBody* body, real dt)
+{
+  real firstImpact = dt;
+  RigidBody::CompositeColliderRange colliders = body->mColliders.All();
+  for (; !colliders.Empty(); colliders.PopFront())
+  {
+    Collider::ContactEdgeList::range edges = colliders.Front().mContactEdges.All();
+    for (; !edges.Empty(); edges.PopFront())
     {
-      Physics::Manifold& manifold = tempManifolds[i];
-      mContactManager->AddManifold(tempManifolds[i]);
-      manifold.Clear();
+      Physics::ContactEdge& edge = edges.Front();
+      if (!edge.mContact->GetSpeculative() || !CanComputeTimeOfImpact(edge.mCollider, edge.mOther))
+        continue;
+
+      TimeOfImpactData data(edge.mCollider, edge.mOther, dt);
+      TimeOfImpact(&data);
+      for (uint i = 0; i < data.ImpactTimes.Size(); ++i)
+      {
+        // An impact at the start means the pair is already touching, which
+        // the normal contact deals with next timestep
+        if (data.ImpactTimes[i] > real(0.0))
+          firstImpact = Math::Min(firstImpact, data.ImpactTimes[i]);
+      }
     }
+  }
+  return firstImpact;
+}
 
-    tempManifolds.Clear();
+void PhysicsSpace::ClampToTimesOfImpact(real dt, Array<ClampedBody>& clampedBodies)
+{
+  PhysicsSolverConfig* config = mPhysicsSolverConfig;
+  if (!config->mSpeculativeContacts || !config->mTimeOfImpactClamping)
+    return;
+
+  // Most continuous bodies were kept from tunneling by the solver, only the
+  // ones that weren't need a time of impact
+  real slop = config->mContactBlock.GetSlop();
+  Array<RigidBody*> bodies;
+  RigidBodyList::range range = mRigidBodies.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    RigidBody& body = range.Front();
+    if (!body.GetContinuousCollision() || !body.IsDynamic() || body.IsAsleep())
+      continue;
+    if (OvershootsSpeculativeContact(&body, dt, slop))
+      bodies.PushBack(&body);
   }
 
-  mBroadPhase->RecordFrameResults(Collisions);
+  if (bodies.Empty())
+    return;
 
-  // We have all connections for the frame so build the islands.
-  mIslandManager->BuildIslands(mDynamicColliders);
+  // Every body's time of impact is independent (nothing has moved yet)
+  Array<real> impactTimes;
+  impactTimes.Resize(bodies.Size());
+  Z::gJobs->ParallelFor(0, bodies.Size(), 1, [&](uint begin, uint end) {
+    for (uint i = begin; i < end; ++i)
+      impactTimes[i] = FirstTimeOfImpact(bodies[i], dt);
+  });
+
+  for (uint i = 0; i < bodies.Size(); ++i)
+  {
+    if (impactTimes[i] >= dt)
+      continue;
+
+    RigidBody* body = bodies[i];
+    ClampedBody& clampedBody = clampedBodies.PushBack();
+    clampedBody.mBody = body;
+    clampedBody.mVelocity = body->mVelocity;
+    clampedBody.mAngularVelocity = body->mAngularVelocity;
+
+    real scale = impactTimes[i] / dt;
+    body->mVelocity *= scale;
+    body->mAngularVelocity *= scale;
+  }
+}
+
+void PhysicsSpace::RestoreClampedBodies(Array<ClampedBody>& clampedBodies)
+{
+  for (uint i = 0; i < clampedBodies.Size(); ++i)
+  {
+    ClampedBody& clampedBody = clampedBodies[i];
+    clampedBody.mBody->mVelocity = clampedBody.mVelocity;
+    clampedBody.mBody->mAngularVelocity = clampedBody.mAngularVelocity;
+  }
 }
 
 void PhysicsSpace::PreSolve(real dt)
@@ -972,6 +1322,75 @@ CastResultsRange PhysicsSpace::CastSegment(const Segment& segment, uint maxCount
   return CastResultsRange(results);
 }
 
+void PhysicsSpace::CastRays(CastBatch& batch)
+{
+  CastFilter filter;
+  CastRays(batch, filter);
+}
+
+void PhysicsSpace::CastRays(CastBatch& batch, CastFilter& filter)
+{
+  // Have to always push here because otherwise an object that has already been
+  // deleted could be returned
+  PushBroadPhaseQueue();
+
+  uint castCount = batch.mCasts.Size();
+  uint maxHits = batch.mMaxHitsPerCast;
+  batch.mResults.Resize(castCount * maxHits);
+  batch.mHitCounts.Resize(castCount);
+  if (castCount == 0)
+    return;
+
+  // Segments don't ignore internal casts (same as CastSegment)
+  CastFilter segmentFilter = filter;
+  segmentFilter.ClearFlag(BaseCastFilterFlags::IgnoreInternalCasts);
+
+  auto castPacket = [&](uint begin, uint end) {
+    // One set of proxy results is reused for every cast in the packet
+    ProxyCastResultArray hits(maxHits);
+    ProxyCastResults rayResults(hits, filter);
+    ProxyCastResults segmentResults(hits, segmentFilter);
+    for (uint castIndex = begin; castIndex < end; ++castIndex)
+    {
+      CastBatch::QueuedCast& cast = batch.mCasts[castIndex];
+      ProxyCastResults& results = cast.mSegment ? segmentResults : rayResults;
+      results.Clear();
+      if (cast.mSegment)
+        mBroadPhase->CastSegment(cast.mStart, cast.mVector, results);
+      else
+        mBroadPhase->CastRay(cast.mStart, cast.mVector, results);
+
+      // Copy the hits into the batch, swapping the proxy data for the collider
+      // the same as CastResults::ConvertToColliders
+      uint hitCount = results.GetCurrentSize();
+      CastResult* castHits = batch.mResults.Data() + castIndex * maxHits;
+      for (uint i = 0; i < hitCount; ++i)
+      {
+        reinterpret_cast<ProxyResult&>(castHits[i]) = hits[i];
+        castHits[i].mObjectHit = static_cast<Collider*>(hits[i].mObjectHit);
+      }
+      batch.mHitCounts[castIndex] = hitCount;
+    }
+  };
+
+  // The first cast is run on this thread so that any broad phase that defers
+  // work until its first query has done so before the rest are cast in
+  // parallel. Script callbacks and the auto tuner's timing aren't thread safe.
+  castPacket(0, 1);
+  if (filter.mCallbackObject != nullptr || mAutoTuneBroadPhases)
+    castPacket(1, castCount);
+  else
+    Z::gJobs->ParallelFor(1, castCount, cCastPacketSize, castPacket);
+}
+
+void PhysicsSpace::CastRays(const Array<Ray>& rays, CastFilter& filter, CastBatch& results)
+{
+  results.Clear();
+  for (uint i = 0; i < rays.Size(); ++i)
+    results.AddRay(rays[i]);
+  CastRays(results, filter);
+}
+
 void PhysicsSpace::CastAabb(const Aabb& aabb, CastResults& results)
 {
   BaseCastFilter& filter = results.mResults.Filter;
@@ -1274,6 +1693,14 @@ void PhysicsSpace::SetAllowSleep(bool allowSleep)
     range.Front().ForceAwake();
     range.PopFront();
   }
+  ForceAwakeRigidBodies();
+}
+
+void PhysicsSpace::ApplyBroadPhaseSettings(IBroadPhase* broadPhase)
+{
+  HierarchicalGridBroadPhase* grid = Type::DynamicCast<HierarchicalGridBroadPhase*>(broadPhase);
+  if (grid != nullptr)
+    grid->SetCellSize(mHierarchicalGridCellSize);
 }
 
 void PhysicsSpace::SerializeBroadPhases(Serializer& stream)
@@ -1394,35 +1821,44 @@ void PhysicsSpace::ApplyGlobalEffects(RigidBody* body, real dt)
 
 void PhysicsSpace::WakeInactiveMovingBodies()
 {
-  RigidBodyList::range range = mInactiveRigidBodies.All();
+  // Only bodies solved with awake bodies this step could've started moving,
+  // so the (possibly very many) other asleep bodies don't need to be checked
+  mIslandManager->WakeMovingBodies();
+}
 
-  while (!range.Empty())
+void PhysicsSpace::SetCollidersAsleep(RigidBody* body, bool asleep)
+{
+  RigidBody::CompositeColliderRange range = body->mColliders.All();
+  for (; !range.Empty(); range.PopFront())
   {
-    RigidBody& body = range.Front();
-    range.PopFront();
-
-    if (body.GetStatic())
+    Collider& collider = range.Front();
+    if (collider.mState.IsSet(ColliderFlags::Sleeping) == asleep)
       continue;
 
-    if (body.mVelocity.LengthSq() != real(0.0) || body.mAngularVelocity.Length() != real(0.0))
-      body.WakeUp();
+    ColliderList::Unlink(&collider);
+    collider.mState.SetState(ColliderFlags::Sleeping, asleep);
+    if (asleep)
+      mSleepingColliders.PushBack(&collider);
+    else
+      mDynamicColliders.PushBack(&collider);
   }
 }
 
 void PhysicsSpace::ForceAwakeRigidBodies()
 {
+  // Waking a body wakes its whole island, which moves other bodies out of the
+  // inactive list, so gather the bodies before waking any of them
+  Array<RigidBody*> bodies;
   RigidBodyList::range range = mInactiveRigidBodies.All();
-
-  while (!range.Empty())
+  for (; !range.Empty(); range.PopFront())
   {
     RigidBody& body = range.Front();
-    range.PopFront();
-
-    if (body.GetStatic())
-      continue;
-
-    body.ForceAwake();
+    if (!body.GetStatic())
+      bodies.PushBack(&body);
   }
+
+  for (uint i = 0; i < bodies.Size(); ++i)
+    bodies[i]->ForceAwake();
 }
 
 String PhysicsSpace::WhyAreTheyNotColliding(Cog* cogA, Cog* cogB)
@@ -1544,25 +1980,44 @@ void PhysicsSpace::AddComponent(RigidBody* body)
   else if (body->mState.IsSet(RigidBodyStates::Asleep | RigidBodyStates::Static))
     mInactiveRigidBodies.PushBack(body);
   else
+  {
     mRigidBodies.PushBack(body);
+    mBodyStore.Add(body);
+  }
 }
 
 void PhysicsSpace::RemoveComponent(RigidBody* body)
 {
   // This can be in several lists, unlink from whichever
   RigidBodyList::Unlink(body);
+  mBodyStore.Remove(body);
+  mIslandManager->RemoveBody(body);
 }
 
 void PhysicsSpace::ComponentStateChange(RigidBody* body)
 {
   RigidBodyList::Unlink(body);
+  mBodyStore.Remove(body);
+
+  // Only dynamic bodies sleep with the bodies they're touching. An awake
+  // dynamic body wakes everything it was sleeping with.
+  if (!body->IsDynamic())
+    mIslandManager->RemoveBody(body);
+  else if (!body->IsAsleep())
+  {
+    SetCollidersAsleep(body, false);
+    mIslandManager->WakePersistentIsland(body);
+  }
 
   if (body->GetStatic() || body->IsAsleep())
     mInactiveRigidBodies.PushBack(body);
   else if (body->GetKinematic())
     mMovingKinematicBodies.PushBack(body);
   else
+  {
     mRigidBodies.PushBack(body);
+    mBodyStore.Add(body);
+  }
 }
 
 void PhysicsSpace::AddComponent(Joint* joint)
@@ -1597,6 +2052,7 @@ void PhysicsSpace::RemoveComponent(Collider* collider)
 {
   mIslandManager->RemoveCollider(collider);
   ColliderList::Unlink(collider);
+  collider->mState.ClearFlag(ColliderFlags::Sleeping);
 
   // Doesn't work now because the id we have at this point is already gone.
   // Valid code below for when the id problem is fixed
@@ -1622,6 +2078,7 @@ void PhysicsSpace::RemoveComponent(Collider* collider)
 void PhysicsSpace::ComponentStateChange(Collider* collider)
 {
   ColliderList::Unlink(collider);
+  collider->mState.ClearFlag(ColliderFlags::Sleeping);
 
   if (!collider->GetActiveBody())
     mStaticColliders.PushBack(collider);
@@ -1629,6 +2086,11 @@ void PhysicsSpace::ComponentStateChange(Collider* collider)
     mDynamicColliders.PushBack(collider);
 }
 
+void PhysicsSpace::ConstraintRemoved(Collider* colliderA, Collider* colliderB)
+{
+  mIslandManager->ConstraintRemoved(colliderA, colliderB);
+}
+
 void PhysicsSpace::AddComponent(PhysicsCar* car)
 {
   mCars.PushBack(car);
@@ -1698,6 +2160,14 @@ BroadPhasePackage* PhysicsSpace::ReplaceBroadPhase(BroadPhasePackage* newBroadPh
     r.PopFront();
   }
 
+  r = mSleepingColliders.All();
+  while (!r.Empty())
+  {
+    Collider* collider = &r.Front();
+    RemovalAction action(collider);
+    r.PopFront();
+  }
+
   FlushPhysicsQueue();
 
   // Swap the broad phases
@@ -1721,6 +2191,14 @@ BroadPhasePackage* PhysicsSpace::ReplaceBroadPhase(BroadPhasePackage* newBroadPh
     r.PopFront();
   }
 
+  r = mSleepingColliders.All();
+  while (!r.Empty())
+  {
+    Collider* collider = &r.Front();
+    InsertionAction action(collider);
+    r.PopFront();
+  }
+
   FlushPhysicsQueue();
 
   return old;
@@ -1834,7 +2312,14 @@ void PhysicsSpace::DrawColliders()
 
   bool onTop = mDebugDrawFlags.IsSet(PhysicsSpaceDebugDrawFlags::DrawOnTop);
 
-  ColliderList::range range = mDynamicColliders.All();
+  // Asleep colliders are still in the broadphase so they're drawn as well
+  DrawColliderList(mDynamicColliders, onTop);
+  DrawColliderList(mSleepingColliders, onTop);
+}
+
+void PhysicsSpace::DrawColliderList(ColliderList& colliders, bool onTop)
+{
+  ColliderList::range range = colliders.All();
 
   while (!range.Empty())
   {
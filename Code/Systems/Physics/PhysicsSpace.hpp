@@ -5,9 +5,10 @@ namespace Raverie
 {
 
 class BroadPhasePackage;
+class PhysicsSnapshot;
 typedef Array<Collider*> ColliderArray;
 
-DeclareBitField3(PhysicsSpaceFlags, AllowSleep, Mode2D, Deterministic);
+DeclareBitField4(PhysicsSpaceFlags, AllowSleep, Mode2D, Deterministic, ContiguousIntegration);
 
 namespace Tags
 {
@@ -82,6 +83,7 @@ class PhysicsSpace : public Component
 public:
   RaverieDeclareType(PhysicsSpace, TypeCopyMode::ReferenceType);
   friend class RigidBody;
+  friend class PhysicsSnapshot;
 
   PhysicsSpace();
   virtual ~PhysicsSpace();
@@ -130,9 +132,32 @@ public:
   /// InheritFromSpace then it will use this value.
   bool GetMode2D() const;
   void SetMode2D(bool state);
-  /// Performs extra work to help enforce determinism in the simulation.
+  /// Performs extra work to help enforce determinism in the simulation. Pairs
+  /// are sorted, islands are solved one after another in a fixed order and
+  /// bodies are integrated one at a time so the results only depend on the
+  /// inputs (not on threading or simd). The StateHash is also updated every
+  /// timestep. Use the Basic or Normal solver for lockstep between different
+  /// builds of the engine.
   bool GetDeterministic() const;
   void SetDeterministic(bool state);
+  /// A hash of the position, rotation, velocity and sleep state of every
+  /// dynamic body after the last timestep. Only updated while the space is
+  /// deterministic. Two machines simulating the same inputs have the same
+  /// hash, so comparing it (e.g. between a server and client) catches a
+  /// desync on the step it happens.
+  s64 GetStateHash() const;
+  /// Computes the state hash of the space as it is right now.
+  u64 ComputeStateHash();
+  /// Copies the simulated state of every dynamic body, contact and sleeping
+  /// group so it can be put back later with RestoreSnapshot.
+  HandleOf<PhysicsSnapshot> SaveSnapshot();
+  /// Puts every body from the snapshot back into the state it was in. Used to
+  /// roll back a deterministic space and re-simulate it.
+  void RestoreSnapshot(PhysicsSnapshot* snapshot);
+  /// Integrates rigid bodies from contiguous arrays instead of one body at a
+  /// time. Faster for spaces with many active bodies.
+  bool GetContiguousIntegration() const;
+  void SetContiguousIntegration(bool state);
 
   /// Helper for a collider. Returns this space's instance for a CollisionGroup.
   CollisionGroupInstance* GetCollisionGroupInstance(ResourceId groupId) const;
@@ -177,10 +202,37 @@ public:
   void IntegrateBodiesPosition(real dt);
   /// Updates all BroadPhases and then finds all possible collision pairs.
   void BroadPhase();
+  /// How many broad phase pairs each narrow phase task tests.
+  static const uint cNarrowPhaseGrainSize = 64;
+  /// How many casts each task of CastRays performs.
+  static const uint cCastPacketSize = 8;
   /// Takes the possible collisions from the BroadPhase step and checks if they
   /// actually collide. If they do collide then they are added to the
   /// IslandManager.
   void NarrowPhase();
+  /// Creates a speculative manifold for a pair that isn't touching if either
+  /// collider uses continuous collision and the pair will touch before the end
+  /// of the timestep. Returns false if no manifold was created.
+  bool TestSpeculativeCollision(ColliderPair& pair, Physics::ManifoldArray& manifolds);
+  /// Makes sure the broad phase aabbs of bodies with continuous collision are
+  /// swept by the velocity they were just given.
+  void QueueContinuousBodies();
+
+  /// A body whose velocity was scaled down for position integration so that it
+  /// stops at its time of impact.
+  struct ClampedBody
+  {
+    RigidBody* mBody;
+    Vec3 mVelocity;
+    Vec3 mAngularVelocity;
+  };
+  /// Finds continuous bodies that would still move through one of their
+  /// speculative contacts after resolution and scales their velocity so they
+  /// only move up to the time of impact. Times of impact are computed in
+  /// parallel.
+  void ClampToTimesOfImpact(real dt, Array<ClampedBody>& clampedBodies);
+  /// Restores the velocities of clamped bodies after position integration.
+  void RestoreClampedBodies(Array<ClampedBody>& clampedBodies);
   /// Sends out any pre-solve events so users can modify state before
   /// resolution.
   void PreSolve(real dt);
@@ -221,6 +273,16 @@ public:
   /// given filter. This returns up to maxCount number of objects.
   CastResultsRange CastSegment(const Segment& segment, uint maxCount, CastFilter& filter);
 
+  /// Casts every ray and segment in the batch, storing each cast's results in
+  /// the batch. Casts are split into packets that run in parallel on the job
+  /// system. A default CastFilter will be used.
+  void CastRays(CastBatch& batch);
+  /// Casts every ray and segment in the batch using the given filter. Filters
+  /// with a callback object run all casts on the calling thread.
+  void CastRays(CastBatch& batch, CastFilter& filter);
+  /// Replaces the casts in results with the given rays and casts them.
+  void CastRays(const Array<Ray>& rays, CastFilter& filter, CastBatch& results);
+
   void CastAabb(const Aabb& aabb, CastResults& results);
   /// Finds all colliders in the space that an Aabb hits using the
   /// given filter. This returns up to maxCount number of objects.
@@ -295,6 +357,8 @@ public:
   void RemoveComponent(Collider* collider);
   /// This collider's body has changed dynamic state.
   void ComponentStateChange(Collider* collider);
+  /// A contact or joint between the two colliders was removed.
+  void ConstraintRemoved(Collider* colliderA, Collider* colliderB);
 
   void AddComponent(PhysicsCar* car);
   void RemoveComponent(PhysicsCar* car);
@@ -331,9 +395,12 @@ public:
 
 private:
   friend class PhysicsEngine;
+  friend class Physics::IslandManager;
 
   /// Serializes the broad phase information.
   void SerializeBroadPhases(Serializer& stream);
+  /// Applies the space's broad phase settings to a newly created broad phase.
+  void ApplyBroadPhaseSettings(IBroadPhase* broadPhase);
 
   /// Tell the rest of the engine what objects have been updated (integration).
   void Publish();
@@ -352,6 +419,9 @@ private:
 
   /// Checks all inactive objects to see if they should be woken up.
   void WakeInactiveMovingBodies();
+  /// Moves the colliders of a body whose island fell asleep out of the
+  /// dynamic collider list (and back when it wakes up).
+  void SetCollidersAsleep(RigidBody* body, bool asleep);
 
   /// Takes a kinematic object and moves it to the moving kinematic list.
   void ActivateKinematic(RigidBody* body);
@@ -368,6 +438,7 @@ private:
 
   void DebugDraw();
   void DrawColliders();
+  void DrawColliderList(ColliderList& colliders, bool onTop);
   void DrawRigidBodies();
   void DrawInactiveObjects();
 
@@ -406,9 +477,14 @@ private:
   /// Kinematic bodies that have not had a transform update recently.
   /// They do not need any iteration whatsoever.
   RigidBodyList mInactiveKinematicBodies;
+  /// Contiguous copy of the integration state of every body in mRigidBodies.
+  Physics::RigidBodyStore mBodyStore;
   // Separate dynamic and static components to reduce queries.
   ColliderList mDynamicColliders;
   ColliderList mStaticColliders;
+  /// Colliders of bodies in an asleep island. Nothing iterates these every
+  /// step.
+  ColliderList mSleepingColliders;
   RegionList mRegions;
 
   typedef InList<PhysicsCar, &PhysicsCar::SpaceLink> CarList;
@@ -455,6 +531,9 @@ public:
   // if it is operating during IterateTimestep.
   real mIterationDt;
 
+  /// The state hash after the last timestep (see GetStateHash).
+  u64 mStateHash;
+
   // These variables control the max velocity that a rigid body can be set to.
   // The bool is used to only display an error message the first time this
   // happens.
@@ -467,6 +546,14 @@ public:
   /// What kind of broadphase is used for static objects (those without
   /// RigidBodies).
   String mStaticBroadphaseType;
+  /// Whether the space should measure the broadphases as it runs and switch
+  /// to whichever is cheapest for the current level. The broadphase types
+  /// above are what it starts with. Takes effect when the space is created.
+  bool mAutoTuneBroadPhases;
+  /// The cell size of the lowest level when a broadphase is a
+  /// HierarchicalGridBroadPhase. Should be about the size of the most common
+  /// objects. Takes effect when the space is created.
+  real mHierarchicalGridCellSize;
 
   Memory::Heap* mHeap;
   /// Dummy collider used when things attach to the world. Makes life
@@ -105,6 +105,7 @@ RaverieDefineStaticLibrary(PhysicsLibrary)
 
   RaverieInitializeType(PhysicsEngine);
   RaverieInitializeType(PhysicsSpace);
+  RaverieInitializeType(PhysicsSnapshot);
   RaverieInitializeType(RigidBody);
   RaverieInitializeType(Region);
   RaverieInitializeType(MassOverride);
@@ -190,6 +191,7 @@ RaverieDefineStaticLibrary(PhysicsLibrary)
   RaverieInitializeType(CastFilter);
   RaverieInitializeType(CastResult);
   RaverieInitializeType(CastResults);
+  RaverieInitializeType(CastBatch);
   RaverieInitializeType(SweepResult);
 
   // Misc
@@ -220,6 +222,16 @@ RaverieDefineStaticLibrary(PhysicsLibrary)
   EngineLibraryExtensions::AddNativeExtensions(builder);
 }
 
+// Lets large static trees (mesh colliders) build their subtrees on the job
+// system.
+static void TreeBuildParallelFor(uint begin, uint end, uint grainSize, TreeBuildRangeFunction function, void* userData)
+{
+  if (Z::gJobs == nullptr)
+    function(userData, begin, end);
+  else
+    Z::gJobs->ParallelFor(begin, end, grainSize, function, userData);
+}
+
 void PhysicsLibrary::Initialize()
 {
   BuildStaticLibrary();
@@ -233,10 +245,13 @@ void PhysicsLibrary::Initialize()
   InitializeResourceManager(CollisionTableManager);
   InitializeResourceManager(ConvexMeshManager);
   InitializeResourceManager(MultiConvexMeshManager);
+
+  gTreeBuildParallelFor = &TreeBuildParallelFor;
 }
 
 void PhysicsLibrary::Shutdown()
 {
+  gTreeBuildParallelFor = nullptr;
   GetLibrary()->ClearComponents();
 }
 
@@ -77,6 +77,7 @@ public:
 #include "ConvexMeshCollider.hpp"
 #include "CylinderCollider.hpp"
 #include "EllipsoidCollider.hpp"
+#include "QuantizedHeightMap.hpp"
 #include "HeightMapCollider.hpp"
 #include "MassOverride.hpp"
 #include "MeshCollider.hpp"
@@ -106,6 +107,7 @@ public:
 
 #include "Region.hpp"
 #include "RigidBody.hpp"
+#include "RigidBodyStore.hpp"
 #include "PhysicsCar.hpp"
 #include "PhysicsCarWheel.hpp"
 #include "DebugFlags.hpp"
@@ -139,7 +141,9 @@ public:
 
 #include "RayCast.hpp"
 #include "Manifold.hpp"
+#include "WideSolver.hpp"
 #include "PhysicsSpace.hpp"
+#include "PhysicsSnapshot.hpp"
 
 // BroadPhase
 #include "Analyzer.hpp"
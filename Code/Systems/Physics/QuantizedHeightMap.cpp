@@ -0,0 +1,472 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+/// Samples a vertex of a patch the same way HeightMap::SampleHeight does, but
+/// treats the removed patch (if any) as if it were already gone.
+real SampleQuantizedVertex(HeightMap* map, HeightPatch* patch, uint x, uint y, HeightPatch* removedPatch)
+{
+  // Everything but the last row and column belongs to the patch itself
+  if (x < HeightPatch::Size && y < HeightPatch::Size)
+    return patch->GetHeight(CellIndex(x, y));
+
+  AbsoluteIndex absoluteIndex = map->GetAbsoluteIndex(patch->Index, CellIndex(x, y));
+  PatchIndex patchIndex;
+  CellIndex cellIndex;
+  map->GetPatchAndCellIndex(absoluteIndex, patchIndex, cellIndex);
+
+  HeightPatch* samplePatch = map->GetPatchAtIndex(patchIndex);
+  if (samplePatch != nullptr && samplePatch != removedPatch)
+    return samplePatch->GetHeight(cellIndex);
+
+  if (cellIndex.x == 0)
+  {
+    patchIndex.x -= 1;
+    cellIndex.x = HeightPatch::Size - 1;
+  }
+  if (cellIndex.y == 0)
+  {
+    patchIndex.y -= 1;
+    cellIndex.y = HeightPatch::Size - 1;
+  }
+
+  samplePatch = map->GetPatchAtIndex(patchIndex);
+  if (samplePatch != nullptr && samplePatch != removedPatch)
+    return samplePatch->GetHeight(cellIndex);
+  return Math::cInfinite;
+}
+
+void QuantizedHeightPatch::Build(HeightMap* map, HeightPatch* patch, HeightPatch* removedPatch)
+{
+  mIndex = patch->Index;
+  real unitsPerPatch = map->GetUnitsPerPatch();
+  mPatchStart = map->GetLocalPosition(mIndex) - Vec2(unitsPerPatch, unitsPerPatch) * real(0.5);
+  mCellSize = unitsPerPatch / real(cCellsPerSide);
+
+  real heights[cVertexCount];
+  real minHeight = Math::PositiveMax();
+  real maxHeight = -Math::PositiveMax();
+  for (uint y = 0; y < cVerticesPerSide; ++y)
+  {
+    for (uint x = 0; x < cVerticesPerSide; ++x)
+    {
+      real height = SampleQuantizedVertex(map, patch, x, y, removedPatch);
+      heights[GetVertexIndex(x, y)] = height;
+      if (height == Math::cInfinite)
+        continue;
+
+      minHeight = Math::Min(minHeight, height);
+      maxHeight = Math::Max(maxHeight, height);
+    }
+  }
+
+  // A patch of nothing but holes
+  if (minHeight > maxHeight)
+    minHeight = maxHeight = real(0.0);
+
+  mMinHeight = minHeight;
+  real heightRange = maxHeight - minHeight;
+  mHeightScale = heightRange / real(cMaxQuantizedHeight);
+  real toQuantized = heightRange > real(0.0) ? real(cMaxQuantizedHeight) / heightRange : real(0.0);
+  for (uint i = 0; i < cVertexCount; ++i)
+  {
+    if (heights[i] == Math::cInfinite)
+    {
+      mHeights[i] = cHole;
+      continue;
+    }
+
+    real quantized = Math::Round((heights[i] - minHeight) * toQuantized);
+    mHeights[i] = (u16)Math::Clamp(quantized, real(0.0), real(cMaxQuantizedHeight));
+  }
+
+  // Build the quadtree bottom up, the lowest nodes cover 2x2 cells. Empty
+  // nodes are left with min > max so they never change their parent's range.
+  uint leafLevel = cLevelCount - 1;
+  uint leafSide = 1 << leafLevel;
+  for (uint y = 0; y < leafSide; ++y)
+  {
+    for (uint x = 0; x < leafSide; ++x)
+    {
+      u16 nodeMin = cHole;
+      u16 nodeMax = 0;
+      for (uint i = 0; i < 4; ++i)
+      {
+        u16 cellMin, cellMax;
+        if (!GetCellRange(x * 2 + (i & 1), y * 2 + (i >> 1), cellMin, cellMax))
+          continue;
+        nodeMin = Math::Min(nodeMin, cellMin);
+        nodeMax = Math::Max(nodeMax, cellMax);
+      }
+
+      uint node = GetNodeIndex(leafLevel, x, y);
+      mNodeMin[node] = nodeMin;
+      mNodeMax[node] = nodeMax;
+    }
+  }
+
+  for (int level = (int)leafLevel - 1; level >= 0; --level)
+  {
+    uint side = 1 << level;
+    for (uint y = 0; y < side; ++y)
+    {
+      for (uint x = 0; x < side; ++x)
+      {
+        u16 nodeMin = cHole;
+        u16 nodeMax = 0;
+        for (uint i = 0; i < 4; ++i)
+        {
+          uint child = GetNodeIndex(level + 1, x * 2 + (i & 1), y * 2 + (i >> 1));
+          nodeMin = Math::Min(nodeMin, mNodeMin[child]);
+          nodeMax = Math::Max(nodeMax, mNodeMax[child]);
+        }
+
+        uint node = GetNodeIndex(level, x, y);
+        mNodeMin[node] = nodeMin;
+        mNodeMax[node] = nodeMax;
+      }
+    }
+  }
+}
+
+real QuantizedHeightPatch::GetMinHeight() const
+{
+  return mMinHeight;
+}
+
+real QuantizedHeightPatch::GetMaxHeight() const
+{
+  return Dequantize(cMaxQuantizedHeight);
+}
+
+uint QuantizedHeightPatch::GetCellTriangles(CellIndexParam cellIndex, Triangle triangles[2]) const
+{
+  uint x = cellIndex.x;
+  uint y = cellIndex.y;
+
+  u16 h00 = mHeights[GetVertexIndex(x, y)];
+  u16 h01 = mHeights[GetVertexIndex(x, y + 1)];
+  u16 h10 = mHeights[GetVertexIndex(x + 1, y)];
+  u16 h11 = mHeights[GetVertexIndex(x + 1, y + 1)];
+
+  real x0 = mPatchStart.x + real(x) * mCellSize;
+  real z0 = mPatchStart.y + real(y) * mCellSize;
+  real x1 = x0 + mCellSize;
+  real z1 = z0 + mCellSize;
+
+  Vec3 p00 = Vec3(x0, Dequantize(h00), z0);
+  Vec3 p01 = Vec3(x0, Dequantize(h01), z1);
+  Vec3 p10 = Vec3(x1, Dequantize(h10), z0);
+  Vec3 p11 = Vec3(x1, Dequantize(h11), z1);
+
+  bool b00 = h00 != cHole;
+  bool b01 = h01 != cHole;
+  bool b10 = h10 != cHole;
+  bool b11 = h11 != cHole;
+
+  // Same triangles and order as HeightMap::GetQuadAtIndex so that the keys
+  // built from the index in this cell match
+  uint count = 0;
+  if (b01 && b00 && b10)
+    triangles[count++] = Triangle(p00, p01, p10);
+  if (b01 && b10 && b11)
+    triangles[count++] = Triangle(p10, p01, p11);
+  return count;
+}
+
+uint QuantizedHeightPatch::GetChildBounds(uint level, uint x, uint y, real thickness, real minX[4], real minY[4], real minZ[4], real maxX[4], real maxY[4], real maxZ[4]) const
+{
+  uint childLevel = level + 1;
+  real childSize = mCellSize * real(cCellsPerSide >> childLevel);
+
+  uint validMask = 0;
+  for (uint i = 0; i < 4; ++i)
+  {
+    uint childX = x * 2 + (i & 1);
+    uint childY = y * 2 + (i >> 1);
+
+    u16 low = 0;
+    u16 high = 0;
+    if (childLevel == cCellLevel)
+    {
+      if (GetCellRange(childX, childY, low, high))
+        validMask |= 1 << i;
+    }
+    else
+    {
+      uint child = GetNodeIndex(childLevel, childX, childY);
+      if (mNodeMin[child] <= mNodeMax[child])
+      {
+        low = mNodeMin[child];
+        high = mNodeMax[child];
+        validMask |= 1 << i;
+      }
+    }
+
+    minX[i] = mPatchStart.x + real(childX) * childSize;
+    minZ[i] = mPatchStart.y + real(childY) * childSize;
+    maxX[i] = minX[i] + childSize;
+    maxZ[i] = minZ[i] + childSize;
+    minY[i] = Dequantize(low) - thickness;
+    maxY[i] = Dequantize(high);
+  }
+  return validMask;
+}
+
+bool QuantizedHeightPatch::CastRay(Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const
+{
+  if (mNodeMin[0] > mNodeMax[0])
+    return false;
+
+  // Most rays miss the range of heights of the whole patch
+  real patchSize = mCellSize * real(cCellsPerSide);
+  Vec3 rootMin = Vec3(mPatchStart.x, Dequantize(mNodeMin[0]), mPatchStart.y);
+  Vec3 rootMax = Vec3(mPatchStart.x + patchSize, Dequantize(mNodeMax[0]), mPatchStart.y + patchSize);
+  if (Intersection::RayAabb(rayStart, rayDir, rootMin, rootMax) == Intersection::None)
+    return false;
+
+  // Visiting the child nearest the ray's start first, then the two beside it
+  // and then the far one walks the quadtree front to back
+  uint childOrder = (rayDir.x < real(0.0) ? 1 : 0) | (rayDir.z < real(0.0) ? 2 : 0);
+  return CastRayNode(0, 0, 0, childOrder, rayStart, rayDir, result);
+}
+
+bool QuantizedHeightPatch::CastRayNode(uint level, uint x, uint y, uint childOrder, Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const
+{
+  real minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+  uint mask = GetChildBounds(level, x, y, real(0.0), minX, minY, minZ, maxX, maxY, maxZ);
+  if (mask == 0)
+    return false;
+  mask &= Intersection::RayAabb4(rayStart, rayDir, minX, minY, minZ, maxX, maxY, maxZ);
+
+  for (uint i = 0; i < 4; ++i)
+  {
+    uint child = i ^ childOrder;
+    if ((mask & (1 << child)) == 0)
+      continue;
+
+    uint childX = x * 2 + (child & 1);
+    uint childY = y * 2 + (child >> 1);
+    if (level + 1 == cCellLevel)
+    {
+      if (CastRayCell(childX, childY, rayStart, rayDir, result))
+        return true;
+    }
+    else if (CastRayNode(level + 1, childX, childY, childOrder, rayStart, rayDir, result))
+      return true;
+  }
+  return false;
+}
+
+bool QuantizedHeightPatch::CastRayCell(uint x, uint y, Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const
+{
+  Triangle triangles[2];
+  uint count = GetCellTriangles(CellIndex(x, y), triangles);
+
+  // Same epsilon as the HeightMapRayRange
+  real epsilon = real(0.001);
+  bool hit = false;
+  for (uint i = 0; i < count; ++i)
+  {
+    Triangle& tri = triangles[i];
+    Intersection::IntersectionPoint point;
+    if (Intersection::RayTriangle(rayStart, rayDir, tri.p0, tri.p1, tri.p2, &point, epsilon) == Intersection::None)
+      continue;
+    if (hit && point.T >= result.mIntersectionInfo.T)
+      continue;
+
+    result.mLocalTri = tri;
+    result.mIntersectionInfo = point;
+    result.mCellIndex = CellIndex(x, y);
+    result.mTriangleIndex = i;
+    hit = true;
+  }
+  return hit;
+}
+
+uint QuantizedHeightPatch::GetNodeIndex(uint level, uint x, uint y)
+{
+  // Each level has 4 times the nodes of the one above it
+  uint levelStart = ((1 << (2 * level)) - 1) / 3;
+  return levelStart + y * (1 << level) + x;
+}
+
+uint QuantizedHeightPatch::GetVertexIndex(uint x, uint y)
+{
+  return x + y * cVerticesPerSide;
+}
+
+real QuantizedHeightPatch::Dequantize(u16 height) const
+{
+  return mMinHeight + real(height) * mHeightScale;
+}
+
+bool QuantizedHeightPatch::GetCellRange(uint x, uint y, u16& minHeight, u16& maxHeight) const
+{
+  u16 h00 = mHeights[GetVertexIndex(x, y)];
+  u16 h01 = mHeights[GetVertexIndex(x, y + 1)];
+  u16 h10 = mHeights[GetVertexIndex(x + 1, y)];
+  u16 h11 = mHeights[GetVertexIndex(x + 1, y + 1)];
+
+  bool tri0Valid = h00 != cHole && h01 != cHole && h10 != cHole;
+  bool tri1Valid = h01 != cHole && h10 != cHole && h11 != cHole;
+  if (!tri0Valid && !tri1Valid)
+    return false;
+
+  // Both triangles share the 01 and 10 vertices
+  minHeight = Math::Min(h01, h10);
+  maxHeight = Math::Max(h01, h10);
+  if (tri0Valid)
+  {
+    minHeight = Math::Min(minHeight, h00);
+    maxHeight = Math::Max(maxHeight, h00);
+  }
+  if (tri1Valid)
+  {
+    minHeight = Math::Min(minHeight, h11);
+    maxHeight = Math::Max(maxHeight, h11);
+  }
+  return true;
+}
+
+QuantizedHeightMapAabbRange::QuantizedHeightMapAabbRange()
+{
+  mMap = nullptr;
+  mPatches = nullptr;
+  mCurrentPatch = nullptr;
+  mNodeStackSize = 0;
+  mTriangleCount = 0;
+  mTriangleIndex = 0;
+}
+
+void QuantizedHeightMapAabbRange::SetLocal(HeightMap* map, QuantizedPatchMap* patches, const Aabb& aabb, real thickness)
+{
+  mMap = map;
+  mPatches = patches;
+  mLocalAabbMin = aabb.mMin;
+  mLocalAabbMax = aabb.mMax;
+  mThickness = thickness;
+
+  mMinPatch = mMap->GetPatchIndexFromLocal(Vec2(mLocalAabbMin.x, mLocalAabbMin.z));
+  mMaxPatch = mMap->GetPatchIndexFromLocal(Vec2(mLocalAabbMax.x, mLocalAabbMax.z));
+  mPatchIndex = mMinPatch;
+
+  LoadPatch();
+  LoadTriangles();
+}
+
+void QuantizedHeightMapAabbRange::PopFront()
+{
+  ++mTriangleIndex;
+  if (mTriangleIndex >= mTriangleCount)
+    LoadTriangles();
+}
+
+bool QuantizedHeightMapAabbRange::Empty() const
+{
+  return mPatchIndex.y > mMaxPatch.y;
+}
+
+QuantizedHeightMapAabbRange::TriangleInfo& QuantizedHeightMapAabbRange::Front()
+{
+  return mTriangles[mTriangleIndex];
+}
+
+void QuantizedHeightMapAabbRange::LoadPatch()
+{
+  mNodeStackSize = 0;
+  for (; !Empty(); GetNextPatch())
+  {
+    mCurrentPatch = mPatches->FindPointer(mPatchIndex);
+    if (mCurrentPatch == nullptr)
+      continue;
+
+    // Most queries away from the surface stop at the patch's height range
+    // (the patch's extents were already found from the aabb)
+    real minHeight = mCurrentPatch->GetMinHeight() - mThickness;
+    real maxHeight = mCurrentPatch->GetMaxHeight();
+    if (minHeight > mLocalAabbMax.y || maxHeight < mLocalAabbMin.y)
+      continue;
+
+    NodeEntry& root = mNodeStack[mNodeStackSize++];
+    root.mLevel = 0;
+    root.mX = 0;
+    root.mY = 0;
+    return;
+  }
+}
+
+void QuantizedHeightMapAabbRange::GetNextPatch()
+{
+  ++mPatchIndex.x;
+  if (mPatchIndex.x > mMaxPatch.x)
+  {
+    mPatchIndex.x = mMinPatch.x;
+    ++mPatchIndex.y;
+  }
+}
+
+void QuantizedHeightMapAabbRange::LoadTriangles()
+{
+  mTriangleCount = 0;
+  mTriangleIndex = 0;
+
+  while (!Empty())
+  {
+    while (mNodeStackSize != 0)
+    {
+      NodeEntry node = mNodeStack[--mNodeStackSize];
+
+      real minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+      uint mask = mCurrentPatch->GetChildBounds(node.mLevel, node.mX, node.mY, mThickness, minX, minY, minZ, maxX, maxY, maxZ);
+      if (mask == 0)
+        continue;
+      mask &= Intersection::AabbAabb4(mLocalAabbMin, mLocalAabbMax, minX, minY, minZ, maxX, maxY, maxZ);
+
+      uint childLevel = node.mLevel + 1;
+      for (uint i = 0; i < 4; ++i)
+      {
+        if ((mask & (1 << i)) == 0)
+          continue;
+
+        uint childX = node.mX * 2 + (i & 1);
+        uint childY = node.mY * 2 + (i >> 1);
+        if (childLevel == QuantizedHeightPatch::cCellLevel)
+        {
+          GatherCellTriangles(childX, childY);
+          continue;
+        }
+
+        NodeEntry& child = mNodeStack[mNodeStackSize++];
+        child.mLevel = (u8)childLevel;
+        child.mX = (u8)childX;
+        child.mY = (u8)childY;
+      }
+
+      if (mTriangleCount != 0)
+        return;
+    }
+
+    GetNextPatch();
+    LoadPatch();
+  }
+}
+
+void QuantizedHeightMapAabbRange::GatherCellTriangles(uint x, uint y)
+{
+  CellIndex cellIndex = CellIndex(x, y);
+  Triangle triangles[2];
+  uint count = mCurrentPatch->GetCellTriangles(cellIndex, triangles);
+  for (uint i = 0; i < count; ++i)
+  {
+    TriangleInfo& info = mTriangles[mTriangleCount++];
+    info.mLocalTri = triangles[i];
+    info.mPatchIndex = mPatchIndex;
+    info.mCellIndex = cellIndex;
+    info.mTriangleIndex = i;
+  }
+}
+
+} // namespace Raverie
@@ -0,0 +1,143 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+/// A compact, read only copy of the collision data of one HeightPatch. Heights
+/// are stored as 16 bit values relative to the lowest height in the patch
+/// (losing at most 1/65534th of the patch's height range) and a min/max
+/// quadtree over the cells lets queries skip any region of the patch that they
+/// can't touch. The vertices shared with the next patches are copied in so
+/// every quad of the patch can be built without looking at another patch.
+class QuantizedHeightPatch
+{
+public:
+  static const uint cCellsPerSide = HeightPatch::Size;
+  static const uint cVerticesPerSide = cCellsPerSide + 1;
+  static const uint cVertexCount = cVerticesPerSide * cVerticesPerSide;
+  /// Marks a vertex that doesn't exist (a hole or the edge of the map).
+  static const u16 cHole = 0xffff;
+  static const u16 cMaxQuantizedHeight = 0xfffe;
+  /// The stored levels of the quadtree, from the whole patch down to nodes of
+  /// 2x2 cells. The level below that is the cells themselves, whose bounds
+  /// are computed from their vertices.
+  static const uint cLevelCount = 5;
+  static const uint cCellLevel = cLevelCount;
+  static const uint cNodeCount = 1 + 4 + 16 + 64 + 256;
+
+  /// The nearest triangle hit by a ray.
+  struct RayResult
+  {
+    Triangle mLocalTri;
+    Intersection::IntersectionPoint mIntersectionInfo;
+    CellIndex mCellIndex;
+    /// The index of the triangle in the cell's valid triangles (the same
+    /// index HeightMap::GetQuadAtIndex uses).
+    uint mTriangleIndex;
+  };
+
+  /// Samples and quantizes the patch's vertices and builds the quadtree. The
+  /// removed patch is treated as missing when sampling the shared vertices
+  /// (it's still in the map while its removal event is sent).
+  void Build(HeightMap* map, HeightPatch* patch, HeightPatch* removedPatch = nullptr);
+
+  /// The range of heights (in local space) of the patch's vertices.
+  real GetMinHeight() const;
+  real GetMaxHeight() const;
+
+  /// Fills out the valid triangles of a cell in the same order as
+  /// HeightMap::GetQuadAtIndex and returns how many there are.
+  uint GetCellTriangles(CellIndexParam cellIndex, Triangle triangles[2]) const;
+
+  /// Gets the bounds of the 4 children of a node (structure of arrays for the
+  /// 4-wide intersection tests) with the bottom pushed down by the thickness.
+  /// Returns a mask of the children that have any triangles.
+  uint GetChildBounds(uint level, uint x, uint y, real thickness, real minX[4], real minY[4], real minZ[4], real maxX[4], real maxY[4], real maxZ[4]) const;
+
+  /// Casts a local space ray against the patch, walking the quadtree front to
+  /// back so the first triangle hit is the nearest one.
+  bool CastRay(Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const;
+
+  PatchIndex mIndex;
+
+private:
+  bool CastRayNode(uint level, uint x, uint y, uint childOrder, Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const;
+  bool CastRayCell(uint x, uint y, Vec3Param rayStart, Vec3Param rayDir, RayResult& result) const;
+
+  static uint GetNodeIndex(uint level, uint x, uint y);
+  static uint GetVertexIndex(uint x, uint y);
+  real Dequantize(u16 height) const;
+  /// The quantized min/max of a cell's valid triangles. Returns false if the
+  /// cell doesn't have any.
+  bool GetCellRange(uint x, uint y, u16& minHeight, u16& maxHeight) const;
+
+  Vec2 mPatchStart;
+  real mCellSize;
+  real mMinHeight;
+  real mHeightScale;
+  u16 mHeights[cVertexCount];
+  /// The quantized min/max height of every quadtree node, one level after
+  /// another starting at the root. Nodes without triangles have min > max.
+  u16 mNodeMin[cNodeCount];
+  u16 mNodeMax[cNodeCount];
+};
+
+typedef HashMap<PatchIndex, QuantizedHeightPatch> QuantizedPatchMap;
+
+/// A range of the local space triangles of quantized patches that overlap a
+/// local space aabb. Walks each patch's quadtree, testing 4 children at a time,
+/// and gathers the triangles of every overlapping cell of a 2x2 cell node at
+/// once.
+struct QuantizedHeightMapAabbRange
+{
+  struct TriangleInfo
+  {
+    Triangle mLocalTri;
+    PatchIndex mPatchIndex;
+    CellIndex mCellIndex;
+    uint mTriangleIndex;
+  };
+
+  QuantizedHeightMapAabbRange();
+  void SetLocal(HeightMap* map, QuantizedPatchMap* patches, const Aabb& aabb, real thickness);
+
+  /// Range interface
+  void PopFront();
+  bool Empty() const;
+  TriangleInfo& Front();
+
+private:
+  struct NodeEntry
+  {
+    u8 mLevel;
+    u8 mX;
+    u8 mY;
+  };
+
+  void LoadPatch();
+  void GetNextPatch();
+  /// Walks the quadtree until the triangles of a node have been gathered or
+  /// the patch has no more nodes to visit.
+  void LoadTriangles();
+  void GatherCellTriangles(uint x, uint y);
+
+  HeightMap* mMap;
+  QuantizedPatchMap* mPatches;
+  Vec3 mLocalAabbMin, mLocalAabbMax;
+  real mThickness;
+
+  PatchIndex mMinPatch, mMaxPatch;
+  PatchIndex mPatchIndex;
+  QuantizedHeightPatch* mCurrentPatch;
+
+  NodeEntry mNodeStack[4 * QuantizedHeightPatch::cLevelCount];
+  uint mNodeStackSize;
+
+  /// The triangles of the cells of the last node.
+  TriangleInfo mTriangles[8];
+  uint mTriangleCount;
+  uint mTriangleIndex;
+};
+
+} // namespace Raverie
@@ -346,4 +346,110 @@ uint CastResultsRange::Size()
   return mRange.Size();
 }
 
+RaverieDefineType(CastBatch, builder, type)
+{
+  type->CreatableInScript = true;
+
+  RaverieBindDocumented();
+
+  RaverieBindDefaultCopyDestructor();
+  RaverieBindConstructor(uint);
+
+  RaverieBindMethod(AddRay);
+  RaverieBindMethod(AddSegment);
+  RaverieBindMethod(Clear);
+  RaverieBindGetterProperty(CastCount);
+  RaverieBindGetterSetterProperty(MaxHitsPerCast);
+  RaverieBindMethod(GetHitCount);
+  RaverieBindMethod(GetHits);
+}
+
+CastBatch::CastBatch(uint maxHitsPerCast)
+{
+  mMaxHitsPerCast = 1;
+  SetMaxHitsPerCast(maxHitsPerCast);
+}
+
+uint CastBatch::AddRay(const Ray& ray)
+{
+  QueuedCast& cast = mCasts.PushBack();
+  cast.mStart = ray.Start;
+  cast.mVector = ray.Direction.AttemptNormalized();
+  cast.mSegment = false;
+  return mCasts.Size() - 1;
+}
+
+uint CastBatch::AddSegment(const Segment& segment)
+{
+  QueuedCast& cast = mCasts.PushBack();
+  cast.mStart = segment.Start;
+  cast.mVector = segment.End;
+  cast.mSegment = true;
+  return mCasts.Size() - 1;
+}
+
+void CastBatch::Clear()
+{
+  mCasts.Clear();
+  mResults.Clear();
+  mHitCounts.Clear();
+}
+
+uint CastBatch::GetCastCount()
+{
+  return mCasts.Size();
+}
+
+uint CastBatch::GetMaxHitsPerCast()
+{
+  return mMaxHitsPerCast;
+}
+
+void CastBatch::SetMaxHitsPerCast(uint maxHitsPerCast)
+{
+  // Same limits as CastResults
+  const uint maxResults = 100000;
+  if (maxHitsPerCast == 0)
+  {
+    DoNotifyTimer("Ray/Volume Cast Error", "Cannot make a cast with 0 results.  Result count set to 1.", "Warning", 1.0f);
+    maxHitsPerCast = 1;
+  }
+  if (maxHitsPerCast > maxResults)
+  {
+    DoNotifyTimer("Ray/Volume Cast Error", String::Format("Cannot have %d results in a cast, clamping to %d", maxHitsPerCast, maxResults), "Warning", 1.0f);
+    maxHitsPerCast = maxResults;
+  }
+
+  mMaxHitsPerCast = maxHitsPerCast;
+  mResults.Clear();
+  mHitCounts.Clear();
+}
+
+uint CastBatch::GetHitCount(uint castIndex)
+{
+  if (!ValidateCastIndex(castIndex))
+    return 0;
+  return mHitCounts[castIndex];
+}
+
+CastBatch::range CastBatch::GetHits(uint castIndex)
+{
+  if (!ValidateCastIndex(castIndex))
+    return range();
+  return mResults.SubRange(castIndex * mMaxHitsPerCast, mHitCounts[castIndex]);
+}
+
+bool CastBatch::ValidateCastIndex(uint castIndex)
+{
+  if (castIndex >= mCasts.Size())
+  {
+    String msg = String::Format("Index %d is invalid. There are only %d casts in the batch", castIndex, mCasts.Size());
+    DoNotifyException("Invalid index", msg);
+    return false;
+  }
+
+  // The batch hasn't been cast since this cast was added
+  return castIndex < mHitCounts.Size();
+}
+
 } // namespace Raverie
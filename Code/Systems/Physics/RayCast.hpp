@@ -185,4 +185,54 @@ struct CastResultsRange
   CastResultArray mArray;
 };
 
+/// A set of rays and segments that are cast all at once through
+/// PhysicsSpace.CastRays. Every cast keeps up to MaxHitsPerCast results (sorted
+/// by time) and all of the results are stored back to back in one array, so
+/// casting many rays (e.g. projectiles) doesn't allocate a CastResults each.
+class CastBatch
+{
+public:
+  RaverieDeclareType(CastBatch, TypeCopyMode::ReferenceType);
+  typedef CastResultArray::range range;
+
+  CastBatch(uint maxHitsPerCast = 1);
+
+  /// Adds a ray to the batch. Returns the index of the cast.
+  uint AddRay(const Ray& ray);
+  /// Adds a segment to the batch. Returns the index of the cast.
+  uint AddSegment(const Segment& segment);
+  /// Removes all casts and their results.
+  void Clear();
+
+  /// The number of rays and segments in the batch.
+  uint GetCastCount();
+  /// The most objects each cast can hit. Setting this throws away old results.
+  uint GetMaxHitsPerCast();
+  void SetMaxHitsPerCast(uint maxHitsPerCast);
+
+  /// The number of objects that the cast at the given index hit.
+  uint GetHitCount(uint castIndex);
+  /// The objects that the cast at the given index hit, sorted by time.
+  range GetHits(uint castIndex);
+
+private:
+  friend class PhysicsSpace;
+
+  bool ValidateCastIndex(uint castIndex);
+
+  /// The start and direction of a ray or the start and end of a segment.
+  struct QueuedCast
+  {
+    Vec3 mStart;
+    Vec3 mVector;
+    bool mSegment;
+  };
+
+  Array<QueuedCast> mCasts;
+  /// mMaxHitsPerCast results for every cast.
+  CastResultArray mResults;
+  Array<uint> mHitCounts;
+  uint mMaxHitsPerCast;
+};
+
 } // namespace Raverie
@@ -59,6 +59,7 @@ RaverieDefineType(RigidBody, builder, type)
   RaverieBindMethod(ForceAwake);
   RaverieBindMethod(ForceAsleep);
   RaverieBindGetterSetterProperty(RotationLocked)->RaverieSerialize(false);
+  RaverieBindGetterSetterProperty(ContinuousCollision)->RaverieSerialize(false);
   RaverieBindGetterSetterProperty(Mode2D)->RaverieSerialize(Mode2DStates::InheritFromSpace);
   RaverieBindGetterProperty(Mass);
   RaverieBindGetter(LocalInverseInertiaTensor);
@@ -87,6 +88,8 @@ RigidBody::RigidBody()
   mPhysicsNode = nullptr;
   mSpaceEffectsToIgnore = nullptr;
   mSpace = nullptr;
+  mStoreIndex = Physics::RigidBodyStore::cInvalidIndex;
+  mPersistentIsland = nullptr;
 }
 
 void RigidBody::Serialize(Serializer& stream)
@@ -554,6 +557,16 @@ void RigidBody::SetRotationLocked(bool state)
     ForceAwake();
 }
 
+bool RigidBody::GetContinuousCollision() const
+{
+  return mState.IsSet(RigidBodyStates::ContinuousCollision);
+}
+
+void RigidBody::SetContinuousCollision(bool state)
+{
+  mState.SetState(RigidBodyStates::ContinuousCollision, state);
+}
+
 Mode2DStates::Enum RigidBody::GetMode2D() const
 {
   // Convert our bits to the enum representation
@@ -12,8 +12,13 @@ class PhysicsSpace;
 class PhysicsNode;
 class IgnoreSpaceEffects;
 
+namespace Physics
+{
+class PersistentIsland;
+}
+
 // Internal states of a rigid body.
-DeclareBitField8(RigidBodyStates, Static, Asleep, Kinematic, RotationLocked, Mode2D, AllowSleep, Inherit2DMode, SleepAccumulated);
+DeclareBitField9(RigidBodyStates, Static, Asleep, Kinematic, RotationLocked, Mode2D, AllowSleep, Inherit2DMode, SleepAccumulated, ContinuousCollision);
 
 /// What kind of dynamics this body should have. Determines if forces are
 /// integrated and if collisions are resolved.
@@ -216,6 +221,14 @@ public:
   bool GetRotationLocked() const;
   void SetRotationLocked(bool state);
 
+  /// Keeps fast moving bodies (e.g. projectiles) from tunneling through other
+  /// objects. The body's broad phase aabb covers where it will move over the
+  /// timestep and contacts are created before the body touches anything. Costs
+  /// more than normal collision so it should only be used on bodies that need
+  /// it. See PhysicsSolverConfig.SpeculativeContacts.
+  bool GetContinuousCollision() const;
+  void SetContinuousCollision(bool state);
+
   /// Used to make an object act as if it were 2D. This is done by locking
   /// it to the current z-plane and only allowing rotation about the
   /// world's z-axis. Objects can be set to always be 2D or 3D, or this can
@@ -392,6 +405,12 @@ public:
   // Space information
   PhysicsSpace* mSpace;
   Link<RigidBody> mSpaceLink;
+  /// Handle into the space's RigidBodyStore (only while in the active list).
+  uint mStoreIndex;
+  /// The group of connected bodies this body sleeps and wakes with. Only
+  /// dynamic bodies are ever in one.
+  Physics::PersistentIsland* mPersistentIsland;
+  Link<RigidBody> mPersistentIslandLink;
 };
 
 typedef InList<RigidBody, &RigidBody::mSpaceLink> RigidBodyList;
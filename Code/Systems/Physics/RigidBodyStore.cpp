@@ -0,0 +1,329 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+namespace Raverie
+{
+
+namespace Physics
+{
+
+RigidBodyStore::RigidBodyStore()
+{
+}
+
+void RigidBodyStore::Add(RigidBody* body)
+{
+  if (body->mStoreIndex != cInvalidIndex)
+    return;
+
+  body->mStoreIndex = mBodies.Size();
+  mBodies.PushBack(body);
+
+  // Grow a whole lane at a time (the new lanes start zeroed)
+  uint paddedSize = mFields[0].Size();
+  if (mBodies.Size() > paddedSize)
+  {
+    for (uint i = 0; i < FieldCount; ++i)
+      mFields[i].Resize(paddedSize + cLaneCount, real(0.0));
+  }
+}
+
+void RigidBodyStore::Remove(RigidBody* body)
+{
+  uint index = body->mStoreIndex;
+  if (index == cInvalidIndex)
+    return;
+
+  ErrorIf(mBodies[index] != body, "Rigid body does not own its store handle.");
+  body->mStoreIndex = cInvalidIndex;
+
+  // Move the last body into the freed slot so the arrays stay dense. A body
+  // that was already gathered is still written back from its new slot.
+  uint lastIndex = mBodies.Size() - 1;
+  for (uint i = 0; i < mGathered.Size(); ++i)
+  {
+    if (mGathered[i] == index)
+      mGathered.EraseAt(i--);
+    else if (mGathered[i] == lastIndex)
+      mGathered[i] = index;
+  }
+
+  if (index != lastIndex)
+  {
+    RigidBody* lastBody = mBodies[lastIndex];
+    mBodies[index] = lastBody;
+    lastBody->mStoreIndex = index;
+    for (uint i = 0; i < FieldCount; ++i)
+      mFields[i][index] = mFields[i][lastIndex];
+  }
+  mBodies.PopBack();
+}
+
+void RigidBodyStore::Clear()
+{
+  for (uint i = 0; i < mBodies.Size(); ++i)
+    mBodies[i]->mStoreIndex = cInvalidIndex;
+  mBodies.Clear();
+  for (uint i = 0; i < FieldCount; ++i)
+    mFields[i].Clear();
+  mGathered.Clear();
+}
+
+uint RigidBodyStore::Size() const
+{
+  return mBodies.Size();
+}
+
+real* RigidBodyStore::GetField(uint field)
+{
+  return mFields[field].Data();
+}
+
+void RigidBodyStore::SetVec3(uint field, uint index, Vec3Param value)
+{
+  mFields[field][index] = value.x;
+  mFields[field + 1][index] = value.y;
+  mFields[field + 2][index] = value.z;
+}
+
+Vec3 RigidBodyStore::GetVec3(uint field, uint index)
+{
+  return Vec3(mFields[field][index], mFields[field + 1][index], mFields[field + 2][index]);
+}
+
+void RigidBodyStore::GatherVelocity(RigidBody* body, real dt)
+{
+  ErrorIf(body->mStoreIndex == cInvalidIndex, "Only stored bodies can be integrated from the store.");
+  uint index = body->mStoreIndex;
+  mGathered.PushBack(index);
+
+  if (body->mState.IsSet(RigidBodyStates::Mode2D))
+  {
+    body->mVelocity.z = real(0.0);
+    body->mAngularVelocity.x = real(0.0);
+    body->mAngularVelocity.y = real(0.0);
+  }
+  body->mVelocityOld = body->mVelocity;
+  body->mAngularVelocityOld = body->mAngularVelocity;
+
+  SetVec3(LinearX, index, body->mVelocity);
+  SetVec3(AngularX, index, body->mAngularVelocity);
+  SetVec3(InvMassX, index, body->mInvMass.GetInvMasses());
+  SetVec3(ForceX, index, body->mForceAccumulator);
+  SetVec3(TorqueX, index, body->mTorqueAccumulator);
+  // The gyroscopic term needs a small solve per body, it's the only part
+  // of the integration that isn't done in the kernel
+  SetVec3(GyroscopicX, index, SolveGyroscopic(body, dt));
+
+  Mat3 invInertia = body->mInvInertia.GetInvWorldTensor();
+  SetVec3(InvInertia00, index, Vec3(invInertia.m00, invInertia.m01, invInertia.m02));
+  SetVec3(InvInertia10, index, Vec3(invInertia.m10, invInertia.m11, invInertia.m12));
+  SetVec3(InvInertia20, index, Vec3(invInertia.m20, invInertia.m21, invInertia.m22));
+}
+
+void RigidBodyStore::IntegrateVelocities(real dt, real maxVelocity)
+{
+  uint paddedSize = mFields[0].Size();
+  real* vx = GetField(LinearX);
+  real* vy = GetField(LinearY);
+  real* vz = GetField(LinearZ);
+  real* wx = GetField(AngularX);
+  real* wy = GetField(AngularY);
+  real* wz = GetField(AngularZ);
+  const real* mx = GetField(InvMassX);
+  const real* my = GetField(InvMassY);
+  const real* mz = GetField(InvMassZ);
+  const real* i00 = GetField(InvInertia00);
+  const real* i01 = GetField(InvInertia01);
+  const real* i02 = GetField(InvInertia02);
+  const real* i10 = GetField(InvInertia10);
+  const real* i11 = GetField(InvInertia11);
+  const real* i12 = GetField(InvInertia12);
+  const real* i20 = GetField(InvInertia20);
+  const real* i21 = GetField(InvInertia21);
+  const real* i22 = GetField(InvInertia22);
+  const real* fx = GetField(ForceX);
+  const real* fy = GetField(ForceY);
+  const real* fz = GetField(ForceZ);
+  const real* tx = GetField(TorqueX);
+  const real* ty = GetField(TorqueY);
+  const real* tz = GetField(TorqueZ);
+  const real* gx = GetField(GyroscopicX);
+  const real* gy = GetField(GyroscopicY);
+  const real* gz = GetField(GyroscopicZ);
+
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec dtVec = Set(dt);
+  SimVec maxVec = Set(maxVelocity);
+  SimVec minVec = Set(-maxVelocity);
+  for (uint i = 0; i < paddedSize; i += cLaneCount)
+  {
+    // v += invMass * force * dt
+    SimVec v0 = MultiplyAdd(Multiply(UnAlignedLoad(mx + i), UnAlignedLoad(fx + i)), dtVec, UnAlignedLoad(vx + i));
+    SimVec v1 = MultiplyAdd(Multiply(UnAlignedLoad(my + i), UnAlignedLoad(fy + i)), dtVec, UnAlignedLoad(vy + i));
+    SimVec v2 = MultiplyAdd(Multiply(UnAlignedLoad(mz + i), UnAlignedLoad(fz + i)), dtVec, UnAlignedLoad(vz + i));
+    UnAlignedStore(Clamp(v0, minVec, maxVec), vx + i);
+    UnAlignedStore(Clamp(v1, minVec, maxVec), vy + i);
+    UnAlignedStore(Clamp(v2, minVec, maxVec), vz + i);
+
+    // w += invInertia * torque * dt + gyroscopic
+    SimVec t0 = UnAlignedLoad(tx + i);
+    SimVec t1 = UnAlignedLoad(ty + i);
+    SimVec t2 = UnAlignedLoad(tz + i);
+    SimVec a0 = MultiplyAdd(UnAlignedLoad(i02 + i), t2, MultiplyAdd(UnAlignedLoad(i01 + i), t1, Multiply(UnAlignedLoad(i00 + i), t0)));
+    SimVec a1 = MultiplyAdd(UnAlignedLoad(i12 + i), t2, MultiplyAdd(UnAlignedLoad(i11 + i), t1, Multiply(UnAlignedLoad(i10 + i), t0)));
+    SimVec a2 = MultiplyAdd(UnAlignedLoad(i22 + i), t2, MultiplyAdd(UnAlignedLoad(i21 + i), t1, Multiply(UnAlignedLoad(i20 + i), t0)));
+    SimVec w0 = MultiplyAdd(a0, dtVec, Math::Simd::Add(UnAlignedLoad(wx + i), UnAlignedLoad(gx + i)));
+    SimVec w1 = MultiplyAdd(a1, dtVec, Math::Simd::Add(UnAlignedLoad(wy + i), UnAlignedLoad(gy + i)));
+    SimVec w2 = MultiplyAdd(a2, dtVec, Math::Simd::Add(UnAlignedLoad(wz + i), UnAlignedLoad(gz + i)));
+    UnAlignedStore(Clamp(w0, minVec, maxVec), wx + i);
+    UnAlignedStore(Clamp(w1, minVec, maxVec), wy + i);
+    UnAlignedStore(Clamp(w2, minVec, maxVec), wz + i);
+  }
+#else
+  for (uint i = 0; i < paddedSize; ++i)
+  {
+    vx[i] = Math::Clamp(vx[i] + mx[i] * fx[i] * dt, -maxVelocity, maxVelocity);
+    vy[i] = Math::Clamp(vy[i] + my[i] * fy[i] * dt, -maxVelocity, maxVelocity);
+    vz[i] = Math::Clamp(vz[i] + mz[i] * fz[i] * dt, -maxVelocity, maxVelocity);
+
+    real a0 = i00[i] * tx[i] + i01[i] * ty[i] + i02[i] * tz[i];
+    real a1 = i10[i] * tx[i] + i11[i] * ty[i] + i12[i] * tz[i];
+    real a2 = i20[i] * tx[i] + i21[i] * ty[i] + i22[i] * tz[i];
+    wx[i] = Math::Clamp(wx[i] + gx[i] + a0 * dt, -maxVelocity, maxVelocity);
+    wy[i] = Math::Clamp(wy[i] + gy[i] + a1 * dt, -maxVelocity, maxVelocity);
+    wz[i] = Math::Clamp(wz[i] + gz[i] + a2 * dt, -maxVelocity, maxVelocity);
+  }
+#endif
+}
+
+void RigidBodyStore::ScatterVelocities()
+{
+  for (uint i = 0; i < mGathered.Size(); ++i)
+  {
+    uint index = mGathered[i];
+    RigidBody* body = mBodies[index];
+    body->mVelocity = GetVec3(LinearX, index);
+    body->mAngularVelocity = GetVec3(AngularX, index);
+  }
+  mGathered.Clear();
+}
+
+void RigidBodyStore::GatherPosition(RigidBody* body)
+{
+  ErrorIf(body->mStoreIndex == cInvalidIndex, "Only stored bodies can be integrated from the store.");
+  uint index = body->mStoreIndex;
+  mGathered.PushBack(index);
+
+  // The solver has changed the velocities since they were integrated
+  SetVec3(LinearX, index, body->mVelocity);
+  SetVec3(AngularX, index, body->mAngularVelocity);
+  SetVec3(InvMassX, index, body->mInvMass.GetInvMasses());
+  SetVec3(ForceX, index, body->mForceAccumulator);
+
+  Quat rotation = body->GetWorldRotationQuat();
+  mFields[RotationX][index] = rotation.x;
+  mFields[RotationY][index] = rotation.y;
+  mFields[RotationZ][index] = rotation.z;
+  mFields[RotationW][index] = rotation.w;
+}
+
+void RigidBodyStore::IntegratePositions(real dt)
+{
+  uint paddedSize = mFields[0].Size();
+  const real* vx = GetField(LinearX);
+  const real* vy = GetField(LinearY);
+  const real* vz = GetField(LinearZ);
+  const real* wx = GetField(AngularX);
+  const real* wy = GetField(AngularY);
+  const real* wz = GetField(AngularZ);
+  const real* mx = GetField(InvMassX);
+  const real* my = GetField(InvMassY);
+  const real* mz = GetField(InvMassZ);
+  const real* fx = GetField(ForceX);
+  const real* fy = GetField(ForceY);
+  const real* fz = GetField(ForceZ);
+  const real* qx = GetField(RotationX);
+  const real* qy = GetField(RotationY);
+  const real* qz = GetField(RotationZ);
+  const real* qw = GetField(RotationW);
+  real* ox = GetField(OffsetX);
+  real* oy = GetField(OffsetY);
+  real* oz = GetField(OffsetZ);
+  real* sx = GetField(SpinX);
+  real* sy = GetField(SpinY);
+  real* sz = GetField(SpinZ);
+  real* sw = GetField(SpinW);
+
+  real halfDt = dt * real(0.5);
+
+#if defined(USESSE)
+  using namespace Math::Simd;
+
+  SimVec dtVec = Set(dt);
+  SimVec halfDtVec = Set(halfDt);
+  for (uint i = 0; i < paddedSize; i += cLaneCount)
+  {
+    // offset = (v + invMass * force * dt / 2) * dt
+    SimVec o0 = MultiplyAdd(Multiply(UnAlignedLoad(mx + i), UnAlignedLoad(fx + i)), halfDtVec, UnAlignedLoad(vx + i));
+    SimVec o1 = MultiplyAdd(Multiply(UnAlignedLoad(my + i), UnAlignedLoad(fy + i)), halfDtVec, UnAlignedLoad(vy + i));
+    SimVec o2 = MultiplyAdd(Multiply(UnAlignedLoad(mz + i), UnAlignedLoad(fz + i)), halfDtVec, UnAlignedLoad(vz + i));
+    UnAlignedStore(Multiply(o0, dtVec), ox + i);
+    UnAlignedStore(Multiply(o1, dtVec), oy + i);
+    UnAlignedStore(Multiply(o2, dtVec), oz + i);
+
+    // spin = (Quat(w, 0) * rotation) * dt / 2
+    SimVec w0 = UnAlignedLoad(wx + i);
+    SimVec w1 = UnAlignedLoad(wy + i);
+    SimVec w2 = UnAlignedLoad(wz + i);
+    SimVec r0 = UnAlignedLoad(qx + i);
+    SimVec r1 = UnAlignedLoad(qy + i);
+    SimVec r2 = UnAlignedLoad(qz + i);
+    SimVec r3 = UnAlignedLoad(qw + i);
+    SimVec s0 = Subtract(MultiplyAdd(w1, r2, Multiply(w0, r3)), Multiply(w2, r1));
+    SimVec s1 = Subtract(MultiplyAdd(w2, r0, Multiply(w1, r3)), Multiply(w0, r2));
+    SimVec s2 = Subtract(MultiplyAdd(w0, r1, Multiply(w2, r3)), Multiply(w1, r0));
+    SimVec s3 = Negate(MultiplyAdd(w2, r2, MultiplyAdd(w1, r1, Multiply(w0, r0))));
+    UnAlignedStore(Multiply(s0, halfDtVec), sx + i);
+    UnAlignedStore(Multiply(s1, halfDtVec), sy + i);
+    UnAlignedStore(Multiply(s2, halfDtVec), sz + i);
+    UnAlignedStore(Multiply(s3, halfDtVec), sw + i);
+  }
+#else
+  for (uint i = 0; i < paddedSize; ++i)
+  {
+    ox[i] = (vx[i] + mx[i] * fx[i] * halfDt) * dt;
+    oy[i] = (vy[i] + my[i] * fy[i] * halfDt) * dt;
+    oz[i] = (vz[i] + mz[i] * fz[i] * halfDt) * dt;
+
+    sx[i] = (wx[i] * qw[i] + wy[i] * qz[i] - wz[i] * qy[i]) * halfDt;
+    sy[i] = (wy[i] * qw[i] + wz[i] * qx[i] - wx[i] * qz[i]) * halfDt;
+    sz[i] = (wz[i] * qw[i] + wx[i] * qy[i] - wy[i] * qx[i]) * halfDt;
+    sw[i] = -(wx[i] * qx[i] + wy[i] * qy[i] + wz[i] * qz[i]) * halfDt;
+  }
+#endif
+}
+
+void RigidBodyStore::ScatterPositions(real dt)
+{
+  for (uint i = 0; i < mGathered.Size(); ++i)
+  {
+    uint index = mGathered[i];
+    RigidBody* body = mBodies[index];
+
+    body->UpdateCenterMass(GetVec3(OffsetX, index));
+    Quat spin(mFields[SpinX][index], mFields[SpinY][index], mFields[SpinZ][index], mFields[SpinW][index]);
+    body->UpdateOrientation(spin);
+    body->GenerateIntegrationUpdate();
+
+    // Attempt to sleep the body.
+    body->UpdateSleepTimer(dt);
+  }
+  mGathered.Clear();
+}
+
+} // namespace Physics
+
+} // namespace Raverie
@@ -0,0 +1,85 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+class RigidBody;
+
+namespace Physics
+{
+
+/// Structure of arrays copy of everything integration reads and writes for the
+/// active dynamic bodies of a space. Each body is given a handle (its index in
+/// the arrays) when it becomes active and keeps it until it falls asleep or is
+/// removed, so integration runs over contiguous memory four bodies at a time
+/// (one per simd lane with USESSE) instead of chasing each body's pointers.
+/// The RigidBody stays the authority on its own state (the solver, effects and
+/// scripts all work on it directly), the store is refreshed from the bodies
+/// that are integrated each step and the results are written back.
+class RigidBodyStore
+{
+public:
+  static const uint cInvalidIndex = uint(-1);
+  /// Bodies are integrated in groups of this many.
+  static const uint cLaneCount = 4;
+
+  RigidBodyStore();
+
+  /// Gives the body a handle. Does nothing if it already has one.
+  void Add(RigidBody* body);
+  /// Releases the body's handle, the last body is moved into its slot.
+  void Remove(RigidBody* body);
+  void Clear();
+  uint Size() const;
+
+  /// Copies the body's velocity integration inputs into its slot. The body's
+  /// old velocities are saved and 2d mode is enforced, just like
+  /// Integration::IntegrateVelocity.
+  void GatherVelocity(RigidBody* body, real dt);
+  void IntegrateVelocities(real dt, real maxVelocity);
+  /// Writes the integrated velocities back to every gathered body.
+  void ScatterVelocities();
+
+  /// Copies the body's position integration inputs into its slot.
+  void GatherPosition(RigidBody* body);
+  void IntegratePositions(real dt);
+  /// Moves every gathered body by its integrated offsets, queues its transform
+  /// update and updates its sleep timer.
+  void ScatterPositions(real dt);
+
+private:
+  enum Field
+  {
+    LinearX, LinearY, LinearZ,
+    AngularX, AngularY, AngularZ,
+    InvMassX, InvMassY, InvMassZ,
+    InvInertia00, InvInertia01, InvInertia02,
+    InvInertia10, InvInertia11, InvInertia12,
+    InvInertia20, InvInertia21, InvInertia22,
+    ForceX, ForceY, ForceZ,
+    TorqueX, TorqueY, TorqueZ,
+    // The implicit gyroscopic change in angular velocity (solved per body)
+    GyroscopicX, GyroscopicY, GyroscopicZ,
+    RotationX, RotationY, RotationZ, RotationW,
+    // Position integration results
+    OffsetX, OffsetY, OffsetZ,
+    SpinX, SpinY, SpinZ, SpinW,
+    FieldCount
+  };
+
+  real* GetField(uint field);
+  void SetVec3(uint field, uint index, Vec3Param value);
+  Vec3 GetVec3(uint field, uint index);
+
+  /// The body in each slot.
+  Array<RigidBody*> mBodies;
+  /// Every field is padded to a whole number of lanes.
+  Array<real> mFields[FieldCount];
+  /// The slots that were gathered since the last scatter.
+  Array<uint> mGathered;
+};
+
+} // namespace Physics
+
+} // namespace Raverie
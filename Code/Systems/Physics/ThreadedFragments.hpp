@@ -13,12 +13,15 @@ struct ConstraintBatch
   ConstraintBatch()
   {
     ConstraintCount = 0;
+    MoleculeOffset = 0;
   }
   ~ConstraintBatch()
   {
     Joints.Clear();
   }
   uint ConstraintCount;
+  /// Where this batch's molecules start in the solver's molecule array.
+  uint MoleculeOffset;
   typedef InList<JointType, &JointType::SolverLink> JointList;
   JointList Joints;
 
@@ -120,13 +123,22 @@ void GroupOperationTwoParamFragment(ConstraintGroup<typename ListType::value_typ
   }
 }
 
+/// The body whose velocities solving a constraint on this collider changes.
+inline RigidBody* GetSolvedBody(Collider* collider)
+{
+  RigidBody* body = collider->GetActiveBody();
+  if (body == nullptr || !body->IsDynamic())
+    return nullptr;
+  return body;
+}
+
 template <typename ListType>
 void SplitConstraints(ListType& joints, ConstraintGroup<typename ListType::value_type>& phases)
 {
   typedef ConstraintPhase<typename ListType::value_type> PhaseType;
   typedef ConstraintBatch<typename ListType::value_type> BatchType;
 
-  HashSet<uint> bodySet;
+  HashSet<RigidBody*> bodySet;
   uint batchSize = 32;
   uint batchesPerPhase = 2;
 
@@ -155,13 +167,16 @@ void SplitConstraints(ListType& joints, ConstraintGroup<typename ListType::value
       typename ListType::pointer joint = &(range.Front());
       range.PopFront();
 
-      // get the id of the two bodies involved in this joint
-      uint idA = joint->GetCollider(0)->mId;
-      uint idB = joint->GetCollider(1)->mId;
+      // get the two bodies that solving this joint changes. The batches of a
+      // phase are solved in parallel so they can't share a body (colliders of
+      // the same body would otherwise be solved at the same time). Bodies that
+      // aren't dynamic can be shared since the solver never changes them.
+      RigidBody* bodyA = GetSolvedBody(joint->GetCollider(0));
+      RigidBody* bodyB = GetSolvedBody(joint->GetCollider(1));
 
       // if either of the bodies have been used in this phase, then skip this
       // joint
-      if (!bodySet.Find(idA).Empty() || !bodySet.Find(idB).Empty())
+      if ((bodyA != nullptr && bodySet.Contains(bodyA)) || (bodyB != nullptr && bodySet.Contains(bodyB)))
         continue;
 
       // if adding this joint would make the batch too large, make a new batch
@@ -187,8 +202,10 @@ void SplitConstraints(ListType& joints, ConstraintGroup<typename ListType::value
       }
 
       // mark both of these bodies as being used for this phase
-      bodySet.Insert(idA);
-      bodySet.Insert(idB);
+      if (bodyA != nullptr)
+        bodySet.Insert(bodyA);
+      if (bodyB != nullptr)
+        bodySet.Insert(bodyB);
 
       // put the joint in this batch
       ListType::Unlink(joint);
@@ -25,12 +25,78 @@ namespace Physics
 {
 
 template <typename JointList>
-void ThreadSolveFunction(JointList& joints, MoleculeWalker molecules, uint startIndex)
+void ThreadSolveFunction(JointList& joints, MoleculeWalker molecules, uint startIndex, uint iteration)
 {
   MoleculeWalker mols = molecules;
   mols += startIndex;
 
-  IterateVelocitiesFragment(joints, mols, 0);
+  IterateVelocitiesFragmentList(joints, mols, iteration);
+}
+
+/// The batches of one phase (which share no bodies) being solved in parallel.
+template <typename JointType>
+struct PhaseSolveData
+{
+  Array<ConstraintBatch<JointType>*> Batches;
+  MoleculeWalker Molecules;
+  uint Iteration;
+};
+
+template <typename JointType>
+void ThreadSolveBatches(void* userData, uint begin, uint end)
+{
+  PhaseSolveData<JointType>* data = (PhaseSolveData<JointType>*)userData;
+  for (uint i = begin; i < end; ++i)
+  {
+    ConstraintBatch<JointType>* batch = data->Batches[i];
+    ThreadSolveFunction(batch->Joints, data->Molecules, batch->MoleculeOffset, data->Iteration);
+  }
+}
+
+/// Solves every phase in order, the batches within a phase are solved across
+/// all of the job system's threads.
+template <typename JointType>
+void ThreadSolveGroup(ConstraintGroup<JointType>& group, MoleculeWalker& molecules, uint iteration)
+{
+  typedef ConstraintPhase<JointType> PhaseType;
+
+  PhaseSolveData<JointType> data;
+  data.Molecules = molecules;
+  data.Iteration = iteration;
+
+  typename ConstraintGroup<JointType>::PhaseTypeList::range phaseRange = group.Phases.All();
+  for (; !phaseRange.Empty(); phaseRange.PopFront())
+  {
+    PhaseType& phase = phaseRange.Front();
+    data.Batches.Clear();
+    typename PhaseType::JointBatches::range range = phase.Batches.All();
+    for (; !range.Empty(); range.PopFront())
+      data.Batches.PushBack(&range.Front());
+
+    Z::gJobs->ParallelFor(0, uint(data.Batches.Size()), 1, &ThreadSolveBatches<JointType>, &data);
+  }
+}
+
+/// Computes the molecules of every batch, recording where each batch's
+/// molecules start so that batches can be solved independently.
+template <typename JointType>
+void ThreadUpdateDataGroup(ConstraintGroup<JointType>& group, MoleculeWalker& molecules, uint& moleculeOffset)
+{
+  typedef ConstraintPhase<JointType> PhaseType;
+
+  typename ConstraintGroup<JointType>::PhaseTypeList::range phaseRange = group.Phases.All();
+  for (; !phaseRange.Empty(); phaseRange.PopFront())
+  {
+    PhaseType& phase = phaseRange.Front();
+    typename PhaseType::JointBatches::range range = phase.Batches.All();
+    for (; !range.Empty(); range.PopFront())
+    {
+      ConstraintBatch<JointType>& batch = range.Front();
+      batch.MoleculeOffset = moleculeOffset;
+      UpdateDataFragmentList(batch.Joints, molecules);
+      moleculeOffset += batch.ConstraintCount;
+    }
+  }
 }
 
 ThreadedSolver::ThreadedSolver()
@@ -124,8 +190,9 @@ void ThreadedSolver::UpdateData()
   SplitConstraints(mContacts, mContactPhases);
   SplitConstraints(mJoints, mJointPhases);
 
-  GroupOperationParamFragment<ContactList>(mContactPhases, molecules, UpdateDataFragmentList<ContactList>);
-  GroupOperationParamFragment<JointList>(mJointPhases, molecules, UpdateDataFragmentList<JointList>);
+  uint moleculeOffset = 0;
+  ThreadUpdateDataGroup(mContactPhases, molecules, moleculeOffset);
+  ThreadUpdateDataGroup(mJointPhases, molecules, moleculeOffset);
 }
 
 void ThreadedSolver::WarmStart()
@@ -150,8 +217,10 @@ void ThreadedSolver::IterateVelocities(uint iteration)
 {
   MoleculeWalker molecules(mMolecules.Data(), sizeof(ConstraintMolecule), 0);
 
-  GroupOperationTwoParamFragment<ContactList>(mContactPhases, molecules, iteration, IterateVelocitiesFragmentList<ContactList>);
-  GroupOperationTwoParamFragment<JointList>(mJointPhases, molecules, iteration, IterateVelocitiesFragmentList<JointList>);
+  // Contacts and joints are coloured separately (they can share bodies), so
+  // only the batches within each of their phases are solved in parallel
+  ThreadSolveGroup(mContactPhases, molecules, iteration);
+  ThreadSolveGroup(mJointPhases, molecules, iteration);
 }
 
 void ThreadedSolver::SolvePositions()
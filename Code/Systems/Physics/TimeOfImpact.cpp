@@ -538,4 +538,9 @@ void TimeOfImpact(TimeOfImpactData* data)
   function(data);
 }
 
+bool CanComputeTimeOfImpact(Collider* colliderA, Collider* colliderB)
+{
+  return sTimeOfImpactLookup[colliderA->mType][colliderB->mType] != nullptr;
+}
+
 } // namespace Raverie
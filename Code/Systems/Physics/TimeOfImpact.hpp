@@ -25,5 +25,7 @@ struct TimeOfImpactData
 };
 
 void TimeOfImpact(TimeOfImpactData* data);
+/// Not every pair of collider types has a time of impact function.
+bool CanComputeTimeOfImpact(Collider* colliderA, Collider* colliderB);
 
 } // namespace Raverie
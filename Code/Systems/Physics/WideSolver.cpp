@@ -0,0 +1,511 @@
+// MIT Licensed (see LICENSE.md).
+#include "Precompiled.hpp"
+
+#ifdef USESSE
+#  include "ConstraintFragmentsSse.hpp"
+#endif
+
+namespace Raverie
+{
+
+namespace Physics
+{
+
+WideContactRow::WideContactRow()
+{
+  Clear();
+}
+
+void WideContactRow::Clear()
+{
+  memset(this, 0, sizeof(WideContactRow));
+}
+
+bool WideContactRow::CanAdd(RigidBody* body0, RigidBody* body1) const
+{
+  for (uint lane = 0; lane < mLaneCount; ++lane)
+  {
+    for (uint i = 0; i < 2; ++i)
+    {
+      RigidBody* body = mBodies[i][lane];
+      if (body != nullptr && (body == body0 || body == body1))
+        return false;
+    }
+  }
+  return true;
+}
+
+void WideContactRow::AddContact(Contact* contact, RigidBody* body0, RigidBody* body1, ConstraintMolecule* molecules)
+{
+  uint lane = mLaneCount;
+  ++mLaneCount;
+
+  mContacts[lane] = contact;
+  mBodies[0][lane] = body0;
+  mBodies[1][lane] = body1;
+
+  uint pointCount = contact->GetContactCount();
+  mPointCount = Math::Max(mPointCount, pointCount);
+  mFrictionRatio[lane] = contact->mManifold->DynamicFriction / pointCount;
+
+  JointMass masses;
+  JointHelpers::GetMasses(contact->GetCollider(0), contact->GetCollider(1), masses);
+  for (uint i = 0; i < 2; ++i)
+  {
+    Vec3 invMass = masses.mInvMass[i].GetInvMasses();
+    for (uint axis = 0; axis < 3; ++axis)
+      mInvMass[i][axis][lane] = invMass[axis];
+
+    for (uint r = 0; r < 3; ++r)
+    {
+      for (uint c = 0; c < 3; ++c)
+        mInvInertia[i][r * 3 + c][lane] = masses.InverseInertia[i](r, c);
+    }
+  }
+
+  for (uint point = 0; point < pointCount; ++point)
+  {
+    for (uint j = 0; j < 3; ++j)
+    {
+      ConstraintMolecule& molecule = molecules[point * 3 + j];
+      WideConstraint& constraint = mConstraints[point][j];
+      for (uint i = 0; i < 2; ++i)
+      {
+        for (uint axis = 0; axis < 3; ++axis)
+        {
+          constraint.mLinear[i][axis][lane] = molecule.mJacobian.Linear[i][axis];
+          constraint.mAngular[i][axis][lane] = molecule.mJacobian.Angular[i][axis];
+        }
+      }
+      constraint.mMass[lane] = molecule.mMass;
+      constraint.mBias[lane] = molecule.mBias;
+      constraint.mGamma[lane] = molecule.mGamma;
+      constraint.mImpulse[lane] = molecule.mImpulse;
+    }
+  }
+}
+
+void WideContactRow::StoreImpulses(ConstraintMolecule* molecules)
+{
+  for (uint lane = 0; lane < mLaneCount; ++lane)
+  {
+    ConstraintMolecule* laneMolecules = molecules + mMoleculeStart[lane];
+    uint pointCount = mContacts[lane]->GetContactCount();
+    for (uint point = 0; point < pointCount; ++point)
+    {
+      for (uint j = 0; j < 3; ++j)
+        laneMolecules[point * 3 + j].mImpulse = mConstraints[point][j].mImpulse[lane];
+    }
+  }
+}
+
+#ifdef USESSE
+
+/// Solves one constraint for every lane of a row. Returns the new accumulated
+/// impulse of each lane.
+SimVec SolveWideConstraint(WideContactRow& row, WideConstraint& constraint, SimVecParam minImpulse, SimVecParam maxImpulse, SimVec linear[2][3], SimVec angular[2][3])
+{
+  SimVec cDot = Simd::ZeroOutVec();
+  for (uint i = 0; i < 2; ++i)
+  {
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      cDot = Simd::MultiplyAdd(linear[i][axis], Simd::UnAlignedLoad(constraint.mLinear[i][axis]), cDot);
+      cDot = Simd::MultiplyAdd(angular[i][axis], Simd::UnAlignedLoad(constraint.mAngular[i][axis]), cDot);
+    }
+  }
+
+  SimVec oldImpulse = Simd::UnAlignedLoad(constraint.mImpulse);
+  cDot = Simd::Add(cDot, Simd::UnAlignedLoad(constraint.mBias));
+  cDot = Simd::MultiplyAdd(Simd::UnAlignedLoad(constraint.mGamma), oldImpulse, cDot);
+  SimVec lambda = Simd::Negate(Simd::Multiply(Simd::UnAlignedLoad(constraint.mMass), cDot));
+
+  SimVec impulse = Simd::Clamp(Simd::Add(oldImpulse, lambda), minImpulse, maxImpulse);
+  lambda = Simd::Subtract(impulse, oldImpulse);
+  Simd::UnAlignedStore(impulse, constraint.mImpulse);
+
+  for (uint i = 0; i < 2; ++i)
+  {
+    SimVec angularImpulse[3];
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      SimVec linearImpulse = Simd::Multiply(Simd::UnAlignedLoad(constraint.mLinear[i][axis]), lambda);
+      linear[i][axis] = Simd::MultiplyAdd(Simd::UnAlignedLoad(row.mInvMass[i][axis]), linearImpulse, linear[i][axis]);
+      angularImpulse[axis] = Simd::Multiply(Simd::UnAlignedLoad(constraint.mAngular[i][axis]), lambda);
+    }
+
+    for (uint r = 0; r < 3; ++r)
+    {
+      for (uint c = 0; c < 3; ++c)
+        angular[i][r] = Simd::MultiplyAdd(Simd::UnAlignedLoad(row.mInvInertia[i][r * 3 + c]), angularImpulse[c], angular[i][r]);
+    }
+  }
+
+  return impulse;
+}
+
+#else
+
+/// Solves one constraint for every lane of a row. Written as loops over the
+/// lanes so the compiler can vectorize them.
+void SolveWideConstraint(WideContactRow& row, WideConstraint& constraint, const real* minImpulse, const real* maxImpulse, real linear[2][3][cWideLaneCount], real angular[2][3][cWideLaneCount])
+{
+  real lambda[cWideLaneCount];
+  for (uint lane = 0; lane < cWideLaneCount; ++lane)
+  {
+    real cDot = real(0.0);
+    for (uint i = 0; i < 2; ++i)
+    {
+      for (uint axis = 0; axis < 3; ++axis)
+      {
+        cDot += linear[i][axis][lane] * constraint.mLinear[i][axis][lane];
+        cDot += angular[i][axis][lane] * constraint.mAngular[i][axis][lane];
+      }
+    }
+
+    real oldImpulse = constraint.mImpulse[lane];
+    cDot += constraint.mBias[lane] + constraint.mGamma[lane] * oldImpulse;
+    real impulse = Math::Clamp(oldImpulse - constraint.mMass[lane] * cDot, minImpulse[lane], maxImpulse[lane]);
+    lambda[lane] = impulse - oldImpulse;
+    constraint.mImpulse[lane] = impulse;
+  }
+
+  for (uint i = 0; i < 2; ++i)
+  {
+    for (uint lane = 0; lane < cWideLaneCount; ++lane)
+    {
+      real angularImpulse[3];
+      for (uint axis = 0; axis < 3; ++axis)
+      {
+        linear[i][axis][lane] += row.mInvMass[i][axis][lane] * constraint.mLinear[i][axis][lane] * lambda[lane];
+        angularImpulse[axis] = constraint.mAngular[i][axis][lane] * lambda[lane];
+      }
+
+      for (uint r = 0; r < 3; ++r)
+      {
+        for (uint c = 0; c < 3; ++c)
+          angular[i][r][lane] += row.mInvInertia[i][r * 3 + c][lane] * angularImpulse[c];
+      }
+    }
+  }
+}
+
+#endif
+
+WideSolver::WideSolver()
+{
+  SetConfiguration(nullptr);
+  mJointConstraintCount = 0;
+  mContactConstraintCount = 0;
+}
+
+WideSolver::~WideSolver()
+{
+  Clear();
+}
+
+void WideSolver::AddJoint(Joint* joint)
+{
+  joint->mSolver = this;
+  joint->UpdateAtomsVirtual();
+  mJointConstraintCount += joint->MoleculeCountVirtual();
+  mJoints.PushBack(joint);
+}
+
+void WideSolver::AddContact(Contact* contact)
+{
+  contact->mSolver = this;
+  contact->UpdateAtoms();
+  mContactConstraintCount += contact->MoleculeCount();
+  mContacts.PushBack(contact);
+}
+
+void WideSolver::AddJoints(JointList& joints)
+{
+  JointList::range range = joints.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Joint* joint = &(range.Front());
+    joint->mSolver = this;
+    joint->UpdateAtomsVirtual();
+    mJointConstraintCount += joint->MoleculeCountVirtual();
+  }
+  mJoints.Splice(mJoints.End(), joints.All());
+}
+
+void WideSolver::AddContacts(ContactList& contacts)
+{
+  ContactList::range range = contacts.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Contact* contact = &(range.Front());
+    contact->mSolver = this;
+    contact->UpdateAtoms();
+    mContactConstraintCount += contact->MoleculeCount();
+  }
+  mContacts.Splice(mContacts.End(), contacts.All());
+}
+
+void WideSolver::Solve(real dt)
+{
+  WideSolver::UpdateData();
+  WideSolver::WarmStart();
+  WideSolver::SolveVelocities();
+  WideSolver::Commit();
+  WideSolver::BatchEvents();
+}
+
+void WideSolver::DebugDraw(uint debugFlags)
+{
+  if (debugFlags & PhysicsSpaceDebugDrawFlags::DrawConstraints)
+    DrawJoints(debugFlags);
+}
+
+void WideSolver::Clear()
+{
+  ClearFragmentList(mJoints);
+  ClearFragmentList(mContacts);
+  mJointConstraintCount = 0;
+  mContactConstraintCount = 0;
+  mRows.Clear();
+}
+
+void WideSolver::UpdateData()
+{
+  mJointMolecules.Resize(mJointConstraintCount);
+  mContactMolecules.Resize(mContactConstraintCount);
+
+  MoleculeWalker jointMolecules(mJointMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  UpdateDataFragmentList(mJoints, jointMolecules);
+
+  // The molecules (and with them the impulses cached on the manifold points)
+  // are computed as normal and then packed into the rows
+  MoleculeWalker contactMolecules(mContactMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  UpdateDataFragmentList(mContacts, contactMolecules);
+
+  BuildRows();
+}
+
+void WideSolver::WarmStart()
+{
+  if (mSolverConfig->mWarmStart == false)
+    return;
+
+  MoleculeWalker jointMolecules(mJointMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  WarmStartFragmentList(mJoints, jointMolecules);
+
+  MoleculeWalker contactMolecules(mContactMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  WarmStartFragmentList(mContacts, contactMolecules);
+}
+
+void WideSolver::SolveVelocities()
+{
+  ProfileScopeTree("SolveVelocities", "ResolutionPhase", Color::DarkMagenta);
+
+  for (uint i = 0; i < GetSolverIterationCount(); ++i)
+    IterateVelocities(i);
+}
+
+void WideSolver::IterateVelocities(uint iteration)
+{
+  MoleculeWalker jointMolecules(mJointMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  IterateVelocitiesFragmentList(mJoints, jointMolecules, iteration);
+
+  for (uint i = 0; i < mRows.Size(); ++i)
+    SolveRow(mRows[i]);
+}
+
+void WideSolver::SolvePositions()
+{
+  JointList jointsToSolve;
+  ContactList contactsToSolve;
+
+  CollectJointsToSolve(mJoints, jointsToSolve);
+  CollectContactsToSolve(mContacts, contactsToSolve, mSolverConfig);
+
+  for (uint iterationCount = 0; iterationCount < GetSolverPositionIterationCount(); ++iterationCount)
+  {
+    if (mSolverConfig->mSubType == PhysicsSolverSubType::BasicSolving)
+    {
+      SolveConstraintPosition(jointsToSolve, EmptyUpdate<Joint>);
+      SolveConstraintPosition(contactsToSolve, ContactUpdate);
+    }
+    else
+    {
+      BlockSolvePositions(jointsToSolve, EmptyUpdate<Joint>);
+      BlockSolvePositions(contactsToSolve, ContactUpdate);
+    }
+  }
+
+  if (!jointsToSolve.Empty())
+    mJoints.Splice(mJoints.End(), jointsToSolve.All());
+  if (!contactsToSolve.Empty())
+    mContacts.Splice(mContacts.End(), contactsToSolve.All());
+}
+
+void WideSolver::Commit()
+{
+  // Copy the impulses out of the rows first so the contacts can store them on
+  // their manifold points for next frame's warm start
+  for (uint i = 0; i < mRows.Size(); ++i)
+    mRows[i].StoreImpulses(mContactMolecules.Data());
+
+  MoleculeWalker jointMolecules(mJointMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  CommitFragmentList(mJoints, jointMolecules);
+
+  MoleculeWalker contactMolecules(mContactMolecules.Data(), sizeof(ConstraintMolecule), 0);
+  CommitFragmentList(mContacts, contactMolecules);
+}
+
+void WideSolver::BatchEvents()
+{
+  BatchEventsFragmentList(mJoints);
+}
+
+void WideSolver::DrawJoints(uint debugFlag)
+{
+  DrawJointsFragmentList(mJoints);
+  DrawJointsFragmentList(mContacts);
+}
+
+void WideSolver::BuildRows()
+{
+  mRows.Clear();
+
+  // Greedily colour the contacts: each contact goes into the first of the
+  // last few rows that has an open lane and doesn't touch either of its
+  // dynamic bodies, otherwise a new row is started
+  uint moleculeStart = 0;
+  ContactList::range range = mContacts.All();
+  for (; !range.Empty(); range.PopFront())
+  {
+    Contact* contact = &range.Front();
+    uint moleculeCount = contact->MoleculeCount();
+    if (moleculeCount == 0)
+      continue;
+
+    RigidBody* body0 = GetSolvedBody(contact->GetCollider(0));
+    RigidBody* body1 = GetSolvedBody(contact->GetCollider(1));
+
+    WideContactRow* row = nullptr;
+    uint rowCount = mRows.Size();
+    uint searchStart = rowCount > cRowSearchCount ? rowCount - cRowSearchCount : 0;
+    for (uint i = searchStart; i < rowCount; ++i)
+    {
+      WideContactRow& testRow = mRows[i];
+      if (testRow.mLaneCount < cWideLaneCount && testRow.CanAdd(body0, body1))
+      {
+        row = &testRow;
+        break;
+      }
+    }
+
+    if (row == nullptr)
+      row = &mRows.PushBack();
+
+    row->mMoleculeStart[row->mLaneCount] = moleculeStart;
+    row->AddContact(contact, body0, body1, mContactMolecules.Data() + moleculeStart);
+    moleculeStart += moleculeCount;
+  }
+}
+
+void WideSolver::SolveRow(WideContactRow& row)
+{
+  // Gather the velocities of each lane's bodies (empty lanes stay at zero)
+  real linear[2][3][cWideLaneCount] = {};
+  real angular[2][3][cWideLaneCount] = {};
+  for (uint lane = 0; lane < row.mLaneCount; ++lane)
+  {
+    Contact* contact = row.mContacts[lane];
+    JointVelocity velocities;
+    JointHelpers::GetVelocities(contact->GetCollider(0), contact->GetCollider(1), velocities);
+    for (uint i = 0; i < 2; ++i)
+    {
+      for (uint axis = 0; axis < 3; ++axis)
+      {
+        linear[i][axis][lane] = velocities.Linear[i][axis];
+        angular[i][axis][lane] = velocities.Angular[i][axis];
+      }
+    }
+  }
+
+#ifdef USESSE
+  SimVec simLinear[2][3];
+  SimVec simAngular[2][3];
+  for (uint i = 0; i < 2; ++i)
+  {
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      simLinear[i][axis] = Simd::UnAlignedLoad(linear[i][axis]);
+      simAngular[i][axis] = Simd::UnAlignedLoad(angular[i][axis]);
+    }
+  }
+
+  SimVec zero = Simd::ZeroOutVec();
+  SimVec positiveMax = Simd::Set(Math::PositiveMax());
+  SimVec frictionRatio = Simd::UnAlignedLoad(row.mFrictionRatio);
+  for (uint point = 0; point < row.mPointCount; ++point)
+  {
+    WideConstraint* constraints = row.mConstraints[point];
+    SimVec normalImpulse = SolveWideConstraint(row, constraints[0], zero, positiveMax, simLinear, simAngular);
+
+    // Same limits as ComputeContactLimits, friction is bounded by the normal
+    // impulse that was just solved
+    SimVec frictionMax = Simd::Multiply(frictionRatio, normalImpulse);
+    SimVec frictionMin = Simd::Negate(frictionMax);
+    SolveWideConstraint(row, constraints[1], frictionMin, frictionMax, simLinear, simAngular);
+    SolveWideConstraint(row, constraints[2], frictionMin, frictionMax, simLinear, simAngular);
+  }
+
+  for (uint i = 0; i < 2; ++i)
+  {
+    for (uint axis = 0; axis < 3; ++axis)
+    {
+      Simd::UnAlignedStore(simLinear[i][axis], linear[i][axis]);
+      Simd::UnAlignedStore(simAngular[i][axis], angular[i][axis]);
+    }
+  }
+#else
+  real normalMin[cWideLaneCount] = {};
+  real normalMax[cWideLaneCount];
+  real frictionMin[cWideLaneCount];
+  real frictionMax[cWideLaneCount];
+  for (uint lane = 0; lane < cWideLaneCount; ++lane)
+    normalMax[lane] = Math::PositiveMax();
+
+  for (uint point = 0; point < row.mPointCount; ++point)
+  {
+    WideConstraint* constraints = row.mConstraints[point];
+    SolveWideConstraint(row, constraints[0], normalMin, normalMax, linear, angular);
+
+    // Same limits as ComputeContactLimits, friction is bounded by the normal
+    // impulse that was just solved
+    for (uint lane = 0; lane < cWideLaneCount; ++lane)
+    {
+      frictionMax[lane] = row.mFrictionRatio[lane] * constraints[0].mImpulse[lane];
+      frictionMin[lane] = -frictionMax[lane];
+    }
+    SolveWideConstraint(row, constraints[1], frictionMin, frictionMax, linear, angular);
+    SolveWideConstraint(row, constraints[2], frictionMin, frictionMax, linear, angular);
+  }
+#endif
+
+  // Only dynamic bodies can change velocity and the colouring guarantees
+  // that each of them is in one lane of the row
+  for (uint lane = 0; lane < row.mLaneCount; ++lane)
+  {
+    for (uint i = 0; i < 2; ++i)
+    {
+      RigidBody* body = row.mBodies[i][lane];
+      if (body == nullptr)
+        continue;
+
+      body->mVelocity.Set(linear[i][0][lane], linear[i][1][lane], linear[i][2][lane]);
+      body->mAngularVelocity.Set(angular[i][0][lane], angular[i][1][lane], angular[i][2][lane]);
+    }
+  }
+}
+
+} // namespace Physics
+
+} // namespace Raverie
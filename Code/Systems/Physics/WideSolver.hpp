@@ -0,0 +1,115 @@
+// MIT Licensed (see LICENSE.md).
+#pragma once
+
+namespace Raverie
+{
+
+namespace Physics
+{
+
+/// How many contacts the WideSolver solves at once. This is the width of the
+/// simd registers (4 floats).
+const uint cWideLaneCount = 4;
+
+/// One constraint (the normal or a friction axis) of one contact point for
+/// every lane of a WideContactRow. Stored as a structure of arrays so that a
+/// value for all lanes can be loaded into one register.
+struct WideConstraint
+{
+  real mLinear[2][3][cWideLaneCount];
+  real mAngular[2][3][cWideLaneCount];
+  real mMass[cWideLaneCount];
+  real mBias[cWideLaneCount];
+  real mGamma[cWideLaneCount];
+  real mImpulse[cWideLaneCount];
+};
+
+/// Up to cWideLaneCount contacts that don't share a dynamic body so they can
+/// be solved at the same time. Empty lanes and the missing points of contacts
+/// with fewer points have no mass so they never apply an impulse.
+struct WideContactRow
+{
+  WideContactRow();
+
+  void Clear();
+  /// Can a contact between these bodies be added without two lanes writing to
+  /// the same body? Null bodies (static or kinematic) can be shared.
+  bool CanAdd(RigidBody* body0, RigidBody* body1) const;
+  /// Copies a contact's molecules into the next open lane.
+  void AddContact(Contact* contact, RigidBody* body0, RigidBody* body1, ConstraintMolecule* molecules);
+  /// Copies the accumulated impulses back to the contacts' molecules.
+  void StoreImpulses(ConstraintMolecule* molecules);
+
+  Contact* mContacts[cWideLaneCount];
+  RigidBody* mBodies[2][cWideLaneCount];
+  /// Where each lane's molecules start in the solver's contact molecules.
+  uint mMoleculeStart[cWideLaneCount];
+  uint mLaneCount;
+  /// The most points of any contact in this row.
+  uint mPointCount;
+
+  real mFrictionRatio[cWideLaneCount];
+  real mInvMass[2][3][cWideLaneCount];
+  real mInvInertia[2][9][cWideLaneCount];
+  /// The normal and two friction constraints of each point.
+  WideConstraint mConstraints[cMaxContacts][3];
+};
+
+/// A solver that solves several contacts at once with simd. Contacts are
+/// graph coloured into rows where no two contacts share a dynamic body, then
+/// the molecules of each row are packed lane by lane so one set of simd
+/// instructions solves a constraint for every contact in the row. Meant for
+/// scenes with large stacks or piles where solving contacts is the bottleneck.
+/// Joints are solved one at a time like the BasicSolver.
+class WideSolver : public IConstraintSolver
+{
+public:
+  WideSolver();
+  ~WideSolver();
+
+  // IConstraintSolver Interface
+  void AddJoint(Joint* joint) override;
+  void AddContact(Contact* contact) override;
+  void AddJoints(JointList& joints) override;
+  void AddContacts(ContactList& contacts) override;
+  // Solve Functions
+  void Solve(real dt) override;
+  void DebugDraw(uint debugFlags) override;
+  void Clear() override;
+  // Iteration functions
+  void UpdateData() override;
+  void WarmStart() override;
+  void SolveVelocities() override;
+  void IterateVelocities(uint iteration) override;
+  void SolvePositions() override;
+  void Commit() override;
+  void BatchEvents() override;
+
+  void DrawJoints(uint debugFlags);
+
+private:
+  typedef InList<Joint, &Joint::SolverLink> JointList;
+  typedef InList<Contact, &Contact::SolverLink> ContactList;
+  typedef Array<ConstraintMolecule> MoleculeList;
+  typedef Array<WideContactRow> RowList;
+
+  /// Colours the contacts into rows and packs their molecules.
+  void BuildRows();
+  void SolveRow(WideContactRow& row);
+
+  /// How many of the last rows are searched for an open lane before a new
+  /// row is started. Keeps building the rows linear in the contact count.
+  static const uint cRowSearchCount = 16;
+
+  JointList mJoints;
+  ContactList mContacts;
+  uint mJointConstraintCount;
+  uint mContactConstraintCount;
+  MoleculeList mJointMolecules;
+  MoleculeList mContactMolecules;
+  RowList mRows;
+};
+
+} // namespace Physics
+
+} // namespace Raverie
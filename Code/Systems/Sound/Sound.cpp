@@ -139,6 +139,11 @@ void SoundLoader::ReloadFromFile(Resource* resource, ResourceEntry& entry)
   LoadSound(sound, entry);
 }
 
+bool SoundLoader::CanLoadOnDemand()
+{
+  return true;
+}
+
 bool SoundLoader::LoadSound(Sound* sound, ResourceEntry& entry)
 {
   Raverie::Status status;
@@ -55,6 +55,7 @@ public:
   HandleOf<Resource> LoadFromBlock(ResourceEntry& entry) override;
   HandleOf<Resource> LoadFromFile(ResourceEntry& entry) override;
   void ReloadFromFile(Resource* resource, ResourceEntry& entry) override;
+  bool CanLoadOnDemand() override;
   bool LoadSound(Sound* sound, ResourceEntry& entry);
 
   AudioFileLoadType::Enum mLoadType;